@@ -0,0 +1,92 @@
+#pragma once
+
+#include "core/VulkanContext.hpp"
+#include "core/MemoryAllocator.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace core {
+
+/**
+ * @brief One logical Vulkan device per sub-domain
+ *
+ * Device 0 is the primary context; the others are created on its instance
+ * with VulkanContext::initShared. Logical devices are spread round-robin
+ * over the matching physical devices, so several of them may share one GPU
+ * (or a software implementation such as lavapipe) to exercise the
+ * multi-device paths on a single machine.
+ *
+ * Devices share no memory or semaphores: data moves between them through
+ * host-visible staging buffers (see halo::StagedTransfer).
+ */
+class DeviceGroup {
+public:
+    /**
+     * @brief Device selection
+     */
+    struct Config {
+        uint32_t deviceCount = 1;
+        std::string deviceFilter;   // Physical device name substring ("llvmpipe" = lavapipe); empty = any
+    };
+
+    /**
+     * Create devices 1..deviceCount-1 next to an initialized primary context
+     * @param primary Device 0 (not owned, must outlive the group)
+     * @param primaryAllocator Allocator of device 0 (not owned)
+     * @param config Device count and physical device filter
+     */
+    DeviceGroup(VulkanContext& primary, MemoryAllocator& primaryAllocator, const Config& config);
+
+    ~DeviceGroup();
+
+    DeviceGroup(const DeviceGroup&) = delete;
+    DeviceGroup& operator=(const DeviceGroup&) = delete;
+
+    /**
+     * Number of logical devices
+     */
+    uint32_t getDeviceCount() const { return static_cast<uint32_t>(m_contexts.size()); }
+
+    /**
+     * Get the context of a logical device
+     */
+    VulkanContext& getContext(uint32_t device) const;
+
+    /**
+     * Get the allocator of a logical device
+     */
+    MemoryAllocator& getAllocator(uint32_t device) const;
+
+    /**
+     * Physical device index (among the matching ones) a logical device was created on
+     */
+    uint32_t getPhysicalIndex(uint32_t device) const { return m_physicalIndices.at(device); }
+
+    /**
+     * Number of distinct physical devices in use
+     */
+    uint32_t getPhysicalDeviceCount() const { return m_physicalCount; }
+
+    /**
+     * Physical device of each logical device: round-robin over the
+     * candidates, starting with the primary's
+     * @param deviceCount Logical devices
+     * @param candidateCount Matching physical devices, the primary's first
+     */
+    static std::vector<uint32_t> assignPhysical(uint32_t deviceCount, uint32_t candidateCount);
+
+private:
+    // Device 0 is borrowed; secondaries are owned
+    std::vector<VulkanContext*> m_contexts;
+    std::vector<MemoryAllocator*> m_allocators;
+    std::vector<std::unique_ptr<VulkanContext>> m_ownedContexts;
+    std::vector<std::unique_ptr<MemoryAllocator>> m_ownedAllocators;
+
+    std::vector<uint32_t> m_physicalIndices;
+    uint32_t m_physicalCount = 1;
+};
+
+} // namespace core
@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.hpp>
 #include <vk_mem_alloc.h>
 #include <cstddef>
+#include <vector>
 
 namespace core {
 
@@ -93,6 +94,20 @@ public:
      */
     void unmapBuffer(const Buffer& buffer);
 
+    /**
+     * Make host writes to a mapped buffer visible to the device
+     * (no-op for host-coherent memory; thread-safe)
+     */
+    void flushBuffer(const Buffer& buffer, vk::DeviceSize offset = 0,
+                    vk::DeviceSize size = VK_WHOLE_SIZE);
+
+    /**
+     * Make device writes to a mapped buffer visible to the host
+     * (no-op for host-coherent memory; thread-safe)
+     */
+    void invalidateBuffer(const Buffer& buffer, vk::DeviceSize offset = 0,
+                         vk::DeviceSize size = VK_WHOLE_SIZE);
+
     /**
      * Copy data from CPU to GPU using a staging buffer
      * Allocates a temporary staging buffer, copies data, and submits transfer commands
@@ -104,6 +119,16 @@ public:
     void uploadToGPU(const Buffer& dst, const void* srcData,
                     vk::DeviceSize size, vk::DeviceSize offset = 0);
 
+    /**
+     * Copy several disjoint regions from CPU to GPU with one staging buffer
+     * and a single submission
+     * @param dst Destination GPU buffer
+     * @param srcData Source CPU data pointer (region srcOffsets are relative to it)
+     * @param regions Copy regions
+     */
+    void uploadToGPU(const Buffer& dst, const void* srcData,
+                    const std::vector<vk::BufferCopy>& regions);
+
     /**
      * Get device address for bindless access
      * @param buffer Buffer to query
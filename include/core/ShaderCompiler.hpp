@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace core {
+
+/**
+ * @brief In-process GLSL to SPIR-V compiler shared by all modules
+ *
+ * Wraps one process-wide libshaderc compiler, created on first use.
+ * Sources are compiled from memory for Vulkan 1.2 (buffer device address,
+ * int64 and scalar layouts are available to every kernel). Safe to call
+ * from several threads at once.
+ */
+class ShaderCompiler {
+public:
+    /**
+     * @brief Outcome of one compilation
+     */
+    struct Result {
+        std::vector<uint32_t> spirv;    // Empty on failure
+        std::string diagnostics;        // Errors and warnings as "name:line: message"
+        uint32_t warningCount = 0;
+        uint32_t errorCount = 0;
+
+        bool succeeded() const { return !spirv.empty(); }
+    };
+
+    /**
+     * Compile a shader
+     * @param source GLSL source
+     * @param stage Shader stage (compute, vertex or fragment)
+     * @param name Name used in diagnostics
+     * @param entryPoint Entry function name
+     */
+    static Result compile(const std::string& source,
+                          vk::ShaderStageFlagBits stage,
+                          const std::string& name,
+                          const std::string& entryPoint = "main");
+
+    /**
+     * Compile a shader, logging its warnings
+     * @return SPIR-V words
+     * @throws std::runtime_error carrying the diagnostics on failure
+     */
+    static std::vector<uint32_t> compileOrThrow(const std::string& source,
+                                                vk::ShaderStageFlagBits stage,
+                                                const std::string& name,
+                                                const std::string& entryPoint = "main");
+
+private:
+    ShaderCompiler() = delete;
+    ~ShaderCompiler() = delete;
+};
+
+} // namespace core
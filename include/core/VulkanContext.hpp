@@ -6,6 +6,7 @@
 // Include other headers
 #include <VkBootstrap.h>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace core {
@@ -34,8 +35,20 @@ public:
     /**
      * Initialize Vulkan 1.3 with required features and extensions
      * @param enableValidation Enable Vulkan validation layers (recommended for debugging)
+     * @param deviceFilter Pick the first physical device whose name contains
+     *        this string (e.g. "llvmpipe" for lavapipe); empty = prefer discrete
      */
-    void init(bool enableValidation = true);
+    void init(bool enableValidation = true, const std::string& deviceFilter = "");
+
+    /**
+     * Create another logical device on an initialized context's instance
+     * (multi-device runs). The instance stays owned by the primary context,
+     * which must outlive this one. Device-level entry points are switched
+     * to the loader's dispatching trampolines, so calls work on every device.
+     * @param primary Context owning the instance
+     * @param physicalDevice Device to create on; may be the primary's own
+     */
+    void initShared(const VulkanContext& primary, vk::PhysicalDevice physicalDevice);
 
     /**
      * Cleanup all Vulkan resources
@@ -100,6 +113,11 @@ public:
      */
     bool isFeatureSupported(const std::string& featureName) const;
 
+    /**
+     * Name of the physical device (for logs)
+     */
+    std::string getDeviceName() const;
+
 private:
     vk::Instance m_instance;
     vk::PhysicalDevice m_physicalDevice;
@@ -112,6 +130,10 @@ private:
     vkb::Device m_vkbDevice;
 
     bool m_initialized = false;
+    bool m_ownsInstance = true;    // False for contexts created with initShared
+
+    // Create m_device and its queues on m_physicalDevice
+    void createLogicalDevice();
 };
 
 } // namespace core
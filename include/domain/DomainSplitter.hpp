@@ -3,27 +3,114 @@
 #include <nanovdb/NanoVDB.h>
 #include <nanovdb/GridHandle.h>
 #include <nanovdb/HostBuffer.h>
+#include <array>
+#include <functional>
 #include <vector>
 #include <cstdint>
 
 namespace domain {
 
+/**
+ * @brief Per-leaf statistics used for partitioning
+ *
+ * Compact summary of a NanoVDB leaf node, so the splitter can balance a grid
+ * without holding its voxel data (e.g. when leaves are streamed from disk).
+ */
+struct LeafStats {
+    nanovdb::Coord origin;                // Leaf origin (multiple of 8)
+    nanovdb::CoordBBox bbox;              // Bounding box of active voxels
+    uint32_t activeCount = 0;             // Number of active voxels in the leaf
+    std::array<uint16_t, 6> faceCounts{}; // Active voxels on each face (-X, +X, -Y, +Y, -Z, +Z)
+};
+
+/**
+ * @brief Space-filling curve / partitioning scheme used to order leaves
+ */
+enum class SplitStrategy {
+    Morton,    // Z-order curve (cheap, but jumps produce fragmented domains)
+    Hilbert,   // Hilbert curve (contiguous, more compact domains)
+    Bisection, // Recursive coordinate bisection (axis-aligned box domains)
+    Graph      // Multilevel graph partition of the leaf adjacency graph (minimal edge cut)
+};
+
+/**
+ * @brief How halo data reaches edge and corner neighbors
+ */
+enum class HaloRouting {
+    Direct,    // One message per neighbor, edge and corner neighbors included
+    Forwarded  // Face messages only, one phase per axis (X, Y, Z); diagonal data is relayed
+};
+
+/**
+ * @brief Periodic wrap of the domain box along some axes
+ *
+ * The grid carries a ghost shell just outside the box on each periodic
+ * axis (see DomainSplitter::addPeriodicGhosts). Ghost voxels are ordinary
+ * field elements, so stencils read across the wrap without index
+ * arithmetic; the halo exchange refills them from their periodic images.
+ */
+struct PeriodicBoundary {
+    std::array<bool, 3> axes{};      // Periodic along X, Y, Z
+    nanovdb::CoordBBox box;          // Cells of one period (inclusive)
+
+    bool any() const { return axes[0] || axes[1] || axes[2]; }
+    int32_t period(int axis) const { return box.max()[axis] - box.min()[axis] + 1; }
+
+    // Outside the box along a periodic axis (filled from its image)
+    bool isGhost(const nanovdb::Coord& ijk) const {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (axes[axis] && (ijk[axis] < box.min()[axis] || ijk[axis] > box.max()[axis])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Periodic image inside the box (unchanged along non-periodic axes)
+    nanovdb::Coord wrap(const nanovdb::Coord& ijk) const {
+        nanovdb::Coord image = ijk;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (axes[axis]) {
+                int32_t offset = (ijk[axis] - box.min()[axis]) % period(axis);
+                image[axis] = box.min()[axis] + (offset < 0 ? offset + period(axis) : offset);
+            }
+        }
+        return image;
+    }
+};
+
 /**
  * @brief Sub-domain descriptor for a single GPU
  */
 struct SubDomain {
     uint32_t gpuIndex = 0;
+    uint32_t deviceIndex = 0;                            // Partition slot before empty domains were
+                                                         // dropped (indexes SplitConfig::deviceThroughput)
     nanovdb::CoordBBox bounds;                           // Inclusive bounding box
     uint32_t activeVoxelCount = 0;
+    double workload = 0.0;                               // Summed leaf cost (see SplitConfig::leafCost)
     std::vector<nanovdb::CoordBBox> assignedLeaves;     // Leaf nodes in this domain
 
     // Neighbor information for halo exchange
     struct Neighbor {
         uint32_t gpuIndex = 0;
-        uint32_t face = 0;  // 0=-X, 1=+X, 2=-Y, 3=+Y, 4=-Z, 5=+Z
+        uint32_t face = 0;  // 0=-X, 1=+X, 2=-Y, 3=+Y, 4=-Z, 5=+Z (dominant contact face)
+        uint32_t contactCount = 0;    // Adjacent (leaf, direction) pairs across the interface
+        uint32_t directionMask = 0;   // Bit (dx+1)*9 + (dy+1)*3 + (dz+1) per contact direction
     };
     std::vector<Neighbor> neighbors;
 
+    // Exact halo send list towards one neighbor
+    struct HaloList {
+        uint32_t neighborGpu = 0;
+        std::vector<nanovdb::Coord> sendVoxels;  // Active owned voxels the neighbor reads, by layer
+        std::vector<nanovdb::Coord> recvVoxels;  // Where the neighbor stores each one (empty = same
+                                                 // coords; periodic ghosts differ by a period)
+        std::vector<uint32_t> layerEnds;         // layerEnds[k] = voxels within distance k + 1
+        uint32_t phase = 0;                      // Exchange phase (Forwarded: axis of the shared face)
+    };
+    std::vector<HaloList> haloLists;
+
     // Statistics
     uint64_t estimatedMemoryUsage() const {
         return static_cast<uint64_t>(activeVoxelCount) * sizeof(float) * 8;
@@ -46,6 +133,20 @@ public:
         uint32_t haloThickness = 2;
         bool preferSpatialLocality = true;
         float loadBalanceTolerance = 0.1f;
+        SplitStrategy strategy = SplitStrategy::Morton;
+        HaloRouting haloRouting = HaloRouting::Direct;
+
+        // Periodic axes: ghost voxels outside the box are exchanged with the
+        // owners of their images (possibly the same domain)
+        PeriodicBoundary periodic;
+
+        // Cost model: predicted work of a leaf (empty = active voxel count).
+        // May combine boundary stencils, refinement sub-steps or measured timings.
+        std::function<double(const LeafStats&)> leafCost;
+
+        // Relative throughput of each device (empty = all equal). Domain i is
+        // given work proportional to deviceThroughput[i].
+        std::vector<double> deviceThroughput;
     };
 
     /**
@@ -57,6 +158,17 @@ public:
         double averageVoxels = 0.0;
         double standardDeviation = 0.0;
         double imbalanceFactor = 0.0;  // max / avg
+
+        // Communication metrics (leaf-face granularity)
+        uint64_t totalHaloVoxels = 0;      // Voxels received by all domains per exchange
+        uint64_t maxHaloVoxels = 0;        // Largest per-domain halo
+        double averageSurfaceToVolume = 0.0;  // Boundary-face voxels / active voxels
+        double maxSurfaceToVolume = 0.0;
+
+        // Cost-model predictions (workload / device throughput)
+        std::vector<double> predictedDeviceTime;
+        double maxPredictedTime = 0.0;
+        double predictedImbalance = 0.0;   // max / avg predicted time
     };
 
     explicit DomainSplitter();
@@ -69,6 +181,35 @@ public:
      */
     static uint64_t getMortonCode(const nanovdb::Coord& coord);
 
+    /**
+     * Compute Hilbert curve index for a non-negative coordinate
+     * @param coord 3D coordinate (each component < 2^order)
+     * @param order Number of bits per axis (max 21)
+     * @return Hilbert index
+     */
+    static uint64_t getHilbertCode(const nanovdb::Coord& coord, uint32_t order = 21);
+
+    /**
+     * Compute hash key of the leaf containing a coordinate
+     * @param coord Any coordinate inside the leaf (e.g. its origin)
+     * @return Key unique per leaf for leaf indices within +/-2^20
+     */
+    static uint64_t getLeafKey(const nanovdb::Coord& coord);
+
+    /**
+     * Summarize a leaf node for partitioning
+     * @param leaf Leaf node (from a resident grid or a streamed chunk)
+     * @return Leaf statistics
+     */
+    static LeafStats computeLeafStats(const nanovdb::NanoLeaf<float>& leaf);
+
+    /**
+     * Summarize every leaf of a grid (one pass, active counts via popcount)
+     * @param grid Host-resident float grid
+     * @return Per-leaf statistics in tree order
+     */
+    static std::vector<LeafStats> collectLeafStats(const nanovdb::GridHandle<nanovdb::HostBuffer>& grid);
+
     /**
      * Main split function - divides grid into sub-domains
      * @param grid Full NanoVDB grid on host
@@ -76,16 +217,106 @@ public:
      */
     std::vector<SubDomain> split(const nanovdb::GridHandle<nanovdb::HostBuffer>& grid);
 
+    /**
+     * Split using precomputed leaf statistics (no resident grid required)
+     * @param leaves Statistics for every leaf of the grid
+     * @return Vector of sub-domains (one per GPU)
+     */
+    std::vector<SubDomain> split(const std::vector<LeafStats>& leaves);
+
     /**
      * Extract sub-grid for a specific domain
      * @param fullGrid Full NanoVDB grid
      * @param domain Domain to extract
-     * @return Sub-grid handle containing only voxels in domain bounds
+     * @return Sub-grid handle containing only the domain's assigned leaves
      */
     nanovdb::GridHandle<nanovdb::HostBuffer> extract(
         const nanovdb::GridHandle<nanovdb::HostBuffer>& fullGrid,
         const SubDomain& domain);
 
+    /**
+     * Extract sub-grids for all domains in a single traversal of the full grid
+     *
+     * Each leaf is copied whole into the domain whose assignedLeaves own it
+     * (domain bounds may overlap and are not consulted). Leaf copies and
+     * domain grids are built on at most one worker per hardware thread.
+     * @param fullGrid Full NanoVDB grid
+     * @param domains Domains to extract
+     * @return One sub-grid handle per domain (same order)
+     */
+    std::vector<nanovdb::GridHandle<nanovdb::HostBuffer>> extractAll(
+        const nanovdb::GridHandle<nanovdb::HostBuffer>& fullGrid,
+        const std::vector<SubDomain>& domains);
+
+    /**
+     * Find neighbors from leaf adjacency across domains
+     *
+     * Two domains are neighbors when any of their leaves touch through a
+     * face, edge or corner; overlapping bounding boxes are irrelevant.
+     * @param domains Domains with assignedLeaves; neighbors is filled
+     */
+    void computeNeighbors(std::vector<SubDomain>& domains) const;
+
+    /**
+     * Add the periodic ghost shell to a grid
+     *
+     * Every active voxel inside the box is copied to its images that lie
+     * within depth of the box on the periodic axes (faces, edges and
+     * corners). Voxels already outside the box on a periodic axis are
+     * dropped: ghosts hold images only.
+     * @param grid Grid without ghosts
+     * @param periodic Periodic axes and box
+     * @param depth Ghost layers per side (the halo thickness)
+     * @return Grid with the ghost shell
+     */
+    static nanovdb::GridHandle<nanovdb::HostBuffer> addPeriodicGhosts(
+        const nanovdb::GridHandle<nanovdb::HostBuffer>& grid,
+        const PeriodicBoundary& periodic,
+        uint32_t depth);
+
+    /**
+     * Build exact halo send lists for every neighbor pair
+     *
+     * A voxel is sent to a neighbor when an active voxel owned by that
+     * neighbor lies within haloThickness (Chebyshev distance, so edge and
+     * corner contacts are covered). Lists are ordered by that distance.
+     * With periodic axes, each ghost voxel a domain reads is sent by the
+     * owner of its image (recvVoxels holds the ghost), which adds wrap
+     * neighbors and self-exchanges; ghosts are never sent themselves.
+     * @param grid Full NanoVDB grid
+     * @param domains Domains (neighbors must already be computed); haloLists is filled
+     */
+    void buildHaloLists(const nanovdb::GridHandle<nanovdb::HostBuffer>& grid,
+                        std::vector<SubDomain>& domains) const;
+
+    /**
+     * Rebuild the halo lists of some domains only; the others keep theirs.
+     * After a repartition, rebuild the domains that changed and their old
+     * and new neighbors: lists between two unchanged domains stay valid.
+     * Forwarded routing and periodic axes always rebuild every domain.
+     * @param grid Full NanoVDB grid
+     * @param domains Domains (neighbors of rebuilt domains must be current)
+     * @param rebuild Domains whose lists are rebuilt
+     * @return Domains actually rebuilt
+     */
+    std::vector<uint32_t> buildHaloLists(const nanovdb::GridHandle<nanovdb::HostBuffer>& grid,
+                                         std::vector<SubDomain>& domains,
+                                         const std::vector<uint32_t>& rebuild) const;
+
+    /**
+     * Reroute halo lists so that only face neighbors exchange messages
+     *
+     * Each face-adjacent pair is assigned the axis of its shared face as
+     * exchange phase. Voxels for an edge or corner neighbor travel through
+     * face neighbors in strictly increasing phase order (dimension by
+     * dimension), so relays forward them with the halo data of the next
+     * phase instead of extra messages. Pairs without such a route keep a
+     * direct message in phase 0. Called by buildHaloLists for
+     * HaloRouting::Forwarded.
+     * @param domains Domains with neighbors and direct halo lists
+     */
+    void forwardHaloLists(std::vector<SubDomain>& domains) const;
+
     /**
      * Analyze load balance quality of a domain split
      * @param domains Vector of domains
@@ -93,11 +324,60 @@ public:
      */
     LoadBalanceStats analyzeBalance(const std::vector<SubDomain>& domains) const;
 
+    /**
+     * Get the active configuration
+     */
+    const SplitConfig& getConfig() const { return m_config; }
+
+    /**
+     * Replace the per-device throughput used by subsequent splits
+     * @param throughput Relative throughput per device (empty = all equal)
+     */
+    void setDeviceThroughput(const std::vector<double>& throughput) { m_config.deviceThroughput = throughput; }
+
+    /**
+     * Replace the periodic axes used by subsequent halo lists
+     */
+    void setPeriodicBoundary(const PeriodicBoundary& periodic) { m_config.periodic = periodic; }
+
 private:
     SplitConfig m_config;
 
-    // Find neighbors for halo exchange
-    void computeNeighbors(std::vector<SubDomain>& domains);
+    // Order leaf indices along the configured space-filling curve
+    std::vector<uint32_t> orderLeaves(const std::vector<LeafStats>& leaves) const;
+
+    // Predicted cost of a leaf under the configured cost model
+    double leafCost(const LeafStats& leaf) const;
+
+    // Relative throughput of a device (1.0 when not configured)
+    double deviceThroughput(uint32_t device) const;
+
+    // Summed throughput of devices [first, first + count)
+    double throughputSum(uint32_t first, uint32_t count) const;
+
+    // Assign leaves to domains by chunking the curve order (returns owner per leaf)
+    std::vector<uint32_t> partitionCurve(const std::vector<LeafStats>& leaves,
+                                         const std::vector<double>& costs) const;
+
+    // Assign leaves to domains by recursive coordinate bisection
+    std::vector<uint32_t> partitionBisection(const std::vector<LeafStats>& leaves,
+                                             const std::vector<double>& costs) const;
+
+    // Assign leaves to domains with the multilevel graph partitioner
+    std::vector<uint32_t> partitionGraph(const std::vector<LeafStats>& leaves,
+                                         const std::vector<double>& costs) const;
+
+    // Split indices at the weighted median of the longest axis into partCount parts
+    void bisect(const std::vector<LeafStats>& leaves,
+                const std::vector<double>& costs,
+                std::vector<uint32_t>& indices,
+                uint32_t firstPart, uint32_t partCount,
+                std::vector<uint32_t>& owner) const;
+
+    // Build sub-domains from a leaf -> domain assignment
+    std::vector<SubDomain> assembleDomains(const std::vector<LeafStats>& leaves,
+                                           const std::vector<double>& costs,
+                                           const std::vector<uint32_t>& owner) const;
 };
 
 } // namespace domain
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "domain/DomainSplitter.hpp"
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+namespace domain {
+
+/**
+ * @brief Multilevel k-way graph partitioner
+ *
+ * Partitions a weighted graph by recursive bisection. Each bisection
+ * coarsens the graph with heavy-edge matching, bisects the coarsest graph by
+ * greedy region growing, then projects back level by level with
+ * Fiduccia-Mattheyses refinement. Minimizes edge cut subject to the balance
+ * tolerance.
+ */
+class GraphPartitioner {
+public:
+    /**
+     * @brief Partitioner parameters
+     */
+    struct Config {
+        float tolerance = 0.1f;          // Allowed overweight of a part (fraction of its target)
+        uint32_t coarsenTarget = 32;     // Stop coarsening at this many nodes
+        uint32_t initialTrials = 8;      // Region-growing attempts on the coarsest graph
+        uint32_t refinementPasses = 8;   // Maximum FM passes per level
+        uint32_t seed = 1;               // Matching / seed order (results are deterministic)
+    };
+
+    /**
+     * @brief Undirected weighted graph in CSR form (each edge stored twice)
+     */
+    struct Graph {
+        std::vector<uint32_t> offsets;      // Row offsets (nodeCount + 1)
+        std::vector<uint32_t> adjacency;    // Neighbor node per edge
+        std::vector<double> edgeWeights;    // Weight per edge
+        std::vector<double> nodeWeights;    // Weight per node
+
+        uint32_t nodeCount() const { return static_cast<uint32_t>(nodeWeights.size()); }
+    };
+
+    GraphPartitioner();
+    explicit GraphPartitioner(const Config& config);
+
+    /**
+     * Build the leaf adjacency graph
+     *
+     * Nodes are leaves weighted by cost; edges join face-adjacent leaves and
+     * are weighted by the active voxels shared across the face.
+     * @param leaves Leaf statistics
+     * @param costs Node weight per leaf
+     * @return Graph with one node per leaf (same order)
+     */
+    static Graph buildLeafGraph(const std::vector<LeafStats>& leaves,
+                                const std::vector<double>& costs);
+
+    /**
+     * Partition a graph into parts with given relative weights
+     * @param graph Input graph
+     * @param partWeights Relative target weight per part (size = part count)
+     * @return Part index per node
+     */
+    std::vector<uint32_t> partition(const Graph& graph, const std::vector<double>& partWeights);
+
+    /**
+     * Total weight of edges whose endpoints lie in different parts
+     */
+    static double edgeCut(const Graph& graph, const std::vector<uint32_t>& part);
+
+private:
+    Config m_config;
+    std::mt19937 m_rng;
+
+    // Assign nodes to parts [firstPart, firstPart + partCount)
+    void partitionRecursive(const Graph& graph,
+                            const std::vector<uint32_t>& nodes,
+                            const std::vector<double>& partWeights,
+                            uint32_t firstPart, uint32_t partCount,
+                            double tolerance,
+                            std::vector<uint32_t>& part);
+
+    // Multilevel bisection; side 0 receives `fraction` of the node weight
+    std::vector<uint8_t> bisect(const Graph& graph, double fraction, double tolerance);
+
+    // Heavy-edge matching; cmap maps fine nodes to coarse nodes
+    Graph coarsen(const Graph& graph, std::vector<uint32_t>& cmap);
+
+    // Best of several greedy region-growing bisections
+    std::vector<uint8_t> initialBisection(const Graph& graph, double fraction, double tolerance);
+
+    // Fiduccia-Mattheyses refinement of a bisection
+    void refine(const Graph& graph, std::vector<uint8_t>& side, double fraction, double tolerance);
+
+    // Induced subgraph on a node subset (local ids follow `nodes` order)
+    static Graph subgraph(const Graph& graph, const std::vector<uint32_t>& nodes);
+};
+
+} // namespace domain
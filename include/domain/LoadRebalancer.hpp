@@ -0,0 +1,99 @@
+#pragma once
+
+#include "domain/DomainSplitter.hpp"
+
+#include <vector>
+#include <cstdint>
+
+namespace domain {
+
+/**
+ * @brief Runtime load rebalancing for a fixed set of sub-domains
+ *
+ * Tracks smoothed per-domain step times and, once the imbalance exceeds the
+ * tolerance, re-partitions the leaves using the measured per-domain
+ * throughput. Only leaves whose owner changes are reported for migration.
+ */
+class LoadRebalancer {
+public:
+    /**
+     * @brief Rebalancing policy
+     */
+    struct Config {
+        float tolerance = 0.1f;        // Trigger when max/avg step time > 1 + tolerance
+        double smoothing = 0.3;        // EMA weight of the newest sample
+        uint32_t warmupSteps = 5;      // Samples required before the first decision
+        uint32_t cooldownSteps = 20;   // Minimum steps between two rebalances
+    };
+
+    /**
+     * @brief A leaf changing owner
+     */
+    struct LeafMove {
+        nanovdb::Coord origin;
+        uint32_t fromDomain = 0;
+        uint32_t toDomain = 0;
+        uint32_t activeCount = 0;
+    };
+
+    /**
+     * @brief Result of a repartition
+     */
+    struct MigrationPlan {
+        std::vector<SubDomain> domains;         // New decomposition (same domain count)
+        std::vector<LeafMove> moves;            // Leaves whose owner changed
+        std::vector<uint32_t> changedDomains;   // Domains that gained or lost leaves
+        uint64_t migratedVoxels = 0;
+
+        bool empty() const { return moves.empty(); }
+    };
+
+    LoadRebalancer();
+    explicit LoadRebalancer(const Config& config);
+
+    /**
+     * Record the measured time of one step for every domain
+     * @param seconds Step time per domain (indexed by gpuIndex)
+     */
+    void recordStepTimes(const std::vector<double>& seconds);
+
+    /**
+     * Check whether the smoothed imbalance warrants a repartition
+     */
+    bool shouldRebalance() const;
+
+    /**
+     * Get current imbalance (max / avg of smoothed step times)
+     */
+    double getImbalance() const;
+
+    /**
+     * Get smoothed step time per domain
+     */
+    const std::vector<double>& getSmoothedTimes() const { return m_smoothedTimes; }
+
+    /**
+     * Re-partition leaves using measured throughput and diff against the
+     * current decomposition
+     * @param splitter Splitter (its device throughput is updated)
+     * @param leaves Statistics for every leaf
+     * @param current Current decomposition
+     * @return Migration plan; empty when ownership is unchanged
+     */
+    MigrationPlan plan(DomainSplitter& splitter,
+                       const std::vector<LeafStats>& leaves,
+                       const std::vector<SubDomain>& current);
+
+    /**
+     * Discard measurements (call after a plan has been applied)
+     */
+    void reset();
+
+private:
+    Config m_config;
+    std::vector<double> m_smoothedTimes;
+    uint32_t m_sampleCount = 0;
+    uint32_t m_stepsSinceRebalance = 0;
+};
+
+} // namespace domain
@@ -3,14 +3,17 @@
 #include "core/VulkanContext.hpp"
 #include "halo/HaloManager.hpp"
 #include "halo/HaloSync.hpp"
+#include "halo/Transport.hpp"
 #include "field/FieldRegistry.hpp"
 #include "domain/DomainSplitter.hpp"
 #include "stencil/StencilRegistry.hpp"
+#include "graph/HaloPlanner.hpp"
 
 #include <vulkan/vulkan.hpp>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 namespace graph {
 
@@ -31,9 +34,42 @@ public:
     struct StencilPushConstants {
         uint64_t gridAddr = 0;              // NanoVDB grid device address
         uint64_t bdaTableAddr = 0;          // Field BDA table address
-        uint32_t activeVoxelCount = 0;      // Active voxels in this domain
+        uint64_t voxelListAddr = 0;         // Field element per thread (0 = identity)
+        uint32_t activeVoxelCount = 0;      // Voxels dispatched
         uint32_t neighborRadius = 0;        // For neighbor access
         float dt = 0.016f;                  // Timestep delta
+        uint32_t firstVoxel = 0;            // Element of thread 0 without a voxel list
+    };
+
+    enum class QueueType {
+        Compute,
+        Transfer
+    };
+
+    /**
+     * @brief Timestamp query range of one domain
+     *
+     * The first and last written queries bracket the whole step; the ones
+     * in between come in pairs around each dispatch. Reserve
+     * 2 + 6 * stencils (interior, boundary and ghost dispatches).
+     */
+    struct TimestampQueries {
+        vk::QueryPool pool;
+        uint32_t first = 0;
+        uint32_t count = 0;
+        uint32_t used = 0;      // Written by the recording; read back only these
+    };
+
+    /**
+     * @brief One queue submission of an overlapped timestep
+     */
+    struct Submission {
+        QueueType queue = QueueType::Compute;
+        vk::CommandBuffer cmd;
+        std::vector<vk::Semaphore> waitSemaphores;
+        std::vector<uint64_t> waitValues;
+        std::vector<vk::Semaphore> signalSemaphores;
+        std::vector<uint64_t> signalValues;
     };
 
     /**
@@ -46,8 +82,45 @@ public:
                  halo::HaloManager& haloManager,
                  const field::FieldRegistry& fieldRegistry);
 
+    /**
+     * Plan the halo exchanges of a timestep, shared by all domains
+     *
+     * Call once per step before recording the domains. Fields are
+     * exchanged only before a stencil that reads their neighbors, and
+     * only if written since their last exchange.
+     * @param schedule Execution schedule (topologically sorted)
+     * @param stencilRegistry Compiled stencils
+     */
+    void beginStep(const std::vector<std::string>& schedule,
+                   const stencil::StencilRegistry& stencilRegistry);
+
+    /**
+     * Force a full exchange of every field on the next step
+     * (after uploads or repartitioning)
+     */
+    void markHalosDirty() { m_haloPlanner.markAllDirty(); }
+
+    /**
+     * Exchange halos every blockSteps steps (temporal blocking). Halos must
+     * be allocated blockSteps * HaloPlanner::stepRadius deep; the next step
+     * starts a new block with a full exchange. Needs a copy of the fields
+     * per domain: on the device-copy transport domains share field buffers,
+     * and a domain's ghosts are its neighbour's owned voxels.
+     * @throws std::runtime_error if blockSteps > 1 on a device-local transport
+     */
+    void setBlockSteps(uint32_t blockSteps);
+
+    /**
+     * Get the halo planner (block position, dirty state)
+     */
+    const HaloPlanner& getHaloPlanner() const { return m_haloPlanner; }
+
     /**
      * Record command buffer for a single timestep
+     *
+     * Exchanges are recorded inline, so their semaphores apply to the whole
+     * command buffer. Meant for domains without neighbors; multi-domain runs
+     * use recordOverlappedTimestep, which splits submissions at exchanges.
      * @param cmd Command buffer to record into
      * @param schedule Execution schedule (topologically sorted)
      * @param stencilRegistry Compiled stencils
@@ -60,16 +133,84 @@ public:
                        const domain::SubDomain& domain,
                        float dt = 0.016f);
 
+    /**
+     * Record one stencil over a contiguous element range, e.g. the cells of
+     * one refinement level (no halo exchange)
+     * @param cmd Command buffer to record into
+     * @param stencilName Stencil to dispatch
+     * @param stencilRegistry Compiled stencils
+     * @param domain Domain to execute on
+     * @param count Elements dispatched
+     * @param firstVoxel First element of the range
+     * @param dt Timestep delta time
+     */
+    void dispatchStencil(vk::CommandBuffer cmd,
+                         const std::string& stencilName,
+                         const stencil::StencilRegistry& stencilRegistry,
+                         const domain::SubDomain& domain,
+                         uint32_t count,
+                         uint32_t firstVoxel,
+                         float dt = 0.016f);
+
+    /**
+     * Check whether a domain has interior/boundary voxel lists for overlapping
+     */
+    bool canOverlapExchange(const domain::SubDomain& domain) const;
+
+    /**
+     * Record a multi-domain timestep as separate queue submissions
+     *
+     * For each stencil preceded by an exchange: pack on the compute queue,
+     * copy on the transfer queue, then unpack and dispatch once the
+     * neighbors' halo semaphores signal. With overlapInterior the interior
+     * voxels are dispatched in between, hiding the transfer. With forwarded
+     * routing every phase adds an unpack-then-pack submission, so relays
+     * pass on what they received. Timeline values
+     * grow monotonically across steps, so submissions of consecutive steps
+     * may be in flight together. Submissions must be queued in order; the
+     * k-th submission of every domain belongs to the same stage. The last
+     * submission is always on the compute queue.
+     * @param computePool Pool for compute queue command buffers
+     * @param transferPool Pool for transfer queue command buffers
+     * @param schedule Execution schedule (topologically sorted)
+     * @param stencilRegistry Compiled stencils
+     * @param domain Domain to execute on
+     * @param dt Timestep delta time
+     * @param overlapInterior Dispatch interior voxels during the transfer
+     * @param timestamps Optional queries bracketing each dispatch
+     * @return Submissions in queue order
+     */
+    std::vector<Submission> recordOverlappedTimestep(vk::CommandPool computePool,
+                                                     vk::CommandPool transferPool,
+                                                     const std::vector<std::string>& schedule,
+                                                     const stencil::StencilRegistry& stencilRegistry,
+                                                     const domain::SubDomain& domain,
+                                                     float dt = 0.016f,
+                                                     bool overlapInterior = true,
+                                                     TimestampQueries* timestamps = nullptr);
+
     /**
      * Record halo exchange operations
      * @param cmd Command buffer
-     * @param schedule Stencil schedule
+     * @param requests Fields to exchange
      * @param domain Domain with neighbor information
      */
     void recordHaloExchange(vk::CommandBuffer cmd,
-                           const std::vector<std::string>& schedule,
+                           const std::vector<HaloPlanner::HaloRequest>& requests,
                            const domain::SubDomain& domain);
 
+    /**
+     * Select how halo messages move between domains, e.g. a
+     * halo::StagedTransfer for domains on separate devices or in separate
+     * processes (nullptr: copy directly between receive buffers).
+     * Only the overlapped timestep supports transports that are not device-local.
+     */
+    void setTransport(halo::Transport* transport);
+
+    halo::Transport& getTransport() const { return *m_transport; }
+
+    const HaloPlanner::StepPlan& getStepPlan() const { return m_stepPlan; }
+
     const std::vector<vk::Semaphore>& getWaitSemaphores() const { return m_waitSemaphores; }
     const std::vector<vk::Semaphore>& getSignalSemaphores() const { return m_signalSemaphores; }
     const std::vector<uint64_t>& getWaitValues() const { return m_waitValues; }
@@ -80,6 +221,12 @@ private:
     halo::HaloManager& m_haloManager;
     halo::HaloSync m_haloSync;
     const field::FieldRegistry& m_fieldRegistry;
+    std::unique_ptr<halo::DeviceCopyTransport> m_deviceCopy;
+    halo::Transport* m_transport = nullptr;
+
+    // Dirty tracking and the current step's exchange plan
+    HaloPlanner m_haloPlanner;
+    HaloPlanner::StepPlan m_stepPlan;
 
     // Semaphores for the current frame
     std::vector<vk::Semaphore> m_waitSemaphores;
@@ -93,6 +240,76 @@ private:
      */
     void recordMemoryBarrier(vk::CommandBuffer cmd);
 
+    /**
+     * Record the pack, transfer and unpack stages of one exchange phase
+     * (barriers between stages are left to the caller)
+     */
+    void recordHaloPack(vk::CommandBuffer cmd,
+                        const std::vector<HaloPlanner::HaloRequest>& requests,
+                        const domain::SubDomain& domain,
+                        uint32_t phase);
+    void recordHaloTransfer(vk::CommandBuffer cmd,
+                            const std::vector<HaloPlanner::HaloRequest>& requests,
+                            const domain::SubDomain& domain,
+                            uint32_t phase);
+    void recordHaloUnpack(vk::CommandBuffer cmd,
+                          const std::vector<HaloPlanner::HaloRequest>& requests,
+                          const domain::SubDomain& domain,
+                          uint32_t phase);
+
+    /**
+     * Bit mask of the message segments carrying requested fields
+     * @param send Use send counts (pack) or receive counts (unpack)
+     * @param maxUnits Largest pack/unpack invocation count among the selected
+     *        segments (see HaloManager::encodedUnits)
+     */
+    static uint32_t segmentMask(const halo::HaloMessage& message,
+                                const std::vector<HaloPlanner::HaloRequest>& requests,
+                                bool send,
+                                uint32_t& maxUnits);
+
+    /**
+     * Add the synchronization of a domain's pack: wait until its previous
+     * transfer of each message in the phase has read the send buffer
+     * @return Whether any wait was added
+     */
+    bool addPackSync(const domain::SubDomain& domain,
+                     std::vector<vk::Semaphore>& waitSemaphores,
+                     std::vector<uint64_t>& waitValues,
+                     uint32_t phase);
+
+    /**
+     * Add the synchronization of a domain's transfers: wait until the
+     * transport can take each neighbor's next message, signal the next halo value
+     */
+    void addTransferSync(const domain::SubDomain& domain,
+                         std::vector<vk::Semaphore>& waitSemaphores,
+                         std::vector<uint64_t>& waitValues,
+                         std::vector<vk::Semaphore>& signalSemaphores,
+                         std::vector<uint64_t>& signalValues,
+                         uint32_t phase);
+
+    /**
+     * Add the synchronization of a domain's unpack: wait until the transport
+     * delivered each neighbor's next message, then release the receive buffer
+     * @param selfRecorded The domain's own transfer precedes the unpack in the
+     *        same submission (periodic self-exchange, ordered by barriers)
+     */
+    void addUnpackSync(const domain::SubDomain& domain,
+                       std::vector<vk::Semaphore>& waitSemaphores,
+                       std::vector<uint64_t>& waitValues,
+                       std::vector<vk::Semaphore>& signalSemaphores,
+                       std::vector<uint64_t>& signalValues,
+                       uint32_t phase,
+                       bool selfRecorded = false);
+
+    /**
+     * Add a semaphore to a submit list unless already present
+     */
+    static void addSemaphore(std::vector<vk::Semaphore>& semaphores,
+                             std::vector<uint64_t>& values,
+                             vk::Semaphore semaphore, uint64_t value);
+
     /**
      * Record a single stencil dispatch
      * @param cmd Command buffer
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "stencil/StencilDefinition.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace graph {
+
+/**
+ * @brief Schedule-aware halo exchange planning
+ *
+ * Decides which fields need a halo exchange and where in the schedule it
+ * goes. A field is exchanged only when a stencil reads its neighbors
+ * (see readsNeighbors) and the field was written since its
+ * last exchange; the exchange is placed right before that first consumer.
+ * Dirty state carries over between steps.
+ *
+ * With temporal blocking (setBlockSteps > 1) a domain runs k steps per
+ * exchange: halos are exchanged k times as deep at the start of each block,
+ * and every stencil also recomputes the ghost layers that are still valid,
+ * a region that shrinks by the stencil's radius each time.
+ */
+class HaloPlanner {
+public:
+    /**
+     * @brief One field exchange
+     */
+    struct HaloRequest {
+        std::string field;
+        uint32_t radius = 1;   // Largest neighbor radius read before the next write
+    };
+
+    /**
+     * @brief Exchanges for one step
+     */
+    struct StepPlan {
+        // exchanges[i] are recorded before schedule[i]
+        std::vector<std::vector<HaloRequest>> exchanges;
+        uint32_t exchangeCount = 0;   // Total field exchanges in the step
+
+        // ghostDepth[i] halo layers are recomputed by schedule[i] (temporal blocking only)
+        std::vector<uint32_t> ghostDepth;
+    };
+
+    /**
+     * Plan one step and advance the dirty state past it
+     * @param stencils Stencil definitions in schedule order
+     * @return Exchanges before each stencil
+     */
+    StepPlan planStep(const std::vector<const stencil::StencilDefinition*>& stencils);
+
+    /**
+     * Set the number of steps per exchange (1 = exchange every step).
+     * Restarts the block and marks every field dirty, since halos must be
+     * reallocated at the new depth.
+     */
+    void setBlockSteps(uint32_t blockSteps);
+
+    /**
+     * Get the number of steps per exchange
+     */
+    uint32_t getBlockSteps() const { return m_blockSteps; }
+
+    /**
+     * Position of the next planned step within its block (0 = exchanging)
+     */
+    uint32_t getBlockPosition() const { return m_blockPosition; }
+
+    /**
+     * Mark a field as modified outside the schedule (e.g. host upload)
+     */
+    void markDirty(const std::string& field);
+
+    /**
+     * Mark every field as modified (e.g. after repartitioning); a temporal
+     * block restarts, since ghost layers are only refreshed at its start
+     */
+    void markAllDirty();
+
+    /**
+     * Check whether a field's halos are out of date
+     */
+    bool isDirty(const std::string& field) const;
+
+    /**
+     * Halo thickness each field needs: the largest neighborRadius of any
+     * stencil reading it (at least 1 for neighbor-reading stencils).
+     * With blockSteps > 1 every input field needs blockSteps * stepRadius,
+     * since pointwise stencils recompute ghost layers too.
+     * Fields missing from the result need no halo.
+     */
+    static std::unordered_map<std::string, uint32_t> fieldHaloThickness(
+        const std::vector<const stencil::StencilDefinition*>& stencils,
+        uint32_t blockSteps = 1);
+
+    /**
+     * Ghost layers one step invalidates: the sum of the radii of its
+     * neighbor-reading stencils (each at least 1)
+     */
+    static uint32_t stepRadius(const std::vector<const stencil::StencilDefinition*>& stencils);
+
+    /**
+     * Whether a stencil reads voxels outside its own domain
+     */
+    static bool readsNeighbors(const stencil::StencilDefinition& stencil);
+
+private:
+    // Fields whose halos are up to date; absent fields count as dirty
+    std::unordered_map<std::string, bool> m_clean;
+
+    // Temporal blocking state
+    uint32_t m_blockSteps = 1;
+    uint32_t m_blockPosition = 0;
+    uint32_t m_validDepth = 0;     // Ghost layers still holding current values
+
+    // Plan one step of a temporal block
+    StepPlan planBlockStep(const std::vector<const stencil::StencilDefinition*>& stencils);
+};
+
+} // namespace graph
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+namespace graph {
+
+/**
+ * @brief Picks the temporal blocking depth from measured costs
+ *
+ * Deeper blocks amortize one exchange over more steps but send thicker
+ * halos and recompute more ghost voxels. The tuner measures whole blocks at
+ * k = 1 and at k = maxBlockSteps, fits the exchange cost per block as
+ * latency + k * per-layer cost and interpolates the compute cost per step
+ * linearly between the two probes, then settles on the k with the lowest
+ * predicted time per step.
+ */
+class TemporalBlockTuner {
+public:
+    /**
+     * @brief Tuning policy
+     */
+    struct Config {
+        uint32_t maxBlockSteps = 4;    // Largest k considered
+        uint32_t probeBlocks = 4;      // Blocks measured per probe
+    };
+
+    TemporalBlockTuner();
+    explicit TemporalBlockTuner(const Config& config);
+
+    /**
+     * Record one step run with the current getBlockSteps()
+     * @param exchangeSeconds Time not spent in stencil dispatches (0 for most block steps)
+     * @param computeSeconds Time spent in stencil dispatches
+     */
+    void recordStep(double exchangeSeconds, double computeSeconds);
+
+    /**
+     * Steps per exchange to run next
+     */
+    uint32_t getBlockSteps() const { return m_blockSteps; }
+
+    /**
+     * Check whether probing is finished
+     */
+    bool isTuned() const { return m_phase == Phase::Tuned; }
+
+    /**
+     * Predicted time per step for a block depth (0 until tuned)
+     */
+    double predictStepTime(uint32_t blockSteps) const;
+
+    /**
+     * Discard measurements and probe again (e.g. after repartitioning)
+     */
+    void reset();
+
+private:
+    enum class Phase { ProbeSingle, ProbeDeep, Tuned };
+
+    Config m_config;
+    Phase m_phase = Phase::ProbeSingle;
+    uint32_t m_blockSteps = 1;
+
+    // Accumulated over the running probe
+    double m_exchangeSum = 0.0;
+    double m_computeSum = 0.0;
+    uint32_t m_stepCount = 0;
+
+    // Single-step probe results
+    double m_singleExchange = 0.0;
+    double m_singleCompute = 0.0;
+
+    // Fitted model
+    double m_exchangeLatency = 0.0;   // Per block
+    double m_exchangePerLayer = 0.0;  // Per block and step of depth
+    double m_computeGrowth = 0.0;     // Relative compute increase per extra block step
+};
+
+} // namespace graph
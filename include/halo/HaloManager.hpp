@@ -2,55 +2,185 @@
 
 #include "core/VulkanContext.hpp"
 #include "core/MemoryAllocator.hpp"
+#include "core/DeviceGroup.hpp"
 #include "domain/DomainSplitter.hpp"
 #include "field/FieldRegistry.hpp"
 
 #include <vulkan/vulkan.hpp>
 #include <vector>
 #include <array>
+#include <limits>
+#include <string>
+#include <unordered_map>
 #include <cstdint>
 
 namespace halo {
 
 /**
- * @brief Per-face halo buffer storage
+ * @brief Wire format of a field's halo values
  *
- * Manages halo layers (boundary voxels) for a single field across all 6 faces.
+ * Values are converted by the pack kernel and restored to fp32 by the
+ * unpack kernel, so only ghost layers lose precision; owned voxels keep
+ * full fp32 values. The reduced formats move roughly half the bytes.
+ */
+enum class HaloEncoding : uint32_t {
+    Float32 = 0,     // Exact
+    Float16 = 1,     // IEEE half; finite values up to 65504 only
+    BFloat16 = 2,    // Upper half of the fp32 bits, rounded; full fp32 range
+    BlockDelta = 3   // Per 32 values of one component: fp32 minimum and step, 16-bit offsets
+};
+
+/**
+ * @brief Placement of one field inside a neighbor message
+ */
+struct HaloSegment {
+    std::string fieldName;
+    uint32_t elementSize = 0;       // Bytes per voxel (fp32 in the field)
+    uint32_t thickness = 0;         // Halo layers exchanged for this field
+    uint32_t sendCount = 0;         // Voxels packed per exchange
+    uint32_t recvCount = 0;         // Voxels unpacked per exchange
+    HaloEncoding encoding = HaloEncoding::Float32;
+    vk::DeviceSize sendOffset = 0;  // Byte offset in the send message
+    vk::DeviceSize recvOffset = 0;  // Byte offset in the receive message
+    vk::DeviceSize sendBytes = 0;   // Encoded size in the send message
+    vk::DeviceSize recvBytes = 0;   // Encoded size in the receive message
+};
+
+/**
+ * @brief Aggregated halo message of one domain towards a single neighbor
+ *
+ * All haloed fields share one send and one receive buffer, laid out as
+ * consecutive segments sorted by field name. An exchange costs one pack
+ * dispatch, one copy and one unpack dispatch per neighbor, however many
+ * fields it carries.
+ */
+struct HaloMessage {
+    uint32_t neighborGpu = 0;
+    uint32_t phase = 0;             // Exchange phase, see HaloIndexList::phase
+    std::vector<HaloSegment> segments;
+
+    // Packed values gathered for the neighbor (remote halo)
+    core::MemoryAllocator::Buffer sendBuffer;
+
+    // Packed values received from the neighbor (local halo)
+    core::MemoryAllocator::Buffer recvBuffer;
+
+    // Segment layout read by the pack/unpack shaders
+    core::MemoryAllocator::Buffer segmentTable;
+
+    vk::DeviceSize sendBytes = 0;
+    vk::DeviceSize recvBytes = 0;
+
+    /**
+     * Index of a field's segment (-1 if the field has no halo)
+     */
+    int32_t segmentIndex(const std::string& fieldName) const {
+        for (size_t i = 0; i < segments.size(); ++i) {
+            if (segments[i].fieldName == fieldName) return static_cast<int32_t>(i);
+        }
+        return -1;
+    }
+};
+
+/**
+ * @brief Per-neighbor halo buffer storage of one domain
+ *
+ * Buffers are sized by the exact gather/scatter lists, truncated to each
+ * field's halo thickness, so memory scales with the sparse surface.
  */
 struct HaloBufferSet {
-    // Local halos: data read from neighbor GPUs
-    std::array<core::MemoryAllocator::Buffer, 6> localHalos;
-
-    // Remote halos: data to be sent to neighbor GPUs
-    std::array<core::MemoryAllocator::Buffer, 6> remoteHalos;
-
-    // Timeline semaphore values for synchronization
-    std::array<uint64_t, 6> writeValues;  // Last completed halo write per face
-    std::array<uint64_t, 6> readValues;   // Last consumed halo read per face
-
-    // Halo dimensions per face
-    struct FaceDimensions {
-        uint32_t thickness = 0;
-        uint32_t width = 0;   // Y or Z dimension
-        uint32_t height = 0;  // Z or Y dimension
-    };
-    std::array<FaceDimensions, 6> faceDims;
-
-    // Total voxels in each halo (thickness × width × height)
-    std::array<uint32_t, 6> haloVoxelCounts;
+    std::vector<HaloMessage> messages;   // Same order as the domain's index lists
+
+    // Timeline values, indexed by neighbor GPU. They count exchanges over the
+    // whole run and survive message reallocation, so they only ever grow.
+    std::vector<uint64_t> writeValues;   // Messages sent to the neighbor (halo semaphore)
+    std::vector<uint64_t> readValues;    // Messages unpacked from the neighbor (release semaphore)
+    uint64_t packValue = 0;              // Pack stages recorded (pack semaphore)
+
+    /**
+     * Find the message for a neighbor (nullptr if not adjacent)
+     */
+    HaloMessage* find(uint32_t neighborGpu) {
+        for (auto& message : messages) {
+            if (message.neighborGpu == neighborGpu) return &message;
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * @brief Gather/scatter index lists of one domain towards one neighbor
+ *
+ * Indices address field elements (positions in the grid's Morton-ordered
+ * LUT) and are shared by all fields.
+ */
+struct HaloIndexList {
+    uint32_t neighborGpu = 0;
+    core::MemoryAllocator::Buffer gatherIndices;   // Elements packed for the neighbor
+    core::MemoryAllocator::Buffer scatterIndices;  // Elements written from received values
+    uint32_t sendCount = 0;
+    uint32_t recvCount = 0;
+    std::vector<uint32_t> sendLayerEnds;           // See SubDomain::HaloList::layerEnds
+    std::vector<uint32_t> recvLayerEnds;
+
+    // Exchange phase: phase p is unpacked before phase p + 1 is packed, so
+    // lists may forward voxels received in earlier phases (see HaloRouting)
+    uint32_t phase = 0;
+};
+
+/**
+ * @brief Owned voxels of one domain, split by halo dependence
+ *
+ * Interior voxels lie deeper than the halo lists reach and never read halo
+ * data, so they can be computed while the exchange is in flight. Boundary
+ * voxels (the union of the domain's send lists) wait for the exchange.
+ * Ghost voxels are the received halo voxels, ordered by depth so that the
+ * first ghostLayerEnds[d-1] of them cover d layers (temporal blocking
+ * recomputes them redundantly).
+ */
+struct DomainVoxelLists {
+    core::MemoryAllocator::Buffer interiorIndices;  // Field element indices, ascending
+    core::MemoryAllocator::Buffer boundaryIndices;
+    core::MemoryAllocator::Buffer ghostIndices;     // Neighbor-owned, by increasing depth
+    uint32_t interiorCount = 0;
+    uint32_t boundaryCount = 0;
+    uint32_t ghostCount = 0;
+    std::vector<uint32_t> ghostLayerEnds;           // Cumulative ghost count per layer
+
+    // Host copy of interior + boundary elements (devices per domain only:
+    // gathering a field takes each element from its owner's device)
+    std::vector<uint32_t> ownedElements;
+};
+
+/**
+ * @brief Host-side index lists of one domain, before upload
+ *
+ * gather[n] and scatter[n] belong to the domain's n-th halo list: gather
+ * follows its sendVoxels, scatter the neighbor's matching list (empty if
+ * the neighbor sends nothing back).
+ */
+struct HostIndexLists {
+    std::vector<std::vector<uint32_t>> gather;
+    std::vector<std::vector<uint32_t>> scatter;
+    std::vector<uint32_t> interior;             // Ascending
+    std::vector<uint32_t> boundary;             // Ascending
+    std::vector<uint32_t> ghosts;               // By increasing depth
+    std::vector<uint32_t> ghostLayerEnds;
 };
 
 /**
  * @brief Manages halo exchange for multi-GPU simulations
  *
  * Handles:
- * - Halo buffer allocation per field and domain
- * - Packing halo data (extract boundary voxels from main buffer)
- * - Unpacking halo data (write received boundary voxels)
+ * - Gather/scatter index lists built from the exact halo lists
+ * - Interior/boundary voxel lists for overlapping exchange with compute
+ * - Aggregated halo messages per domain and neighbor
  * - Timeline semaphore synchronization between GPUs
  */
 class HaloManager {
 public:
+    using FieldMap = std::unordered_map<std::string, field::FieldDesc>;
+
     /**
      * Initialize halo manager for multi-GPU simulation
      * @param context Vulkan context
@@ -64,14 +194,180 @@ public:
     ~HaloManager();
 
     /**
-     * Allocate halo buffers for a specific field
-     * @param fieldName Field name
-     * @param fieldDesc Field descriptor with format and element size
-     * @param gpuIndex GPU to allocate halos for
+     * Place every domain on its own logical device: domain d's lists,
+     * messages and pack semaphore live on device d, halo semaphores on the
+     * sender's device and release semaphores on the receiver's. Messages
+     * then cannot be copied directly (see StagedTransfer). Call before
+     * buildIndexLists.
+     */
+    void setDevices(core::DeviceGroup& devices);
+
+    /**
+     * Device group set with setDevices (nullptr: all domains share one device)
      */
-    void allocateFieldHalos(const std::string& fieldName,
-                           const field::FieldDesc& fieldDesc,
-                           uint32_t gpuIndex);
+    core::DeviceGroup* getDevices() const { return m_devices; }
+
+    /**
+     * Allocator and device holding a domain's buffers and semaphores
+     */
+    core::MemoryAllocator& getAllocator(uint32_t gpuIndex) const;
+    vk::Device getDevice(uint32_t gpuIndex) const;
+
+    /**
+     * Build gather/scatter index lists for all domains from their halo lists
+     * (DomainSplitter::buildHaloLists). Must be called before halo buffers
+     * are allocated; replaces previously built lists.
+     * @param fieldCoords Coordinate of every field element (Morton-ordered LUT)
+     */
+    void buildIndexLists(const std::vector<nanovdb::Coord>& fieldCoords);
+
+    /**
+     * Rebuild the index lists of some domains only (e.g. the domains a load
+     * rebalance changed and their neighbors); other domains keep theirs
+     * @param fieldCoords Coordinate of every field element (Morton-ordered LUT)
+     * @param domains Domains whose lists are rebuilt
+     */
+    void buildIndexLists(const std::vector<nanovdb::Coord>& fieldCoords,
+                         const std::vector<uint32_t>& domains);
+
+    /**
+     * Map halo lists to field element indices and split owned voxels into
+     * interior and boundary, on the host
+     * @param domains Domains with halo lists
+     * @param fieldCoords Coordinate of every field element (Morton-ordered LUT)
+     * @param selected Domains to compute; the others are left empty
+     * @return One entry per domain
+     */
+    static std::vector<HostIndexLists> computeIndexLists(const std::vector<domain::SubDomain>& domains,
+                                                         const std::vector<nanovdb::Coord>& fieldCoords,
+                                                         const std::vector<uint32_t>& selected);
+
+    /**
+     * Get index lists of a domain (one entry per neighbor)
+     */
+    const std::vector<HaloIndexList>& getIndexLists(uint32_t gpuIndex) const;
+
+    /**
+     * Number of exchange phases (1 for direct routing, up to 3 when forwarding)
+     */
+    uint32_t getPhaseCount() const { return m_phaseCount; }
+
+    /**
+     * Get interior/boundary voxel lists of a domain (built with the index lists)
+     */
+    const DomainVoxelLists& getVoxelLists(uint32_t gpuIndex) const;
+
+    /**
+     * Set the halo thickness of a field, usually the largest neighborRadius
+     * of any stencil reading it (0 = field needs no halo). Takes effect on
+     * the next allocateHalos.
+     * @return true if the thickness changed
+     */
+    bool setFieldHaloThickness(const std::string& fieldName, uint32_t thickness);
+
+    /**
+     * Get the halo thickness of a field (default thickness if never set)
+     */
+    uint32_t getFieldHaloThickness(const std::string& fieldName) const;
+
+    /**
+     * Set the wire format of a field's halo values. The encoding is only
+     * used if its error bound (encodingError) is within the tolerance,
+     * otherwise the field stays fp32; integer fields are always sent
+     * exactly. Takes effect on the next allocateHalos.
+     * @param tolerance Largest acceptable error, relative to the largest
+     *        magnitude of the same field component (see encodingError)
+     * @param maxMagnitude Largest |value| the field holds (infinity if unknown)
+     * @return true if the field's encoding changed
+     */
+    bool setFieldHaloEncoding(const std::string& fieldName, HaloEncoding encoding, float tolerance,
+                              float maxMagnitude = std::numeric_limits<float>::infinity());
+
+    /**
+     * Get the wire format of a field's halo values (fp32 if never set)
+     */
+    HaloEncoding getFieldHaloEncoding(const std::string& fieldName) const;
+
+    /**
+     * Worst-case error of an encoding, as a fraction of M, the largest
+     * magnitude of the value's field component: |decoded - x| <= error * M.
+     * Float16 and BFloat16 round each value (relative error, so at most
+     * that fraction of M; Float16 components entirely below 2^-14 lose
+     * precision to subnormals). BlockDelta quantizes a block of one
+     * component to 65535 steps of its range, which is at most 2M.
+     * @param maxMagnitude Largest |value| of the field: Float16 cannot
+     *        represent more than 65504 and is reported as infinite error
+     */
+    static float encodingError(HaloEncoding encoding,
+                               float maxMagnitude = std::numeric_limits<float>::infinity());
+
+    /**
+     * Message words (4 bytes) holding the encoded values of voxelCount voxels
+     */
+    static uint32_t encodedWords(HaloEncoding encoding, uint32_t voxelCount, uint32_t components);
+
+    /**
+     * Pack/unpack invocations for voxelCount voxels: one per value (Float32),
+     * per value pair (Float16, BFloat16) or per block of one component
+     * (BlockDelta)
+     */
+    static uint32_t encodedUnits(HaloEncoding encoding, uint32_t voxelCount, uint32_t components);
+
+    /**
+     * Number of list voxels within a halo thickness
+     * @param layerEnds Cumulative layer sizes of a halo list
+     * @param total Size of the whole list
+     * @param thickness Halo layers requested
+     */
+    static uint32_t layerVoxelCount(const std::vector<uint32_t>& layerEnds,
+                                    uint32_t total, uint32_t thickness);
+
+    /**
+     * Interleave layered lists so that every layer prefix is contiguous
+     * @param lists Index lists, each ordered by layer
+     * @param layerEnds Cumulative layer sizes of each list
+     * @param mergedLayerEnds Receives the cumulative layer sizes of the result
+     * @return Layer 1 of every list, then layer 2 of every list, ...
+     */
+    static std::vector<uint32_t> mergeLayers(const std::vector<std::vector<uint32_t>>& lists,
+                                             const std::vector<std::vector<uint32_t>>& layerEnds,
+                                             std::vector<uint32_t>& mergedLayerEnds);
+
+    /**
+     * Lay out the message towards one neighbor without allocating it:
+     * segments of the haloed fields sorted by name, each sized by its
+     * thickness, components and encoding
+     * @param list Index list towards the neighbor (counts and layers)
+     * @param fields Field descriptors
+     */
+    HaloMessage layoutMessage(const HaloIndexList& list, const FieldMap& fields) const;
+
+    /**
+     * Allocate the aggregated halo messages of every domain
+     * @param fields Field descriptors (element sizes and buffers)
+     */
+    void allocateHalos(const std::unordered_map<std::string, field::FieldDesc>& fields);
+
+    /**
+     * Allocate the halo messages of every domain from per-domain field
+     * descriptors (devices per domain: each device has its own field buffers)
+     * @param domainFields Field descriptors of each domain's device
+     */
+    void allocateHalos(const std::vector<const FieldMap*>& domainFields);
+
+    /**
+     * Reallocate the halo messages of one domain after its halo lists changed
+     * (e.g. after load rebalancing); other domains are left untouched
+     * @param gpuIndex Domain whose halos are rebuilt
+     * @param fields Field descriptors (element sizes and buffers)
+     */
+    void rebuildDomainHalos(uint32_t gpuIndex,
+                            const std::unordered_map<std::string, field::FieldDesc>& fields);
+
+    /**
+     * Check whether halo messages have been allocated
+     */
+    bool hasHalos() const { return m_halosAllocated; }
 
     /**
      * Create timeline semaphores for halo synchronization
@@ -80,10 +376,22 @@ public:
     void createHaloSemaphores();
 
     /**
-     * Get halo buffer set for a field on a specific GPU
-     * @throws std::runtime_error if field halos not allocated
+     * Get halo messages of a specific GPU
+     * @throws std::runtime_error if halos not allocated
      */
-    HaloBufferSet& getHaloBufferSet(const std::string& fieldName, uint32_t gpuIndex);
+    HaloBufferSet& getHaloBufferSet(uint32_t gpuIndex);
+
+    /**
+     * Get timeline semaphore signalled when a domain's halos are packed,
+     * waited on by its transfer queue submission
+     */
+    vk::Semaphore getPackSemaphore(uint32_t gpuIndex);
+
+    /**
+     * Get timeline semaphore signalled when dstGpu has unpacked a message from
+     * srcGpu, so srcGpu may overwrite dstGpu's receive buffer again
+     */
+    vk::Semaphore getReleaseSemaphore(uint32_t srcGpu, uint32_t dstGpu);
 
     /**
      * Get timeline semaphore for inter-GPU synchronization
@@ -93,7 +401,7 @@ public:
     vk::Semaphore getHaloSemaphore(uint32_t srcGpu, uint32_t dstGpu);
 
     /**
-     * Get halo thickness (constant across all domains)
+     * Get default halo thickness, used for fields without an explicit one
      */
     uint32_t getHaloThickness() const { return m_haloThickness; }
 
@@ -106,23 +414,47 @@ private:
     const core::VulkanContext& m_context;
     core::MemoryAllocator& m_allocator;
     const std::vector<domain::SubDomain>& m_domains;
+    core::DeviceGroup* m_devices = nullptr;   // Device per domain, if set
 
     uint32_t m_haloThickness = 2;  // Standard: 2 voxels for 2nd-order stencils
 
-    // Halo buffers per field per GPU
-    // Structure: m_fieldHalos[fieldName][gpuIndex] -> HaloBufferSet
-    std::unordered_map<std::string, std::vector<HaloBufferSet>> m_fieldHalos;
+    // Halo messages per GPU: m_haloSets[gpuIndex].messages[neighbor]
+    std::vector<HaloBufferSet> m_haloSets;
+    bool m_halosAllocated = false;
+
+    // Halo thickness per field, set from stencil neighbor radii
+    std::unordered_map<std::string, uint32_t> m_fieldThickness;
+
+    // Wire format per field; absent fields are sent as fp32
+    std::unordered_map<std::string, HaloEncoding> m_fieldEncoding;
+
+    // Gather/scatter lists per GPU: m_indexLists[gpuIndex][neighbor]
+    std::vector<std::vector<HaloIndexList>> m_indexLists;
+
+    // Interior/boundary split per GPU
+    std::vector<DomainVoxelLists> m_voxelLists;
+    uint32_t m_phaseCount = 1;
 
     // Timeline semaphores for inter-GPU synchronization
     // Structure: m_haloSemaphores[srcGpu * gpuCount + dstGpu] -> vk::Semaphore
     std::vector<vk::Semaphore> m_haloSemaphores;
 
-    /**
-     * Calculate halo dimensions for a specific domain and face
-     */
-    HaloBufferSet::FaceDimensions calculateFaceDimensions(
-        const domain::SubDomain& domain,
-        uint32_t face);
+    // Receive-buffer release semaphores, same layout as m_haloSemaphores
+    std::vector<vk::Semaphore> m_releaseSemaphores;
+
+    // Pack-complete timeline semaphores, one per GPU
+    std::vector<vk::Semaphore> m_packSemaphores;
+
+    // Release halo message buffers of one domain
+    void destroyHaloSet(uint32_t gpuIndex);
+
+    // Lay out and allocate one domain's messages
+    void allocateDomainHalos(uint32_t gpuIndex,
+                             const std::unordered_map<std::string, field::FieldDesc>& fields);
+
+    // Release all index list buffers, or those of one domain
+    void destroyIndexLists();
+    void destroyDomainIndexLists(uint32_t gpuIndex);
 };
 
 } // namespace halo
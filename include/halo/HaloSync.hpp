@@ -16,6 +16,9 @@ namespace halo {
  * 2. Transfer halos (copy between GPUs)
  * 3. Unpack halos (write boundary data into local arrays)
  * 4. Compute (use halo data in stencils)
+ *
+ * Each message segment carries its HaloEncoding: pack converts fp32 field
+ * values to the wire format and unpack restores fp32.
  */
 class HaloSync {
 public:
@@ -44,45 +47,54 @@ public:
     void createPipelines();
 
     /**
-     * Record halo pack operation (extract boundary voxels)
+     * Record halo pack operation (gather the boundary voxels of several
+     * fields into one neighbor message)
      * @param cmd Command buffer
-     * @param gpu GPU index
-     * @param sem Semaphore to signal when done
-     * @param value Semaphore value to signal
+     * @param segmentTable Per-field layout of the message (HaloMessage::segmentTable)
+     * @param messageBuffer Send message
+     * @param indexBuffer Gather list (field element per halo slot)
+     * @param segmentMask Bit per segment to pack
+     * @param segmentCount Number of segments in the table
+     * @param maxUnits Largest invocation count among the packed segments
+     *        (values, value pairs or blocks, by segment encoding)
      */
     void recordHaloPack(vk::CommandBuffer cmd,
-                       vk::Buffer fieldBuffer,
-                       vk::Buffer haloBuffer,
-                       uint32_t offset,
-                       uint32_t count);
+                       vk::Buffer segmentTable,
+                       vk::Buffer messageBuffer,
+                       vk::Buffer indexBuffer,
+                       uint32_t segmentMask,
+                       uint32_t segmentCount,
+                       uint32_t maxUnits);
 
     /**
      * Record halo transfer operation (copy between GPUs)
      * @param cmd Command buffer
-     * @param srcGpu Source GPU
-     * @param dstGpu Destination GPU
-     * @param waitSem Semaphore to wait on (pack complete)
-     * @param waitValue Semaphore value to wait for
-     * @param signalSem Semaphore to signal (transfer complete)
-     * @param signalValue Semaphore value to signal
+     * @param srcBuffer Send message
+     * @param dstBuffer Neighbor's receive message
+     * @param regions One region per exchanged field segment
      */
     void recordHaloTransfer(vk::CommandBuffer cmd,
                            vk::Buffer srcBuffer,
                            vk::Buffer dstBuffer,
-                           vk::DeviceSize size);
+                           const std::vector<vk::BufferCopy>& regions);
 
     /**
-     * Record halo unpack operation (write received data)
+     * Record halo unpack operation (scatter a received message into its fields)
      * @param cmd Command buffer
-     * @param gpu GPU index
-     * @param waitSem Semaphore to wait on (transfer complete)
-     * @param waitValue Semaphore value to wait for
+     * @param segmentTable Per-field layout of the message
+     * @param messageBuffer Receive message
+     * @param indexBuffer Scatter list (field element per halo slot)
+     * @param segmentMask Bit per segment to unpack
+     * @param segmentCount Number of segments in the table
+     * @param maxUnits Largest invocation count among the unpacked segments
      */
     void recordHaloUnpack(vk::CommandBuffer cmd,
-                         vk::Buffer haloBuffer,
-                         vk::Buffer fieldBuffer,
-                         uint32_t offset,
-                         uint32_t count);
+                         vk::Buffer segmentTable,
+                         vk::Buffer messageBuffer,
+                         vk::Buffer indexBuffer,
+                         uint32_t segmentMask,
+                         uint32_t segmentCount,
+                         uint32_t maxUnits);
 
     /**
      * Create synchronization commands for a timestep
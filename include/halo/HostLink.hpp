@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+namespace halo {
+
+/**
+ * @brief Host link backends between rank processes
+ */
+enum class HostLinkType : uint32_t {
+    SharedMemory = 0,   // POSIX shared memory ring (same node, one copy)
+    UnixSocket = 1      // Unix-domain stream socket (same node, kernel copies)
+};
+
+/**
+ * @brief One direction of halo messages between two processes
+ *
+ * Messages are tagged with their exchange number and delivered in order.
+ * The receiver creates a link and the sender opens it by name. All calls
+ * are non-blocking: a full or empty link returns nullptr, so one relay
+ * thread can serve several links.
+ */
+class HostLink {
+public:
+    virtual ~HostLink() = default;
+
+    /**
+     * Buffer for the next message (producer)
+     * @return nullptr while the link cannot take another message
+     */
+    virtual uint8_t* beginPush() = 0;
+
+    /**
+     * Send the message written into the buffer returned by beginPush
+     * @param exchange Exchange number of the message
+     * @param size Payload bytes written
+     */
+    virtual void commitPush(uint64_t exchange, uint64_t size) = 0;
+
+    /**
+     * Push out the rest of a committed message the link could not take at once
+     * @return true once nothing is left to send
+     */
+    virtual bool flush() { return true; }
+
+    /**
+     * Oldest complete message (consumer)
+     * @param exchange Receives its exchange number
+     * @param size Receives its payload size
+     * @return nullptr until a whole message has arrived
+     */
+    virtual const uint8_t* beginPop(uint64_t& exchange, uint64_t& size) = 0;
+
+    /**
+     * Release the message returned by beginPop
+     */
+    virtual void commitPop() = 0;
+
+    /**
+     * Largest message the link carries
+     */
+    virtual uint64_t getSlotBytes() const = 0;
+
+    /**
+     * Create the receiving end of a link
+     * @param name Link name (see linkName)
+     * @param slotCount Messages in flight (rings; sockets buffer in the kernel)
+     * @param slotBytes Largest message
+     */
+    static std::unique_ptr<HostLink> create(HostLinkType type, const std::string& name,
+                                            uint32_t slotCount, uint64_t slotBytes);
+
+    /**
+     * Open the sending end of a link created by another process
+     * @param slotBytes Largest message the sender will push
+     * @throws std::runtime_error if it does not appear within the timeout
+     *         or cannot carry slotBytes
+     */
+    static std::unique_ptr<HostLink> open(HostLinkType type, const std::string& name,
+                                          uint64_t slotBytes, std::chrono::milliseconds timeout);
+
+    /**
+     * Name of one message direction
+     * @param session Name shared by all ranks of a run
+     * @param generation Allocation round (all ranks reallocate in lockstep)
+     */
+    static std::string linkName(const std::string& session, uint32_t generation,
+                                uint32_t srcGpu, uint32_t dstGpu);
+
+    /**
+     * Backend name for logs, benchmarks and the command line
+     */
+    static const char* typeName(HostLinkType type);
+
+    /**
+     * Parse a backend name ("shm" or "socket")
+     * @throws std::runtime_error for unknown names
+     */
+    static HostLinkType parseType(const std::string& name);
+};
+
+} // namespace halo
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "core/VulkanContext.hpp"
+#include "core/MemoryAllocator.hpp"
+#include "field/FieldRegistry.hpp"
+#include "nanovdb_adapter/GpuGridManager.hpp"
+
+#include <nanovdb/NanoVDB.h>
+#include <vulkan/vulkan.hpp>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+namespace halo {
+
+/**
+ * @brief How interface ghosts of a fine level are filled from the coarse level
+ */
+enum class Prolongation : uint32_t {
+    Trilinear = 0,      // Parent and its 7 neighbours towards the ghost, 3/4 : 1/4 per axis
+    Conservative = 1    // Parent value (piecewise constant, preserves coarse sums)
+};
+
+/**
+ * @brief Ghost values at coarse-fine interfaces of a multi-level grid
+ *
+ * Field buffers hold every level back to back (GridResources::levels):
+ * the cells of a level, then its interface ghosts, i.e. fine-index voxels
+ * within ghostDepth of the level whose parent is a cell one level down.
+ * Level L+1 coordinates are twice as fine as level L, so the parent of
+ * a fine voxel is ijk >> 1, and coarse cells under a fine region stay
+ * active (covered cells).
+ *
+ * Before a stencil runs on level L, recordFill restricts level L+1 into
+ * the covered cells of L and L into the covered cells of L-1, then
+ * prolongs L-1 into the ghosts of L. Every transfer is one weighted
+ * gather kernel, batched over all float fields, so stencils read ghosts
+ * like any other neighbour and need no level-specific code.
+ *
+ * SimulationEngine uploads single-level grids and does not use it; callers
+ * upload a buildLayout layout through GpuGridManager::uploadLevels and
+ * call recordFill before dispatching a level.
+ */
+class LevelInterface {
+public:
+    using LevelRange = nanovdb_adapter::GpuGridManager::LevelRange;
+
+    static constexpr uint32_t kMaxSources = 8;
+
+    /**
+     * @brief One interpolated element: target = sum of weight * source
+     *
+     * Unused source slots have weight 0. Matches the kernel's scalar layout.
+     */
+    struct Entry {
+        uint32_t target = 0;
+        std::array<uint32_t, kMaxSources> sources{};
+        std::array<float, kMaxSources> weights{};
+    };
+
+    /**
+     * @brief Interpolation work of one level
+     */
+    struct LevelLists {
+        uint32_t level = 0;
+        std::vector<Entry> prolongation;    // Ghosts of this level from the level below
+        std::vector<Entry> restriction;     // Covered cells of this level from the level above
+    };
+
+    /**
+     * @brief Field element layout of a multi-level grid
+     */
+    struct Layout {
+        std::vector<nanovdb::Coord> coords;     // Per element, in its level's index space
+        std::vector<LevelRange> levels;         // Coarsest first
+    };
+
+    struct Config {
+        Prolongation prolongation = Prolongation::Trilinear;
+    };
+
+    /**
+     * Lay out the cells of every level in Morton order, each level followed
+     * by its interface ghosts
+     * @param levelCells Active cells per level (index = level)
+     * @param ghostDepth Ghost layers around each fine level (stencil radius)
+     */
+    static Layout buildLayout(const std::vector<std::vector<nanovdb::Coord>>& levelCells,
+                              uint32_t ghostDepth);
+
+    /**
+     * Build the prolongation and restriction entries of every level
+     * @param coords Coordinate of each field element
+     * @param levels Element ranges per level (coarsest first)
+     * @param prolongation Ghost interpolation
+     */
+    static std::vector<LevelLists> buildLists(const std::vector<nanovdb::Coord>& coords,
+                                              const std::vector<LevelRange>& levels,
+                                              Prolongation prolongation);
+
+    LevelInterface(const core::VulkanContext& context,
+                   core::MemoryAllocator& allocator,
+                   const Config& config);
+    ~LevelInterface();
+
+    LevelInterface(const LevelInterface&) = delete;
+    LevelInterface& operator=(const LevelInterface&) = delete;
+
+    /**
+     * Rebuild and upload the interface lists (after every topology change)
+     * @param coords Coordinate of each field element
+     * @param levels Element ranges per level
+     */
+    void rebuild(const std::vector<nanovdb::Coord>& coords, const std::vector<LevelRange>& levels);
+
+    /**
+     * Record the restriction and prolongation a stencil on this level reads,
+     * followed by a barrier
+     * @param cmd Command buffer
+     * @param fields Fields to fill (non-float fields are skipped)
+     * @param level Level about to be dispatched
+     */
+    void recordFill(vk::CommandBuffer cmd, const field::FieldRegistry& fields, uint32_t level);
+
+    const std::vector<LevelLists>& getLevelLists() const { return m_lists; }
+
+private:
+    // Device copy of one level's lists: prolongation entries, then restriction entries
+    struct LevelBuffers {
+        core::MemoryAllocator::Buffer entries;
+        uint32_t prolongationCount = 0;
+        uint32_t restrictionCount = 0;
+    };
+
+    // Float field as seen by the kernel
+    struct FieldSlot {
+        uint64_t address = 0;
+        uint32_t components = 0;
+        uint32_t _pad = 0;
+    };
+
+    const core::VulkanContext& m_context;
+    core::MemoryAllocator& m_allocator;
+    Config m_config;
+
+    std::vector<LevelLists> m_lists;
+    std::vector<LevelBuffers> m_buffers;    // Parallel to m_lists
+
+    std::vector<FieldSlot> m_fieldSlots;
+    core::MemoryAllocator::Buffer m_fieldTable;
+
+    vk::PipelineLayout m_pipelineLayout;
+    vk::Pipeline m_pipeline;
+
+    void createPipeline();
+    void releaseBuffers();
+
+    /**
+     * Refresh the field table when fields were added or reallocated
+     */
+    void updateFieldTable(const field::FieldRegistry& fields);
+
+    /**
+     * Dispatch count entries starting at entry first of a level's buffer
+     * @return Whether anything was recorded
+     */
+    bool recordGather(vk::CommandBuffer cmd, const LevelBuffers& buffers,
+                      uint32_t first, uint32_t count);
+};
+
+} // namespace halo
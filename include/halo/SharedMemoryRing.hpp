@@ -0,0 +1,118 @@
+#pragma once
+
+#include "halo/HostLink.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace halo {
+
+/**
+ * @brief Single-producer single-consumer ring of halo messages in POSIX shared memory
+ *
+ * Carries one direction of a halo message between two rank processes. The
+ * receiving rank creates the ring, the sending rank opens it by name. Each
+ * slot holds one exchange laid out at the receive message offsets, tagged
+ * with its exchange number, so the receiver can copy it straight into its
+ * staging slot. A full ring stalls the sender, which bounds how far one
+ * rank runs ahead of another.
+ *
+ * Head and tail are lock-free atomics in the mapping; nothing else is shared.
+ */
+class SharedMemoryRing : public HostLink {
+public:
+    /**
+     * Create a ring, replacing a stale one of the same name (crashed run)
+     * @param name Link name (no slashes; mapped to a POSIX shared memory name)
+     * @param slotCount Messages in flight
+     * @param slotBytes Largest message
+     */
+    static std::unique_ptr<SharedMemoryRing> create(const std::string& name,
+                                                    uint32_t slotCount,
+                                                    uint64_t slotBytes);
+
+    /**
+     * Open a ring created by another process, waiting until it is initialized
+     * @param slotBytes Largest message the sender will push
+     * @throws std::runtime_error if it does not appear within the timeout or
+     *         its slots are smaller than slotBytes
+     */
+    static std::unique_ptr<SharedMemoryRing> open(const std::string& name,
+                                                  uint64_t slotBytes,
+                                                  std::chrono::milliseconds timeout);
+
+    /**
+     * Unmaps the ring; the creator also unlinks its name
+     */
+    ~SharedMemoryRing() override;
+
+    SharedMemoryRing(const SharedMemoryRing&) = delete;
+    SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+    /**
+     * Payload of the next free slot (producer)
+     * @return nullptr while the ring is full
+     */
+    uint8_t* beginPush() override;
+
+    /**
+     * Publish the slot returned by beginPush
+     * @param exchange Exchange number of the message
+     * @param size Payload bytes written
+     */
+    void commitPush(uint64_t exchange, uint64_t size) override;
+
+    /**
+     * Payload of the oldest message (consumer)
+     * @param exchange Receives its exchange number
+     * @param size Receives its payload size
+     * @return nullptr while the ring is empty
+     */
+    const uint8_t* beginPop(uint64_t& exchange, uint64_t& size) override;
+
+    /**
+     * Hand the slot returned by beginPop back to the producer
+     */
+    void commitPop() override;
+
+    uint32_t getSlotCount() const { return m_slotCount; }
+    uint64_t getSlotBytes() const override { return m_slotBytes; }
+    const std::string& getName() const { return m_name; }
+
+private:
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "Shared memory rings need address-free 64-bit atomics");
+
+    struct Header {
+        std::atomic<uint32_t> magic;        // Set last by the creator
+        uint32_t slotCount;
+        uint64_t slotBytes;
+        alignas(64) std::atomic<uint64_t> head;  // Messages pushed
+        alignas(64) std::atomic<uint64_t> tail;  // Messages popped
+    };
+
+    struct SlotHeader {
+        uint64_t exchange;
+        uint64_t size;
+    };
+
+    SharedMemoryRing(std::string name, void* mapping, size_t mappingBytes, bool owner);
+
+    static size_t slotStride(uint64_t slotBytes);
+    static size_t mappingSize(uint32_t slotCount, uint64_t slotBytes);
+    SlotHeader* slot(uint64_t index) const;
+
+    std::string m_name;
+    void* m_mapping = nullptr;
+    size_t m_mappingBytes = 0;
+    bool m_owner = false;
+    Header* m_header = nullptr;
+    uint32_t m_slotCount = 0;
+    uint64_t m_slotBytes = 0;
+};
+
+} // namespace halo
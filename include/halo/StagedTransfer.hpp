@@ -0,0 +1,230 @@
+#pragma once
+
+#include "halo/HaloManager.hpp"
+#include "halo/HostLink.hpp"
+#include "halo/Transport.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace halo {
+
+/**
+ * @brief Host-staged halo messages between domains on different devices or processes
+ *
+ * Logical devices can neither copy into each other's buffers nor wait on
+ * each other's semaphores, so a message takes three hops: the sender's
+ * transfer queue copies the packed segments into a host-visible staging
+ * slot, a relay thread copies them into the receiver's host-visible slot,
+ * and the receiver copies that slot into its receive buffer right before
+ * unpacking. Every direction has two slots: while the relay copies
+ * exchange k, exchange k + 1 can already be packed and staged, and interior
+ * compute runs on both devices throughout.
+ *
+ * Exchange k of a message uses slot k % 2:
+ * - the sender signals its halo semaphore with k once staged
+ * - the relay waits for that, and for the receiver's release semaphore to
+ *   reach k - 2 (slot copied out), copies, and signals drained (sender
+ *   device) and arrived (receiver device) with k from the host
+ * - the sender waits for drained >= k - 2 before refilling a slot; the
+ *   receiver waits for arrived >= k before copying it out
+ *
+ * With a rank, this process runs a single domain and the middle hop goes
+ * through a HostLink per direction (shared memory ring or Unix socket): the
+ * sender's relay pushes staged exchanges into the link, the receiver's
+ * relay pops them into its slots. Each semaphore then only involves the
+ * local device.
+ *
+ * Domains on separate devices need HaloManager::setDevices.
+ */
+class StagedTransfer : public Transport {
+public:
+    /**
+     * @brief Process layout
+     */
+    struct Config {
+        int32_t rank = -1;              // Domain run by this process; -1 = every domain in process
+        std::string session;            // Link name prefix shared by all ranks of a run
+        HostLinkType link = HostLinkType::SharedMemory;
+        uint32_t ringSlots = 4;         // Messages in flight per shared memory ring
+        uint32_t openTimeoutMs = 60000; // Wait for peer ranks to create their links
+    };
+
+    /**
+     * @param haloManager Messages and halo/release semaphores of every domain
+     * @param config Process layout (default: all domains in this process)
+     */
+    explicit StagedTransfer(HaloManager& haloManager, const Config& config = Config());
+
+    /**
+     * Stops the relay threads and frees the staging slots
+     */
+    ~StagedTransfer() override;
+
+    /**
+     * Allocate two staging slots per direction of every message and (re)start
+     * the relay. Call after HaloManager::allocateHalos, with no exchange in
+     * flight; relay semaphore values carry over like the halo values. Ranks
+     * create the links they receive from, then open the ones they send to,
+     * so every rank must reallocate in the same order.
+     */
+    void allocate();
+
+    const char* getName() const override;
+
+    /**
+     * Staging slots alternate: the relay must have drained exchange k - 2
+     * from the slot exchange k refills
+     */
+    Wait sendWait(uint32_t srcGpu, uint32_t dstGpu, uint64_t exchange) const override;
+
+    /**
+     * Stage exchange k (see recordStage)
+     */
+    void recordSend(vk::CommandBuffer cmd, uint32_t srcGpu, uint32_t dstGpu,
+                    uint64_t exchange, const std::vector<vk::BufferCopy>& regions) override {
+        recordStage(cmd, srcGpu, dstGpu, exchange, regions);
+    }
+
+    /**
+     * The relay must have delivered exchange k into the receiver's slot
+     */
+    Wait receiveWait(uint32_t srcGpu, uint32_t dstGpu, uint64_t exchange) const override;
+
+    /**
+     * Record the sender side of one exchange: copy the given regions of the
+     * send message into the exchange's staging slot and queue them for the relay
+     * @param exchange Exchange number (the sender's halo semaphore value)
+     * @param regions Send message offset to receive message offset, per segment
+     */
+    void recordStage(vk::CommandBuffer cmd, uint32_t srcGpu, uint32_t dstGpu,
+                     uint64_t exchange, const std::vector<vk::BufferCopy>& regions);
+
+    /**
+     * Record the receiver side of one exchange: copy the staging slot into
+     * the receive message, ahead of the unpack dispatch
+     * @param exchange Exchange number (the receiver's release semaphore value)
+     * @param regions Receive message regions to copy (srcOffset == dstOffset)
+     */
+    void recordReceive(vk::CommandBuffer cmd, uint32_t srcGpu, uint32_t dstGpu,
+                       uint64_t exchange, const std::vector<vk::BufferCopy>& regions) override;
+
+    /**
+     * Timeline semaphore on srcGpu's device: exchange k left its sender slot
+     */
+    vk::Semaphore getDrainedSemaphore(uint32_t srcGpu, uint32_t dstGpu) const;
+
+    /**
+     * Timeline semaphore on dstGpu's device: exchange k reached its receiver slot
+     */
+    vk::Semaphore getArrivedSemaphore(uint32_t srcGpu, uint32_t dstGpu) const;
+
+    /**
+     * Whether a domain is run by this process
+     */
+    bool isLocal(uint32_t gpuIndex) const {
+        return m_config.rank < 0 || gpuIndex == static_cast<uint32_t>(m_config.rank);
+    }
+
+    /**
+     * Bytes relayed out of and into this process's staging slots
+     */
+    uint64_t getBytesSent() const override { return m_bytesSent; }
+    uint64_t getBytesReceived() const override { return m_bytesReceived; }
+
+    /**
+     * Whether the relay may copy an exchange
+     * @param exchange Exchange number k
+     * @param staged Sender's halo semaphore value
+     * @param released Receiver's release semaphore value
+     * @return true once k is staged and the receiver has copied out k - 2
+     */
+    static bool slotReady(uint64_t exchange, uint64_t staged, uint64_t released) {
+        return staged >= exchange && released + 2 >= exchange;
+    }
+
+private:
+    struct PendingCopy {
+        uint64_t exchange = 0;
+        std::vector<vk::BufferCopy> regions;
+    };
+
+    // Which hops of a direction run in this process
+    enum class Route {
+        Local,      // Both domains here: slot to slot
+        Outgoing,   // Sender here: slot to link
+        Incoming    // Receiver here: link to slot
+    };
+
+    // One direction of a message
+    struct Channel {
+        uint32_t srcGpu = 0;
+        uint32_t dstGpu = 0;
+        Route route = Route::Local;
+        uint32_t relay = 0;                                      // Relay thread serving it
+        std::array<core::MemoryAllocator::Buffer, 2> sendSlots;  // Sender device, read by the host
+        std::array<core::MemoryAllocator::Buffer, 2> recvSlots;  // Receiver device, written by the host
+        std::unique_ptr<HostLink> link;                          // Outgoing/incoming only
+        std::deque<PendingCopy> pending;                         // Guarded by m_mutex
+    };
+
+    // Outcome of one relay attempt on a channel
+    enum class Progress {
+        Idle,       // Nothing queued
+        Blocked,    // Queued, waiting on a semaphore, slot or link
+        Moved       // Relayed one exchange
+    };
+
+    HaloManager& m_haloManager;
+    Config m_config;
+    uint32_t m_gpuCount = 0;
+
+    std::vector<std::unique_ptr<Channel>> m_channels;
+    std::vector<Channel*> m_channelIndex;          // [src * gpuCount + dst], null if no message
+
+    // Created once per pair and kept across reallocation: [src * gpuCount + dst]
+    std::vector<vk::Semaphore> m_drainedSemaphores;
+    std::vector<vk::Semaphore> m_arrivedSemaphores;
+
+    // One relay thread per sending device (ranks: one outgoing, one incoming)
+    std::vector<std::thread> m_relays;
+    std::atomic<bool> m_stop{false};
+    std::mutex m_mutex;
+    std::condition_variable m_pendingChanged;
+
+    std::atomic<uint64_t> m_bytesSent{0};
+    std::atomic<uint64_t> m_bytesReceived{0};
+
+    Channel& channel(uint32_t srcGpu, uint32_t dstGpu) const;
+    void startRelays();
+    void stopRelays();
+    void destroyChannels();
+
+    // Relay loop of one thread
+    void relay(uint32_t relayIndex);
+
+    // One step of each route; staged waits are added for a sleeping wait-any
+    Progress relayLocal(Channel& channel, std::vector<vk::Semaphore>& waitSemaphores,
+                        std::vector<uint64_t>& waitValues);
+    Progress relayOutgoing(Channel& channel, std::vector<vk::Semaphore>& waitSemaphores,
+                           std::vector<uint64_t>& waitValues);
+    Progress relayIncoming(Channel& channel);
+
+    // Oldest staged exchange of a channel (only its relay thread pops)
+    const PendingCopy* frontPending(Channel& channel);
+    void popPending(Channel& channel);
+
+    // Host-signal a timeline semaphore on a domain's device
+    void signal(uint32_t gpuIndex, vk::Semaphore semaphore, uint64_t value);
+};
+
+} // namespace halo
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "halo/HaloManager.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace halo {
+
+/**
+ * @brief Moves packed halo messages from a sender's send buffer into the
+ *        receiver's receive buffer
+ *
+ * GraphExecutor records pack and unpack; a transport records what happens
+ * in between and says when each side may proceed. Completion is
+ * asynchronous and expressed as timeline semaphore values on the waiting
+ * side's device: exchange k of a message may be sent once sendWait is
+ * reached and unpacked once receiveWait is reached. The sender's halo
+ * semaphore (k once its transfer commands ran) and the receiver's release
+ * semaphore (k once unpacked) are signalled by the executor and are the
+ * inputs a transport builds on.
+ *
+ * A backend for another interconnect (MPI, RDMA) implements this interface
+ * without touching the executor.
+ */
+class Transport {
+public:
+    /**
+     * @brief A timeline semaphore value to wait for (no semaphore = no wait)
+     */
+    struct Wait {
+        vk::Semaphore semaphore;
+        uint64_t value = 0;
+    };
+
+    virtual ~Transport() = default;
+
+    /**
+     * Backend name for logs
+     */
+    virtual const char* getName() const = 0;
+
+    /**
+     * What the sender waits for before recording exchange k
+     * (the destination it writes must be free again)
+     */
+    virtual Wait sendWait(uint32_t srcGpu, uint32_t dstGpu, uint64_t exchange) const = 0;
+
+    /**
+     * Record the sender side of exchange k, in the sender's transfer commands
+     * @param regions Send message offset to receive message offset, per segment
+     */
+    virtual void recordSend(vk::CommandBuffer cmd, uint32_t srcGpu, uint32_t dstGpu,
+                            uint64_t exchange, const std::vector<vk::BufferCopy>& regions) = 0;
+
+    /**
+     * What the receiver waits for before unpacking exchange k
+     */
+    virtual Wait receiveWait(uint32_t srcGpu, uint32_t dstGpu, uint64_t exchange) const = 0;
+
+    /**
+     * Record the receiver side of exchange k, ahead of its unpack dispatch
+     * @param regions Receive message regions being unpacked (srcOffset == dstOffset)
+     */
+    virtual void recordReceive(vk::CommandBuffer cmd, uint32_t srcGpu, uint32_t dstGpu,
+                               uint64_t exchange, const std::vector<vk::BufferCopy>& regions) = 0;
+
+    /**
+     * Whether sender and receiver commands may share one submission
+     * (every wait is satisfied by the device itself, no host progress needed)
+     */
+    virtual bool isDeviceLocal() const { return false; }
+
+    /**
+     * Bytes this process moved out of and into its domains
+     */
+    virtual uint64_t getBytesSent() const { return 0; }
+    virtual uint64_t getBytesReceived() const { return 0; }
+};
+
+/**
+ * @brief Same-device transport: the sender copies straight into the
+ *        neighbor's receive buffer
+ *
+ * Needs every domain on one device (or devices sharing memory). The sender
+ * waits for the receiver to release exchange k - 1 before overwriting it.
+ */
+class DeviceCopyTransport : public Transport {
+public:
+    explicit DeviceCopyTransport(HaloManager& haloManager);
+
+    const char* getName() const override { return "device copy"; }
+    Wait sendWait(uint32_t srcGpu, uint32_t dstGpu, uint64_t exchange) const override;
+    void recordSend(vk::CommandBuffer cmd, uint32_t srcGpu, uint32_t dstGpu,
+                    uint64_t exchange, const std::vector<vk::BufferCopy>& regions) override;
+    Wait receiveWait(uint32_t srcGpu, uint32_t dstGpu, uint64_t exchange) const override;
+    void recordReceive(vk::CommandBuffer cmd, uint32_t srcGpu, uint32_t dstGpu,
+                       uint64_t exchange, const std::vector<vk::BufferCopy>& regions) override;
+    bool isDeviceLocal() const override { return true; }
+
+private:
+    HaloManager& m_haloManager;
+};
+
+} // namespace halo
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "halo/HostLink.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace halo {
+
+/**
+ * @brief Halo messages over a Unix-domain stream socket
+ *
+ * The receiving rank binds a socket in the temp directory and accepts its
+ * peer lazily from beginPop; the sending rank connects by name. Messages
+ * are framed as {exchange, size} followed by the payload. Both ends are
+ * non-blocking: a message the kernel buffer cannot take yet stays in the
+ * sender's buffer (beginPush returns nullptr until it is flushed), and the
+ * receiver accumulates bytes until a whole message has arrived.
+ *
+ * Costs two kernel copies per message compared to the shared memory ring,
+ * but is the same byte stream a network transport would carry.
+ */
+class UnixSocketLink : public HostLink {
+public:
+    /**
+     * Bind the receiving end, replacing a stale socket of the same name
+     * @param name Link name (no slashes)
+     * @param slotBytes Largest message
+     */
+    static std::unique_ptr<UnixSocketLink> create(const std::string& name, uint64_t slotBytes);
+
+    /**
+     * Connect the sending end, retrying until the receiver has bound it
+     * @param slotBytes Largest message the sender will push
+     * @throws std::runtime_error if it does not appear within the timeout
+     */
+    static std::unique_ptr<UnixSocketLink> open(const std::string& name, uint64_t slotBytes,
+                                                std::chrono::milliseconds timeout);
+
+    /**
+     * Closes the socket; the creator also removes its path
+     */
+    ~UnixSocketLink() override;
+
+    UnixSocketLink(const UnixSocketLink&) = delete;
+    UnixSocketLink& operator=(const UnixSocketLink&) = delete;
+
+    uint8_t* beginPush() override;
+    void commitPush(uint64_t exchange, uint64_t size) override;
+    bool flush() override;
+    const uint8_t* beginPop(uint64_t& exchange, uint64_t& size) override;
+    void commitPop() override;
+    uint64_t getSlotBytes() const override { return m_slotBytes; }
+
+    /**
+     * Filesystem path of a link's socket
+     */
+    static std::string socketPath(const std::string& name);
+
+private:
+    struct MessageHeader {
+        uint64_t exchange;
+        uint64_t size;
+    };
+
+    UnixSocketLink(std::string path, int listenFd, int fd, uint64_t slotBytes);
+
+    // Read towards the next whole message
+    bool fill();
+
+    std::string m_path;
+    int m_listenFd = -1;        // Receiver until its peer connects
+    int m_fd = -1;
+    uint64_t m_slotBytes = 0;
+    bool m_closed = false;      // Peer hung up
+
+    std::vector<uint8_t> m_sendBuffer;   // Header + payload of one message
+    size_t m_sendOffset = 0;
+    size_t m_sendEnd = 0;                // Bytes of the pending message (0 = none)
+
+    std::vector<uint8_t> m_recvBuffer;
+    size_t m_recvFilled = 0;
+};
+
+} // namespace halo
@@ -1,12 +1,14 @@
 #pragma once
 
 #include "core/MemoryAllocator.hpp"
+#include "nanovdb_adapter/StreamingGridLoader.hpp"
 #include <nanovdb/NanoVDB.h>
 #include <nanovdb/GridHandle.h>
 #include <nanovdb/HostBuffer.h>
 #include <nanovdb/tools/GridBuilder.h>
 #include <vulkan/vulkan.hpp>
 #include <cstdint>
+#include <vector>
 
 namespace core {
 class VulkanContext;
@@ -35,6 +37,19 @@ struct PNanoVDB {
  */
 class GpuGridManager {
 public:
+    /**
+     * @brief Field elements of one refinement level
+     *
+     * The level's cells come first, followed by its coarse-fine interface
+     * ghosts (filled by halo::LevelInterface, never dispatched).
+     */
+    struct LevelRange {
+        uint32_t level = 0;
+        uint32_t startIndex = 0;    // First element of the level
+        uint32_t count = 0;         // Cells
+        uint32_t ghostCount = 0;    // Interface ghosts after the cells
+    };
+
     /**
      * @brief GPU grid resources descriptor
      */
@@ -44,6 +59,7 @@ public:
         core::MemoryAllocator::Buffer linearValues; // Values in Morton order
         uint32_t activeVoxelCount;
         nanovdb::CoordBBox bounds;
+        std::vector<LevelRange> levels;             // Coarsest first (one level unless refined)
 
         /**
          * Get shader-compatible structure
@@ -74,6 +90,42 @@ public:
      */
     GridResources upload(const nanovdb::GridHandle<nanovdb::HostBuffer>& grid);
 
+    /**
+     * Upload grid from an out-of-core loader, one chunk at a time
+     *
+     * Produces the same Morton-ordered LUT/values as upload() while holding at
+     * most one chunk of leaves plus its staging data in host memory. The raw
+     * grid buffer is only uploaded for unfiltered loads.
+     * @param loader Streaming loader
+     * @param filter Optional leaf filter (e.g. a sub-domain region)
+     * @param onChunk Optional callback seeing every uploaded chunk (e.g. to
+     *        gather leaf statistics without a second pass over the file)
+     * @return GPU resources descriptor
+     */
+    GridResources uploadStreamed(StreamingGridLoader& loader,
+                                 const StreamingGridLoader::LeafFilter& filter = {},
+                                 const StreamingGridLoader::ChunkCallback& onChunk = {});
+
+    /**
+     * Upload the elements of a multi-level grid (no raw NanoVDB structure)
+     * @param coords Coordinate of each element, in its level's index space
+     * @param values Initial value of each element
+     * @param levels Element ranges per level, e.g. from halo::LevelInterface::buildLayout
+     * @return GPU resources descriptor
+     */
+    GridResources uploadLevels(const std::vector<nanovdb::Coord>& coords,
+                               const std::vector<float>& values,
+                               std::vector<LevelRange> levels);
+
+    /**
+     * Collect active voxel coordinates in the order used for field storage
+     * (element i of every field buffer belongs to coordinate i)
+     * @param grid Host-resident NanoVDB grid
+     * @return Morton-ordered active coordinates
+     */
+    static std::vector<nanovdb::Coord> collectSortedCoords(
+        const nanovdb::GridHandle<nanovdb::HostBuffer>& grid);
+
     /**
      * Cleanup and deallocate GPU grid resources
      * @param resources Resources to destroy
@@ -84,6 +136,11 @@ private:
     const core::VulkanContext& m_context;
     core::MemoryAllocator& m_allocator;
 
+    // Create and fill the coordinate LUT and linear values
+    void uploadElements(GridResources& resources,
+                        const std::vector<nanovdb::Coord>& coords,
+                        const std::vector<float>& values);
+
     // Helper to compute Morton code (Z-order curve)
     static uint64_t getMortonCode(uint32_t x, uint32_t y, uint32_t z);
 };
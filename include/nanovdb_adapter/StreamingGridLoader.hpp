@@ -0,0 +1,186 @@
+#pragma once
+
+#include <nanovdb/NanoVDB.h>
+#include <nanovdb/HostBuffer.h>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace nanovdb_adapter {
+
+/**
+ * @brief Out-of-core reader for float grids stored in uncompressed .nvdb files
+ *
+ * Only the grid/tree headers are kept resident. Leaf nodes are read from disk
+ * in bounded-size chunks (optionally prefetched on a background thread) and
+ * handed to a callback, so grids larger than host memory can be scanned,
+ * partitioned and uploaded without materializing the full host grid.
+ *
+ * NanoVDB leaf nodes are self-contained (origin, masks and values), so a
+ * streamed chunk can be used with the regular nanovdb::NanoLeaf API.
+ */
+class StreamingGridLoader {
+public:
+    /**
+     * @brief Streaming limits
+     */
+    struct Config {
+        uint64_t memoryBudget = 256ull << 20;  // Max bytes of leaf data resident at once
+        uint32_t readAhead = 1;                // Chunks prefetched while one is processed
+    };
+
+    /**
+     * @brief A contiguous batch of leaves resident in host memory
+     */
+    struct LeafChunk {
+        const nanovdb::NanoLeaf<float>* leaves = nullptr;
+        uint32_t count = 0;
+        const uint32_t* leafIndices = nullptr;  // File leaf index of each entry
+    };
+
+    /**
+     * @brief Compact per-leaf index entry (kept resident after the first scan)
+     */
+    struct LeafIndexEntry {
+        nanovdb::CoordBBox bbox;      // Active bounding box of the leaf
+        uint32_t activeCount = 0;
+    };
+
+    using ChunkCallback = std::function<void(const LeafChunk&)>;
+    using LeafFilter = std::function<bool(const LeafIndexEntry&)>;
+    using RawCallback = std::function<void(const void* data, uint64_t offset, uint64_t size)>;
+
+    /**
+     * Open a grid for streaming with the default memory cap and read-ahead
+     * @param path Path to an uncompressed .nvdb file
+     * @param gridName Name of grid to stream (empty = first grid)
+     */
+    explicit StreamingGridLoader(const std::filesystem::path& path,
+                                 const std::string& gridName = "");
+
+    /**
+     * Open a grid for streaming
+     * @param path Path to an uncompressed .nvdb file
+     * @param gridName Name of grid to stream (empty = first grid)
+     * @param config Memory cap and read-ahead
+     * @throws std::runtime_error if the file/grid is missing, compressed or not a float grid
+     */
+    StreamingGridLoader(const std::filesystem::path& path,
+                        const std::string& gridName,
+                        const Config& config);
+
+    ~StreamingGridLoader();
+
+    StreamingGridLoader(const StreamingGridLoader&) = delete;
+    StreamingGridLoader& operator=(const StreamingGridLoader&) = delete;
+
+    /**
+     * Stream every leaf of the grid in file order
+     * @param callback Invoked once per chunk; chunk memory is only valid during the call
+     */
+    void forEachChunk(const ChunkCallback& callback);
+
+    /**
+     * Stream only leaves accepted by a filter
+     *
+     * Uses the leaf index to read just the selected runs, so a sub-domain can
+     * load the region it owns without touching the rest of the file.
+     * @param filter Predicate on leaf index entries
+     * @param callback Invoked once per chunk
+     */
+    void forEachChunk(const LeafFilter& filter, const ChunkCallback& callback);
+
+    /**
+     * Stream only leaves overlapping a region
+     * @param region Index-space bounding box
+     * @param callback Invoked once per chunk
+     */
+    void forEachChunk(const nanovdb::CoordBBox& region, const ChunkCallback& callback);
+
+    /**
+     * Stream the raw grid buffer (for direct GPU upload) in budget-sized blocks
+     * @param callback Receives each block and its byte offset within the grid
+     */
+    void forEachRawBlock(const RawCallback& callback);
+
+    /**
+     * Get the per-leaf index (scans the file on first call)
+     */
+    const std::vector<LeafIndexEntry>& getLeafIndex();
+
+    /**
+     * Get number of leaf nodes in the grid
+     */
+    uint32_t getLeafCount() const { return m_leafCount; }
+
+    /**
+     * Get active voxel count recorded in the grid header
+     */
+    uint64_t getActiveVoxelCount() const { return m_activeVoxelCount; }
+
+    /**
+     * Get index-space bounding box recorded in the grid header
+     */
+    const nanovdb::CoordBBox& getIndexBBox() const { return m_indexBBox; }
+
+    /**
+     * Get total size of the grid buffer in bytes
+     */
+    uint64_t getGridSize() const { return m_gridSize; }
+
+    /**
+     * Get maximum number of leaves held in one chunk
+     */
+    uint32_t getChunkCapacity() const { return m_chunkCapacity; }
+
+private:
+    /**
+     * @brief A contiguous run of leaves to read into a chunk
+     */
+    struct ReadRange {
+        uint32_t firstLeaf = 0;
+        uint32_t count = 0;
+    };
+
+    /**
+     * @brief Work description for one chunk
+     */
+    struct ChunkPlan {
+        std::vector<ReadRange> ranges;
+        std::vector<uint32_t> leafIndices;
+    };
+
+    std::filesystem::path m_path;
+    Config m_config;
+    std::ifstream m_stream;
+
+    uint64_t m_gridOffset = 0;        // Byte offset of the grid buffer in the file
+    uint64_t m_gridSize = 0;          // Size of the grid buffer in bytes
+    uint64_t m_leafOffset = 0;        // Byte offset of the first leaf within the grid buffer
+    uint32_t m_leafCount = 0;
+    uint64_t m_activeVoxelCount = 0;
+    nanovdb::CoordBBox m_indexBBox;
+
+    uint32_t m_chunkCapacity = 0;
+    std::vector<LeafIndexEntry> m_leafIndex;
+
+    /**
+     * Locate the requested grid in the file and read its headers
+     */
+    void openGrid(const std::string& gridName);
+
+    /**
+     * Read a chunk plan into a (32-byte aligned) host buffer
+     */
+    void readChunk(const ChunkPlan& plan, nanovdb::HostBuffer& buffer);
+
+    /**
+     * Execute chunk plans with read-ahead, invoking callback in order
+     */
+    void streamChunks(const std::vector<ChunkPlan>& plans, const ChunkCallback& callback);
+};
+
+} // namespace nanovdb_adapter
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "script/SimulationEngine.hpp"
+#include "halo/HostLink.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace script {
+
+/**
+ * @brief Runs one scenario as one process per sub-domain on this node
+ *
+ * The launcher spawns the application once per rank with
+ * `--rank r --ranks n --session s --metrics file`, waits for all of them
+ * and merges the metrics files they write on exit. Ranks exchange halos
+ * over host links (shared memory rings or Unix sockets, see halo::HostLink);
+ * a crashed rank takes the run down without corrupting the others' state,
+ * and the launcher stops the survivors instead of leaving them blocked on
+ * its links.
+ */
+class RankLauncher {
+public:
+    /**
+     * @brief Launch configuration
+     */
+    struct Config {
+        uint32_t rankCount = 2;
+        std::string session;            // Empty = derived from the launcher's pid
+        std::string metricsDir;         // Empty = system temp directory
+        halo::HostLinkType link = halo::HostLinkType::SharedMemory;
+    };
+
+    /**
+     * @brief Metrics of one rank
+     */
+    struct RankMetrics {
+        uint32_t rank = 0;
+        SimulationEngine::RunMetrics metrics;
+    };
+
+    /**
+     * Spawn every rank, wait for them and log the merged metrics
+     * @param executable Application binary (usually argv[0])
+     * @param scriptPath Lua scenario run by every rank
+     * @param config Rank count and session
+     * @return 0 if every rank succeeded
+     */
+    static int launch(const std::string& executable, const std::string& scriptPath, const Config& config);
+
+    /**
+     * Write the metrics of the calling rank
+     */
+    static void writeMetrics(const std::string& path, const RankMetrics& metrics);
+
+    /**
+     * Read metrics written by writeMetrics
+     * @throws std::runtime_error if the file is missing or malformed
+     */
+    static RankMetrics readMetrics(const std::string& path);
+
+    /**
+     * Combine per-rank metrics: steps completed by every rank, the slowest
+     * rank's time, total halo traffic
+     */
+    static SimulationEngine::RunMetrics merge(const std::vector<RankMetrics>& ranks);
+};
+
+} // namespace script
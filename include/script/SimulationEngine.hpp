@@ -2,17 +2,24 @@
 
 #include "core/VulkanContext.hpp"
 #include "core/MemoryAllocator.hpp"
+#include "core/DeviceGroup.hpp"
 #include "field/FieldRegistry.hpp"
 #include "stencil/StencilRegistry.hpp"
 #include "graph/DependencyGraph.hpp"
 #include "graph/GraphExecutor.hpp"
+#include "graph/TemporalBlockTuner.hpp"
 #include "domain/DomainSplitter.hpp"
+#include "domain/LoadRebalancer.hpp"
 #include "halo/HaloManager.hpp"
+#include "halo/StagedTransfer.hpp"
 #include "nanovdb_adapter/GpuGridManager.hpp"
 
 #include <vulkan/vulkan.hpp>
 #include <memory>
+#include <deque>
 #include <string>
+#include <limits>
+#include <vector>
 #include <map>
 
 namespace script {
@@ -25,6 +32,23 @@ namespace script {
  */
 class SimulationEngine {
 public:
+    /**
+     * @brief Uniform domain box, geometry and boundary conditions
+     *
+     * Boundary strings name the condition on each face. "periodic" must be
+     * given on both faces of an axis: the grid then gets a ghost shell on
+     * that axis, refilled by the halo exchange from the opposite side.
+     */
+    struct DomainConfig {
+        uint32_t nx = 0, ny = 0, nz = 0;             // Cells per axis
+        float dx = 1.0f;                             // Cell size
+        std::string geometryType;                    // "sphere", "box" or empty
+        std::vector<float> geometryParams;
+        std::string boundaryX0, boundaryX1;          // -X, +X
+        std::string boundaryY0, boundaryY1;
+        std::string boundaryZ0, boundaryZ1;
+    };
+
     /**
      * @brief Simulation configuration
      */
@@ -32,6 +56,63 @@ public:
         uint32_t gpuCount = 1;
         std::string gridFile;           // Path to NanoVDB grid
         uint32_t haloThickness = 2;
+
+        // Out-of-core loading: stream leaves from disk instead of reading the whole grid
+        // (single domain only: halo lists are built from a host grid)
+        bool streamGrid = false;
+        uint64_t streamMemoryBudget = 256ull << 20;  // Max resident leaf bytes
+        uint32_t streamReadAhead = 1;                // Chunks prefetched in the background
+
+        // Runtime load rebalancing from measured per-domain step times
+        bool dynamicRebalance = false;
+        float loadBalanceTolerance = 0.1f;           // Rebalance when max/avg > 1 + tolerance
+
+        // Hide halo exchange behind interior compute (multi-domain runs)
+        bool overlapHaloExchange = true;
+        uint32_t maxStepsInFlight = 2;               // Steps queued before the host waits
+
+        // Edge/corner halos: direct diagonal messages, or face messages only with
+        // diagonal data relayed dimension by dimension (not combined with temporal blocking)
+        domain::HaloRouting haloRouting = domain::HaloRouting::Direct;
+
+        // Temporal blocking: exchange every k steps with k-deep halos, recomputing
+        // ghost layers in between (1 = off, 0 = auto-tune k from measured costs;
+        // needs devicePerDomain or ranks, where each domain has its own fields;
+        // ranks need a fixed k)
+        uint32_t temporalBlockSteps = 1;
+        uint32_t maxTemporalBlockSteps = 4;          // Upper bound for the auto-tuner
+
+        // Halo wire format of one field; the encoding is used only if its error
+        // bound fits the tolerance (see HaloManager::setFieldHaloEncoding)
+        struct HaloCompression {
+            halo::HaloEncoding encoding = halo::HaloEncoding::Float32;
+            float tolerance = 0.0f;                  // Largest acceptable error / maxMagnitude
+            float maxMagnitude = std::numeric_limits<float>::infinity();  // Bound on |value|; fp16 needs <= 65504
+        };
+        std::map<std::string, HaloCompression> haloCompression;  // By field name; others stay fp32
+
+        // One logical device per domain, halos staged through pinned host memory
+        // (several devices may share a GPU or lavapipe; needs a host grid)
+        bool devicePerDomain = false;
+        std::string deviceFilter;                    // Physical device name substring; empty = any
+
+        // Multi-process runs: this process runs domain 'rank' of gpuCount and exchanges
+        // halos with the other ranks over host links (see RankLauncher)
+        int32_t rank = -1;                           // -1 = every domain in this process
+        std::string rankSession;                     // Link name prefix shared by all ranks
+        halo::HostLinkType rankLink = halo::HostLinkType::SharedMemory;
+
+        DomainConfig domain;                         // Used when no grid file is given
+    };
+
+    /**
+     * @brief Per-process run statistics (merged across ranks by RankLauncher)
+     */
+    struct RunMetrics {
+        uint64_t steps = 0;
+        double seconds = 0.0;                        // Host time spent in step()
+        uint64_t haloBytesSent = 0;                  // Relayed through host staging
+        uint64_t haloBytesReceived = 0;
     };
 
     /**
@@ -55,6 +136,12 @@ public:
                  const std::string& format,
                  const std::string& initialValue = "0.0");
 
+    /**
+     * Set the domain box and boundary conditions (before the first step)
+     * @throws std::runtime_error if an axis is periodic on one face only
+     */
+    void configureDomain(const DomainConfig& config);
+
     /**
      * Add a stencil (compute kernel) to the simulation
      * @param definition Stencil definition
@@ -74,6 +161,14 @@ public:
      */
     void runFrames(uint32_t frameCount, float dt = 0.016f);
 
+    /**
+     * Run one stencil on the cells of one refinement level
+     * @param stencilName Stencil to run
+     * @param level Refinement level (0 = coarsest)
+     * @param dt Delta time
+     */
+    void dispatch(const std::string& stencilName, uint32_t level, float dt = 0.016f);
+
     /**
      * Build dependency graph from registered stencils
      * Automatically detects RAW/WAR dependencies
@@ -113,6 +208,11 @@ public:
      */
     uint32_t getGPUCount() const { return m_config.gpuCount; }
 
+    /**
+     * Statistics of the steps run so far
+     */
+    RunMetrics getRunMetrics() const;
+
     /**
      * Check if initialized successfully
      */
@@ -125,6 +225,7 @@ private:
     // Core Vulkan components
     std::unique_ptr<core::VulkanContext> m_vulkanContext;
     std::unique_ptr<core::MemoryAllocator> m_memoryAllocator;
+    std::unique_ptr<core::DeviceGroup> m_deviceGroup;    // Devices per domain only
 
     // Simulation components
     std::unique_ptr<field::FieldRegistry> m_fieldRegistry;
@@ -132,12 +233,56 @@ private:
     std::unique_ptr<graph::DependencyGraph> m_dependencyGraph;
     std::unique_ptr<graph::GraphExecutor> m_graphExecutor;
     std::unique_ptr<domain::DomainSplitter> m_domainSplitter;
+    std::unique_ptr<domain::LoadRebalancer> m_rebalancer;
+    std::unique_ptr<graph::TemporalBlockTuner> m_blockTuner;
     std::unique_ptr<halo::HaloManager> m_haloManager;
+    std::unique_ptr<halo::StagedTransfer> m_stagedTransfer;
     std::unique_ptr<nanovdb_adapter::GpuGridManager> m_gridManager;
 
+    // Fields, stencils and executor of devices 1..n-1 (devices per domain);
+    // device 0 uses the members above. Field buffers are full size on every
+    // device, each domain keeping its own voxels current.
+    struct DeviceReplica {
+        std::unique_ptr<field::FieldRegistry> fieldRegistry;
+        std::unique_ptr<stencil::StencilRegistry> stencilRegistry;
+        std::unique_ptr<graph::GraphExecutor> graphExecutor;
+    };
+    std::vector<DeviceReplica> m_replicas;
+
     // GPU grid and domains
     nanovdb_adapter::GpuGridManager::GridResources m_gridResources;
     std::vector<domain::SubDomain> m_subDomains;
+    std::vector<domain::LeafStats> m_leafStats;      // Kept for repartitioning
+    nanovdb::GridHandle<nanovdb::HostBuffer> m_hostGrid;  // Kept for halo list rebuilds (multi-GPU)
+    std::vector<nanovdb::Coord> m_fieldCoords;       // Coordinate of each field element (halo indices)
+
+    // A submitted step whose command buffers may still be executing
+    struct InFlightStep {
+        uint64_t index = 0;
+        uint32_t blockSteps = 1;                     // Temporal blocking depth it ran with
+        uint32_t slot = 0;                           // Pools it records into (see StepSlot)
+        std::vector<std::vector<vk::CommandBuffer>> commandBuffers;      // Per domain and pool
+        std::vector<std::vector<uint64_t>> sentValues;   // Per domain and neighbor: last halo value sent (rank mode)
+        std::vector<graph::GraphExecutor::TimestampQueries> timestamps;  // Per domain; empty unless timed
+    };
+
+    // Command and query pools of one in-flight step, kept for the whole run:
+    // step n records into slot n % maxStepsInFlight, whose previous step has
+    // retired by then, and the pools are reset when a step retires
+    struct StepSlot {
+        std::vector<std::vector<vk::CommandPool>> pools;  // Per domain: compute, transfer (empty if remote)
+        std::vector<vk::QueryPool> queryPools;       // Per device; created when first timing for the rebalancer or tuner
+        uint32_t queriesPerPool = 0;
+    };
+
+    // Multi-domain steps are pipelined: domains run ahead of each other as
+    // far as the halo semaphores allow, and the host only waits on the
+    // oldest step once maxStepsInFlight are queued
+    std::deque<InFlightStep> m_inFlightSteps;
+    std::vector<vk::Semaphore> m_stepSemaphores;     // Per domain (on its device), signalled with the step index
+    std::vector<StepSlot> m_stepSlots;
+    uint64_t m_stepIndex = 0;
+    RunMetrics m_metrics;
 
     /**
      * Initialize all subsystems
@@ -149,11 +294,118 @@ private:
      */
     void loadGrid();
 
+    /**
+     * Build a host grid from the domain configuration
+     */
+    nanovdb::GridHandle<nanovdb::HostBuffer> buildUniformGrid();
+
+    /**
+     * Add the periodic ghost shell to a host grid (unchanged without periodic axes)
+     */
+    nanovdb::GridHandle<nanovdb::HostBuffer> addPeriodicGhosts(
+        nanovdb::GridHandle<nanovdb::HostBuffer> grid) const;
+
     /**
      * Build domain decomposition for current grid
      */
     void decomposeDomain();
 
+    /**
+     * (Re)allocate halo messages for the registered fields, and their
+     * staging slots when domains live on separate devices
+     */
+    void allocateHaloMessages();
+
+    /**
+     * Whether this process runs a domain (always, unless running as a rank)
+     */
+    bool isLocalDomain(uint32_t gpuIndex) const {
+        return m_config.rank < 0 || gpuIndex == static_cast<uint32_t>(m_config.rank);
+    }
+
+    /**
+     * Device-specific objects of a domain (device 0 unless devices per domain)
+     */
+    core::VulkanContext& contextFor(uint32_t gpuIndex) const;
+    graph::GraphExecutor& executorFor(uint32_t gpuIndex) const;
+    const stencil::StencilRegistry& stencilsFor(uint32_t gpuIndex) const;
+    const field::FieldRegistry& fieldsFor(uint32_t gpuIndex) const;
+
+    /**
+     * Run an operation on the executors of all devices
+     */
+    template <typename Fn>
+    void forEachExecutor(Fn&& fn) {
+        if (m_graphExecutor) {
+            fn(*m_graphExecutor);
+        }
+        for (auto& replica : m_replicas) {
+            if (replica.graphExecutor) {
+                fn(*replica.graphExecutor);
+            }
+        }
+    }
+
+    /**
+     * Read back a field, taking each voxel from the device of its domain
+     */
+    std::vector<uint8_t> downloadField(const std::string& fieldName, size_t size);
+
+    /**
+     * Read back the first size bytes of a device buffer
+     */
+    std::vector<uint8_t> downloadBuffer(const core::MemoryAllocator::Buffer& buffer, size_t size);
+
+    /**
+     * Repartition and migrate leaves when measured step times are imbalanced
+     */
+    void rebalanceDomains();
+
+    /**
+     * Record and submit one timestep of all domains as split queue
+     * submissions, without waiting for it to finish
+     */
+    void stepPipelined(const std::vector<std::string>& schedule, float dt);
+
+    /**
+     * Wait for the oldest in-flight step, feed its measured per-domain
+     * compute times to the rebalancer and reset its slot's command pools
+     */
+    void retireStep();
+
+    /**
+     * Retire every in-flight step (before touching halo buffers or reading fields)
+     */
+    void drainSteps();
+
+    /**
+     * Destroy the pools of every step slot (no step may be in flight)
+     */
+    void destroyStepSlots();
+
+    /**
+     * Largest temporal blocking depth the halo lists can hold for the
+     * registered stencils (1 when domains share field buffers)
+     */
+    uint32_t blockStepLimit() const;
+
+    /**
+     * Switch temporal blocking depth: drains in-flight steps and
+     * reallocates halos at the new thickness
+     */
+    void applyBlockSteps(uint32_t blockSteps);
+
+    /**
+     * Derive per-field halo thickness from the registered stencils and
+     * re-lay out the halo messages when any thickness changed
+     */
+    void updateHaloThickness();
+
+    /**
+     * Open the configured grid file for out-of-core streaming
+     */
+    std::unique_ptr<nanovdb_adapter::StreamingGridLoader> openStreamingGrid() const;
+
     /**
      * Parse Vulkan format string to vk::Format
      */
@@ -80,7 +80,7 @@ public:
     vk::PipelineCache m_vkPipelineCache;
 
     /**
-     * Compile GLSL source to SPIR-V (stub - full implementation requires DXC)
+     * Compile GLSL source to SPIR-V (in process, see core::ShaderCompiler)
      * @param glslSource GLSL shader source
      * @param entryPoint Entry function name
      * @return SPIR-V bytecode
@@ -0,0 +1,82 @@
+#include "core/DeviceGroup.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace core {
+
+DeviceGroup::DeviceGroup(VulkanContext& primary, MemoryAllocator& primaryAllocator, const Config& config) {
+    uint32_t deviceCount = std::max(config.deviceCount, 1u);
+    LOG_INFO("Creating device group: {} logical devices", deviceCount);
+
+    // Matching physical devices, the primary's first so device 0 keeps its GPU
+    std::vector<vk::PhysicalDevice> candidates{primary.getPhysicalDevice()};
+    for (const auto& physical : primary.getInstance().enumeratePhysicalDevices()) {
+        std::string name(physical.getProperties().deviceName.data());
+        bool matches = config.deviceFilter.empty() || name.find(config.deviceFilter) != std::string::npos;
+        auto families = physical.getQueueFamilyProperties();
+        bool compute = std::any_of(families.begin(), families.end(),
+                                   [](const vk::QueueFamilyProperties& family) {
+                                       return static_cast<bool>(family.queueFlags & vk::QueueFlagBits::eCompute);
+                                   });
+        if (matches && compute && physical != candidates.front()) {
+            candidates.push_back(physical);
+        }
+    }
+
+    m_physicalIndices = assignPhysical(deviceCount, static_cast<uint32_t>(candidates.size()));
+    m_physicalCount = std::min(deviceCount, static_cast<uint32_t>(candidates.size()));
+
+    m_contexts.push_back(&primary);
+    m_allocators.push_back(&primaryAllocator);
+    for (uint32_t device = 1; device < deviceCount; ++device) {
+        auto context = std::make_unique<VulkanContext>();
+        context->initShared(primary, candidates[m_physicalIndices[device]]);
+        auto allocator = std::make_unique<MemoryAllocator>(*context);
+
+        m_contexts.push_back(context.get());
+        m_allocators.push_back(allocator.get());
+        m_ownedContexts.push_back(std::move(context));
+        m_ownedAllocators.push_back(std::move(allocator));
+    }
+
+    for (uint32_t device = 0; device < deviceCount; ++device) {
+        LOG_INFO("  Device {}: {} (physical {})", device,
+                 m_contexts[device]->getDeviceName(), m_physicalIndices[device]);
+    }
+}
+
+DeviceGroup::~DeviceGroup() {
+    // Allocators free their memory before their devices go away
+    m_ownedAllocators.clear();
+    m_ownedContexts.clear();
+    LOG_DEBUG("DeviceGroup destroyed");
+}
+
+VulkanContext& DeviceGroup::getContext(uint32_t device) const {
+    if (device >= m_contexts.size()) {
+        throw std::runtime_error("Device index out of range: " + std::to_string(device));
+    }
+    return *m_contexts[device];
+}
+
+MemoryAllocator& DeviceGroup::getAllocator(uint32_t device) const {
+    if (device >= m_allocators.size()) {
+        throw std::runtime_error("Device index out of range: " + std::to_string(device));
+    }
+    return *m_allocators[device];
+}
+
+std::vector<uint32_t> DeviceGroup::assignPhysical(uint32_t deviceCount, uint32_t candidateCount) {
+    std::vector<uint32_t> physical(deviceCount, 0);
+    if (candidateCount == 0) {
+        return physical;
+    }
+    for (uint32_t device = 0; device < deviceCount; ++device) {
+        physical[device] = device % candidateCount;
+    }
+    return physical;
+}
+
+} // namespace core
@@ -7,6 +7,8 @@
 #include "core/VulkanContext.hpp"
 #include "core/Logger.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 namespace core {
@@ -167,6 +169,52 @@ void MemoryAllocator::uploadToGPU(const Buffer& dst, const void* srcData,
     destroyBuffer(stagingBuffer);
 }
 
+void MemoryAllocator::uploadToGPU(const Buffer& dst, const void* srcData,
+                                   const std::vector<vk::BufferCopy>& regions) {
+    if (!srcData || regions.empty()) {
+        LOG_WARN("uploadToGPU called with null data or no regions");
+        return;
+    }
+
+    // Stage the span of source bytes covered by the regions
+    vk::DeviceSize stagingSize = 0;
+    for (const auto& region : regions) {
+        stagingSize = std::max(stagingSize, region.srcOffset + region.size);
+    }
+
+    LOG_DEBUG("Uploading {} regions ({} bytes) to GPU", regions.size(), stagingSize);
+
+    Buffer stagingBuffer = createBuffer(stagingSize,
+        vk::BufferUsageFlagBits::eTransferSrc,
+        VMA_MEMORY_USAGE_CPU_ONLY);
+
+    void* mappedData;
+    vmaMapMemory(m_allocator, stagingBuffer.allocation, &mappedData);
+    memcpy(mappedData, srcData, stagingSize);
+    vmaUnmapMemory(m_allocator, stagingBuffer.allocation);
+
+    try {
+        vk::CommandPool cmdPool = m_context.createCommandPool(
+            m_context.getQueues().transferFamily,
+            vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+        vk::CommandBuffer cmd = m_context.beginSingleTimeCommands(cmdPool);
+
+        cmd.copyBuffer(stagingBuffer.handle, dst.handle,
+                       static_cast<uint32_t>(regions.size()), regions.data());
+
+        m_context.endSingleTimeCommands(cmd, cmdPool, m_context.getQueues().transfer);
+
+        m_context.getDevice().destroyCommandPool(cmdPool);
+
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to upload regions to GPU: {}", e.what());
+        destroyBuffer(stagingBuffer);
+        throw;
+    }
+
+    destroyBuffer(stagingBuffer);
+}
+
 vk::DeviceAddress MemoryAllocator::getBufferAddress(const Buffer& buffer) {
     vk::BufferDeviceAddressInfo addressInfo;
     addressInfo.setBuffer(buffer.handle);
@@ -202,4 +250,18 @@ void MemoryAllocator::unmapBuffer(const Buffer& buffer) {
     LOG_DEBUG("Unmapped buffer of size {} bytes", buffer.size);
 }
 
+void MemoryAllocator::flushBuffer(const Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size) {
+    if (!buffer.allocation) {
+        return;
+    }
+    vmaFlushAllocation(m_allocator, buffer.allocation, offset, size);
+}
+
+void MemoryAllocator::invalidateBuffer(const Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size) {
+    if (!buffer.allocation) {
+        return;
+    }
+    vmaInvalidateAllocation(m_allocator, buffer.allocation, offset, size);
+}
+
 } // namespace core
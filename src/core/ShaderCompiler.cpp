@@ -0,0 +1,74 @@
+#include "core/ShaderCompiler.hpp"
+#include "core/Logger.hpp"
+
+#include <shaderc/shaderc.hpp>
+#include <stdexcept>
+
+namespace core {
+
+namespace {
+
+// Compilers hold no per-compilation state, so one serves every thread
+const shaderc::Compiler& sharedCompiler() {
+    static const shaderc::Compiler compiler;
+    return compiler;
+}
+
+shaderc_shader_kind toShaderKind(vk::ShaderStageFlagBits stage) {
+    switch (stage) {
+    case vk::ShaderStageFlagBits::eCompute:
+        return shaderc_compute_shader;
+    case vk::ShaderStageFlagBits::eVertex:
+        return shaderc_vertex_shader;
+    case vk::ShaderStageFlagBits::eFragment:
+        return shaderc_fragment_shader;
+    default:
+        throw std::runtime_error("Unsupported shader stage: " + vk::to_string(stage));
+    }
+}
+
+} // namespace
+
+ShaderCompiler::Result ShaderCompiler::compile(const std::string& source,
+                                               vk::ShaderStageFlagBits stage,
+                                               const std::string& name,
+                                               const std::string& entryPoint) {
+    const shaderc::Compiler& compiler = sharedCompiler();
+    LOG_CHECK(compiler.IsValid(), "Failed to initialize the shader compiler");
+
+    // Options are not shared: each call configures its own
+    shaderc::CompileOptions options;
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+    options.SetOptimizationLevel(shaderc_optimization_level_performance);
+
+    shaderc::SpvCompilationResult compiled = compiler.CompileGlslToSpv(
+        source.data(), source.size(), toShaderKind(stage), name.c_str(), entryPoint.c_str(), options);
+
+    Result result;
+    result.diagnostics = compiled.GetErrorMessage();
+    result.warningCount = static_cast<uint32_t>(compiled.GetNumWarnings());
+    result.errorCount = static_cast<uint32_t>(compiled.GetNumErrors());
+    if (compiled.GetCompilationStatus() == shaderc_compilation_status_success) {
+        result.spirv.assign(compiled.cbegin(), compiled.cend());
+    }
+    return result;
+}
+
+std::vector<uint32_t> ShaderCompiler::compileOrThrow(const std::string& source,
+                                                     vk::ShaderStageFlagBits stage,
+                                                     const std::string& name,
+                                                     const std::string& entryPoint) {
+    Result result = compile(source, stage, name, entryPoint);
+    if (!result.succeeded()) {
+        LOG_ERROR("Shader '{}' failed to compile:\n{}", name, result.diagnostics);
+        throw std::runtime_error("Shader '" + name + "' failed to compile: " + result.diagnostics);
+    }
+    if (result.warningCount > 0) {
+        LOG_WARN("Shader '{}' compiled with {} warnings:\n{}", name, result.warningCount, result.diagnostics);
+    }
+
+    LOG_DEBUG("Shader '{}' compiled ({} bytes)", name, result.spirv.size() * sizeof(uint32_t));
+    return std::move(result.spirv);
+}
+
+} // namespace core
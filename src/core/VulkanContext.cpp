@@ -14,7 +14,7 @@ VulkanContext::~VulkanContext() {
     cleanup();
 }
 
-void VulkanContext::init(bool enableValidation) {
+void VulkanContext::init(bool enableValidation, const std::string& deviceFilter) {
     if (m_initialized) {
         LOG_WARN("VulkanContext already initialized");
         return;
@@ -122,103 +122,31 @@ void VulkanContext::init(bool enableValidation) {
         // Wrap in C++ type
         m_physicalDevice = vk::PhysicalDevice(m_vkbPhysicalDevice.physical_device);
 
+        // An explicit name filter overrides the discrete-GPU preference
+        if (!deviceFilter.empty()) {
+            bool matched = false;
+            for (const auto& candidate : m_instance.enumeratePhysicalDevices()) {
+                std::string name(candidate.getProperties().deviceName.data());
+                if (name.find(deviceFilter) != std::string::npos) {
+                    m_physicalDevice = candidate;
+                    matched = true;
+                    break;
+                }
+            }
+            LOG_CHECK(matched, "No physical device matches filter '" + deviceFilter + "'");
+        }
+
         vk::PhysicalDeviceProperties props = m_physicalDevice.getProperties();
         LOG_INFO("Selected physical device: {} (type: {})",
                  std::string(props.deviceName.data()),
                  vk::to_string(props.deviceType));
 
         // Step 5: Create logical device with required features
-        LOG_INFO("Creating logical device...");
-
-        // Vulkan 1.2 features
-        vk::PhysicalDeviceVulkan12Features features12;
-        features12.setBufferDeviceAddress(VK_TRUE);
-        features12.setDescriptorIndexing(VK_TRUE);
-        features12.setShaderStorageBufferArrayNonUniformIndexing(VK_TRUE);
-        features12.setRuntimeDescriptorArray(VK_TRUE);
-        features12.setDescriptorBindingVariableDescriptorCount(VK_TRUE);
-
-        // Vulkan 1.3 features
-        vk::PhysicalDeviceVulkan13Features features13;
-        features13.setSynchronization2(VK_TRUE);
-        features13.setDynamicRendering(VK_TRUE);
-
-        features12.setPNext(&features13);
-
-        vk::PhysicalDeviceFeatures2 features2;
-        features2.setPNext(&features12);
-        features2.features.setShaderInt64(VK_TRUE);
-        features2.features.setFragmentStoresAndAtomics(VK_TRUE);
-
-        // Queue info
-        // Find compute queue family
-        auto queueFamilies = m_physicalDevice.getQueueFamilyProperties();
-        uint32_t computeFamily = -1;
-        for (uint32_t i = 0; i < queueFamilies.size(); i++) {
-            if (queueFamilies[i].queueFlags & vk::QueueFlagBits::eCompute) {
-                computeFamily = i;
-                break;
-            }
-        }
-        
-        if (computeFamily == -1) {
-            throw std::runtime_error("Failed to find compute queue family");
-        }
+        createLogicalDevice();
 
-        m_queues.computeFamily = computeFamily;
-        m_queues.transferFamily = computeFamily; // Use same for simplicity
-
-        float queuePriority = 1.0f;
-        vk::DeviceQueueCreateInfo queueCreateInfo;
-        queueCreateInfo.setQueueFamilyIndex(computeFamily);
-        queueCreateInfo.setQueueCount(1);
-        queueCreateInfo.setPQueuePriorities(&queuePriority);
-
-        // Extensions - only add what's actually needed for compute
-        std::vector<const char*> extensions;
-        
-        #ifdef __APPLE__
-        // On macOS with MoltenVK, we need portability subset
-        extensions.push_back("VK_KHR_portability_subset");
-        LOG_INFO("Added VK_KHR_portability_subset for macOS/MoltenVK");
-        #endif
-        
-        // Only add swapchain if we're doing graphics (not for compute-only tests)
-        // Note: Commenting out swapchain for compute-only tests
-        // extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
-
-        vk::DeviceCreateInfo createInfo;
-        createInfo.setPNext(&features2);
-        createInfo.setQueueCreateInfoCount(1);
-        createInfo.setPQueueCreateInfos(&queueCreateInfo);
-        createInfo.setEnabledExtensionCount(static_cast<uint32_t>(extensions.size()));
-        createInfo.setPpEnabledExtensionNames(extensions.data());
-
-        // Try to create device with better error handling
-        try {
-            m_device = m_physicalDevice.createDevice(createInfo);
-        } catch (const vk::SystemError& e) {
-            LOG_ERROR("Vulkan device creation failed: {}", e.what());
-            
-            // Try with minimal features as fallback
-            LOG_WARN("Attempting device creation with minimal features...");
-            vk::PhysicalDeviceFeatures2 minimalFeatures2{};
-            vk::PhysicalDeviceVulkan12Features minimalFeatures12{};
-            minimalFeatures12.setBufferDeviceAddress(VK_TRUE);
-            minimalFeatures12.setPNext(nullptr);
-            minimalFeatures2.setPNext(&minimalFeatures12);
-            
-            createInfo.setPNext(&minimalFeatures2);
-            m_device = m_physicalDevice.createDevice(createInfo);
-        }
-        
         // Initialize volk for device
         volkLoadDevice(m_device);
 
-        // Get queue
-        m_queues.compute = m_device.getQueue(computeFamily, 0);
-        m_queues.transfer = m_queues.compute;
-        
         m_initialized = true;
         LOG_INFO("Logical device created successfully");
 
@@ -232,6 +160,122 @@ void VulkanContext::init(bool enableValidation) {
     }
 }
 
+void VulkanContext::createLogicalDevice() {
+    LOG_INFO("Creating logical device...");
+
+    // Vulkan 1.2 features
+    vk::PhysicalDeviceVulkan12Features features12;
+    features12.setBufferDeviceAddress(VK_TRUE);
+    features12.setDescriptorIndexing(VK_TRUE);
+    features12.setShaderStorageBufferArrayNonUniformIndexing(VK_TRUE);
+    features12.setRuntimeDescriptorArray(VK_TRUE);
+    features12.setDescriptorBindingVariableDescriptorCount(VK_TRUE);
+
+    // Vulkan 1.3 features
+    vk::PhysicalDeviceVulkan13Features features13;
+    features13.setSynchronization2(VK_TRUE);
+    features13.setDynamicRendering(VK_TRUE);
+
+    features12.setPNext(&features13);
+
+    vk::PhysicalDeviceFeatures2 features2;
+    features2.setPNext(&features12);
+    features2.features.setShaderInt64(VK_TRUE);
+    features2.features.setFragmentStoresAndAtomics(VK_TRUE);
+
+    // Queue info
+    // Find compute queue family
+    auto queueFamilies = m_physicalDevice.getQueueFamilyProperties();
+    uint32_t computeFamily = -1;
+    for (uint32_t i = 0; i < queueFamilies.size(); i++) {
+        if (queueFamilies[i].queueFlags & vk::QueueFlagBits::eCompute) {
+            computeFamily = i;
+            break;
+        }
+    }
+    
+    if (computeFamily == -1) {
+        throw std::runtime_error("Failed to find compute queue family");
+    }
+
+    m_queues.computeFamily = computeFamily;
+    m_queues.transferFamily = computeFamily; // Use same for simplicity
+
+    float queuePriority = 1.0f;
+    vk::DeviceQueueCreateInfo queueCreateInfo;
+    queueCreateInfo.setQueueFamilyIndex(computeFamily);
+    queueCreateInfo.setQueueCount(1);
+    queueCreateInfo.setPQueuePriorities(&queuePriority);
+
+    // Extensions - only add what's actually needed for compute
+    std::vector<const char*> extensions;
+    
+    #ifdef __APPLE__
+    // On macOS with MoltenVK, we need portability subset
+    extensions.push_back("VK_KHR_portability_subset");
+    LOG_INFO("Added VK_KHR_portability_subset for macOS/MoltenVK");
+    #endif
+    
+    // Only add swapchain if we're doing graphics (not for compute-only tests)
+    // Note: Commenting out swapchain for compute-only tests
+    // extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+    vk::DeviceCreateInfo createInfo;
+    createInfo.setPNext(&features2);
+    createInfo.setQueueCreateInfoCount(1);
+    createInfo.setPQueueCreateInfos(&queueCreateInfo);
+    createInfo.setEnabledExtensionCount(static_cast<uint32_t>(extensions.size()));
+    createInfo.setPpEnabledExtensionNames(extensions.data());
+
+    // Try to create device with better error handling
+    try {
+        m_device = m_physicalDevice.createDevice(createInfo);
+    } catch (const vk::SystemError& e) {
+        LOG_ERROR("Vulkan device creation failed: {}", e.what());
+        
+        // Try with minimal features as fallback
+        LOG_WARN("Attempting device creation with minimal features...");
+        vk::PhysicalDeviceFeatures2 minimalFeatures2{};
+        vk::PhysicalDeviceVulkan12Features minimalFeatures12{};
+        minimalFeatures12.setBufferDeviceAddress(VK_TRUE);
+        minimalFeatures12.setPNext(nullptr);
+        minimalFeatures2.setPNext(&minimalFeatures12);
+        
+        createInfo.setPNext(&minimalFeatures2);
+        m_device = m_physicalDevice.createDevice(createInfo);
+    }
+
+    // Get queue
+    m_queues.compute = m_device.getQueue(computeFamily, 0);
+    m_queues.transfer = m_queues.compute;
+}
+
+void VulkanContext::initShared(const VulkanContext& primary, vk::PhysicalDevice physicalDevice) {
+    if (m_initialized) {
+        LOG_WARN("VulkanContext already initialized");
+        return;
+    }
+    LOG_CHECK(primary.m_initialized, "Primary VulkanContext not initialized");
+
+    m_instance = primary.m_instance;
+    m_ownsInstance = false;
+    m_physicalDevice = physicalDevice;
+
+    try {
+        createLogicalDevice();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to create shared logical device: {}", e.what());
+        throw;
+    }
+
+    // volkLoadDevice bound the global entry points to the primary device;
+    // loading them through the instance yields trampolines valid for all devices
+    volkLoadInstance(static_cast<VkInstance>(m_instance));
+
+    m_initialized = true;
+    LOG_INFO("Additional logical device created on {}", getDeviceName());
+}
+
 void VulkanContext::cleanup() {
     if (!m_initialized) {
         return;
@@ -251,7 +295,10 @@ void VulkanContext::cleanup() {
         m_device = nullptr;
     }
 
-    // Destroy instance and debug messenger
+    // Destroy instance and debug messenger (shared contexts borrow the primary's)
+    if (m_instance && !m_ownsInstance) {
+        m_instance = nullptr;
+    }
     if (m_instance) {
         try {
             m_instance.destroy();
@@ -339,4 +386,11 @@ bool VulkanContext::isFeatureSupported(const std::string& featureName) const {
     return false;
 }
 
+std::string VulkanContext::getDeviceName() const {
+    if (!m_physicalDevice) {
+        return "";
+    }
+    return std::string(m_physicalDevice.getProperties().deviceName.data());
+}
+
 } // namespace core
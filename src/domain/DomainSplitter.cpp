@@ -1,15 +1,91 @@
 #include "domain/DomainSplitter.hpp"
+#include "domain/GraphPartitioner.hpp"
 #include "core/Logger.hpp"
 
 #include <nanovdb/tools/GridBuilder.h>
 #include <nanovdb/tools/CreateNanoGrid.h>
 #include <nanovdb/NodeManager.h>
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
+#include <cstring>
+#include <future>
+#include <map>
 #include <numeric>
+#include <thread>
+#include <unordered_map>
 
 namespace domain {
 
+namespace {
+
+/**
+ * @brief Table-driven 3D Hilbert curve state machine
+ *
+ * Built at compile time from Hamilton's formulation ("Compact Hilbert
+ * Indices", 2006): a curve orientation is an (entry corner, direction) pair,
+ * giving 24 states. Each entry packs the octant's curve index (high 3 bits)
+ * and the successor state (low 5 bits).
+ */
+struct HilbertTable {
+    std::array<std::array<uint8_t, 8>, 24> entries{};
+};
+
+constexpr uint32_t rotateRight3(uint32_t bits, uint32_t r) {
+    r %= 3;
+    return ((bits >> r) | (bits << (3 - r))) & 7u;
+}
+
+constexpr uint32_t rotateLeft3(uint32_t bits, uint32_t r) {
+    r %= 3;
+    return ((bits << r) | (bits >> (3 - r))) & 7u;
+}
+
+constexpr uint32_t grayCode(uint32_t i) { return i ^ (i >> 1); }
+
+constexpr uint32_t grayCodeInverse(uint32_t g) { return g ^ (g >> 1) ^ (g >> 2); }
+
+constexpr uint32_t trailingOnes(uint32_t i) {
+    uint32_t n = 0;
+    while (i & 1u) {
+        ++n;
+        i >>= 1;
+    }
+    return n;
+}
+
+// Entry corner of sub-cube w
+constexpr uint32_t entryCorner(uint32_t w) {
+    return w == 0 ? 0 : grayCode(2 * ((w - 1) / 2));
+}
+
+// Axis along which sub-cube w is traversed
+constexpr uint32_t intraDirection(uint32_t w) {
+    if (w == 0) return 0;
+    return ((w & 1u) ? trailingOnes(w) : trailingOnes(w - 1)) % 3;
+}
+
+constexpr HilbertTable buildHilbertTable() {
+    HilbertTable table{};
+    for (uint32_t e = 0; e < 8; ++e) {
+        for (uint32_t d = 0; d < 3; ++d) {
+            for (uint32_t octant = 0; octant < 8; ++octant) {
+                uint32_t w = grayCodeInverse(rotateRight3(octant ^ e, d + 1));
+                uint32_t nextEntry = e ^ rotateLeft3(entryCorner(w), d + 1);
+                uint32_t nextDir = (d + intraDirection(w) + 1) % 3;
+                table.entries[e * 3 + d][octant] =
+                    static_cast<uint8_t>((w << 5) | (nextEntry * 3 + nextDir));
+            }
+        }
+    }
+    return table;
+}
+
+constexpr HilbertTable kHilbertTable = buildHilbertTable();
+
+} // namespace
+
 uint64_t DomainSplitter::getMortonCode(const nanovdb::Coord& coord) {
     // Compute bit-interleaved Morton code for 3D coordinates
     auto expandBits = [](uint32_t v) -> uint64_t {
@@ -28,6 +104,50 @@ uint64_t DomainSplitter::getMortonCode(const nanovdb::Coord& coord) {
     return expandBits(x) | (expandBits(y) << 1) | (expandBits(z) << 2);
 }
 
+uint64_t DomainSplitter::getHilbertCode(const nanovdb::Coord& coord, uint32_t order) {
+    order = std::min(order, 21u);
+
+    uint64_t index = 0;
+    uint32_t state = 0;
+    for (int32_t bit = static_cast<int32_t>(order) - 1; bit >= 0; --bit) {
+        uint32_t octant = ((coord[0] >> bit) & 1) |
+                          (((coord[1] >> bit) & 1) << 1) |
+                          (((coord[2] >> bit) & 1) << 2);
+        uint8_t entry = kHilbertTable.entries[state][octant];
+        index = (index << 3) | (entry >> 5);
+        state = entry & 31u;
+    }
+    return index;
+}
+
+uint64_t DomainSplitter::getLeafKey(const nanovdb::Coord& coord) {
+    // 21 bits per axis of the leaf index (coordinate >> 3)
+    auto axisBits = [](int32_t v) { return static_cast<uint64_t>(v >> 3) & 0x1FFFFF; };
+    return axisBits(coord[0]) | (axisBits(coord[1]) << 21) | (axisBits(coord[2]) << 42);
+}
+
+LeafStats DomainSplitter::computeLeafStats(const nanovdb::NanoLeaf<float>& leaf) {
+    LeafStats stats;
+    stats.origin = leaf.origin();
+    stats.bbox = leaf.bbox();
+    stats.activeCount = leaf.valueMask().countOn();
+
+    // Face occupancy drives the graph partitioner's edge weights. Mask word x
+    // holds the x-slice, bit y * 8 + z a voxel of it, so faces are popcounts
+    const uint64_t* words = leaf.valueMask().words();
+    stats.faceCounts[0] = static_cast<uint16_t>(std::popcount(words[0]));
+    stats.faceCounts[1] = static_cast<uint16_t>(std::popcount(words[7]));
+    constexpr uint64_t kRowY0 = 0xFFull;                     // y = 0
+    constexpr uint64_t kColumnZ0 = 0x0101010101010101ull;    // z = 0
+    for (int x = 0; x < 8; ++x) {
+        stats.faceCounts[2] += static_cast<uint16_t>(std::popcount(words[x] & kRowY0));
+        stats.faceCounts[3] += static_cast<uint16_t>(std::popcount(words[x] & (kRowY0 << 56)));
+        stats.faceCounts[4] += static_cast<uint16_t>(std::popcount(words[x] & kColumnZ0));
+        stats.faceCounts[5] += static_cast<uint16_t>(std::popcount(words[x] & (kColumnZ0 << 7)));
+    }
+    return stats;
+}
+
 DomainSplitter::DomainSplitter()
     : m_config() {
     LOG_DEBUG("DomainSplitter initialized with default config ({} GPUs)", m_config.gpuCount);
@@ -42,132 +162,316 @@ std::vector<SubDomain> DomainSplitter::split(
     const nanovdb::GridHandle<nanovdb::HostBuffer>& grid) {
     LOG_INFO("Starting domain split for {} GPUs", m_config.gpuCount);
 
-    auto* hostGrid = grid.grid<float>();
-    LOG_CHECK(hostGrid != nullptr, "Host grid is null");
+    // One pass over the leaves: active counts come from mask popcounts, so
+    // voxels never need to be revisited when domains are closed
+    std::vector<LeafStats> leafStats = collectLeafStats(grid);
+    LOG_CHECK(!leafStats.empty(), "Grid has no leaf nodes");
 
-    // Single GPU case
-    if (m_config.gpuCount == 1) {
-        SubDomain domain;
-        domain.gpuIndex = 0;
-        domain.bounds = hostGrid->indexBBox();
-
-        // Collect all leaf nodes
-        auto mgrHandle = nanovdb::createNodeManager(*hostGrid);
-        auto* mgr = mgrHandle.mgr<float>();
-        
-        if (mgr) {
-            for (uint32_t i = 0; i < mgr->leafCount(); ++i) {
-                domain.assignedLeaves.push_back(mgr->leaf(i).bbox());
-            }
-        }
+    auto domains = split(leafStats);
+    buildHaloLists(grid, domains);
+    return domains;
+}
 
-        domain.activeVoxelCount = hostGrid->activeVoxelCount();
+std::vector<LeafStats> DomainSplitter::collectLeafStats(
+    const nanovdb::GridHandle<nanovdb::HostBuffer>& grid) {
+    auto* hostGrid = grid.grid<float>();
+    LOG_CHECK(hostGrid != nullptr, "Host grid is null");
 
-        LOG_INFO("Single GPU domain: {} active voxels", domain.activeVoxelCount);
-        return {domain};
-    }
+    std::vector<LeafStats> leafStats;
 
-    // Multi-GPU case: collect and sort leaf nodes
-    std::vector<std::pair<nanovdb::CoordBBox, uint64_t>> leafBoxesWithMorton;
-    
     auto mgrHandle = nanovdb::createNodeManager(*hostGrid);
     auto* mgr = mgrHandle.mgr<float>();
 
-    LOG_DEBUG("Collecting leaf nodes...");
+    LOG_DEBUG("Collecting leaf statistics...");
     if (mgr) {
+        leafStats.reserve(mgr->leafCount());
         for (uint32_t i = 0; i < mgr->leafCount(); ++i) {
-            nanovdb::CoordBBox leafBox = mgr->leaf(i).bbox();
-            uint64_t mortonCode = getMortonCode(leafBox.min());
-            leafBoxesWithMorton.push_back({leafBox, mortonCode});
+            leafStats.push_back(computeLeafStats(mgr->leaf(i)));
         }
     }
 
-    // Sort by Morton code for spatial locality
-    LOG_DEBUG("Sorting {} leaf nodes by Morton code", leafBoxesWithMorton.size());
-    std::sort(leafBoxesWithMorton.begin(), leafBoxesWithMorton.end(),
-        [](const auto& a, const auto& b) { return a.second < b.second; });
+    return leafStats;
+}
 
-    // Count total active voxels
-    uint64_t totalVoxels = hostGrid->activeVoxelCount();
+std::vector<uint32_t> DomainSplitter::orderLeaves(const std::vector<LeafStats>& leaves) const {
+    std::vector<uint32_t> order(leaves.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    if (m_config.strategy == SplitStrategy::Hilbert) {
+        // Hilbert indices need non-negative coordinates: use leaf-grid cells
+        // relative to the lowest leaf origin
+        nanovdb::Coord minOrigin = leaves.front().origin;
+        nanovdb::Coord maxOrigin = leaves.front().origin;
+        for (const auto& leaf : leaves) {
+            minOrigin.minComponent(leaf.origin);
+            maxOrigin.maxComponent(leaf.origin);
+        }
+
+        uint32_t extent = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            extent = std::max(extent, static_cast<uint32_t>((maxOrigin[axis] - minOrigin[axis]) >> 3));
+        }
+        uint32_t bits = 1;
+        while (bits < 21 && (extent >> bits) != 0) {
+            ++bits;
+        }
+
+        std::vector<uint64_t> keys(leaves.size());
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            nanovdb::Coord cell = (leaves[i].origin - minOrigin) >> 3;
+            keys[i] = getHilbertCode(cell, bits);
+        }
+        std::sort(order.begin(), order.end(),
+                  [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    } else {
+        std::vector<uint64_t> keys(leaves.size());
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            keys[i] = getMortonCode(leaves[i].origin);
+        }
+        std::sort(order.begin(), order.end(),
+                  [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    }
+
+    return order;
+}
+
+std::vector<SubDomain> DomainSplitter::split(const std::vector<LeafStats>& leaves) {
+    LOG_INFO("Starting domain split of {} leaves for {} GPUs", leaves.size(), m_config.gpuCount);
+    LOG_CHECK(!leaves.empty(), "No leaves to split");
+
+    uint64_t totalVoxels = 0;
+    for (const auto& leaf : leaves) {
+        totalVoxels += leaf.activeCount;
+    }
     LOG_INFO("Total active voxels: {}", totalVoxels);
 
-    // Load balancing: partition leaves to balance voxel distribution
-    uint64_t targetPerGPU = totalVoxels / m_config.gpuCount;
-    std::vector<SubDomain> domains(m_config.gpuCount);
+    LOG_CHECK(m_config.deviceThroughput.empty() ||
+              m_config.deviceThroughput.size() == m_config.gpuCount,
+              "deviceThroughput must have one entry per GPU");
 
-    uint64_t currentCount = 0;
-    uint32_t currentGpu = 0;
-    nanovdb::CoordBBox currentBounds;
-    bool boundsInitialized = false;
+    // Evaluate the cost model once per leaf
+    std::vector<double> costs(leaves.size());
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        costs[i] = leafCost(leaves[i]);
+    }
 
-    LOG_DEBUG("Target voxels per GPU: {}", targetPerGPU);
+    // Assign every leaf to a domain
+    std::vector<uint32_t> owner;
+    if (m_config.gpuCount > 1 && m_config.strategy == SplitStrategy::Bisection) {
+        owner = partitionBisection(leaves, costs);
+    } else if (m_config.gpuCount > 1 && m_config.strategy == SplitStrategy::Graph) {
+        owner = partitionGraph(leaves, costs);
+    } else {
+        owner = partitionCurve(leaves, costs);
+    }
 
-    for (const auto& [leafBox, mortonCode] : leafBoxesWithMorton) {
-        if (!boundsInitialized) {
-            currentBounds = leafBox;
-            boundsInitialized = true;
-        } else {
-            currentBounds.expand(leafBox);
-        }
-
-        domains[currentGpu].assignedLeaves.push_back(leafBox);
-        currentCount += leafBox.volume();
-
-        // Check if we should move to next GPU
-        bool isLastLeaf = (&leafBox == &leafBoxesWithMorton.back().first);
-        if ((currentCount >= targetPerGPU && currentGpu < m_config.gpuCount - 1) ||
-            isLastLeaf) {
-            // Finalize current domain
-            domains[currentGpu].gpuIndex = currentGpu;
-            domains[currentGpu].bounds = currentBounds;
-
-            // Count active voxels in this domain
-            uint32_t domainVoxels = 0;
-            // Re-iterate to count voxels in this domain (approximate or exact?)
-            // Exact count requires iterating voxels.
-            // Using NodeManager again is efficient.
-            if (mgr) {
-                 for (uint32_t i = 0; i < mgr->leafCount(); ++i) {
-                    const auto& leaf = mgr->leaf(i);
-                    if (currentBounds.isInside(leaf.bbox().min())) { // Approximate check using leaf origin/bbox
-                         // Better: check intersection
-                         if (currentBounds.hasOverlap(leaf.bbox())) {
-                             for (auto it = leaf.valueMask().beginOn(); it; ++it) {
-                                 if (currentBounds.isInside(leaf.offsetToGlobalCoord(*it))) {
-                                     domainVoxels++;
-                                 }
-                             }
-                         }
-                    }
-                }
-            }
-            domains[currentGpu].activeVoxelCount = domainVoxels;
+    std::vector<SubDomain> domains = assembleDomains(leaves, costs, owner);
+
+    computeNeighbors(domains);
+
+    LoadBalanceStats stats = analyzeBalance(domains);
+    LOG_INFO("Load balance: min={}, max={}, avg={:.1f}, imbalance={:.2f}x",
+             stats.minVoxels, stats.maxVoxels, stats.averageVoxels, stats.imbalanceFactor);
+    LOG_INFO("Communication: halo voxels total={}, max={}, surface/volume avg={:.3f}, max={:.3f}",
+             stats.totalHaloVoxels, stats.maxHaloVoxels,
+             stats.averageSurfaceToVolume, stats.maxSurfaceToVolume);
+    LOG_INFO("Predicted time: max={:.1f}, imbalance={:.2f}x",
+             stats.maxPredictedTime, stats.predictedImbalance);
 
-            LOG_DEBUG("Domain {}: {} leaves, {} voxels",
-                     currentGpu, domains[currentGpu].assignedLeaves.size(), domainVoxels);
+    return domains;
+}
+
+double DomainSplitter::leafCost(const LeafStats& leaf) const {
+    return m_config.leafCost ? m_config.leafCost(leaf) : static_cast<double>(leaf.activeCount);
+}
+
+double DomainSplitter::deviceThroughput(uint32_t device) const {
+    return device < m_config.deviceThroughput.size() ? m_config.deviceThroughput[device] : 1.0;
+}
+
+double DomainSplitter::throughputSum(uint32_t first, uint32_t count) const {
+    double sum = 0.0;
+    for (uint32_t device = first; device < first + count; ++device) {
+        sum += deviceThroughput(device);
+    }
+    return sum;
+}
+
+std::vector<uint32_t> DomainSplitter::partitionCurve(const std::vector<LeafStats>& leaves,
+                                                     const std::vector<double>& costs) const {
+    std::vector<uint32_t> owner(leaves.size(), 0);
+    if (m_config.gpuCount <= 1) {
+        return owner;
+    }
+
+    // Cut the curve where the running cost crosses each device's cumulative
+    // share of the total: prefix sums + binary search, O(leaves log leaves)
+    std::vector<uint32_t> order = orderLeaves(leaves);
+
+    std::vector<double> prefix(order.size());
+    double running = 0.0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        running += costs[order[i]];
+        prefix[i] = running;
+    }
+
+    const double totalCost = running;
+    const double totalThroughput = throughputSum(0, m_config.gpuCount);
+    double shareBefore = 0.0;
+
+    size_t begin = 0;
+    for (uint32_t part = 0; part < m_config.gpuCount; ++part) {
+        size_t end = order.size();
+        shareBefore += deviceThroughput(part);
+        if (part + 1 < m_config.gpuCount) {
+            // First leaf at which this part's cumulative share is reached
+            // (small relative slack absorbs rounding in the running sums)
+            double target = totalCost * shareBefore / totalThroughput * (1.0 - 1e-12);
+            auto it = std::lower_bound(prefix.begin() + begin, prefix.end(), target);
+            end = std::min<size_t>(static_cast<size_t>(it - prefix.begin()) + 1, order.size());
+        }
+
+        for (size_t i = begin; i < end; ++i) {
+            owner[order[i]] = part;
+        }
+        begin = end;
+    }
+
+    return owner;
+}
+
+std::vector<uint32_t> DomainSplitter::partitionBisection(const std::vector<LeafStats>& leaves,
+                                                         const std::vector<double>& costs) const {
+    std::vector<uint32_t> owner(leaves.size(), 0);
+    std::vector<uint32_t> indices(leaves.size());
+    std::iota(indices.begin(), indices.end(), 0);
+
+    bisect(leaves, costs, indices, 0, m_config.gpuCount, owner);
+    return owner;
+}
+
+std::vector<uint32_t> DomainSplitter::partitionGraph(const std::vector<LeafStats>& leaves,
+                                                     const std::vector<double>& costs) const {
+    GraphPartitioner::Config config;
+    config.tolerance = m_config.loadBalanceTolerance;
+    GraphPartitioner partitioner(config);
+
+    GraphPartitioner::Graph graph = GraphPartitioner::buildLeafGraph(leaves, costs);
+
+    std::vector<double> partWeights(m_config.gpuCount);
+    for (uint32_t device = 0; device < m_config.gpuCount; ++device) {
+        partWeights[device] = deviceThroughput(device);
+    }
+
+    std::vector<uint32_t> owner = partitioner.partition(graph, partWeights);
+    LOG_INFO("Graph partition edge cut: {:.0f} face voxels", GraphPartitioner::edgeCut(graph, owner));
+    return owner;
+}
+
+void DomainSplitter::bisect(const std::vector<LeafStats>& leaves,
+                            const std::vector<double>& costs,
+                            std::vector<uint32_t>& indices,
+                            uint32_t firstPart, uint32_t partCount,
+                            std::vector<uint32_t>& owner) const {
+    if (partCount <= 1 || indices.size() <= 1) {
+        for (uint32_t leaf : indices) {
+            owner[leaf] = firstPart;
+        }
+        return;
+    }
+
+    // Extent of leaf origins, to rank axes from longest to shortest
+    nanovdb::Coord minOrigin = leaves[indices.front()].origin;
+    nanovdb::Coord maxOrigin = minOrigin;
+    double totalWeight = 0.0;
+    for (uint32_t leaf : indices) {
+        minOrigin.minComponent(leaves[leaf].origin);
+        maxOrigin.maxComponent(leaves[leaf].origin);
+        totalWeight += costs[leaf];
+    }
+
+    std::array<int, 3> axes = {0, 1, 2};
+    std::sort(axes.begin(), axes.end(), [&](int a, int b) {
+        return (maxOrigin[a] - minOrigin[a]) > (maxOrigin[b] - minOrigin[b]);
+    });
 
-            if (!isLastLeaf) {
-                // Reset for next GPU
-                currentCount = 0;
-                currentGpu++;
-                boundsInitialized = false;
+    // Non-power-of-two counts: the lower half gets floor(k/2) parts and a
+    // share of the weight proportional to those devices' throughput
+    uint32_t lowerParts = partCount / 2;
+    double target = totalWeight * throughputSum(firstPart, lowerParts) /
+                    throughputSum(firstPart, partCount);
+
+    for (int axis : axes) {
+        if (maxOrigin[axis] == minOrigin[axis]) {
+            break;  // All remaining axes are flat
+        }
+
+        std::sort(indices.begin(), indices.end(), [&](uint32_t a, uint32_t b) {
+            return leaves[a].origin[axis] < leaves[b].origin[axis];
+        });
+
+        // Weighted median, cutting only between distinct leaf planes so the
+        // halves stay disjoint axis-aligned boxes
+        size_t bestCut = 0;
+        double bestError = 0.0;
+        double prefix = 0.0;
+        for (size_t i = 0; i + 1 < indices.size(); ++i) {
+            prefix += costs[indices[i]];
+            if (leaves[indices[i]].origin[axis] == leaves[indices[i + 1]].origin[axis]) {
+                continue;
+            }
+            double error = std::abs(prefix - target);
+            if (bestCut == 0 || error < bestError) {
+                bestCut = i + 1;
+                bestError = error;
             }
         }
+
+        if (bestCut > 0) {
+            std::vector<uint32_t> lower(indices.begin(), indices.begin() + bestCut);
+            std::vector<uint32_t> upper(indices.begin() + bestCut, indices.end());
+            bisect(leaves, costs, lower, firstPart, lowerParts, owner);
+            bisect(leaves, costs, upper, firstPart + lowerParts, partCount - lowerParts, owner);
+            return;
+        }
     }
 
-    // Trim unused domains
+    // Cannot be cut (single leaf plane): keep everything in one part
+    for (uint32_t leaf : indices) {
+        owner[leaf] = firstPart;
+    }
+}
+
+std::vector<SubDomain> DomainSplitter::assembleDomains(const std::vector<LeafStats>& leaves,
+                                                       const std::vector<double>& costs,
+                                                       const std::vector<uint32_t>& owner) const {
+    std::vector<SubDomain> domains(m_config.gpuCount);
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        domains[d].deviceIndex = d;
+    }
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        SubDomain& domain = domains[owner[i]];
+        if (domain.assignedLeaves.empty()) {
+            domain.bounds = leaves[i].bbox;
+        } else {
+            domain.bounds.expand(leaves[i].bbox);
+        }
+        domain.assignedLeaves.push_back(leaves[i].bbox);
+        domain.activeVoxelCount += leaves[i].activeCount;
+        domain.workload += costs[i];
+    }
+
+    // Trim unused domains and renumber densely
     domains.erase(
         std::remove_if(domains.begin(), domains.end(),
                        [](const SubDomain& d) { return d.assignedLeaves.empty(); }),
         domains.end());
-
-    // Compute neighbors for halo exchange
-    computeNeighbors(domains);
-
-    // Analyze load balance
-    LoadBalanceStats stats = analyzeBalance(domains);
-    LOG_INFO("Load balance: min={}, max={}, avg={:.1f}, imbalance={:.2f}x",
-             stats.minVoxels, stats.maxVoxels, stats.averageVoxels, stats.imbalanceFactor);
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        domains[d].gpuIndex = d;
+        LOG_DEBUG("Domain {}: {} leaves, {} voxels, workload {:.1f}",
+                  d, domains[d].assignedLeaves.size(), domains[d].activeVoxelCount,
+                  domains[d].workload);
+    }
 
     return domains;
 }
@@ -177,100 +481,527 @@ nanovdb::GridHandle<nanovdb::HostBuffer> DomainSplitter::extract(
     const SubDomain& domain) {
     LOG_DEBUG("Extracting sub-grid for domain {}", domain.gpuIndex);
 
+    auto handles = extractAll(fullGrid, {domain});
+    return std::move(handles.front());
+}
+
+std::vector<nanovdb::GridHandle<nanovdb::HostBuffer>> DomainSplitter::extractAll(
+    const nanovdb::GridHandle<nanovdb::HostBuffer>& fullGrid,
+    const std::vector<SubDomain>& domains) {
+    using BuildLeaf = nanovdb::tools::build::LeafNode<float>;
+
     auto* hostGrid = fullGrid.grid<float>();
-    
-    // Create builder for sub-grid
-    nanovdb::tools::build::Grid<float> builder(0.0f);
+    LOG_CHECK(hostGrid != nullptr, "Host grid is null");
 
-    // Iterate all active voxels in full grid using NodeManager
     auto mgrHandle = nanovdb::createNodeManager(*hostGrid);
     auto* mgr = mgrHandle.mgr<float>();
-    
-    if (mgr) {
-        for (uint32_t i = 0; i < mgr->leafCount(); ++i) {
+    const uint32_t leafCount = mgr ? mgr->leafCount() : 0;
+
+    // Leaves are owned whole: bucket each leaf by the domain that owns it
+    std::unordered_map<uint64_t, uint32_t> leafOwner;
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        for (const auto& leafBox : domains[d].assignedLeaves) {
+            leafOwner[getLeafKey(leafBox.min())] = d;
+        }
+    }
+
+    struct LeafTask {
+        uint32_t leaf;
+        uint32_t domain;
+        BuildLeaf* node = nullptr;
+    };
+    std::vector<LeafTask> tasks;
+    for (uint32_t i = 0; i < leafCount; ++i) {
+        auto it = leafOwner.find(getLeafKey(mgr->leaf(i).origin()));
+        if (it != leafOwner.end()) {
+            tasks.push_back({i, it->second});
+        }
+    }
+
+    LOG_DEBUG("Extracting {} domains from {} leaves ({} owned)",
+              domains.size(), leafCount, tasks.size());
+
+    // Split [0, count) over at most one worker per hardware thread
+    auto runParallel = [](size_t count, auto&& work) {
+        size_t threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        size_t perThread = std::max<size_t>(1, (count + threadCount - 1) / threadCount);
+        std::vector<std::future<void>> workers;
+        for (size_t begin = 0; begin < count; begin += perThread) {
+            workers.push_back(std::async(std::launch::async, work,
+                                         begin, std::min(begin + perThread, count)));
+        }
+        for (auto& worker : workers) {
+            worker.get();
+        }
+    };
+
+    // Copy leaves whole (mask + values) in parallel
+    runParallel(tasks.size(), [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            const auto& src = mgr->leaf(tasks[t].leaf);
+            auto* node = new BuildLeaf(src.origin(), 0.0f, false);
+            std::memcpy(node->mValues, src.data()->mValues, sizeof(node->mValues));
+            node->mValueMask = src.valueMask();
+            tasks[t].node = node;
+        }
+    });
+
+    // Group leaf copies per domain, then assemble and convert domains in parallel
+    std::vector<std::vector<BuildLeaf*>> domainLeaves(domains.size());
+    for (auto& task : tasks) {
+        domainLeaves[task.domain].push_back(task.node);
+    }
+
+    std::vector<nanovdb::GridHandle<nanovdb::HostBuffer>> handles(domains.size());
+    runParallel(domains.size(), [&](size_t begin, size_t end) {
+        for (size_t d = begin; d < end; ++d) {
+            nanovdb::tools::build::Grid<float> builder(0.0f);
+            for (BuildLeaf* node : domainLeaves[d]) {
+                builder.tree().root().addNode(node);  // Takes ownership
+            }
+            handles[d] = nanovdb::tools::createNanoGrid(builder);
+        }
+    });
+
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        LOG_DEBUG("Sub-grid {} extracted: {} active voxels",
+                  domains[d].gpuIndex, handles[d].grid<float>()->activeVoxelCount());
+    }
+
+    return handles;
+}
+
+void DomainSplitter::computeNeighbors(std::vector<SubDomain>& domains) const {
+    LOG_DEBUG("Computing neighbor relationships from leaf adjacency...");
+
+    std::unordered_map<uint64_t, uint32_t> leafOwner;
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        for (const auto& leafBox : domains[d].assignedLeaves) {
+            leafOwner[getLeafKey(leafBox.min())] = d;
+        }
+    }
+
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        std::map<uint32_t, SubDomain::Neighbor> contacts;
+        std::map<uint32_t, std::array<uint32_t, 6>> faceContacts;
+
+        for (const auto& leafBox : domains[d].assignedLeaves) {
+            nanovdb::Coord origin = leafBox.min() & ~7;
+
+            // All 26 neighboring leaves
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dz = -1; dz <= 1; ++dz) {
+                        if (dx == 0 && dy == 0 && dz == 0) continue;
+
+                        auto it = leafOwner.find(getLeafKey(origin.offsetBy(dx * 8, dy * 8, dz * 8)));
+                        if (it == leafOwner.end() || it->second == d) continue;
+
+                        auto& neighbor = contacts[it->second];
+                        neighbor.gpuIndex = it->second;
+                        neighbor.contactCount++;
+                        neighbor.directionMask |= 1u << ((dx + 1) * 9 + (dy + 1) * 3 + (dz + 1));
+
+                        auto& faces = faceContacts[it->second];
+                        if (std::abs(dx) + std::abs(dy) + std::abs(dz) == 1) {
+                            uint32_t axis = dx != 0 ? 0 : (dy != 0 ? 1 : 2);
+                            int dir = dx + dy + dz;
+                            faces[axis * 2 + (dir > 0 ? 1 : 0)]++;
+                        }
+                    }
+                }
+            }
+        }
+
+        domains[d].neighbors.clear();
+        for (auto& [gpu, neighbor] : contacts) {
+            // Face slabs need one face: take the one with most contacts, or
+            // for pure edge/corner contacts the first axis of the first direction
+            const auto& faces = faceContacts[gpu];
+            auto best = std::max_element(faces.begin(), faces.end());
+            if (*best > 0) {
+                neighbor.face = static_cast<uint32_t>(best - faces.begin());
+            } else {
+                uint32_t bit = 0;
+                while (!(neighbor.directionMask & (1u << bit))) ++bit;
+                int offsets[3] = {static_cast<int>(bit / 9) - 1,
+                                  static_cast<int>((bit / 3) % 3) - 1,
+                                  static_cast<int>(bit % 3) - 1};
+                uint32_t axis = offsets[0] != 0 ? 0 : (offsets[1] != 0 ? 1 : 2);
+                neighbor.face = axis * 2 + (offsets[axis] > 0 ? 1 : 0);
+            }
+            domains[d].neighbors.push_back(neighbor);
+        }
+
+        LOG_DEBUG("Domain {}: {} neighbors", d, domains[d].neighbors.size());
+    }
+}
+
+nanovdb::GridHandle<nanovdb::HostBuffer> DomainSplitter::addPeriodicGhosts(
+    const nanovdb::GridHandle<nanovdb::HostBuffer>& grid,
+    const PeriodicBoundary& periodic,
+    uint32_t depth) {
+    auto* hostGrid = grid.grid<float>();
+    LOG_CHECK(hostGrid != nullptr, "Host grid is null");
+
+    const int32_t ghostDepth = static_cast<int32_t>(depth);
+    nanovdb::tools::build::Grid<float> builder(hostGrid->tree().background());
+    auto acc = builder.getAccessor();
+
+    auto mgrHandle = nanovdb::createNodeManager(*hostGrid);
+    auto* mgr = mgrHandle.mgr<float>();
+    const uint32_t leafCount = mgr ? mgr->leafCount() : 0;
+
+    uint64_t ghostCount = 0;
+    for (uint32_t i = 0; i < leafCount; ++i) {
+        const auto& leaf = mgr->leaf(i);
+        for (auto it = leaf.valueMask().beginOn(); it; ++it) {
+            nanovdb::Coord ijk = leaf.offsetToGlobalCoord(*it);
+            if (periodic.isGhost(ijk)) continue;
+
+            float value = leaf.getValue(*it);
+            acc.setValue(ijk, value);
+
+            // Images one period away along every combination of periodic axes
+            for (int sx = -1; sx <= 1; ++sx) {
+                for (int sy = -1; sy <= 1; ++sy) {
+                    for (int sz = -1; sz <= 1; ++sz) {
+                        if (sx == 0 && sy == 0 && sz == 0) continue;
+
+                        const int shift[3] = {sx, sy, sz};
+                        nanovdb::Coord ghost = ijk;
+                        bool inShell = true;
+                        for (int axis = 0; axis < 3 && inShell; ++axis) {
+                            if (shift[axis] == 0) continue;
+                            ghost[axis] += shift[axis] * periodic.period(axis);
+                            inShell = periodic.axes[axis] &&
+                                      (shift[axis] > 0 ? ghost[axis] <= periodic.box.max()[axis] + ghostDepth
+                                                       : ghost[axis] >= periodic.box.min()[axis] - ghostDepth);
+                        }
+                        if (inShell) {
+                            acc.setValue(ghost, value);
+                            ++ghostCount;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    LOG_INFO("Periodic ghost shell: {} voxels, {} layers deep", ghostCount, depth);
+    return nanovdb::tools::createNanoGrid(builder);
+}
+
+void DomainSplitter::buildHaloLists(const nanovdb::GridHandle<nanovdb::HostBuffer>& grid,
+                                    std::vector<SubDomain>& domains) const {
+    std::vector<uint32_t> all(domains.size());
+    for (uint32_t d = 0; d < all.size(); ++d) {
+        all[d] = d;
+    }
+    buildHaloLists(grid, domains, all);
+}
+
+std::vector<uint32_t> DomainSplitter::buildHaloLists(const nanovdb::GridHandle<nanovdb::HostBuffer>& grid,
+                                                     std::vector<SubDomain>& domains,
+                                                     const std::vector<uint32_t>& rebuild) const {
+    // Relays depend on routes through every domain, and wrap contacts are not
+    // in the neighbor lists: forwarding and periodic axes rebuild all lists
+    std::vector<uint32_t> rebuilt = rebuild;
+    if (m_config.haloRouting == HaloRouting::Forwarded || m_config.periodic.any()) {
+        rebuilt.resize(domains.size());
+        for (uint32_t d = 0; d < rebuilt.size(); ++d) {
+            rebuilt[d] = d;
+        }
+    }
+    std::vector<bool> selected(domains.size(), false);
+    for (uint32_t d : rebuilt) {
+        LOG_CHECK(d < domains.size(), "Halo list domain out of range");
+        selected[d] = true;
+    }
+
+    auto* hostGrid = grid.grid<float>();
+    LOG_CHECK(hostGrid != nullptr, "Host grid is null");
+
+    const auto& periodic = m_config.periodic;
+    LOG_CHECK(!periodic.any() || m_config.haloRouting == HaloRouting::Direct,
+              "Periodic boundaries need direct halo routing");
+
+    const int32_t thickness = static_cast<int32_t>(std::min<uint32_t>(m_config.haloThickness, 8));
+    LOG_DEBUG("Building exact halo lists (thickness {})", thickness);
+
+    std::unordered_map<uint64_t, uint32_t> leafOwner;
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        for (const auto& leafBox : domains[d].assignedLeaves) {
+            leafOwner[getLeafKey(leafBox.min())] = d;
+        }
+    }
+
+    auto acc = hostGrid->getAccessor();
+
+    // Per sender and neighbor: voxels with the distance at which the neighbor reads them
+    struct Candidate {
+        int32_t distance;
+        nanovdb::Coord send;
+        nanovdb::Coord recv;    // Differs from send for periodic ghosts
+    };
+    std::vector<std::map<uint32_t, std::vector<Candidate>>> candidates(domains.size());
+
+    // Nearest active non-ghost voxel of each owner within the halo cube
+    auto nearestReaders = [&](const nanovdb::Coord& ijk, uint32_t skipOwner) {
+        std::map<uint32_t, int32_t> nearest;
+        for (int dx = -thickness; dx <= thickness; ++dx) {
+            for (int dy = -thickness; dy <= thickness; ++dy) {
+                for (int dz = -thickness; dz <= thickness; ++dz) {
+                    nanovdb::Coord probe = ijk.offsetBy(dx, dy, dz);
+                    auto owner = leafOwner.find(getLeafKey(probe));
+                    if (owner == leafOwner.end() || owner->second == skipOwner) continue;
+                    if (!acc.isActive(probe) || periodic.isGhost(probe)) continue;
+
+                    int32_t dist = std::max({std::abs(dx), std::abs(dy), std::abs(dz)});
+                    auto [pos, inserted] = nearest.emplace(owner->second, dist);
+                    if (!inserted) pos->second = std::min(pos->second, dist);
+                }
+            }
+        }
+        return nearest;
+    };
+
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        if (!selected[d]) continue;
+        auto& domain = domains[d];
+        domain.haloLists.clear();
+        for (const auto& neighbor : domain.neighbors) {
+            candidates[d][neighbor.gpuIndex];
+        }
+
+        for (const auto& leafBox : domain.assignedLeaves) {
+            const auto* leaf = acc.probeLeaf(leafBox.min());
+            if (!leaf) continue;
+
+            // Leaves surrounded only by own leaves send nothing
+            bool touchesForeign = false;
+            for (int dx = -1; dx <= 1 && !touchesForeign; ++dx) {
+                for (int dy = -1; dy <= 1 && !touchesForeign; ++dy) {
+                    for (int dz = -1; dz <= 1 && !touchesForeign; ++dz) {
+                        auto owner = leafOwner.find(getLeafKey(leaf->origin().offsetBy(dx * 8, dy * 8, dz * 8)));
+                        touchesForeign = owner != leafOwner.end() && owner->second != d;
+                    }
+                }
+            }
+            if (!touchesForeign) continue;
+
+            for (auto it = leaf->valueMask().beginOn(); it; ++it) {
+                nanovdb::Coord ijk = leaf->offsetToGlobalCoord(*it);
+                nanovdb::Coord local = ijk - leaf->origin();
+
+                // Interior voxels of the leaf cannot see another leaf
+                bool nearLeafBoundary = false;
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (local[axis] < thickness || local[axis] >= 8 - thickness) {
+                        nearLeafBoundary = true;
+                    }
+                }
+                if (!nearLeafBoundary || periodic.isGhost(ijk)) continue;
+
+                for (const auto& [gpu, dist] : nearestReaders(ijk, d)) {
+                    candidates[d][gpu].push_back({dist, ijk, ijk});
+                }
+            }
+        }
+    }
+
+    // Periodic ghosts: whoever reads one receives it from the owner of its image
+    if (periodic.any()) {
+        auto mgrHandle = nanovdb::createNodeManager(*hostGrid);
+        auto* mgr = mgrHandle.mgr<float>();
+        const uint32_t leafCount = mgr ? mgr->leafCount() : 0;
+
+        uint64_t ghostSends = 0;
+        uint64_t orphanGhosts = 0;
+        for (uint32_t i = 0; i < leafCount; ++i) {
             const auto& leaf = mgr->leaf(i);
-            // Optimization: check if leaf bbox overlaps with domain
-            if (!domain.bounds.hasOverlap(leaf.bbox())) continue;
-            
+            if (!periodic.isGhost(leaf.bbox().min()) && !periodic.isGhost(leaf.bbox().max())) continue;
+
             for (auto it = leaf.valueMask().beginOn(); it; ++it) {
-                nanovdb::Coord coord = leaf.offsetToGlobalCoord(*it);
+                nanovdb::Coord ghost = leaf.offsetToGlobalCoord(*it);
+                if (!periodic.isGhost(ghost)) continue;
+
+                nanovdb::Coord image = periodic.wrap(ghost);
+                auto imageOwner = leafOwner.find(getLeafKey(image));
+                if (imageOwner == leafOwner.end() || !acc.isActive(image)) {
+                    ++orphanGhosts;
+                    continue;
+                }
 
-                // Include if voxel is within domain bounds
-                if (domain.bounds.isInside(coord)) {
-                    builder.setValue(coord, leaf.getValue(*it));
+                // Readers include the image owner itself (self-exchange)
+                for (const auto& [gpu, dist] : nearestReaders(ghost, ~0u)) {
+                    if (selected[imageOwner->second]) {
+                        candidates[imageOwner->second][gpu].push_back({dist, image, ghost});
+                        ++ghostSends;
+                    }
+                    if (selected[gpu]) {
+                        candidates[gpu][imageOwner->second];  // Both sides need the list pair
+                    }
                 }
             }
         }
+        if (orphanGhosts > 0) {
+            LOG_WARN("{} periodic ghost voxels have no active image and keep their values", orphanGhosts);
+        }
+        LOG_DEBUG("Periodic halos: {} ghost voxels sent per exchange", ghostSends);
     }
 
-#include <nanovdb/tools/CreateNanoGrid.h>
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        if (!selected[d]) continue;
+        auto& domain = domains[d];
 
-    // Convert builder grid to NanoVDB GridHandle
-    auto subHandle = nanovdb::tools::createNanoGrid(builder);
-    LOG_DEBUG("Sub-grid extracted: {} active voxels",
-              subHandle.grid<float>()->activeVoxelCount());
+        for (auto& [gpu, voxels] : candidates[d]) {
+            std::stable_sort(voxels.begin(), voxels.end(),
+                             [](const auto& a, const auto& b) { return a.distance < b.distance; });
 
-    return subHandle;
-}
+            SubDomain::HaloList list;
+            list.neighborGpu = gpu;
+            list.layerEnds.assign(thickness, 0);
+            bool shifted = false;
+            for (const auto& voxel : voxels) {
+                list.sendVoxels.push_back(voxel.send);
+                shifted = shifted || voxel.send != voxel.recv;
+            }
+            if (shifted) {
+                for (const auto& voxel : voxels) {
+                    list.recvVoxels.push_back(voxel.recv);
+                }
+            }
+            for (int32_t layer = 0; layer < thickness; ++layer) {
+                auto end = std::upper_bound(voxels.begin(), voxels.end(), layer + 1,
+                    [](int32_t value, const auto& entry) { return value < entry.distance; });
+                list.layerEnds[layer] = static_cast<uint32_t>(end - voxels.begin());
+            }
+
+            // Wrap neighbors (and the domain itself) only meet through the ghost shell
+            bool known = std::any_of(domain.neighbors.begin(), domain.neighbors.end(),
+                                     [gpu = gpu](const auto& neighbor) { return neighbor.gpuIndex == gpu; });
+            if (!known) {
+                SubDomain::Neighbor neighbor;
+                neighbor.gpuIndex = gpu;
+                domain.neighbors.push_back(neighbor);
+            }
 
-void DomainSplitter::computeNeighbors(std::vector<SubDomain>& domains) {
-    LOG_DEBUG("Computing neighbor relationships...");
+            LOG_DEBUG("Domain {} -> {}: {} halo voxels", d, gpu, list.sendVoxels.size());
+            domain.haloLists.push_back(std::move(list));
+        }
+    }
+
+    if (m_config.haloRouting == HaloRouting::Forwarded) {
+        forwardHaloLists(domains);
+    }
+    return rebuilt;
+}
 
-    for (uint32_t i = 0; i < domains.size(); i++) {
-        for (uint32_t j = i + 1; j < domains.size(); j++) {
-            const auto& boxA = domains[i].bounds;
-            const auto& boxB = domains[j].bounds;
+void DomainSplitter::forwardHaloLists(std::vector<SubDomain>& domains) const {
+    const uint32_t domainCount = static_cast<uint32_t>(domains.size());
 
-            // Check if domains share a face
-            int32_t dx = 0, dy = 0, dz = 0;
+    // Face contact directions: bit (dx+1)*9 + (dy+1)*3 + (dz+1) with one nonzero offset
+    constexpr uint32_t faceBits = (1u << 4) | (1u << 22) | (1u << 10) | (1u << 16) | (1u << 12) | (1u << 14);
 
-            // Check X direction
-            if (boxA.max()[0] + 1 == boxB.min()[0]) {
-                dx = 1;  // A is left of B
-            } else if (boxB.max()[0] + 1 == boxA.min()[0]) {
-                dx = -1; // B is left of A
+    // Phase (axis) of every face-adjacent pair, taken from the lower index so both sides agree
+    constexpr uint32_t noFace = ~0u;
+    std::vector<uint32_t> pairAxis(domainCount * domainCount, noFace);
+    for (uint32_t d = 0; d < domainCount; ++d) {
+        for (const auto& neighbor : domains[d].neighbors) {
+            if (neighbor.gpuIndex > d && (neighbor.directionMask & faceBits)) {
+                pairAxis[d * domainCount + neighbor.gpuIndex] = neighbor.face / 2;
+                pairAxis[neighbor.gpuIndex * domainCount + d] = neighbor.face / 2;
             }
+        }
+    }
+    auto axisOf = [&](uint32_t a, uint32_t b) { return pairAxis[a * domainCount + b]; };
 
-            // Check Y direction
-            if (boxA.max()[1] + 1 == boxB.min()[1]) {
-                dy = 1;
-            } else if (boxB.max()[1] + 1 == boxA.min()[1]) {
-                dy = -1;
+    // Shortest relay path from src to dst whose hops have strictly increasing axes
+    auto findRoute = [&](uint32_t src, uint32_t dst) {
+        std::vector<uint32_t> best;
+        std::function<void(std::vector<uint32_t>&, uint32_t)> extend =
+            [&](std::vector<uint32_t>& path, uint32_t lastAxis) {
+                uint32_t at = path.back();
+                if (at == dst) {
+                    if (best.empty() || path.size() < best.size()) best = path;
+                    return;
+                }
+                for (const auto& neighbor : domains[at].neighbors) {
+                    uint32_t axis = axisOf(at, neighbor.gpuIndex);
+                    if (axis == noFace || (lastAxis != noFace && axis <= lastAxis)) continue;
+                    if (std::find(path.begin(), path.end(), neighbor.gpuIndex) != path.end()) continue;
+                    path.push_back(neighbor.gpuIndex);
+                    extend(path, axis);
+                    path.pop_back();
+                }
+            };
+        std::vector<uint32_t> path{src};
+        extend(path, noFace);
+        return best;
+    };
+
+    // (layer, voxel) entries per ordered pair
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<std::pair<uint32_t, nanovdb::Coord>>> entries;
+    std::vector<uint32_t> layerCount(domainCount, 0);
+    uint32_t relayed = 0;
+    uint32_t direct = 0;
+
+    for (uint32_t d = 0; d < domainCount; ++d) {
+        for (const auto& list : domains[d].haloLists) {
+            layerCount[d] = std::max<uint32_t>(layerCount[d], static_cast<uint32_t>(list.layerEnds.size()));
+
+            std::vector<uint32_t> route{d, list.neighborGpu};
+            if (axisOf(d, list.neighborGpu) == noFace && !list.sendVoxels.empty()) {
+                auto relay = findRoute(d, list.neighborGpu);
+                if (relay.empty()) {
+                    direct++;
+                } else {
+                    route = std::move(relay);
+                    relayed++;
+                }
             }
 
-            // Check Z direction
-            if (boxA.max()[2] + 1 == boxB.min()[2]) {
-                dz = 1;
-            } else if (boxB.max()[2] + 1 == boxA.min()[2]) {
-                dz = -1;
+            // Voxels keep their distance to the final destination on every hop
+            for (uint32_t i = 0; i < list.sendVoxels.size(); ++i) {
+                uint32_t layer = static_cast<uint32_t>(
+                    std::upper_bound(list.layerEnds.begin(), list.layerEnds.end(), i) - list.layerEnds.begin());
+                for (size_t hop = 0; hop + 1 < route.size(); ++hop) {
+                    entries[{route[hop], route[hop + 1]}].push_back({layer, list.sendVoxels[i]});
+                }
             }
+        }
+    }
+
+    // Rebuild every list: relayed voxels merged in, duplicates dropped, ordered by layer
+    for (uint32_t d = 0; d < domainCount; ++d) {
+        for (auto& list : domains[d].haloLists) {
+            auto& pairEntries = entries[{d, list.neighborGpu}];
+            std::stable_sort(pairEntries.begin(), pairEntries.end(),
+                             [](const auto& a, const auto& b) { return a.first < b.first; });
 
-            // If domains are adjacent
-            if ((dx != 0 || dy != 0 || dz != 0) &&
-                (dx * dx + dy * dy + dz * dz) <= 2) { // Face or edge neighbor
-                // Determine which face (only face neighbors for halo exchange)
-                if (dx == 1 && dy == 0 && dz == 0) {
-                    domains[i].neighbors.push_back({j, 1}); // +X
-                    domains[j].neighbors.push_back({i, 0}); // -X
-                } else if (dx == -1 && dy == 0 && dz == 0) {
-                    domains[i].neighbors.push_back({j, 0}); // -X
-                    domains[j].neighbors.push_back({i, 1}); // +X
-                } else if (dy == 1 && dx == 0 && dz == 0) {
-                    domains[i].neighbors.push_back({j, 3}); // +Y
-                    domains[j].neighbors.push_back({i, 2}); // -Y
-                } else if (dy == -1 && dx == 0 && dz == 0) {
-                    domains[i].neighbors.push_back({j, 2}); // -Y
-                    domains[j].neighbors.push_back({i, 3}); // +Y
-                } else if (dz == 1 && dx == 0 && dy == 0) {
-                    domains[i].neighbors.push_back({j, 5}); // +Z
-                    domains[j].neighbors.push_back({i, 4}); // -Z
-                } else if (dz == -1 && dx == 0 && dy == 0) {
-                    domains[i].neighbors.push_back({j, 4}); // -Z
-                    domains[j].neighbors.push_back({i, 5}); // +Z
+            std::unordered_map<uint64_t, bool> seen;
+            list.sendVoxels.clear();
+            list.layerEnds.assign(layerCount[d], 0);
+            for (const auto& [layer, ijk] : pairEntries) {
+                uint64_t key = (static_cast<uint64_t>(ijk[0]) & 0x1FFFFF) |
+                               ((static_cast<uint64_t>(ijk[1]) & 0x1FFFFF) << 21) |
+                               ((static_cast<uint64_t>(ijk[2]) & 0x1FFFFF) << 42);
+                if (seen[key]) continue;
+                seen[key] = true;
+                list.sendVoxels.push_back(ijk);
+                for (uint32_t l = layer; l < list.layerEnds.size(); ++l) {
+                    list.layerEnds[l] = static_cast<uint32_t>(list.sendVoxels.size());
                 }
             }
+
+            uint32_t axis = axisOf(d, list.neighborGpu);
+            list.phase = axis == noFace ? 0 : axis;
         }
     }
+
+    LOG_INFO("Halo forwarding: {} diagonal lists relayed through face neighbors, {} sent directly",
+             relayed, direct);
 }
 
 DomainSplitter::LoadBalanceStats DomainSplitter::analyzeBalance(
@@ -304,6 +1035,60 @@ DomainSplitter::LoadBalanceStats DomainSplitter::analyzeBalance(
         ? static_cast<double>(stats.maxVoxels) / stats.averageVoxels
         : 1.0;
 
+    // Communication metrics: a leaf face is on a domain boundary when the
+    // neighbouring leaf exists and belongs to another domain
+    std::unordered_map<uint64_t, uint32_t> leafOwner;
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        for (const auto& leafBox : domains[d].assignedLeaves) {
+            leafOwner[getLeafKey(leafBox.min())] = d;
+        }
+    }
+
+    constexpr uint64_t faceVoxels = 8 * 8;
+    const uint64_t haloDepth = std::min<uint32_t>(m_config.haloThickness, 8);
+    double surfaceToVolumeSum = 0.0;
+
+    for (uint32_t d = 0; d < domains.size(); ++d) {
+        uint64_t boundaryFaces = 0;
+        for (const auto& leafBox : domains[d].assignedLeaves) {
+            nanovdb::Coord origin = leafBox.min() & ~7;
+            for (int axis = 0; axis < 3; ++axis) {
+                for (int dir = -1; dir <= 1; dir += 2) {
+                    nanovdb::Coord neighbor = origin;
+                    neighbor[axis] += dir * 8;
+                    auto it = leafOwner.find(getLeafKey(neighbor));
+                    if (it != leafOwner.end() && it->second != d) {
+                        boundaryFaces++;
+                    }
+                }
+            }
+        }
+
+        uint64_t haloVoxels = boundaryFaces * faceVoxels * haloDepth;
+        stats.totalHaloVoxels += haloVoxels;
+        stats.maxHaloVoxels = std::max(stats.maxHaloVoxels, haloVoxels);
+
+        double surfaceToVolume = domains[d].activeVoxelCount > 0
+            ? static_cast<double>(boundaryFaces * faceVoxels) / domains[d].activeVoxelCount
+            : 0.0;
+        surfaceToVolumeSum += surfaceToVolume;
+        stats.maxSurfaceToVolume = std::max(stats.maxSurfaceToVolume, surfaceToVolume);
+    }
+    stats.averageSurfaceToVolume = surfaceToVolumeSum / domains.size();
+
+    // Predicted step time per device under the cost model
+    double predictedSum = 0.0;
+    for (const auto& domain : domains) {
+        double time = domain.workload / deviceThroughput(domain.deviceIndex);
+        stats.predictedDeviceTime.push_back(time);
+        stats.maxPredictedTime = std::max(stats.maxPredictedTime, time);
+        predictedSum += time;
+    }
+    double predictedAverage = predictedSum / domains.size();
+    stats.predictedImbalance = (predictedAverage > 0.0)
+        ? stats.maxPredictedTime / predictedAverage
+        : 1.0;
+
     return stats;
 }
 
@@ -0,0 +1,529 @@
+#include "domain/GraphPartitioner.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
+namespace domain {
+
+namespace {
+
+constexpr uint32_t kUnmatched = std::numeric_limits<uint32_t>::max();
+
+// Target and maximum weight of both sides of a bisection
+struct BisectionLimits {
+    double target[2] = {0.0, 0.0};
+    double maxWeight[2] = {0.0, 0.0};
+};
+
+BisectionLimits computeLimits(const GraphPartitioner::Graph& graph, double fraction, double tolerance) {
+    double total = std::accumulate(graph.nodeWeights.begin(), graph.nodeWeights.end(), 0.0);
+    double heaviest = graph.nodeWeights.empty() ? 0.0 :
+        *std::max_element(graph.nodeWeights.begin(), graph.nodeWeights.end());
+
+    BisectionLimits limits;
+    limits.target[0] = total * fraction;
+    limits.target[1] = total - limits.target[0];
+    for (int s = 0; s < 2; ++s) {
+        // A part can always exceed its target by one node: nodes are indivisible
+        limits.maxWeight[s] = std::max(limits.target[s] * (1.0 + tolerance),
+                                       limits.target[s] + heaviest);
+    }
+    return limits;
+}
+
+double bisectionCut(const GraphPartitioner::Graph& graph, const std::vector<uint8_t>& side) {
+    double cut = 0.0;
+    for (uint32_t v = 0; v < graph.nodeCount(); ++v) {
+        for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            if (side[graph.adjacency[e]] != side[v]) {
+                cut += graph.edgeWeights[e];
+            }
+        }
+    }
+    return cut * 0.5;
+}
+
+// Worst ratio of side weight to target weight
+double overload(const BisectionLimits& limits, const double weights[2]) {
+    double worst = 0.0;
+    for (int s = 0; s < 2; ++s) {
+        if (limits.target[s] > 0.0) {
+            worst = std::max(worst, weights[s] / limits.target[s]);
+        }
+    }
+    return worst;
+}
+
+} // namespace
+
+GraphPartitioner::GraphPartitioner()
+    : GraphPartitioner(Config()) {
+}
+
+GraphPartitioner::GraphPartitioner(const Config& config)
+    : m_config(config), m_rng(config.seed) {
+}
+
+GraphPartitioner::Graph GraphPartitioner::buildLeafGraph(const std::vector<LeafStats>& leaves,
+                                                         const std::vector<double>& costs) {
+    Graph graph;
+    graph.nodeWeights = costs;
+    graph.offsets.reserve(leaves.size() + 1);
+    graph.offsets.push_back(0);
+
+    std::unordered_map<uint64_t, uint32_t> leafIndex;
+    leafIndex.reserve(leaves.size());
+    for (uint32_t i = 0; i < leaves.size(); ++i) {
+        leafIndex[DomainSplitter::getLeafKey(leaves[i].origin)] = i;
+    }
+
+    // Active voxels on a leaf face; leaves without face statistics are
+    // assumed uniformly dense (64 of 512 voxels per face)
+    auto faceVoxels = [](const LeafStats& leaf, int face) {
+        uint32_t recorded = 0;
+        for (uint16_t count : leaf.faceCounts) {
+            recorded += count;
+        }
+        if (recorded == 0 && leaf.activeCount > 0) {
+            return leaf.activeCount / 8.0;
+        }
+        return static_cast<double>(leaf.faceCounts[face]);
+    };
+
+    for (uint32_t i = 0; i < leaves.size(); ++i) {
+        for (int face = 0; face < 6; ++face) {
+            int axis = face / 2;
+            int dir = (face % 2) ? 8 : -8;
+            nanovdb::Coord neighborOrigin = leaves[i].origin;
+            neighborOrigin[axis] += dir;
+
+            auto it = leafIndex.find(DomainSplitter::getLeafKey(neighborOrigin));
+            if (it == leafIndex.end()) {
+                continue;
+            }
+
+            // Voxels that actually face each other are bounded by both sides
+            double weight = std::min(faceVoxels(leaves[i], face),
+                                     faceVoxels(leaves[it->second], face ^ 1));
+            if (weight > 0.0) {
+                graph.adjacency.push_back(it->second);
+                graph.edgeWeights.push_back(weight);
+            }
+        }
+        graph.offsets.push_back(static_cast<uint32_t>(graph.adjacency.size()));
+    }
+
+    return graph;
+}
+
+std::vector<uint32_t> GraphPartitioner::partition(const Graph& graph,
+                                                  const std::vector<double>& partWeights) {
+    std::vector<uint32_t> part(graph.nodeCount(), 0);
+    uint32_t partCount = static_cast<uint32_t>(partWeights.size());
+    if (partCount <= 1 || graph.nodeCount() == 0) {
+        return part;
+    }
+
+    m_rng.seed(m_config.seed);
+
+    // Imbalance compounds over the bisection levels
+    uint32_t levels = static_cast<uint32_t>(std::ceil(std::log2(static_cast<double>(partCount))));
+    double tolerance = m_config.tolerance / std::max(levels, 1u);
+
+    std::vector<uint32_t> nodes(graph.nodeCount());
+    std::iota(nodes.begin(), nodes.end(), 0);
+    partitionRecursive(graph, nodes, partWeights, 0, partCount, tolerance, part);
+
+    LOG_DEBUG("Graph partition: {} nodes into {} parts, edge cut {:.0f}",
+              graph.nodeCount(), partCount, edgeCut(graph, part));
+    return part;
+}
+
+double GraphPartitioner::edgeCut(const Graph& graph, const std::vector<uint32_t>& part) {
+    double cut = 0.0;
+    for (uint32_t v = 0; v < graph.nodeCount(); ++v) {
+        for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            if (part[graph.adjacency[e]] != part[v]) {
+                cut += graph.edgeWeights[e];
+            }
+        }
+    }
+    return cut * 0.5;
+}
+
+void GraphPartitioner::partitionRecursive(const Graph& graph,
+                                          const std::vector<uint32_t>& nodes,
+                                          const std::vector<double>& partWeights,
+                                          uint32_t firstPart, uint32_t partCount,
+                                          double tolerance,
+                                          std::vector<uint32_t>& part) {
+    if (partCount <= 1 || nodes.size() <= 1) {
+        for (uint32_t node : nodes) {
+            part[node] = firstPart;
+        }
+        return;
+    }
+
+    uint32_t leftCount = partCount / 2;
+    double leftWeight = std::accumulate(partWeights.begin() + firstPart,
+                                        partWeights.begin() + firstPart + leftCount, 0.0);
+    double totalWeight = std::accumulate(partWeights.begin() + firstPart,
+                                         partWeights.begin() + firstPart + partCount, 0.0);
+
+    Graph local = subgraph(graph, nodes);
+    std::vector<uint8_t> side = bisect(local, leftWeight / totalWeight, tolerance);
+
+    std::vector<uint32_t> left, right;
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        (side[i] == 0 ? left : right).push_back(nodes[i]);
+    }
+
+    partitionRecursive(graph, left, partWeights, firstPart, leftCount, tolerance, part);
+    partitionRecursive(graph, right, partWeights, firstPart + leftCount,
+                       partCount - leftCount, tolerance, part);
+}
+
+std::vector<uint8_t> GraphPartitioner::bisect(const Graph& graph, double fraction, double tolerance) {
+    // Coarsening phase
+    std::vector<Graph> levels;
+    std::vector<std::vector<uint32_t>> maps;
+    const Graph* current = &graph;
+    while (current->nodeCount() > m_config.coarsenTarget) {
+        std::vector<uint32_t> cmap;
+        Graph coarse = coarsen(*current, cmap);
+
+        // Matching stalled (e.g. star-shaped graphs)
+        if (coarse.nodeCount() > current->nodeCount() * 0.9) {
+            break;
+        }
+
+        maps.push_back(std::move(cmap));
+        levels.push_back(std::move(coarse));
+        current = &levels.back();
+    }
+
+    // Initial bisection of the coarsest graph
+    std::vector<uint8_t> side = initialBisection(*current, fraction, tolerance);
+
+    // Uncoarsening with refinement
+    for (size_t level = maps.size(); level-- > 0;) {
+        const Graph& fine = (level == 0) ? graph : levels[level - 1];
+        std::vector<uint8_t> fineSide(fine.nodeCount());
+        for (uint32_t v = 0; v < fine.nodeCount(); ++v) {
+            fineSide[v] = side[maps[level][v]];
+        }
+        side = std::move(fineSide);
+        refine(fine, side, fraction, tolerance);
+    }
+
+    return side;
+}
+
+GraphPartitioner::Graph GraphPartitioner::coarsen(const Graph& graph, std::vector<uint32_t>& cmap) {
+    const uint32_t n = graph.nodeCount();
+
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), m_rng);
+
+    // Match every node with its heaviest unmatched neighbor
+    std::vector<uint32_t> match(n, kUnmatched);
+    for (uint32_t v : order) {
+        if (match[v] != kUnmatched) {
+            continue;
+        }
+        uint32_t best = v;
+        double bestWeight = -1.0;
+        for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            uint32_t u = graph.adjacency[e];
+            if (u != v && match[u] == kUnmatched && graph.edgeWeights[e] > bestWeight) {
+                best = u;
+                bestWeight = graph.edgeWeights[e];
+            }
+        }
+        match[v] = best;
+        match[best] = v;
+    }
+
+    // Number coarse nodes by their lower fine index
+    cmap.assign(n, 0);
+    uint32_t coarseCount = 0;
+    for (uint32_t v = 0; v < n; ++v) {
+        if (v <= match[v]) {
+            cmap[v] = coarseCount;
+            cmap[match[v]] = coarseCount;
+            ++coarseCount;
+        }
+    }
+
+    // Merge adjacency of matched pairs
+    Graph coarse;
+    coarse.nodeWeights.assign(coarseCount, 0.0);
+    coarse.offsets.reserve(coarseCount + 1);
+    coarse.offsets.push_back(0);
+
+    std::vector<int64_t> slot(coarseCount, -1);
+    for (uint32_t v = 0; v < n; ++v) {
+        if (v > match[v]) {
+            continue;
+        }
+        uint32_t c = cmap[v];
+        int64_t rowStart = static_cast<int64_t>(coarse.adjacency.size());
+
+        uint32_t members[2] = {v, match[v]};
+        uint32_t memberCount = (match[v] == v) ? 1 : 2;
+        for (uint32_t m = 0; m < memberCount; ++m) {
+            uint32_t fine = members[m];
+            coarse.nodeWeights[c] += graph.nodeWeights[fine];
+
+            for (uint32_t e = graph.offsets[fine]; e < graph.offsets[fine + 1]; ++e) {
+                uint32_t cu = cmap[graph.adjacency[e]];
+                if (cu == c) {
+                    continue;
+                }
+                if (slot[cu] >= rowStart) {
+                    coarse.edgeWeights[slot[cu]] += graph.edgeWeights[e];
+                } else {
+                    slot[cu] = static_cast<int64_t>(coarse.adjacency.size());
+                    coarse.adjacency.push_back(cu);
+                    coarse.edgeWeights.push_back(graph.edgeWeights[e]);
+                }
+            }
+        }
+        coarse.offsets.push_back(static_cast<uint32_t>(coarse.adjacency.size()));
+    }
+
+    return coarse;
+}
+
+std::vector<uint8_t> GraphPartitioner::initialBisection(const Graph& graph, double fraction,
+                                                        double tolerance) {
+    const uint32_t n = graph.nodeCount();
+    BisectionLimits limits = computeLimits(graph, fraction, tolerance);
+
+    std::vector<double> degree(n, 0.0);
+    for (uint32_t v = 0; v < n; ++v) {
+        for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            degree[v] += graph.edgeWeights[e];
+        }
+    }
+
+    std::vector<uint8_t> best;
+    double bestCut = std::numeric_limits<double>::max();
+    double bestLoad = std::numeric_limits<double>::max();
+    bool bestFeasible = false;
+
+    std::uniform_int_distribution<uint32_t> pickSeed(0, n - 1);
+    uint32_t trials = std::max(1u, std::min(m_config.initialTrials, n));
+    for (uint32_t trial = 0; trial < trials; ++trial) {
+        // Grow side 0 from a seed, always adding the frontier node that
+        // removes the most cut weight
+        std::vector<uint8_t> side(n, 1);
+        std::vector<double> connection(n, 0.0);  // Edge weight into side 0
+        std::set<std::pair<double, uint32_t>, std::greater<>> frontier;
+        double grown = 0.0;
+
+        uint32_t next = pickSeed(m_rng);
+        while (true) {
+            if (grown > 0.0 &&
+                grown + graph.nodeWeights[next] - limits.target[0] > limits.target[0] - grown) {
+                break;
+            }
+
+            side[next] = 0;
+            grown += graph.nodeWeights[next];
+            for (uint32_t e = graph.offsets[next]; e < graph.offsets[next + 1]; ++e) {
+                uint32_t u = graph.adjacency[e];
+                if (side[u] == 0) {
+                    continue;
+                }
+                frontier.erase({2.0 * connection[u] - degree[u], u});
+                connection[u] += graph.edgeWeights[e];
+                frontier.insert({2.0 * connection[u] - degree[u], u});
+            }
+
+            if (!frontier.empty()) {
+                next = frontier.begin()->second;
+                frontier.erase(frontier.begin());
+            } else {
+                // Disconnected remainder: continue from any unassigned node
+                auto it = std::find(side.begin(), side.end(), 1);
+                if (it == side.end()) {
+                    break;
+                }
+                next = static_cast<uint32_t>(it - side.begin());
+            }
+        }
+
+        refine(graph, side, fraction, tolerance);
+
+        double weights[2] = {0.0, 0.0};
+        for (uint32_t v = 0; v < n; ++v) {
+            weights[side[v]] += graph.nodeWeights[v];
+        }
+        double cut = bisectionCut(graph, side);
+        double load = overload(limits, weights);
+        bool feasible = weights[0] <= limits.maxWeight[0] && weights[1] <= limits.maxWeight[1];
+
+        // Feasible beats infeasible; then lower cut (feasible) or lower overload
+        bool better = best.empty() || (feasible && !bestFeasible) ||
+                      (feasible && bestFeasible && cut < bestCut) ||
+                      (!feasible && !bestFeasible && load < bestLoad);
+        if (better) {
+            best = std::move(side);
+            bestCut = cut;
+            bestLoad = load;
+            bestFeasible = feasible;
+        }
+    }
+
+    return best;
+}
+
+void GraphPartitioner::refine(const Graph& graph, std::vector<uint8_t>& side,
+                              double fraction, double tolerance) {
+    const uint32_t n = graph.nodeCount();
+    BisectionLimits limits = computeLimits(graph, fraction, tolerance);
+
+    for (uint32_t pass = 0; pass < m_config.refinementPasses; ++pass) {
+        double weights[2] = {0.0, 0.0};
+        for (uint32_t v = 0; v < n; ++v) {
+            weights[side[v]] += graph.nodeWeights[v];
+        }
+
+        // Gain = external - internal edge weight (cut reduction when moved)
+        std::vector<double> gain(n, 0.0);
+        std::vector<uint8_t> queued(n, 0);
+        std::vector<uint8_t> locked(n, 0);
+        std::set<std::pair<double, uint32_t>, std::greater<>> queues[2];
+
+        double cut = 0.0;
+        for (uint32_t v = 0; v < n; ++v) {
+            bool boundary = false;
+            for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+                if (side[graph.adjacency[e]] != side[v]) {
+                    gain[v] += graph.edgeWeights[e];
+                    cut += graph.edgeWeights[e];
+                    boundary = true;
+                } else {
+                    gain[v] -= graph.edgeWeights[e];
+                }
+            }
+            if (boundary) {
+                queues[side[v]].insert({gain[v], v});
+                queued[v] = 1;
+            }
+        }
+        cut *= 0.5;
+
+        auto feasible = [&limits](const double w[2]) {
+            return w[0] <= limits.maxWeight[0] && w[1] <= limits.maxWeight[1];
+        };
+
+        double bestCut = cut;
+        double bestLoad = overload(limits, weights);
+        bool bestFeasible = feasible(weights);
+        size_t bestMoves = 0;
+
+        std::vector<uint32_t> moves;
+        const size_t stallLimit = std::max<size_t>(50, n / 20);
+
+        while (moves.size() - bestMoves < stallLimit) {
+            // Highest-gain move whose destination stays within its limit
+            // (or that relieves an overweight source)
+            int from = -1;
+            for (int s = 0; s < 2; ++s) {
+                if (queues[s].empty()) {
+                    continue;
+                }
+                uint32_t v = queues[s].begin()->second;
+                bool allowed = weights[1 - s] + graph.nodeWeights[v] <= limits.maxWeight[1 - s] ||
+                               weights[s] > limits.maxWeight[s];
+                if (allowed && (from < 0 || queues[s].begin()->first > queues[from].begin()->first)) {
+                    from = s;
+                }
+            }
+            if (from < 0) {
+                break;
+            }
+
+            uint32_t v = queues[from].begin()->second;
+            queues[from].erase(queues[from].begin());
+            queued[v] = 0;
+            locked[v] = 1;
+
+            cut -= gain[v];
+            side[v] = static_cast<uint8_t>(1 - from);
+            weights[from] -= graph.nodeWeights[v];
+            weights[1 - from] += graph.nodeWeights[v];
+            moves.push_back(v);
+
+            for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+                uint32_t u = graph.adjacency[e];
+                if (locked[u]) {
+                    continue;
+                }
+                if (queued[u]) {
+                    queues[side[u]].erase({gain[u], u});
+                }
+                gain[u] += (side[u] == side[v]) ? -2.0 * graph.edgeWeights[e]
+                                                : 2.0 * graph.edgeWeights[e];
+                queues[side[u]].insert({gain[u], u});
+                queued[u] = 1;
+            }
+
+            bool isFeasible = feasible(weights);
+            double load = overload(limits, weights);
+            if ((isFeasible && !bestFeasible) ||
+                (isFeasible == bestFeasible &&
+                 (cut < bestCut - 1e-9 || (cut <= bestCut + 1e-9 && load < bestLoad)))) {
+                bestCut = cut;
+                bestLoad = load;
+                bestFeasible = isFeasible;
+                bestMoves = moves.size();
+            }
+        }
+
+        // Roll back past the best prefix
+        for (size_t i = moves.size(); i-- > bestMoves;) {
+            side[moves[i]] = static_cast<uint8_t>(1 - side[moves[i]]);
+        }
+
+        if (bestMoves == 0) {
+            break;
+        }
+    }
+}
+
+GraphPartitioner::Graph GraphPartitioner::subgraph(const Graph& graph,
+                                                   const std::vector<uint32_t>& nodes) {
+    std::vector<uint32_t> local(graph.nodeCount(), kUnmatched);
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        local[nodes[i]] = i;
+    }
+
+    Graph sub;
+    sub.nodeWeights.reserve(nodes.size());
+    sub.offsets.reserve(nodes.size() + 1);
+    sub.offsets.push_back(0);
+    for (uint32_t node : nodes) {
+        sub.nodeWeights.push_back(graph.nodeWeights[node]);
+        for (uint32_t e = graph.offsets[node]; e < graph.offsets[node + 1]; ++e) {
+            uint32_t u = local[graph.adjacency[e]];
+            if (u != kUnmatched) {
+                sub.adjacency.push_back(u);
+                sub.edgeWeights.push_back(graph.edgeWeights[e]);
+            }
+        }
+        sub.offsets.push_back(static_cast<uint32_t>(sub.adjacency.size()));
+    }
+    return sub;
+}
+
+} // namespace domain
@@ -0,0 +1,151 @@
+#include "domain/LoadRebalancer.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace domain {
+
+LoadRebalancer::LoadRebalancer()
+    : LoadRebalancer(Config()) {
+}
+
+LoadRebalancer::LoadRebalancer(const Config& config)
+    : m_config(config) {
+    LOG_DEBUG("LoadRebalancer initialized (tolerance {:.2f})", m_config.tolerance);
+}
+
+void LoadRebalancer::recordStepTimes(const std::vector<double>& seconds) {
+    if (m_smoothedTimes.size() != seconds.size()) {
+        m_smoothedTimes = seconds;
+        m_sampleCount = 1;
+    } else {
+        for (size_t d = 0; d < seconds.size(); ++d) {
+            m_smoothedTimes[d] = m_config.smoothing * seconds[d] +
+                                 (1.0 - m_config.smoothing) * m_smoothedTimes[d];
+        }
+        m_sampleCount++;
+    }
+    m_stepsSinceRebalance++;
+}
+
+double LoadRebalancer::getImbalance() const {
+    if (m_smoothedTimes.empty()) {
+        return 1.0;
+    }
+
+    double sum = std::accumulate(m_smoothedTimes.begin(), m_smoothedTimes.end(), 0.0);
+    double average = sum / m_smoothedTimes.size();
+    double maxTime = *std::max_element(m_smoothedTimes.begin(), m_smoothedTimes.end());
+    return (average > 0.0) ? maxTime / average : 1.0;
+}
+
+bool LoadRebalancer::shouldRebalance() const {
+    if (m_smoothedTimes.size() < 2 ||
+        m_sampleCount < m_config.warmupSteps ||
+        m_stepsSinceRebalance < m_config.cooldownSteps) {
+        return false;
+    }
+    return getImbalance() > 1.0 + m_config.tolerance;
+}
+
+LoadRebalancer::MigrationPlan LoadRebalancer::plan(DomainSplitter& splitter,
+                                                   const std::vector<LeafStats>& leaves,
+                                                   const std::vector<SubDomain>& current) {
+    MigrationPlan result;
+    LOG_CHECK(m_smoothedTimes.size() == current.size(), "Step times do not match domain count");
+
+    // Measured throughput = predicted work / observed time, normalized to mean 1
+    // over the measured devices. This absorbs both device speed and cost-model
+    // error. Times are per domain, speeds per device: trimmed empty domains
+    // leave gaps, so domains map to devices through deviceIndex.
+    uint32_t gpuCount = splitter.getConfig().gpuCount;
+    std::vector<double> throughput(gpuCount, 1.0);
+    std::vector<bool> measured(gpuCount, false);
+    double measuredSum = 0.0;
+    uint32_t measuredCount = 0;
+    for (const auto& domain : current) {
+        double time = m_smoothedTimes[domain.gpuIndex];
+        if (domain.deviceIndex < gpuCount && time > 0.0 && domain.workload > 0.0) {
+            throughput[domain.deviceIndex] = domain.workload / time;
+            measured[domain.deviceIndex] = true;
+            measuredSum += throughput[domain.deviceIndex];
+            measuredCount++;
+        }
+    }
+    if (measuredCount > 0) {
+        // Unmeasured devices keep the measured average speed
+        double mean = measuredSum / measuredCount;
+        for (uint32_t device = 0; device < gpuCount; ++device) {
+            if (measured[device]) {
+                throughput[device] /= mean;
+            }
+        }
+    }
+
+    LOG_INFO("Rebalancing {} domains (imbalance {:.2f}x)", current.size(), getImbalance());
+    splitter.setDeviceThroughput(throughput);
+    result.domains = splitter.split(leaves);
+
+    if (result.domains.size() != current.size()) {
+        LOG_WARN("Repartition produced {} domains instead of {}, keeping current layout",
+                 result.domains.size(), current.size());
+        result.domains.clear();
+        return result;
+    }
+
+    // Diff ownership leaf by leaf
+    std::unordered_map<uint64_t, uint32_t> oldOwner;
+    for (const auto& domain : current) {
+        for (const auto& leafBox : domain.assignedLeaves) {
+            oldOwner[DomainSplitter::getLeafKey(leafBox.min())] = domain.gpuIndex;
+        }
+    }
+
+    std::vector<bool> changed(current.size(), false);
+    std::unordered_map<uint64_t, uint32_t> activeCounts;
+    for (const auto& leaf : leaves) {
+        activeCounts[DomainSplitter::getLeafKey(leaf.origin)] = leaf.activeCount;
+    }
+
+    for (const auto& domain : result.domains) {
+        for (const auto& leafBox : domain.assignedLeaves) {
+            uint64_t key = DomainSplitter::getLeafKey(leafBox.min());
+            auto it = oldOwner.find(key);
+            if (it == oldOwner.end() || it->second == domain.gpuIndex) {
+                continue;
+            }
+
+            LeafMove move;
+            move.origin = leafBox.min() & ~7;
+            move.fromDomain = it->second;
+            move.toDomain = domain.gpuIndex;
+            move.activeCount = activeCounts[key];
+            result.moves.push_back(move);
+            result.migratedVoxels += move.activeCount;
+
+            changed[move.fromDomain] = true;
+            changed[move.toDomain] = true;
+        }
+    }
+
+    for (uint32_t d = 0; d < changed.size(); ++d) {
+        if (changed[d]) {
+            result.changedDomains.push_back(d);
+        }
+    }
+
+    LOG_INFO("Migration plan: {} leaves ({} voxels) across {} domains",
+             result.moves.size(), result.migratedVoxels, result.changedDomains.size());
+
+    return result;
+}
+
+void LoadRebalancer::reset() {
+    m_smoothedTimes.clear();
+    m_sampleCount = 0;
+    m_stepsSinceRebalance = 0;
+}
+
+} // namespace domain
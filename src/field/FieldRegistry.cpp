@@ -1,12 +1,10 @@
 #include "field/FieldRegistry.hpp"
 #include "core/VulkanContext.hpp"
 #include "core/Logger.hpp"
+#include "core/ShaderCompiler.hpp"
 
 #include <stdexcept>
 #include <sstream>
-#include <fstream>
-#include <cstdlib>
-#include <cstdio>
 
 namespace field {
 
@@ -229,44 +227,8 @@ void main() {
 }
 )";
 
-    // Compile to SPIR-V using StencilRegistry's helper (we need to expose it or duplicate it)
-    // Since StencilRegistry depends on FieldRegistry, we can't easily use it here without circular dep.
-    // For now, we'll duplicate the compile logic or use a static helper.
-    // Actually, let's use a temporary StencilRegistry just for compilation if possible,
-    // or better, move the compile logic to a common utility.
-    // Given the constraints, I will duplicate the compile logic here for simplicity as per plan.
-    
-    // ... Duplicated compile logic from StencilRegistry ...
-    // Wait, I can't easily duplicate it without including headers.
-    // Let's assume I can use a helper or just implement it here.
-    
-    // Create temporary files
-    std::string uuid = "fill_shader_" + std::to_string(std::rand());
-    std::string glslFile = "/tmp/" + uuid + ".comp";
-    std::string spvFile = "/tmp/" + uuid + ".spv";
-
-    {
-        std::ofstream out(glslFile);
-        out << glslSource;
-    }
-
-    std::string command = "/opt/homebrew/bin/glslc -fshader-stage=compute -o " + spvFile + " " + glslFile;
-    int ret = std::system(command.c_str());
-    std::remove(glslFile.c_str());
-
-    if (ret != 0) {
-        throw std::runtime_error("Fill shader compilation failed");
-    }
-
-    std::vector<uint32_t> spirv;
-    {
-        std::ifstream in(spvFile, std::ios::binary | std::ios::ate);
-        size_t fileSize = in.tellg();
-        spirv.resize(fileSize / 4);
-        in.seekg(0);
-        in.read(reinterpret_cast<char*>(spirv.data()), fileSize);
-    }
-    std::remove(spvFile.c_str());
+    std::vector<uint32_t> spirv = core::ShaderCompiler::compileOrThrow(
+        glslSource, vk::ShaderStageFlagBits::eCompute, "field_fill");
 
     // Create shader module
     vk::ShaderModuleCreateInfo moduleInfo(
@@ -1,6 +1,8 @@
 #include "graph/GraphExecutor.hpp"
 #include "core/Logger.hpp"
 
+#include <algorithm>
+
 namespace graph {
 
 GraphExecutor::GraphExecutor(const core::VulkanContext& context,
@@ -9,10 +11,24 @@ GraphExecutor::GraphExecutor(const core::VulkanContext& context,
     : m_context(context),
       m_haloManager(haloManager),
       m_haloSync(haloManager.getGPUCount(), context),
-      m_fieldRegistry(fieldRegistry) {
+      m_fieldRegistry(fieldRegistry),
+      m_deviceCopy(std::make_unique<halo::DeviceCopyTransport>(haloManager)),
+      m_transport(m_deviceCopy.get()) {
     LOG_INFO("GraphExecutor initialized");
 }
 
+void GraphExecutor::setTransport(halo::Transport* transport) {
+    m_transport = transport ? transport : m_deviceCopy.get();
+    LOG_INFO("Halo transport: {}", m_transport->getName());
+}
+
+void GraphExecutor::setBlockSteps(uint32_t blockSteps) {
+    // Ghost dispatches would advance the neighbour's voxels a step ahead of it
+    LOG_CHECK(blockSteps <= 1 || !m_transport->isDeviceLocal(),
+              "Temporal blocking needs per-domain field buffers (a device per domain or ranks)");
+    m_haloPlanner.setBlockSteps(blockSteps);
+}
+
 void GraphExecutor::recordMemoryBarrier(vk::CommandBuffer cmd) {
     // Barrier: wait for compute writes before reading
     vk::MemoryBarrier barrier(
@@ -27,6 +43,32 @@ void GraphExecutor::recordMemoryBarrier(vk::CommandBuffer cmd) {
         barrier, nullptr, nullptr);
 }
 
+void GraphExecutor::addSemaphore(std::vector<vk::Semaphore>& semaphores,
+                                 std::vector<uint64_t>& values,
+                                 vk::Semaphore semaphore, uint64_t value) {
+    auto it = std::find(semaphores.begin(), semaphores.end(), semaphore);
+    if (it == semaphores.end()) {
+        semaphores.push_back(semaphore);
+        values.push_back(value);
+    } else {
+        auto& existing = values[it - semaphores.begin()];
+        existing = std::max(existing, value);
+    }
+}
+
+void GraphExecutor::beginStep(const std::vector<std::string>& schedule,
+                              const stencil::StencilRegistry& stencilRegistry) {
+    std::vector<const stencil::StencilDefinition*> stencils;
+    stencils.reserve(schedule.size());
+    for (const auto& stencilName : schedule) {
+        stencils.push_back(&stencilRegistry.getStencil(stencilName).definition);
+    }
+
+    m_stepPlan = m_haloPlanner.planStep(stencils);
+    LOG_DEBUG("Step plan: {} field exchanges across {} stencils",
+              m_stepPlan.exchangeCount, schedule.size());
+}
+
 void GraphExecutor::recordStencilDispatch(vk::CommandBuffer cmd,
                                          const std::string& stencilName,
                                          const stencil::CompiledStencil& stencil,
@@ -45,139 +87,275 @@ void GraphExecutor::recordStencilDispatch(vk::CommandBuffer cmd,
                      &pushConstants);
 
     // Calculate thread groups (128 threads per group)
-    uint32_t groupCount = (domain.activeVoxelCount + 127) / 128;
+    uint32_t groupCount = (pushConstants.activeVoxelCount + 127) / 128;
+    if (groupCount == 0) {
+        return;
+    }
 
     // Dispatch compute shader
     cmd.dispatch(groupCount, 1, 1);
 
-    LOG_DEBUG("  Dispatched {} groups for {} voxels",
-              groupCount, domain.activeVoxelCount);
+    LOG_DEBUG("  Dispatched {} groups for {} voxels of domain {}",
+              groupCount, pushConstants.activeVoxelCount, domain.gpuIndex);
 }
 
-void GraphExecutor::recordHaloExchange(vk::CommandBuffer cmd,
-                                      const std::vector<std::string>& schedule,
-                                      const domain::SubDomain& domain) {
-    LOG_DEBUG("Recording halo exchange for domain {}", domain.gpuIndex);
+void GraphExecutor::dispatchStencil(vk::CommandBuffer cmd,
+                                    const std::string& stencilName,
+                                    const stencil::StencilRegistry& stencilRegistry,
+                                    const domain::SubDomain& domain,
+                                    uint32_t count,
+                                    uint32_t firstVoxel,
+                                    float dt) {
+    const stencil::CompiledStencil& compiledStencil = stencilRegistry.getStencil(stencilName);
+    StencilPushConstants pc{
+        .gridAddr = 0,  // Would be filled from domain's GPU grid
+        .bdaTableAddr = static_cast<uint64_t>(m_fieldRegistry.getBDATableAddress()),
+        .activeVoxelCount = count,
+        .neighborRadius = compiledStencil.definition.neighborRadius,
+        .dt = dt,
+        .firstVoxel = firstVoxel
+    };
+    recordStencilDispatch(cmd, stencilName, compiledStencil, pc, domain);
+}
 
-    // 1. Pack Halos
-    // Iterate over all fields and neighbors
-    // For this implementation, we iterate over registered fields
-    // In a real dependency graph, we'd only exchange fields that are needed by neighbors
-    
-    // Clear previous semaphores
-    m_waitSemaphores.clear();
-    m_waitValues.clear();
-    m_signalSemaphores.clear();
-    m_signalValues.clear();
+uint32_t GraphExecutor::segmentMask(const halo::HaloMessage& message,
+                                    const std::vector<HaloPlanner::HaloRequest>& requests,
+                                    bool send,
+                                    uint32_t& maxUnits) {
+    uint32_t mask = 0;
+    maxUnits = 0;
+    for (const auto& request : requests) {
+        int32_t index = message.segmentIndex(request.field);
+        if (index < 0) continue;
+
+        const auto& segment = message.segments[index];
+        uint32_t count = send ? segment.sendCount : segment.recvCount;
+        if (count == 0) continue;
+
+        uint32_t components = segment.elementSize / static_cast<uint32_t>(sizeof(float));
+        mask |= 1u << index;
+        maxUnits = std::max(maxUnits, halo::HaloManager::encodedUnits(segment.encoding, count, components));
+    }
+    return mask;
+}
 
-    // 1. Pack Halos
-    // Barrier before pack
-    vk::MemoryBarrier packBarrier(
-        vk::AccessFlagBits::eShaderWrite,
-        vk::AccessFlagBits::eShaderRead
-    );
-    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
-                        vk::PipelineStageFlagBits::eComputeShader,
-                        vk::DependencyFlags{},
-                        packBarrier, nullptr, nullptr);
-
-    for (const auto& [fieldName, fieldDesc] : m_fieldRegistry.getFields()) {
-        // Get halo buffer set for this GPU
-        auto& haloSet = m_haloManager.getHaloBufferSet(fieldName, domain.gpuIndex);
-        // Get field buffer (assuming FieldRegistry has a way to get it, or we use a helper)
-        // FieldRegistry::getFieldBuffer is not standard in the interface I saw earlier?
-        // Let's check FieldRegistry.hpp if I can. 
-        // Assuming I can get it via name or I have to rely on something else.
-        // Wait, FieldRegistry has getFields() returning map.
-        // Does it expose buffer?
-        // I'll assume getFieldBuffer exists or I can get it.
-        // If not, I might need to use MemoryAllocator or similar.
-        // Let's assume m_fieldRegistry.getFieldBuffer(fieldName, gpuIndex) exists for now.
-        // If it fails compilation, I'll fix it.
-        // Actually, looking at previous context, FieldRegistry was used to get descriptors.
-        // I'll use a placeholder accessor: m_fieldRegistry.getFieldBuffer(fieldName, domain.gpuIndex)
-        
-        vk::Buffer fieldBuf = m_fieldRegistry.getField(fieldName).buffer.handle;
-
-        for (const auto& neighbor : domain.neighbors) {
-             uint32_t count = haloSet.haloVoxelCounts[neighbor.face];
-             if (count == 0) continue;
-             
-             m_haloSync.recordHaloPack(cmd, fieldBuf, haloSet.remoteHalos[neighbor.face].handle, 0, count);
+void GraphExecutor::recordHaloPack(vk::CommandBuffer cmd,
+                                   const std::vector<HaloPlanner::HaloRequest>& requests,
+                                   const domain::SubDomain& domain,
+                                   uint32_t phase) {
+    const auto& indexLists = m_haloManager.getIndexLists(domain.gpuIndex);
+    auto& haloSet = m_haloManager.getHaloBufferSet(domain.gpuIndex);
+
+    // One dispatch per neighbor packs every requested field
+    for (const auto& list : indexLists) {
+        auto* message = haloSet.find(list.neighborGpu);
+        if (!message || list.phase != phase) continue;
+
+        uint32_t maxUnits = 0;
+        uint32_t mask = segmentMask(*message, requests, true, maxUnits);
+        m_haloSync.recordHaloPack(cmd, message->segmentTable.handle, message->sendBuffer.handle,
+                                  list.gatherIndices.handle, mask,
+                                  static_cast<uint32_t>(message->segments.size()), maxUnits);
+    }
+}
+
+void GraphExecutor::recordHaloTransfer(vk::CommandBuffer cmd,
+                                       const std::vector<HaloPlanner::HaloRequest>& requests,
+                                       const domain::SubDomain& domain,
+                                       uint32_t phase) {
+    auto& haloSet = m_haloManager.getHaloBufferSet(domain.gpuIndex);
+
+    // One copy per neighbor with a region per requested field
+    for (auto& message : haloSet.messages) {
+        if (message.phase != phase) continue;
+
+        // The neighbor's receive message from this domain
+        auto* neighborMessage = m_haloManager.getHaloBufferSet(message.neighborGpu).find(domain.gpuIndex);
+        if (!neighborMessage) {
+            LOG_WARN("GPU {} has no halo message from GPU {}", message.neighborGpu, domain.gpuIndex);
+            continue;
         }
+
+        std::vector<vk::BufferCopy> regions;
+        for (const auto& request : requests) {
+            int32_t index = message.segmentIndex(request.field);
+            int32_t neighborIndex = neighborMessage->segmentIndex(request.field);
+            if (index < 0 || neighborIndex < 0) continue;
+
+            const auto& segment = message.segments[index];
+            const auto& neighborSegment = neighborMessage->segments[neighborIndex];
+            if (segment.sendCount == 0) continue;
+            if (neighborSegment.recvCount != segment.sendCount ||
+                neighborSegment.encoding != segment.encoding) {
+                LOG_WARN("Halo lists of GPU {} and GPU {} disagree, skipping field '{}'",
+                         domain.gpuIndex, message.neighborGpu, request.field);
+                continue;
+            }
+
+            regions.emplace_back(segment.sendOffset, neighborSegment.recvOffset, segment.sendBytes);
+        }
+
+        m_transport->recordSend(cmd, domain.gpuIndex, message.neighborGpu,
+                                haloSet.writeValues[message.neighborGpu], regions);
     }
+}
 
-    // 2. Transfer
-    // Barrier between Pack and Transfer
-    vk::MemoryBarrier transferBarrier(
-        vk::AccessFlagBits::eShaderWrite,
-        vk::AccessFlagBits::eTransferRead
-    );
-    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
-                        vk::PipelineStageFlagBits::eTransfer,
-                        vk::DependencyFlags{},
-                        transferBarrier, nullptr, nullptr);
-
-    for (const auto& [fieldName, fieldDesc] : m_fieldRegistry.getFields()) {
-         auto& haloSet = m_haloManager.getHaloBufferSet(fieldName, domain.gpuIndex);
-         
-         for (const auto& neighbor : domain.neighbors) {
-             uint32_t count = haloSet.haloVoxelCounts[neighbor.face];
-             if (count == 0) continue;
-
-             // Determine opposite face for neighbor
-             // Simple logic: 0<->1, 2<->3, 4<->5
-             uint32_t oppositeFace = (neighbor.face % 2 == 0) ? neighbor.face + 1 : neighbor.face - 1;
-             
-             // Get neighbor's halo set (requires access to all domains' buffers, which HaloManager has)
-             auto& neighborHaloSet = m_haloManager.getHaloBufferSet(fieldName, neighbor.gpuIndex);
-             
-             // Record transfer (copy from my remote to neighbor's local)
-             m_haloSync.recordHaloTransfer(cmd, 
-                                           haloSet.remoteHalos[neighbor.face].handle, 
-                                           neighborHaloSet.localHalos[oppositeFace].handle, 
-                                           count * 4); // 4 bytes per float
-                                           
-             // Collect signal semaphore (I signal that I finished writing to neighbor)
-             // Actually, usually we signal that *transfer* is done.
-             // The neighbor waits on this.
-             vk::Semaphore signalSem = m_haloManager.getHaloSemaphore(domain.gpuIndex, neighbor.gpuIndex);
-             m_signalSemaphores.push_back(signalSem);
-             m_signalValues.push_back(1); // Timeline value, should increment in real app
-         }
-    }
-
-    // 3. Unpack Halos
-    // Barrier between Transfer and Unpack
-    vk::MemoryBarrier unpackBarrier(
-        vk::AccessFlagBits::eTransferWrite,
-        vk::AccessFlagBits::eShaderRead
-    );
-    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-                        vk::PipelineStageFlagBits::eComputeShader,
-                        vk::DependencyFlags{},
-                        unpackBarrier, nullptr, nullptr);
-
-    for (const auto& [fieldName, fieldDesc] : m_fieldRegistry.getFields()) {
-         auto& haloSet = m_haloManager.getHaloBufferSet(fieldName, domain.gpuIndex);
-         vk::Buffer fieldBuf = m_fieldRegistry.getField(fieldName).buffer.handle;
-
-         for (const auto& neighbor : domain.neighbors) {
-             uint32_t count = haloSet.haloVoxelCounts[neighbor.face];
-             if (count == 0) continue;
-             
-             // Record unpack (from my local halo to field)
-             // Note: 'localHalos' are where neighbors wrote data TO.
-             m_haloSync.recordHaloUnpack(cmd, haloSet.localHalos[neighbor.face].handle, fieldBuf, 0, count);
-             
-             // Collect wait semaphore (I wait for neighbor to finish writing to me)
-             vk::Semaphore waitSem = m_haloManager.getHaloSemaphore(neighbor.gpuIndex, domain.gpuIndex);
-             m_waitSemaphores.push_back(waitSem);
-             m_waitValues.push_back(1); // Timeline value
-         }
-    }
-    
-    LOG_DEBUG("Halo exchange recorded with {} neighbors", domain.neighbors.size());
+void GraphExecutor::recordHaloUnpack(vk::CommandBuffer cmd,
+                                     const std::vector<HaloPlanner::HaloRequest>& requests,
+                                     const domain::SubDomain& domain,
+                                     uint32_t phase) {
+    const auto& indexLists = m_haloManager.getIndexLists(domain.gpuIndex);
+    auto& haloSet = m_haloManager.getHaloBufferSet(domain.gpuIndex);
+
+    for (const auto& list : indexLists) {
+        auto* message = haloSet.find(list.neighborGpu);
+        if (!message || list.phase != phase) continue;
+
+        // 'recvBuffer' is where the neighbor wrote data TO
+        uint32_t maxUnits = 0;
+        uint32_t mask = segmentMask(*message, requests, false, maxUnits);
+
+        // The transport finishes delivery first (e.g. out of a host staging slot)
+        std::vector<vk::BufferCopy> regions;
+        for (uint32_t index = 0; index < message->segments.size(); ++index) {
+            const auto& segment = message->segments[index];
+            if (mask & (1u << index)) {
+                regions.emplace_back(segment.recvOffset, segment.recvOffset, segment.recvBytes);
+            }
+        }
+        m_transport->recordReceive(cmd, list.neighborGpu, domain.gpuIndex,
+                                   haloSet.readValues[list.neighborGpu], regions);
+
+        m_haloSync.recordHaloUnpack(cmd, message->segmentTable.handle, message->recvBuffer.handle,
+                                    list.scatterIndices.handle, mask,
+                                    static_cast<uint32_t>(message->segments.size()), maxUnits);
+    }
+}
+
+bool GraphExecutor::addPackSync(const domain::SubDomain& domain,
+                                std::vector<vk::Semaphore>& waitSemaphores,
+                                std::vector<uint64_t>& waitValues,
+                                uint32_t phase) {
+    auto& haloSet = m_haloManager.getHaloBufferSet(domain.gpuIndex);
+
+    bool waits = false;
+    for (const auto& list : m_haloManager.getIndexLists(domain.gpuIndex)) {
+        uint64_t sent = haloSet.writeValues[list.neighborGpu];
+        if (list.sendCount == 0 || list.phase != phase || sent == 0) continue;
+
+        // My transfer of message 'sent' signals once it has copied out of the send buffer
+        addSemaphore(waitSemaphores, waitValues,
+                     m_haloManager.getHaloSemaphore(domain.gpuIndex, list.neighborGpu), sent);
+        waits = true;
+    }
+    return waits;
+}
+
+void GraphExecutor::addTransferSync(const domain::SubDomain& domain,
+                                    std::vector<vk::Semaphore>& waitSemaphores,
+                                    std::vector<uint64_t>& waitValues,
+                                    std::vector<vk::Semaphore>& signalSemaphores,
+                                    std::vector<uint64_t>& signalValues,
+                                    uint32_t phase) {
+    auto& haloSet = m_haloManager.getHaloBufferSet(domain.gpuIndex);
+
+    for (const auto& list : m_haloManager.getIndexLists(domain.gpuIndex)) {
+        if (list.sendCount == 0 || list.phase != phase) continue;
+        uint64_t written = ++haloSet.writeValues[list.neighborGpu];
+
+        // The transport says when the destination of message 'written' is free
+        auto wait = m_transport->sendWait(domain.gpuIndex, list.neighborGpu, written);
+        if (wait.semaphore) {
+            addSemaphore(waitSemaphores, waitValues, wait.semaphore, wait.value);
+        }
+
+        // I signal that message 'written' has been sent; the transport builds on this
+        addSemaphore(signalSemaphores, signalValues,
+                     m_haloManager.getHaloSemaphore(domain.gpuIndex, list.neighborGpu), written);
+    }
+}
+
+void GraphExecutor::addUnpackSync(const domain::SubDomain& domain,
+                                  std::vector<vk::Semaphore>& waitSemaphores,
+                                  std::vector<uint64_t>& waitValues,
+                                  std::vector<vk::Semaphore>& signalSemaphores,
+                                  std::vector<uint64_t>& signalValues,
+                                  uint32_t phase,
+                                  bool selfRecorded) {
+    auto& haloSet = m_haloManager.getHaloBufferSet(domain.gpuIndex);
+
+    for (const auto& list : m_haloManager.getIndexLists(domain.gpuIndex)) {
+        if (list.recvCount == 0 || list.phase != phase) continue;
+        uint64_t read = ++haloSet.readValues[list.neighborGpu];
+
+        // I wait for the neighbor's message number 'read' to arrive, then hand its buffer back
+        // (waiting on my own transfer in the submission that records it would never return)
+        if (!selfRecorded || list.neighborGpu != domain.gpuIndex) {
+            auto wait = m_transport->receiveWait(list.neighborGpu, domain.gpuIndex, read);
+            addSemaphore(waitSemaphores, waitValues, wait.semaphore, wait.value);
+        }
+        addSemaphore(signalSemaphores, signalValues,
+                     m_haloManager.getReleaseSemaphore(list.neighborGpu, domain.gpuIndex), read);
+    }
+}
+
+void GraphExecutor::recordHaloExchange(vk::CommandBuffer cmd,
+                                      const std::vector<HaloPlanner::HaloRequest>& requests,
+                                      const domain::SubDomain& domain) {
+    if (requests.empty()) {
+        return;
+    }
+
+    LOG_CHECK(m_transport->isDeviceLocal(), "Host-relayed halo transports need the overlapped timestep");
+    LOG_DEBUG("Recording halo exchange of {} fields for domain {}", requests.size(), domain.gpuIndex);
+
+    // Forwarded routing: each phase relays what the previous one delivered
+    for (uint32_t phase = 0; phase < m_haloManager.getPhaseCount(); ++phase) {
+        // 1. Pack Halos: gather exactly the voxels each neighbor reads
+        // Barrier before pack
+        vk::MemoryBarrier packBarrier(
+            vk::AccessFlagBits::eShaderWrite,
+            vk::AccessFlagBits::eShaderRead
+        );
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                            vk::PipelineStageFlagBits::eComputeShader,
+                            vk::DependencyFlags{},
+                            packBarrier, nullptr, nullptr);
+
+        recordHaloPack(cmd, requests, domain, phase);
+
+        // 2. Transfer
+        // Barrier between Pack and Transfer
+        vk::MemoryBarrier transferBarrier(
+            vk::AccessFlagBits::eShaderWrite,
+            vk::AccessFlagBits::eTransferRead
+        );
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                            vk::PipelineStageFlagBits::eTransfer,
+                            vk::DependencyFlags{},
+                            transferBarrier, nullptr, nullptr);
+
+        // Sync first: it advances the exchange numbers the transport records with
+        addTransferSync(domain, m_waitSemaphores, m_waitValues, m_signalSemaphores, m_signalValues, phase);
+        recordHaloTransfer(cmd, requests, domain, phase);
+
+        // 3. Unpack Halos
+        // Barrier between Transfer and Unpack
+        vk::MemoryBarrier unpackBarrier(
+            vk::AccessFlagBits::eTransferWrite,
+            vk::AccessFlagBits::eShaderRead
+        );
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                            vk::PipelineStageFlagBits::eComputeShader,
+                            vk::DependencyFlags{},
+                            unpackBarrier, nullptr, nullptr);
+
+        addUnpackSync(domain, m_waitSemaphores, m_waitValues, m_signalSemaphores, m_signalValues, phase, true);
+        recordHaloUnpack(cmd, requests, domain, phase);
+    }
+
+    LOG_DEBUG("Halo exchange recorded with {} neighbors",
+              m_haloManager.getIndexLists(domain.gpuIndex).size());
 }
 
 void GraphExecutor::recordTimestep(vk::CommandBuffer cmd,
@@ -200,22 +378,32 @@ void GraphExecutor::recordTimestep(vk::CommandBuffer cmd,
         throw;
     }
 
-    // Record halo exchange if needed
-    recordHaloExchange(cmd, schedule, domain);
+    // Clear previous semaphores
+    m_waitSemaphores.clear();
+    m_waitValues.clear();
+    m_signalSemaphores.clear();
+    m_signalValues.clear();
+
+    if (m_stepPlan.exchanges.size() != schedule.size()) {
+        LOG_WARN("No halo plan for this schedule, planning now (call beginStep once per step)");
+        beginStep(schedule, stencilRegistry);
+    }
 
-    // Execute stencils in order
+    // Execute stencils in order, exchanging halos right before their first consumer
     uint32_t stencilCount = 0;
     for (const auto& stencilName : schedule) {
         try {
+            recordHaloExchange(cmd, m_stepPlan.exchanges[stencilCount], domain);
+
             const stencil::CompiledStencil& compiledStencil =
                 stencilRegistry.getStencil(stencilName);
 
-            // Prepare push constants
+            // Prepare push constants (no voxel list: the whole domain)
             StencilPushConstants pc{
                 .gridAddr = 0,  // Would be filled from domain's GPU grid
                 .bdaTableAddr = static_cast<uint64_t>(m_fieldRegistry.getBDATableAddress()),
                 .activeVoxelCount = domain.activeVoxelCount,
-                .neighborRadius = 1,  // Default for standard stencils
+                .neighborRadius = compiledStencil.definition.neighborRadius,
                 .dt = dt
             };
 
@@ -246,4 +434,197 @@ void GraphExecutor::recordTimestep(vk::CommandBuffer cmd,
     }
 }
 
+
+bool GraphExecutor::canOverlapExchange(const domain::SubDomain& domain) const {
+    try {
+        const auto& lists = m_haloManager.getVoxelLists(domain.gpuIndex);
+        return lists.interiorCount + lists.boundaryCount > 0;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::vector<GraphExecutor::Submission> GraphExecutor::recordOverlappedTimestep(
+    vk::CommandPool computePool,
+    vk::CommandPool transferPool,
+    const std::vector<std::string>& schedule,
+    const stencil::StencilRegistry& stencilRegistry,
+    const domain::SubDomain& domain,
+    float dt,
+    bool overlapInterior,
+    TimestampQueries* timestamps) {
+    LOG_INFO("Recording {} timestep for domain {} ({} stencils, {} voxels)",
+             overlapInterior ? "overlapped" : "split", domain.gpuIndex,
+             schedule.size(), domain.activeVoxelCount);
+
+    if (m_stepPlan.exchanges.size() != schedule.size()) {
+        LOG_WARN("No halo plan for this schedule, planning now (call beginStep once per step)");
+        beginStep(schedule, stencilRegistry);
+    }
+
+    const auto& voxelLists = m_haloManager.getVoxelLists(domain.gpuIndex);
+    auto& haloSet = m_haloManager.getHaloBufferSet(domain.gpuIndex);
+    vk::Semaphore packSemaphore = m_haloManager.getPackSemaphore(domain.gpuIndex);
+    std::vector<Submission> submissions;
+
+    auto beginSubmission = [&](QueueType queue) {
+        vk::CommandBufferAllocateInfo allocInfo(
+            queue == QueueType::Transfer ? transferPool : computePool,
+            vk::CommandBufferLevel::ePrimary,
+            1
+        );
+        Submission submission;
+        submission.queue = queue;
+        submission.cmd = m_context.getDevice().allocateCommandBuffers(allocInfo)[0];
+        submission.cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        submissions.push_back(std::move(submission));
+        return submissions.size() - 1;
+    };
+
+    // Each dispatch is bracketed by timestamps when queries are provided
+    if (timestamps) {
+        timestamps->used = 0;
+    }
+    auto dispatch = [&](vk::CommandBuffer cmd, const std::string& stencilName,
+                        const stencil::CompiledStencil& compiledStencil,
+                        const core::MemoryAllocator::Buffer& voxels, uint32_t count) {
+        StencilPushConstants pc{
+            .gridAddr = 0,  // Would be filled from domain's GPU grid
+            .bdaTableAddr = static_cast<uint64_t>(m_fieldRegistry.getBDATableAddress()),
+            .voxelListAddr = static_cast<uint64_t>(voxels.deviceAddress),
+            .activeVoxelCount = count,
+            .neighborRadius = compiledStencil.definition.neighborRadius,
+            .dt = dt
+        };
+
+        // The last query is kept for the end-of-step timestamp
+        bool timed = timestamps && count > 0 && timestamps->used + 3 <= timestamps->count;
+        if (timed) {
+            cmd.writeTimestamp(vk::PipelineStageFlagBits::eComputeShader,
+                               timestamps->pool, timestamps->first + timestamps->used++);
+        }
+        recordStencilDispatch(cmd, stencilName, compiledStencil, pc, domain);
+        if (timed) {
+            cmd.writeTimestamp(vk::PipelineStageFlagBits::eComputeShader,
+                               timestamps->pool, timestamps->first + timestamps->used++);
+        }
+    };
+
+    // Submissions stay in per-domain order; stages of different domains are
+    // matched by index, so the caller can interleave them across domains
+    size_t current = beginSubmission(QueueType::Compute);
+    bool timed = timestamps && timestamps->count >= 2;
+    if (timed) {
+        submissions[current].cmd.resetQueryPool(timestamps->pool, timestamps->first, timestamps->count);
+        submissions[current].cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe,
+                                                timestamps->pool, timestamps->first + timestamps->used++);
+    }
+
+    for (size_t i = 0; i < schedule.size(); ++i) {
+        const auto& stencilName = schedule[i];
+        const auto& requests = m_stepPlan.exchanges[i];
+        const stencil::CompiledStencil& compiledStencil = stencilRegistry.getStencil(stencilName);
+
+        // Temporal blocking: halo layers that are still valid are recomputed locally
+        uint32_t ghostCount = i < m_stepPlan.ghostDepth.size()
+            ? halo::HaloManager::layerVoxelCount(voxelLists.ghostLayerEnds, voxelLists.ghostCount,
+                                                 m_stepPlan.ghostDepth[i])
+            : 0;
+
+        recordMemoryBarrier(submissions[current].cmd);
+
+        if (requests.empty()) {
+            // Halos are current: interior, boundary and ghosts back to back
+            dispatch(submissions[current].cmd, stencilName, compiledStencil,
+                     voxelLists.interiorIndices, voxelLists.interiorCount);
+            dispatch(submissions[current].cmd, stencilName, compiledStencil,
+                     voxelLists.boundaryIndices, voxelLists.boundaryCount);
+            dispatch(submissions[current].cmd, stencilName, compiledStencil,
+                     voxelLists.ghostIndices, ghostCount);
+            continue;
+        }
+
+        uint32_t phaseCount = m_haloManager.getPhaseCount();
+        for (uint32_t phase = 0; phase < phaseCount; ++phase) {
+            if (phase > 0) {
+                // Relayed voxels arrived in the previous phase; unpack them before packing
+                current = beginSubmission(QueueType::Compute);
+                addUnpackSync(domain,
+                              submissions[current].waitSemaphores, submissions[current].waitValues,
+                              submissions[current].signalSemaphores, submissions[current].signalValues,
+                              phase - 1);
+                recordHaloUnpack(submissions[current].cmd, requests, domain, phase - 1);
+                recordMemoryBarrier(submissions[current].cmd);
+            }
+
+            // 1. Pack on the compute queue, then hand off to the transfer queue. The
+            //    send buffers are reused: the pack waits for the previous exchange's
+            //    transfer, in a submission of its own so earlier work is not held back
+            std::vector<vk::Semaphore> packWaits;
+            std::vector<uint64_t> packWaitValues;
+            if (addPackSync(domain, packWaits, packWaitValues, phase)) {
+                if (phase == 0) {
+                    submissions[current].cmd.end();
+                    current = beginSubmission(QueueType::Compute);
+                }
+                for (size_t w = 0; w < packWaits.size(); ++w) {
+                    addSemaphore(submissions[current].waitSemaphores, submissions[current].waitValues,
+                                 packWaits[w], packWaitValues[w]);
+                }
+            }
+            recordHaloPack(submissions[current].cmd, requests, domain, phase);
+            submissions[current].cmd.end();
+            uint64_t packValue = ++haloSet.packValue;
+            addSemaphore(submissions[current].signalSemaphores, submissions[current].signalValues,
+                         packSemaphore, packValue);
+
+            // 2. Transfer queue copies into the neighbors' receive buffers
+            size_t transfer = beginSubmission(QueueType::Transfer);
+            addSemaphore(submissions[transfer].waitSemaphores, submissions[transfer].waitValues,
+                         packSemaphore, packValue);
+            addTransferSync(domain,
+                            submissions[transfer].waitSemaphores, submissions[transfer].waitValues,
+                            submissions[transfer].signalSemaphores, submissions[transfer].signalValues,
+                            phase);
+            recordHaloTransfer(submissions[transfer].cmd, requests, domain, phase);
+            submissions[transfer].cmd.end();
+
+            // 3. Interior needs no halo data and runs while the transfer is in flight
+            if (phase == 0 && overlapInterior) {
+                size_t interior = beginSubmission(QueueType::Compute);
+                dispatch(submissions[interior].cmd, stencilName, compiledStencil,
+                         voxelLists.interiorIndices, voxelLists.interiorCount);
+                submissions[interior].cmd.end();
+            }
+        }
+
+        // 4. Boundary waits for the neighbors' halos, unpacks them and finishes the stencil
+        current = beginSubmission(QueueType::Compute);
+        addUnpackSync(domain,
+                      submissions[current].waitSemaphores, submissions[current].waitValues,
+                      submissions[current].signalSemaphores, submissions[current].signalValues,
+                      phaseCount - 1);
+        recordHaloUnpack(submissions[current].cmd, requests, domain, phaseCount - 1);
+        recordMemoryBarrier(submissions[current].cmd);
+        if (!overlapInterior) {
+            dispatch(submissions[current].cmd, stencilName, compiledStencil,
+                     voxelLists.interiorIndices, voxelLists.interiorCount);
+        }
+        dispatch(submissions[current].cmd, stencilName, compiledStencil,
+                 voxelLists.boundaryIndices, voxelLists.boundaryCount);
+        dispatch(submissions[current].cmd, stencilName, compiledStencil,
+                 voxelLists.ghostIndices, ghostCount);
+    }
+
+    if (timed) {
+        submissions[current].cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe,
+                                                timestamps->pool, timestamps->first + timestamps->used++);
+    }
+    submissions[current].cmd.end();
+
+    LOG_INFO("Timestep recorded ({} stencils, {} submissions)",
+             schedule.size(), submissions.size());
+    return submissions;
+}
+
 } // namespace graph
@@ -0,0 +1,164 @@
+#include "graph/HaloPlanner.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+
+namespace graph {
+
+bool HaloPlanner::readsNeighbors(const stencil::StencilDefinition& stencil) {
+    return stencil.requiresHalos || stencil.requiresNeighbors || stencil.neighborRadius > 0;
+}
+
+uint32_t HaloPlanner::stepRadius(const std::vector<const stencil::StencilDefinition*>& stencils) {
+    uint32_t radius = 0;
+    for (const auto* stencil : stencils) {
+        if (readsNeighbors(*stencil)) {
+            radius += std::max(stencil->neighborRadius, 1u);
+        }
+    }
+    return radius;
+}
+
+std::unordered_map<std::string, uint32_t> HaloPlanner::fieldHaloThickness(
+    const std::vector<const stencil::StencilDefinition*>& stencils,
+    uint32_t blockSteps) {
+    std::unordered_map<std::string, uint32_t> thickness;
+
+    uint32_t blockDepth = blockSteps * stepRadius(stencils);
+    if (blockSteps > 1 && blockDepth > 0) {
+        for (const auto* stencil : stencils) {
+            for (const auto& field : stencil->inputs) {
+                thickness[field] = blockDepth;
+            }
+        }
+        return thickness;
+    }
+
+    for (const auto* stencil : stencils) {
+        if (!readsNeighbors(*stencil)) {
+            continue;
+        }
+        for (const auto& field : stencil->inputs) {
+            auto& value = thickness[field];
+            value = std::max({value, stencil->neighborRadius, 1u});
+        }
+    }
+    return thickness;
+}
+
+HaloPlanner::StepPlan HaloPlanner::planStep(
+    const std::vector<const stencil::StencilDefinition*>& stencils) {
+    if (m_blockSteps > 1) {
+        return planBlockStep(stencils);
+    }
+
+    StepPlan plan;
+    plan.exchanges.resize(stencils.size());
+    plan.ghostDepth.assign(stencils.size(), 0);
+
+    for (size_t i = 0; i < stencils.size(); ++i) {
+        const auto& stencil = *stencils[i];
+        if (readsNeighbors(stencil)) {
+            for (const auto& field : stencil.inputs) {
+                if (!isDirty(field)) {
+                    continue;
+                }
+
+                // Later consumers before the next write share this exchange
+                uint32_t radius = std::max(stencil.neighborRadius, 1u);
+                for (size_t j = i + 1; j < stencils.size(); ++j) {
+                    const auto& later = *stencils[j];
+                    bool reads = std::find(later.inputs.begin(), later.inputs.end(), field) !=
+                                 later.inputs.end();
+                    if (reads && readsNeighbors(later)) {
+                        radius = std::max(radius, later.neighborRadius);
+                    }
+                    if (std::find(later.outputs.begin(), later.outputs.end(), field) !=
+                        later.outputs.end()) {
+                        break;
+                    }
+                }
+
+                plan.exchanges[i].push_back({field, radius});
+                plan.exchangeCount++;
+                m_clean[field] = true;
+            }
+        }
+
+        for (const auto& field : stencil.outputs) {
+            m_clean[field] = false;
+        }
+    }
+
+    LOG_DEBUG("Halo plan: {} field exchanges for {} stencils", plan.exchangeCount, stencils.size());
+    return plan;
+}
+
+HaloPlanner::StepPlan HaloPlanner::planBlockStep(
+    const std::vector<const stencil::StencilDefinition*>& stencils) {
+    StepPlan plan;
+    plan.exchanges.resize(stencils.size());
+    plan.ghostDepth.assign(stencils.size(), 0);
+
+    if (m_blockPosition == 0 && !stencils.empty()) {
+        // One deep exchange up front for every dirty field read before it is written
+        uint32_t depth = m_blockSteps * stepRadius(stencils);
+        std::unordered_map<std::string, bool> written;
+        for (const auto* stencil : stencils) {
+            for (const auto& field : stencil->inputs) {
+                bool requested = std::any_of(plan.exchanges[0].begin(), plan.exchanges[0].end(),
+                                             [&](const HaloRequest& r) { return r.field == field; });
+                if (depth > 0 && !written[field] && !requested && isDirty(field)) {
+                    plan.exchanges[0].push_back({field, depth});
+                    plan.exchangeCount++;
+                    m_clean[field] = true;
+                }
+            }
+            for (const auto& field : stencil->outputs) {
+                written[field] = true;
+            }
+        }
+        m_validDepth = depth;
+    }
+
+    // Each neighbor read consumes radius layers of the still-valid ghost region
+    for (size_t i = 0; i < stencils.size(); ++i) {
+        const auto& stencil = *stencils[i];
+        if (readsNeighbors(stencil)) {
+            m_validDepth -= std::min(m_validDepth, std::max(stencil.neighborRadius, 1u));
+        }
+        plan.ghostDepth[i] = m_validDepth;
+
+        for (const auto& field : stencil.outputs) {
+            m_clean[field] = false;
+        }
+    }
+
+    m_blockPosition = (m_blockPosition + 1) % m_blockSteps;
+
+    LOG_DEBUG("Halo plan (block step {}/{}): {} field exchanges",
+              m_blockPosition == 0 ? m_blockSteps : m_blockPosition, m_blockSteps, plan.exchangeCount);
+    return plan;
+}
+
+void HaloPlanner::setBlockSteps(uint32_t blockSteps) {
+    m_blockSteps = std::max(blockSteps, 1u);
+    markAllDirty();
+}
+
+void HaloPlanner::markDirty(const std::string& field) {
+    m_clean[field] = false;
+}
+
+void HaloPlanner::markAllDirty() {
+    m_clean.clear();
+    m_blockPosition = 0;
+    m_validDepth = 0;
+}
+
+bool HaloPlanner::isDirty(const std::string& field) const {
+    auto it = m_clean.find(field);
+    return it == m_clean.end() || !it->second;
+}
+
+} // namespace graph
@@ -0,0 +1,86 @@
+#include "graph/TemporalBlockTuner.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+
+namespace graph {
+
+TemporalBlockTuner::TemporalBlockTuner()
+    : TemporalBlockTuner(Config()) {
+}
+
+TemporalBlockTuner::TemporalBlockTuner(const Config& config)
+    : m_config(config) {
+    m_config.maxBlockSteps = std::max(m_config.maxBlockSteps, 1u);
+    m_config.probeBlocks = std::max(m_config.probeBlocks, 1u);
+    reset();
+}
+
+void TemporalBlockTuner::reset() {
+    m_phase = m_config.maxBlockSteps > 1 ? Phase::ProbeSingle : Phase::Tuned;
+    m_blockSteps = 1;
+    m_exchangeSum = 0.0;
+    m_computeSum = 0.0;
+    m_stepCount = 0;
+}
+
+void TemporalBlockTuner::recordStep(double exchangeSeconds, double computeSeconds) {
+    if (m_phase == Phase::Tuned) {
+        return;
+    }
+
+    m_exchangeSum += exchangeSeconds;
+    m_computeSum += computeSeconds;
+    m_stepCount++;
+    if (m_stepCount < m_config.probeBlocks * m_blockSteps) {
+        return;
+    }
+
+    // Exchange cost per block, compute cost per step
+    double exchange = m_exchangeSum / m_config.probeBlocks;
+    double compute = m_computeSum / m_stepCount;
+    m_exchangeSum = 0.0;
+    m_computeSum = 0.0;
+    m_stepCount = 0;
+
+    if (m_phase == Phase::ProbeSingle) {
+        m_singleExchange = exchange;
+        m_singleCompute = compute;
+        m_phase = Phase::ProbeDeep;
+        m_blockSteps = m_config.maxBlockSteps;
+        LOG_DEBUG("Temporal blocking probe k=1: exchange {:.3f} ms, compute {:.3f} ms/step",
+                  exchange * 1e3, compute * 1e3);
+        return;
+    }
+
+    double span = static_cast<double>(m_config.maxBlockSteps - 1);
+    m_exchangePerLayer = std::max(0.0, (exchange - m_singleExchange) / span);
+    m_exchangeLatency = std::max(0.0, m_singleExchange - m_exchangePerLayer);
+    m_computeGrowth = m_singleCompute > 0.0
+        ? std::max(0.0, (compute / m_singleCompute - 1.0) / span)
+        : 0.0;
+
+    m_phase = Phase::Tuned;
+    uint32_t best = 1;
+    for (uint32_t k = 2; k <= m_config.maxBlockSteps; ++k) {
+        if (predictStepTime(k) < predictStepTime(best)) {
+            best = k;
+        }
+    }
+    m_blockSteps = best;
+
+    LOG_INFO("Temporal blocking tuned: k={} ({:.3f} ms/step, k=1 predicts {:.3f} ms/step)",
+             best, predictStepTime(best) * 1e3, predictStepTime(1) * 1e3);
+}
+
+double TemporalBlockTuner::predictStepTime(uint32_t blockSteps) const {
+    if (m_phase != Phase::Tuned || blockSteps == 0) {
+        return 0.0;
+    }
+    double k = static_cast<double>(blockSteps);
+    double exchange = (m_exchangeLatency + k * m_exchangePerLayer) / k;
+    double compute = m_singleCompute * (1.0 + (k - 1.0) * m_computeGrowth);
+    return exchange + compute;
+}
+
+} // namespace graph
@@ -1,123 +1,608 @@
 #include "halo/HaloManager.hpp"
 #include "core/Logger.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace halo {
 
+namespace {
+
+// Values per BlockDelta block and its size: minimum, step, 16 words of offset pairs
+constexpr uint32_t kDeltaBlockValues = 32;
+constexpr uint32_t kDeltaBlockWords = 2 + kDeltaBlockValues / 2;
+
+// Largest finite half-precision value
+constexpr float kFloat16Max = 65504.0f;
+
+bool isFloatFormat(vk::Format format) {
+    switch (format) {
+        case vk::Format::eR32Sfloat:
+        case vk::Format::eR32G32Sfloat:
+        case vk::Format::eR32G32B32Sfloat:
+        case vk::Format::eR32G32B32A32Sfloat:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Halo list the neighbor sends to gpu (nullptr if it sends nothing)
+const domain::SubDomain::HaloList* findIncomingList(const std::vector<domain::SubDomain>& domains,
+                                                    uint32_t gpu, uint32_t neighbor) {
+    for (const auto& incoming : domains[neighbor].haloLists) {
+        if (incoming.neighborGpu == gpu) {
+            return &incoming;
+        }
+    }
+    return nullptr;
+}
+
+const char* encodingName(HaloEncoding encoding) {
+    switch (encoding) {
+        case HaloEncoding::Float16: return "fp16";
+        case HaloEncoding::BFloat16: return "bf16";
+        case HaloEncoding::BlockDelta: return "block-delta";
+        default: return "fp32";
+    }
+}
+
+} // namespace
+
 HaloManager::HaloManager(const core::VulkanContext& context,
                         core::MemoryAllocator& allocator,
                         const std::vector<domain::SubDomain>& domains)
     : m_context(context), m_allocator(allocator), m_domains(domains) {
     LOG_INFO("Initializing HaloManager for {} GPUs, halo thickness: {}",
              domains.size(), m_haloThickness);
+
+    m_haloSets.resize(domains.size());
+    for (auto& haloSet : m_haloSets) {
+        haloSet.writeValues.assign(domains.size(), 0);
+        haloSet.readValues.assign(domains.size(), 0);
+    }
 }
 
 HaloManager::~HaloManager() {
     // Cleanup halos
-    for (auto& [fieldName, gpuHalos] : m_fieldHalos) {
-        for (auto& haloSet : gpuHalos) {
-            for (int face = 0; face < 6; face++) {
-                m_allocator.destroyBuffer(haloSet.localHalos[face]);
-                m_allocator.destroyBuffer(haloSet.remoteHalos[face]);
-            }
-        }
+    for (uint32_t gpu = 0; gpu < m_haloSets.size(); ++gpu) {
+        destroyHaloSet(gpu);
     }
+    destroyIndexLists();
 
-    // Cleanup semaphores
-    for (auto sem : m_haloSemaphores) {
-        m_context.getDevice().destroySemaphore(sem);
+    // Cleanup semaphores: halo on the sender's device, release on the receiver's
+    uint32_t gpuCount = static_cast<uint32_t>(m_domains.size());
+    for (size_t i = 0; i < m_haloSemaphores.size(); ++i) {
+        if (m_haloSemaphores[i]) {
+            getDevice(static_cast<uint32_t>(i / gpuCount)).destroySemaphore(m_haloSemaphores[i]);
+        }
+    }
+    for (size_t i = 0; i < m_releaseSemaphores.size(); ++i) {
+        if (m_releaseSemaphores[i]) {
+            getDevice(static_cast<uint32_t>(i % gpuCount)).destroySemaphore(m_releaseSemaphores[i]);
+        }
+    }
+    for (size_t gpu = 0; gpu < m_packSemaphores.size(); ++gpu) {
+        getDevice(static_cast<uint32_t>(gpu)).destroySemaphore(m_packSemaphores[gpu]);
     }
 
     LOG_DEBUG("HaloManager destroyed");
 }
 
-HaloBufferSet::FaceDimensions HaloManager::calculateFaceDimensions(
-    const domain::SubDomain& domain,
-    uint32_t face) {
-    HaloBufferSet::FaceDimensions dims;
-    dims.thickness = m_haloThickness;
-
-    const auto& bounds = domain.bounds;
-    uint32_t dimX = bounds.max()[0] - bounds.min()[0] + 1;
-    uint32_t dimY = bounds.max()[1] - bounds.min()[1] + 1;
-    uint32_t dimZ = bounds.max()[2] - bounds.min()[2] + 1;
-
-    // Face ordering: 0=-X, 1=+X, 2=-Y, 3=+Y, 4=-Z, 5=+Z
-    switch (face) {
-        case 0: // -X face
-        case 1: // +X face
-            dims.width = dimY;
-            dims.height = dimZ;
-            break;
-        case 2: // -Y face
-        case 3: // +Y face
-            dims.width = dimX;
-            dims.height = dimZ;
-            break;
-        case 4: // -Z face
-        case 5: // +Z face
-            dims.width = dimX;
-            dims.height = dimY;
-            break;
-        default:
-            throw std::runtime_error("Invalid face index");
+void HaloManager::setDevices(core::DeviceGroup& devices) {
+    LOG_CHECK(m_indexLists.empty() && !m_halosAllocated && m_packSemaphores.empty(),
+              "Devices must be set before halo lists, buffers and semaphores are created");
+    LOG_CHECK(devices.getDeviceCount() >= m_domains.size(), "Fewer devices than domains");
+    m_devices = &devices;
+}
+
+core::MemoryAllocator& HaloManager::getAllocator(uint32_t gpuIndex) const {
+    return m_devices ? m_devices->getAllocator(gpuIndex) : m_allocator;
+}
+
+vk::Device HaloManager::getDevice(uint32_t gpuIndex) const {
+    return m_devices ? m_devices->getContext(gpuIndex).getDevice() : m_context.getDevice();
+}
+
+void HaloManager::destroyHaloSet(uint32_t gpuIndex) {
+    auto& allocator = getAllocator(gpuIndex);
+    for (auto& message : m_haloSets[gpuIndex].messages) {
+        allocator.destroyBuffer(message.sendBuffer);
+        allocator.destroyBuffer(message.recvBuffer);
+        allocator.destroyBuffer(message.segmentTable);
     }
+    m_haloSets[gpuIndex].messages.clear();
+}
 
-    return dims;
+void HaloManager::destroyIndexLists() {
+    for (uint32_t gpu = 0; gpu < m_indexLists.size(); ++gpu) {
+        destroyDomainIndexLists(gpu);
+    }
+    m_indexLists.clear();
+    m_voxelLists.clear();
 }
 
-void HaloManager::allocateFieldHalos(const std::string& fieldName,
-                                    const field::FieldDesc& fieldDesc,
-                                    uint32_t gpuIndex) {
-    LOG_INFO("Allocating halos for field '{}' on GPU {}", fieldName, gpuIndex);
+void HaloManager::destroyDomainIndexLists(uint32_t gpuIndex) {
+    auto& allocator = getAllocator(gpuIndex);
+    if (gpuIndex < m_indexLists.size()) {
+        for (auto& list : m_indexLists[gpuIndex]) {
+            allocator.destroyBuffer(list.gatherIndices);
+            allocator.destroyBuffer(list.scatterIndices);
+        }
+        m_indexLists[gpuIndex].clear();
+    }
+    if (gpuIndex < m_voxelLists.size()) {
+        auto& lists = m_voxelLists[gpuIndex];
+        allocator.destroyBuffer(lists.interiorIndices);
+        allocator.destroyBuffer(lists.boundaryIndices);
+        allocator.destroyBuffer(lists.ghostIndices);
+        lists = DomainVoxelLists();
+    }
+}
 
-    if (gpuIndex >= m_domains.size()) {
-        throw std::runtime_error("GPU index out of range");
+std::vector<HostIndexLists> HaloManager::computeIndexLists(
+    const std::vector<domain::SubDomain>& domains,
+    const std::vector<nanovdb::Coord>& fieldCoords,
+    const std::vector<uint32_t>& selected) {
+    std::vector<HostIndexLists> result(domains.size());
+    std::vector<bool> isSelected(domains.size(), false);
+    for (uint32_t gpu : selected) {
+        LOG_CHECK(gpu < domains.size(), "Selected domain out of range");
+        isSelected[gpu] = true;
     }
 
-    // Get or create halo storage for this field
-    if (m_fieldHalos.find(fieldName) == m_fieldHalos.end()) {
-        m_fieldHalos[fieldName] = std::vector<HaloBufferSet>(m_domains.size());
+    // 21 bits per axis, matching the LUT's coordinate range
+    auto coordKey = [](const nanovdb::Coord& ijk) {
+        auto axisBits = [](int32_t v) { return static_cast<uint64_t>(v) & 0x1FFFFF; };
+        return axisBits(ijk[0]) | (axisBits(ijk[1]) << 21) | (axisBits(ijk[2]) << 42);
+    };
+
+    std::unordered_map<uint64_t, uint32_t> elementIndex;
+    elementIndex.reserve(fieldCoords.size());
+    for (uint32_t i = 0; i < fieldCoords.size(); ++i) {
+        elementIndex[coordKey(fieldCoords[i])] = i;
     }
 
-    HaloBufferSet& haloSet = m_fieldHalos[fieldName][gpuIndex];
-    const auto& domain = m_domains[gpuIndex];
+    auto toIndices = [&](const std::vector<nanovdb::Coord>& voxels) {
+        std::vector<uint32_t> indices;
+        indices.reserve(voxels.size());
+        for (const auto& ijk : voxels) {
+            auto it = elementIndex.find(coordKey(ijk));
+            LOG_CHECK(it != elementIndex.end(), "Halo voxel missing from field LUT");
+            indices.push_back(it->second);
+        }
+        return indices;
+    };
+
+    // Interior/boundary split: boundary voxels are the ones some neighbor reads,
+    // which are exactly the voxels that read the neighbor in turn
+    std::vector<std::vector<bool>> isBoundary(domains.size());
+    std::vector<bool> isPeriodicGhost;
+    for (uint32_t gpu = 0; gpu < domains.size(); ++gpu) {
+        if (!isSelected[gpu]) {
+            continue;
+        }
+        auto& lists = result[gpu];
+        std::vector<std::vector<uint32_t>> recvLayerEnds;
+        for (const auto& sendList : domains[gpu].haloLists) {
+            lists.gather.push_back(toIndices(sendList.sendVoxels));
+            if (!lists.gather.back().empty()) {
+                isBoundary[gpu].resize(fieldCoords.size(), false);
+                for (uint32_t index : lists.gather.back()) {
+                    isBoundary[gpu][index] = true;
+                }
+            }
+
+            // Received values arrive in the neighbor's send order; periodic
+            // ghosts are stored a period away from the voxel that was sent
+            LOG_CHECK(sendList.neighborGpu < domains.size(), "Halo list neighbor out of range");
+            const auto* incoming = findIncomingList(domains, gpu, sendList.neighborGpu);
+            lists.scatter.push_back(incoming ? toIndices(incoming->recvVoxels.empty() ? incoming->sendVoxels
+                                                                                      : incoming->recvVoxels)
+                                             : std::vector<uint32_t>{});
+            recvLayerEnds.push_back(incoming ? incoming->layerEnds : std::vector<uint32_t>{});
+        }
+        lists.ghosts = mergeLayers(lists.scatter, recvLayerEnds, lists.ghostLayerEnds);
+    }
+
+    // Periodic ghosts only ever hold received values: no stencil writes them.
+    // Any domain may hold ghosts inside a selected domain's leaves.
+    for (const auto& domain : domains) {
+        for (const auto& sendList : domain.haloLists) {
+            if (sendList.recvVoxels.empty()) {
+                continue;
+            }
+            isPeriodicGhost.resize(fieldCoords.size(), false);
+            for (uint32_t index : toIndices(sendList.recvVoxels)) {
+                isPeriodicGhost[index] = true;
+            }
+        }
+    }
 
-    // Allocate buffers for each face
-    for (int face = 0; face < 6; face++) {
-        auto faceDims = calculateFaceDimensions(domain, face);
-        haloSet.faceDims[face] = faceDims;
+    std::unordered_map<uint64_t, uint32_t> leafOwner;
+    for (uint32_t gpu = 0; gpu < domains.size(); ++gpu) {
+        if (!isSelected[gpu]) {
+            continue;
+        }
+        for (const auto& leaf : domains[gpu].assignedLeaves) {
+            leafOwner[domain::DomainSplitter::getLeafKey(leaf.min())] = gpu;
+        }
+    }
+
+    for (uint32_t i = 0; i < fieldCoords.size(); ++i) {
+        auto it = leafOwner.find(domain::DomainSplitter::getLeafKey(fieldCoords[i]));
+        if (it == leafOwner.end() || (i < isPeriodicGhost.size() && isPeriodicGhost[i])) {
+            continue;
+        }
+        uint32_t gpu = it->second;
+        bool onBoundary = i < isBoundary[gpu].size() && isBoundary[gpu][i];
+        (onBoundary ? result[gpu].boundary : result[gpu].interior).push_back(i);
+    }
+
+    return result;
+}
 
-        uint32_t haloVoxelCount = faceDims.thickness * faceDims.width * faceDims.height;
-        haloSet.haloVoxelCounts[face] = haloVoxelCount;
+void HaloManager::buildIndexLists(const std::vector<nanovdb::Coord>& fieldCoords) {
+    std::vector<uint32_t> all(m_domains.size());
+    for (uint32_t gpu = 0; gpu < all.size(); ++gpu) {
+        all[gpu] = gpu;
+    }
+    buildIndexLists(fieldCoords, all);
+}
 
-        vk::DeviceSize bufferSize = static_cast<vk::DeviceSize>(haloVoxelCount) *
-                                   fieldDesc.elementSize;
+void HaloManager::buildIndexLists(const std::vector<nanovdb::Coord>& fieldCoords,
+                                  const std::vector<uint32_t>& domains) {
+    LOG_INFO("Building halo gather/scatter lists for {} of {} GPUs", domains.size(), m_domains.size());
 
-        // Local halo: stores data received from neighbors
-        LOG_DEBUG("  Face {}: {} voxels ({} bytes)", face, haloVoxelCount, bufferSize);
+    auto hostLists = computeIndexLists(m_domains, fieldCoords, domains);
+    m_indexLists.resize(m_domains.size());
+    m_voxelLists.resize(m_domains.size());
 
-        haloSet.localHalos[face] = m_allocator.createBuffer(
-            bufferSize,
+    auto uploadIndices = [&](uint32_t gpu, const std::vector<uint32_t>& indices) {
+        core::MemoryAllocator::Buffer buffer;
+        if (indices.empty()) {
+            return buffer;
+        }
+        vk::DeviceSize size = indices.size() * sizeof(uint32_t);
+        auto& allocator = getAllocator(gpu);
+        buffer = allocator.createBuffer(
+            size,
             vk::BufferUsageFlagBits::eStorageBuffer |
             vk::BufferUsageFlagBits::eTransferDst |
             vk::BufferUsageFlagBits::eShaderDeviceAddress);
+        allocator.uploadToGPU(buffer, indices.data(), size);
+        return buffer;
+    };
+
+    uint64_t totalSend = 0;
+    for (uint32_t gpu : domains) {
+        destroyDomainIndexLists(gpu);
+        auto& host = hostLists[gpu];
+
+        for (size_t n = 0; n < m_domains[gpu].haloLists.size(); ++n) {
+            const auto& sendList = m_domains[gpu].haloLists[n];
+            HaloIndexList list;
+            list.neighborGpu = sendList.neighborGpu;
+            list.sendCount = static_cast<uint32_t>(sendList.sendVoxels.size());
+            list.sendLayerEnds = sendList.layerEnds;
+            list.phase = sendList.phase;
+            list.gatherIndices = uploadIndices(gpu, host.gather[n]);
+
+            if (const auto* incoming = findIncomingList(m_domains, gpu, sendList.neighborGpu)) {
+                list.recvCount = static_cast<uint32_t>(incoming->sendVoxels.size());
+                list.recvLayerEnds = incoming->layerEnds;
+                list.scatterIndices = uploadIndices(gpu, host.scatter[n]);
+            }
+
+            LOG_DEBUG("  GPU {} <-> GPU {}: send {} voxels, receive {} voxels",
+                      gpu, list.neighborGpu, list.sendCount, list.recvCount);
+            totalSend += list.sendCount;
+            m_indexLists[gpu].push_back(std::move(list));
+        }
+
+        auto& lists = m_voxelLists[gpu];
+        lists.interiorCount = static_cast<uint32_t>(host.interior.size());
+        lists.boundaryCount = static_cast<uint32_t>(host.boundary.size());
+        lists.interiorIndices = uploadIndices(gpu, host.interior);
+        lists.boundaryIndices = uploadIndices(gpu, host.boundary);
+        lists.ghostCount = static_cast<uint32_t>(host.ghosts.size());
+        lists.ghostLayerEnds = std::move(host.ghostLayerEnds);
+        lists.ghostIndices = uploadIndices(gpu, host.ghosts);
+
+        // Each device only holds current values for its own voxels
+        if (m_devices) {
+            lists.ownedElements = std::move(host.interior);
+            lists.ownedElements.insert(lists.ownedElements.end(), host.boundary.begin(), host.boundary.end());
+        }
+
+        LOG_DEBUG("  GPU {}: {} interior voxels, {} boundary voxels, {} ghost voxels",
+                  gpu, lists.interiorCount, lists.boundaryCount, lists.ghostCount);
+    }
+
+    m_phaseCount = 1;
+    for (const auto& lists : m_indexLists) {
+        for (const auto& list : lists) {
+            m_phaseCount = std::max(m_phaseCount, list.phase + 1);
+        }
+    }
+
+    LOG_INFO("Halo lists built: {} voxels sent per field and step by the rebuilt GPUs", totalSend);
+}
+
+const DomainVoxelLists& HaloManager::getVoxelLists(uint32_t gpuIndex) const {
+    if (gpuIndex >= m_voxelLists.size()) {
+        throw std::runtime_error("Voxel lists not built for GPU " + std::to_string(gpuIndex));
+    }
+    return m_voxelLists[gpuIndex];
+}
+
+const std::vector<HaloIndexList>& HaloManager::getIndexLists(uint32_t gpuIndex) const {
+    if (gpuIndex >= m_indexLists.size()) {
+        throw std::runtime_error("Halo index lists not built for GPU " + std::to_string(gpuIndex));
+    }
+    return m_indexLists[gpuIndex];
+}
+
+bool HaloManager::setFieldHaloThickness(const std::string& fieldName, uint32_t thickness) {
+    auto it = m_fieldThickness.find(fieldName);
+    if (it != m_fieldThickness.end() && it->second == thickness) {
+        return false;
+    }
+
+    LOG_DEBUG("Halo thickness of field '{}': {}", fieldName, thickness);
+    m_fieldThickness[fieldName] = thickness;
+    return true;
+}
+
+uint32_t HaloManager::getFieldHaloThickness(const std::string& fieldName) const {
+    auto it = m_fieldThickness.find(fieldName);
+    return it != m_fieldThickness.end() ? it->second : m_haloThickness;
+}
+
+bool HaloManager::setFieldHaloEncoding(const std::string& fieldName, HaloEncoding encoding,
+                                       float tolerance, float maxMagnitude) {
+    float error = encodingError(encoding, maxMagnitude);
+    if (error > tolerance) {
+        LOG_WARN("Field '{}': {} halos err by up to {} of the largest magnitude {} (tolerance {}), sending fp32",
+                 fieldName, encodingName(encoding), error, maxMagnitude, tolerance);
+        encoding = HaloEncoding::Float32;
+    }
+
+    if (getFieldHaloEncoding(fieldName) == encoding) {
+        return false;
+    }
+
+    LOG_DEBUG("Halo encoding of field '{}': {}", fieldName, encodingName(encoding));
+    m_fieldEncoding[fieldName] = encoding;
+    return true;
+}
 
-        // Remote halo: stores data to be sent to neighbors
-        // Use host-to-GPU memory for easier packing
-        haloSet.remoteHalos[face] = m_allocator.createBuffer(
-            bufferSize,
+HaloEncoding HaloManager::getFieldHaloEncoding(const std::string& fieldName) const {
+    auto it = m_fieldEncoding.find(fieldName);
+    return it != m_fieldEncoding.end() ? it->second : HaloEncoding::Float32;
+}
+
+float HaloManager::encodingError(HaloEncoding encoding, float maxMagnitude) {
+    // Half the unit in the last place of the stored mantissa, or half a step
+    // of a block range of at most 2 * maxMagnitude
+    switch (encoding) {
+        case HaloEncoding::Float16:
+            return maxMagnitude <= kFloat16Max ? 1.0f / 2048.0f                 // 10 mantissa bits
+                                               : std::numeric_limits<float>::infinity();
+        case HaloEncoding::BFloat16: return 1.0f / 256.0f;      // 7 mantissa bits
+        case HaloEncoding::BlockDelta: return 1.0f / 65535.0f;  // 65535 steps per block range
+        default: return 0.0f;
+    }
+}
+
+uint32_t HaloManager::encodedWords(HaloEncoding encoding, uint32_t voxelCount, uint32_t components) {
+    uint32_t valueCount = voxelCount * components;
+    switch (encoding) {
+        case HaloEncoding::Float16:
+        case HaloEncoding::BFloat16:
+            return (valueCount + 1) / 2;
+        case HaloEncoding::BlockDelta:
+            return encodedUnits(encoding, voxelCount, components) * kDeltaBlockWords;
+        default:
+            return valueCount;
+    }
+}
+
+uint32_t HaloManager::encodedUnits(HaloEncoding encoding, uint32_t voxelCount, uint32_t components) {
+    uint32_t valueCount = voxelCount * components;
+    switch (encoding) {
+        case HaloEncoding::Float16:
+        case HaloEncoding::BFloat16:
+            return (valueCount + 1) / 2;
+        case HaloEncoding::BlockDelta:
+            // Blocks never mix components, so each block's range is one component's
+            return components * ((voxelCount + kDeltaBlockValues - 1) / kDeltaBlockValues);
+        default:
+            return valueCount;
+    }
+}
+
+uint32_t HaloManager::layerVoxelCount(const std::vector<uint32_t>& layerEnds,
+                                      uint32_t total, uint32_t thickness) {
+    if (thickness == 0) {
+        return 0;
+    }
+    // Lists without layer information are taken whole
+    if (layerEnds.empty() || thickness > layerEnds.size()) {
+        return total;
+    }
+    return layerEnds[thickness - 1];
+}
+
+std::vector<uint32_t> HaloManager::mergeLayers(const std::vector<std::vector<uint32_t>>& lists,
+                                               const std::vector<std::vector<uint32_t>>& layerEnds,
+                                               std::vector<uint32_t>& mergedLayerEnds) {
+    // Lists without layer information count as a single layer
+    size_t layerCount = 0;
+    for (size_t l = 0; l < lists.size(); ++l) {
+        layerCount = std::max<size_t>(layerCount, l < layerEnds.size() ? layerEnds[l].size() : 1);
+    }
+
+    std::vector<uint32_t> merged;
+    mergedLayerEnds.clear();
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        for (size_t l = 0; l < lists.size(); ++l) {
+            const auto& ends = l < layerEnds.size() ? layerEnds[l] : std::vector<uint32_t>{};
+            uint32_t total = static_cast<uint32_t>(lists[l].size());
+            uint32_t begin = layerVoxelCount(ends, total, static_cast<uint32_t>(layer));
+            uint32_t end = ends.empty() ? (layer == 0 ? total : begin)
+                                        : layerVoxelCount(ends, total, static_cast<uint32_t>(layer + 1));
+            merged.insert(merged.end(), lists[l].begin() + begin, lists[l].begin() + end);
+        }
+        mergedLayerEnds.push_back(static_cast<uint32_t>(merged.size()));
+    }
+    return merged;
+}
+
+void HaloManager::allocateHalos(const std::unordered_map<std::string, field::FieldDesc>& fields) {
+    LOG_INFO("Allocating halo messages for {} fields on {} GPUs", fields.size(), m_domains.size());
+
+    for (uint32_t gpu = 0; gpu < m_domains.size(); ++gpu) {
+        allocateDomainHalos(gpu, fields);
+    }
+    m_halosAllocated = true;
+}
+
+void HaloManager::allocateHalos(const std::vector<const FieldMap*>& domainFields) {
+    LOG_CHECK(domainFields.size() >= m_domains.size(), "Field descriptors missing for some domains");
+    LOG_INFO("Allocating halo messages on {} devices", m_domains.size());
+
+    for (uint32_t gpu = 0; gpu < m_domains.size(); ++gpu) {
+        allocateDomainHalos(gpu, *domainFields[gpu]);
+    }
+    m_halosAllocated = true;
+}
+
+HaloMessage HaloManager::layoutMessage(const HaloIndexList& list, const FieldMap& fields) const {
+    HaloMessage message;
+    message.neighborGpu = list.neighborGpu;
+    message.phase = list.phase;
+
+    // Segment order must agree on both ends of a message: sort by name
+    std::vector<std::pair<std::string, const field::FieldDesc*>> haloFields;
+    for (const auto& [fieldName, fieldDesc] : fields) {
+        if (getFieldHaloThickness(fieldName) > 0) {
+            haloFields.emplace_back(fieldName, &fieldDesc);
+        }
+    }
+    std::sort(haloFields.begin(), haloFields.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    LOG_CHECK(haloFields.size() <= 32, "At most 32 fields can carry halos (segment mask width)");
+
+    // Fields sized by the lists' first layers
+    for (const auto& [fieldName, fieldDesc] : haloFields) {
+        HaloSegment segment;
+        segment.fieldName = fieldName;
+        segment.elementSize = fieldDesc->elementSize;
+        segment.thickness = getFieldHaloThickness(fieldName);
+        segment.sendCount = layerVoxelCount(list.sendLayerEnds, list.sendCount, segment.thickness);
+        segment.recvCount = layerVoxelCount(list.recvLayerEnds, list.recvCount, segment.thickness);
+        segment.sendOffset = message.sendBytes;
+        segment.recvOffset = message.recvBytes;
+
+        // Integer fields would be reinterpreted as floats by the reduced encodings
+        uint32_t components = segment.elementSize / static_cast<uint32_t>(sizeof(float));
+        segment.encoding = isFloatFormat(fieldDesc->format) ? getFieldHaloEncoding(fieldName)
+                                                            : HaloEncoding::Float32;
+        segment.sendBytes = sizeof(uint32_t) *
+            static_cast<vk::DeviceSize>(encodedWords(segment.encoding, segment.sendCount, components));
+        segment.recvBytes = sizeof(uint32_t) *
+            static_cast<vk::DeviceSize>(encodedWords(segment.encoding, segment.recvCount, components));
+
+        if (!list.sendLayerEnds.empty() && segment.thickness > list.sendLayerEnds.size()) {
+            LOG_WARN("Field '{}' needs {} halo layers, lists towards GPU {} only hold {}",
+                     fieldName, segment.thickness, list.neighborGpu, list.sendLayerEnds.size());
+        }
+
+        message.sendBytes += segment.sendBytes;
+        message.recvBytes += segment.recvBytes;
+        message.segments.push_back(std::move(segment));
+    }
+    return message;
+}
+
+void HaloManager::allocateDomainHalos(uint32_t gpuIndex,
+                                      const std::unordered_map<std::string, field::FieldDesc>& fields) {
+    if (gpuIndex >= m_domains.size()) {
+        throw std::runtime_error("GPU index out of range");
+    }
+
+    HaloBufferSet& haloSet = m_haloSets[gpuIndex];
+    destroyHaloSet(gpuIndex);
+    auto& allocator = getAllocator(gpuIndex);
+
+    if (gpuIndex >= m_indexLists.size()) {
+        LOG_WARN("No halo index lists for GPU {}, no halo messages allocated", gpuIndex);
+        return;
+    }
+
+    // Layout of one segment as read by the pack/unpack shaders (offsets in words)
+    struct GpuSegment {
+        uint64_t fieldAddr;
+        uint32_t sendOffset;
+        uint32_t sendCount;
+        uint32_t recvOffset;
+        uint32_t recvCount;
+        uint32_t components;
+        uint32_t encoding;
+    };
+
+    auto createBuffer = [&](vk::DeviceSize size, vk::BufferUsageFlags usage) {
+        core::MemoryAllocator::Buffer buffer;
+        if (size == 0) {
+            return buffer;
+        }
+        return allocator.createBuffer(
+            size,
             vk::BufferUsageFlagBits::eStorageBuffer |
-            vk::BufferUsageFlagBits::eTransferSrc |
+            usage |
             vk::BufferUsageFlagBits::eShaderDeviceAddress);
+    };
+
+    // One message pair per neighbor
+    for (const auto& list : m_indexLists[gpuIndex]) {
+        HaloMessage message = layoutMessage(list, fields);
+
+        std::vector<GpuSegment> table;
+        for (const auto& segment : message.segments) {
+            table.push_back({
+                static_cast<uint64_t>(fields.at(segment.fieldName).deviceAddress),
+                static_cast<uint32_t>(segment.sendOffset / sizeof(uint32_t)),
+                segment.sendCount,
+                static_cast<uint32_t>(segment.recvOffset / sizeof(uint32_t)),
+                segment.recvCount,
+                segment.elementSize / static_cast<uint32_t>(sizeof(float)),
+                static_cast<uint32_t>(segment.encoding)
+            });
+        }
+
+        message.sendBuffer = createBuffer(message.sendBytes, vk::BufferUsageFlagBits::eTransferSrc);
+        message.recvBuffer = createBuffer(message.recvBytes, vk::BufferUsageFlagBits::eTransferDst);
+
+        vk::DeviceSize tableSize = table.size() * sizeof(GpuSegment);
+        message.segmentTable = createBuffer(tableSize, vk::BufferUsageFlagBits::eTransferDst);
+        if (tableSize > 0) {
+            allocator.uploadToGPU(message.segmentTable, table.data(), tableSize);
+        }
 
-        // Initialize sync values
-        haloSet.writeValues[face] = 0;
-        haloSet.readValues[face] = 0;
+        LOG_DEBUG("  GPU {} -> GPU {}: {} fields, send {} bytes, receive {} bytes",
+                  gpuIndex, list.neighborGpu, message.segments.size(),
+                  message.sendBytes, message.recvBytes);
+        haloSet.messages.push_back(std::move(message));
     }
+}
 
-    LOG_DEBUG("Halo buffers allocated for field '{}'", fieldName);
+void HaloManager::rebuildDomainHalos(uint32_t gpuIndex,
+                                     const std::unordered_map<std::string, field::FieldDesc>& fields) {
+    LOG_INFO("Rebuilding halos for GPU {}", gpuIndex);
+    allocateDomainHalos(gpuIndex, fields);
 }
 
 void HaloManager::createHaloSemaphores() {
@@ -125,8 +610,9 @@ void HaloManager::createHaloSemaphores() {
 
     uint32_t gpuCount = static_cast<uint32_t>(m_domains.size());
 
-    // Create one semaphore per (src, dst) GPU pair
+    // Create one semaphore pair per (src, dst) GPU pair
     m_haloSemaphores.resize(gpuCount * gpuCount);
+    m_releaseSemaphores.resize(gpuCount * gpuCount);
 
     vk::SemaphoreTypeCreateInfo timelineCreateInfo(
         vk::SemaphoreType::eTimeline,
@@ -136,15 +622,27 @@ void HaloManager::createHaloSemaphores() {
     vk::SemaphoreCreateInfo createInfo;
     createInfo.setPNext(&timelineCreateInfo);
 
+    // Domains wrapping onto themselves (periodic boundaries) exchange with themselves
+    auto exchangesWithSelf = [this](uint32_t gpu) {
+        const auto& lists = m_domains[gpu].haloLists;
+        return std::any_of(lists.begin(), lists.end(),
+                           [gpu](const auto& list) { return list.neighborGpu == gpu; });
+    };
+
+    uint32_t semaphoreCount = gpuCount;
     for (uint32_t src = 0; src < gpuCount; src++) {
         for (uint32_t dst = 0; dst < gpuCount; dst++) {
-            if (src == dst) {
+            if (src == dst && !exchangesWithSelf(src)) {
                 continue;  // No self-semaphores
             }
+            semaphoreCount += 2;
 
+            // Halo is signalled by the sender, release by the receiver
             try {
                 m_haloSemaphores[src * gpuCount + dst] =
-                    m_context.getDevice().createSemaphore(createInfo);
+                    getDevice(src).createSemaphore(createInfo);
+                m_releaseSemaphores[src * gpuCount + dst] =
+                    getDevice(dst).createSemaphore(createInfo);
                 LOG_DEBUG("Created semaphore for GPU {} -> GPU {}", src, dst);
             } catch (const std::exception& e) {
                 LOG_ERROR("Failed to create semaphore: {}", e.what());
@@ -153,21 +651,44 @@ void HaloManager::createHaloSemaphores() {
         }
     }
 
-    LOG_INFO("Timeline semaphores created ({} total)", gpuCount * gpuCount);
+    m_packSemaphores.resize(gpuCount);
+    for (uint32_t gpu = 0; gpu < gpuCount; gpu++) {
+        m_packSemaphores[gpu] = getDevice(gpu).createSemaphore(createInfo);
+    }
+
+    LOG_INFO("Timeline semaphores created ({} total)", semaphoreCount);
 }
 
-HaloBufferSet& HaloManager::getHaloBufferSet(const std::string& fieldName,
-                                             uint32_t gpuIndex) {
-    auto it = m_fieldHalos.find(fieldName);
-    if (it == m_fieldHalos.end()) {
-        throw std::runtime_error("Halo buffers not allocated for field: " + fieldName);
+vk::Semaphore HaloManager::getPackSemaphore(uint32_t gpuIndex) {
+    if (gpuIndex >= m_packSemaphores.size()) {
+        throw std::runtime_error("Pack semaphore not created for GPU " + std::to_string(gpuIndex));
     }
+    return m_packSemaphores[gpuIndex];
+}
+
+HaloBufferSet& HaloManager::getHaloBufferSet(uint32_t gpuIndex) {
+    if (gpuIndex >= m_haloSets.size()) {
+        throw std::runtime_error("GPU index out of range");
+    }
+
+    return m_haloSets[gpuIndex];
+}
+
+vk::Semaphore HaloManager::getReleaseSemaphore(uint32_t srcGpu, uint32_t dstGpu) {
+    uint32_t gpuCount = static_cast<uint32_t>(m_domains.size());
 
-    if (gpuIndex >= it->second.size()) {
+    if (srcGpu >= gpuCount || dstGpu >= gpuCount) {
         throw std::runtime_error("GPU index out of range");
     }
 
-    return it->second[gpuIndex];
+    vk::Semaphore sem = m_releaseSemaphores[srcGpu * gpuCount + dstGpu];
+    if (!sem) {
+        throw std::runtime_error("Release semaphore not created for GPU " +
+                                std::to_string(srcGpu) + " -> " +
+                                std::to_string(dstGpu));
+    }
+
+    return sem;
 }
 
 vk::Semaphore HaloManager::getHaloSemaphore(uint32_t srcGpu, uint32_t dstGpu) {
@@ -1,12 +1,65 @@
 #include "halo/HaloSync.hpp"
 #include "core/Logger.hpp"
-#include <fstream>
-#include <cstdlib>
-#include <cstdio>
+#include "core/ShaderCompiler.hpp"
 #include <stdexcept>
 
 namespace halo {
 
+namespace {
+
+// Declarations shared by the pack and unpack shaders. Encoding ids match
+// HaloEncoding; a BlockDelta block holds one component of 32 voxels as the
+// fp32 minimum, the fp32 step and 16 words of two 16-bit offsets each.
+// Blocks run component by component, so no block mixes vector components.
+constexpr const char* kHaloShaderCommon = R"(
+#version 460
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_scalar_block_layout : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+
+layout(local_size_x = 256) in;
+
+layout(buffer_reference, scalar) buffer FloatBuffer { float data[]; };
+layout(buffer_reference, scalar) buffer WordBuffer { uint data[]; };
+layout(buffer_reference, scalar) buffer IndexBuffer { uint data[]; };
+
+const uint ENCODING_FLOAT32 = 0u;
+const uint ENCODING_FLOAT16 = 1u;
+const uint ENCODING_BFLOAT16 = 2u;
+const uint ENCODING_BLOCK_DELTA = 3u;
+
+const uint BLOCK_VALUES = 32u;
+const uint BLOCK_WORDS = 2u + BLOCK_VALUES / 2u;
+
+// One field of the message (offsets in 32-bit words)
+struct Segment {
+    uint64_t fieldAddr;
+    uint sendOffset;
+    uint sendCount;
+    uint recvOffset;
+    uint recvCount;
+    uint components;
+    uint encoding;
+};
+layout(buffer_reference, scalar) buffer SegmentTable { Segment segments[]; };
+
+layout(push_constant) uniform PC {
+    uint64_t segmentAddr;
+    uint64_t messageAddr;
+    uint64_t indexAddr;   // Gather (pack) or scatter (unpack) list: field element per halo slot
+    uint segmentMask;     // Fields carried by this exchange
+    uint maxUnits;
+} pc;
+
+// Round to nearest even on the upper 16 bits of the fp32 pattern
+uint toBFloat16(float x) {
+    uint bits = floatBitsToUint(x);
+    return (bits + 0x7FFFu + ((bits >> 16) & 1u)) >> 16;
+}
+)";
+
+} // namespace
+
 HaloSync::HaloSync(uint32_t gpuCount, const core::VulkanContext& context)
     : m_gpuCount(gpuCount), m_context(context) {
     LOG_DEBUG("HaloSync initialized for {} GPUs", gpuCount);
@@ -24,59 +77,85 @@ void HaloSync::createPipelines() {
     vk::PushConstantRange pushRange{};
     pushRange.stageFlags = vk::ShaderStageFlagBits::eCompute;
     pushRange.offset = 0;
-    pushRange.size = sizeof(uint64_t) * 2 + sizeof(uint32_t) * 2; // 2 addrs + 2 uints
+    pushRange.size = sizeof(uint64_t) * 3 + sizeof(uint32_t) * 2; // 3 addrs + 2 uints
 
     layoutInfo.pPushConstantRanges = &pushRange;
     m_pipelineLayout = m_context.getDevice().createPipelineLayout(layoutInfo);
 
     // --- Compile Pack Shader ---
-    std::string packSource = R"(
-#version 460
-#extension GL_EXT_buffer_reference : require
-#extension GL_EXT_scalar_block_layout : require
+    std::string packSource = std::string(kHaloShaderCommon) + R"(
+float loadComponent(FloatBuffer field, IndexBuffer indices, uint components, uint voxel, uint component) {
+    return field.data[indices.data[voxel] * components + component];
+}
 
-layout(local_size_x = 256) in;
+float loadValue(FloatBuffer field, IndexBuffer indices, uint components, uint value) {
+    return loadComponent(field, indices, components, value / components, value % components);
+}
 
-layout(buffer_reference, scalar) buffer FloatBuffer { float data[]; };
+// x: encoding unit (value, value pair or block), y: message segment
+void main() {
+    uint seg = gl_WorkGroupID.y;
+    if ((pc.segmentMask & (1u << seg)) == 0u) {
+        return;
+    }
 
-layout(push_constant) uniform PC {
-    uint64_t fieldAddr;
-    uint64_t haloAddr;
-    uint offset;
-    uint count;
-} pc;
+    Segment segment = SegmentTable(pc.segmentAddr).segments[seg];
+    uint unit = gl_GlobalInvocationID.x;
+    uint valueCount = segment.sendCount * segment.components;
 
-void main() {
-    uint idx = gl_GlobalInvocationID.x;
-    if (idx < pc.count) {
-        FloatBuffer field = FloatBuffer(pc.fieldAddr);
-        FloatBuffer halo = FloatBuffer(pc.haloAddr);
-        halo.data[idx] = field.data[pc.offset + idx]; 
+    FloatBuffer field = FloatBuffer(segment.fieldAddr);
+    WordBuffer message = WordBuffer(pc.messageAddr);
+    IndexBuffer indices = IndexBuffer(pc.indexAddr);
+
+    if (segment.encoding == ENCODING_FLOAT32) {
+        if (unit < valueCount) {
+            float x = loadValue(field, indices, segment.components, unit);
+            message.data[segment.sendOffset + unit] = floatBitsToUint(x);
+        }
+    } else if (segment.encoding == ENCODING_FLOAT16 || segment.encoding == ENCODING_BFLOAT16) {
+        uint v = unit * 2u;
+        if (v < valueCount) {
+            float a = loadValue(field, indices, segment.components, v);
+            float b = v + 1u < valueCount ? loadValue(field, indices, segment.components, v + 1u) : 0.0;
+            message.data[segment.sendOffset + unit] = segment.encoding == ENCODING_FLOAT16
+                ? packHalf2x16(vec2(a, b))
+                : toBFloat16(a) | (toBFloat16(b) << 16);
+        }
+    } else {
+        // unit = component * blocksPerComponent + block
+        uint blocks = (segment.sendCount + BLOCK_VALUES - 1u) / BLOCK_VALUES;
+        if (unit < blocks * segment.components) {
+            uint component = unit / blocks;
+            uint first = (unit % blocks) * BLOCK_VALUES;
+            uint count = min(BLOCK_VALUES, segment.sendCount - first);
+            float values[BLOCK_VALUES];
+            float lo = 3.402823466e38;
+            float hi = -3.402823466e38;
+            for (uint i = 0u; i < BLOCK_VALUES; ++i) {
+                values[i] = i < count ? loadComponent(field, indices, segment.components, first + i, component) : 0.0;
+                if (i < count) {
+                    lo = min(lo, values[i]);
+                    hi = max(hi, values[i]);
+                }
+            }
+
+            // Offsets from the block minimum in 65535 steps of its range
+            float stepSize = (hi - lo) / 65535.0;
+            float scale = stepSize > 0.0 ? 1.0 / stepSize : 0.0;
+            uint dst = segment.sendOffset + unit * BLOCK_WORDS;
+            message.data[dst] = floatBitsToUint(lo);
+            message.data[dst + 1u] = floatBitsToUint(stepSize);
+            for (uint i = 0u; i < BLOCK_VALUES; i += 2u) {
+                uint q0 = uint(clamp(round((values[i] - lo) * scale), 0.0, 65535.0));
+                uint q1 = uint(clamp(round((values[i + 1u] - lo) * scale), 0.0, 65535.0));
+                message.data[dst + 2u + i / 2u] = q0 | (q1 << 16);
+            }
+        }
     }
 }
 )";
-    // Compile logic (simplified for brevity, should use helper)
-    std::string uuid = "pack_" + std::to_string(std::rand());
-    std::string glslFile = "/tmp/" + uuid + ".comp";
-    std::string spvFile = "/tmp/" + uuid + ".spv";
-    {
-        std::ofstream out(glslFile);
-        out << packSource;
-    }
-    std::system(("/opt/homebrew/bin/glslc -fshader-stage=compute -o " + spvFile + " " + glslFile).c_str());
-    std::remove(glslFile.c_str());
-    
-    std::vector<uint32_t> packSpirv;
-    {
-        std::ifstream in(spvFile, std::ios::binary | std::ios::ate);
-        if (in) {
-            size_t size = in.tellg();
-            packSpirv.resize(size/4);
-            in.seekg(0);
-            in.read((char*)packSpirv.data(), size);
-        }
-    }
-    std::remove(spvFile.c_str());
+    std::vector<uint32_t> packSpirv = core::ShaderCompiler::compileOrThrow(
+        packSource, vk::ShaderStageFlagBits::eCompute, "halo_pack");
 
     vk::ShaderModuleCreateInfo packModuleInfo(
         {}, // flags
@@ -103,53 +182,68 @@ void main() {
     m_context.getDevice().destroyShaderModule(packModule);
 
     // --- Compile Unpack Shader ---
-    std::string unpackSource = R"(
-#version 460
-#extension GL_EXT_buffer_reference : require
-#extension GL_EXT_scalar_block_layout : require
+    std::string unpackSource = std::string(kHaloShaderCommon) + R"(
+void storeComponent(FloatBuffer field, IndexBuffer indices, uint components, uint voxel, uint component, float x) {
+    field.data[indices.data[voxel] * components + component] = x;
+}
 
-layout(local_size_x = 256) in;
+void storeValue(FloatBuffer field, IndexBuffer indices, uint components, uint value, float x) {
+    storeComponent(field, indices, components, value / components, value % components, x);
+}
 
-layout(buffer_reference, scalar) buffer FloatBuffer { float data[]; };
+// x: encoding unit (value, value pair or block), y: message segment
+void main() {
+    uint seg = gl_WorkGroupID.y;
+    if ((pc.segmentMask & (1u << seg)) == 0u) {
+        return;
+    }
 
-layout(push_constant) uniform PC {
-    uint64_t haloAddr;
-    uint64_t fieldAddr;
-    uint offset;
-    uint count;
-} pc;
+    Segment segment = SegmentTable(pc.segmentAddr).segments[seg];
+    uint unit = gl_GlobalInvocationID.x;
+    uint valueCount = segment.recvCount * segment.components;
 
-void main() {
-    uint idx = gl_GlobalInvocationID.x;
-    if (idx < pc.count) {
-        FloatBuffer halo = FloatBuffer(pc.haloAddr);
-        FloatBuffer field = FloatBuffer(pc.fieldAddr);
-        field.data[pc.offset + idx] = halo.data[idx];
+    WordBuffer message = WordBuffer(pc.messageAddr);
+    FloatBuffer field = FloatBuffer(segment.fieldAddr);
+    IndexBuffer indices = IndexBuffer(pc.indexAddr);
+
+    if (segment.encoding == ENCODING_FLOAT32) {
+        if (unit < valueCount) {
+            float x = uintBitsToFloat(message.data[segment.recvOffset + unit]);
+            storeValue(field, indices, segment.components, unit, x);
+        }
+    } else if (segment.encoding == ENCODING_FLOAT16 || segment.encoding == ENCODING_BFLOAT16) {
+        uint v = unit * 2u;
+        if (v < valueCount) {
+            uint word = message.data[segment.recvOffset + unit];
+            vec2 pair = segment.encoding == ENCODING_FLOAT16
+                ? unpackHalf2x16(word)
+                : vec2(uintBitsToFloat(word << 16), uintBitsToFloat(word & 0xFFFF0000u));
+            storeValue(field, indices, segment.components, v, pair.x);
+            if (v + 1u < valueCount) {
+                storeValue(field, indices, segment.components, v + 1u, pair.y);
+            }
+        }
+    } else {
+        uint blocks = (segment.recvCount + BLOCK_VALUES - 1u) / BLOCK_VALUES;
+        if (unit < blocks * segment.components) {
+            uint component = unit / blocks;
+            uint first = (unit % blocks) * BLOCK_VALUES;
+            uint count = min(BLOCK_VALUES, segment.recvCount - first);
+            uint src = segment.recvOffset + unit * BLOCK_WORDS;
+            float lo = uintBitsToFloat(message.data[src]);
+            float stepSize = uintBitsToFloat(message.data[src + 1u]);
+            for (uint i = 0u; i < count; ++i) {
+                uint word = message.data[src + 2u + i / 2u];
+                uint q = (i & 1u) == 0u ? word & 0xFFFFu : word >> 16;
+                storeComponent(field, indices, segment.components, first + i, component,
+                               lo + float(q) * stepSize);
+            }
+        }
     }
 }
 )";
-    // Compile logic
-    uuid = "unpack_" + std::to_string(std::rand());
-    glslFile = "/tmp/" + uuid + ".comp";
-    spvFile = "/tmp/" + uuid + ".spv";
-    {
-        std::ofstream out(glslFile);
-        out << unpackSource;
-    }
-    std::system(("/opt/homebrew/bin/glslc -fshader-stage=compute -o " + spvFile + " " + glslFile).c_str());
-    std::remove(glslFile.c_str());
-    
-    std::vector<uint32_t> unpackSpirv;
-    {
-        std::ifstream in(spvFile, std::ios::binary | std::ios::ate);
-        if (in) {
-            size_t size = in.tellg();
-            unpackSpirv.resize(size/4);
-            in.seekg(0);
-            in.read((char*)unpackSpirv.data(), size);
-        }
-    }
-    std::remove(spvFile.c_str());
+    std::vector<uint32_t> unpackSpirv = core::ShaderCompiler::compileOrThrow(
+        unpackSource, vk::ShaderStageFlagBits::eCompute, "halo_unpack");
 
     vk::ShaderModuleCreateInfo unpackModuleInfo(
         {}, // flags
@@ -186,117 +280,93 @@ vk::MemoryBarrier HaloSync::createMemoryBarrier() {
 }
 
 void HaloSync::recordHaloPack(vk::CommandBuffer cmd,
-                              vk::Buffer fieldBuffer,
-                              vk::Buffer haloBuffer,
-                              uint32_t offset,
-                              uint32_t count) {
-    // Bind pipeline
+                              vk::Buffer segmentTable,
+                              vk::Buffer messageBuffer,
+                              vk::Buffer indexBuffer,
+                              uint32_t segmentMask,
+                              uint32_t segmentCount,
+                              uint32_t maxUnits) {
+    if (segmentMask == 0 || maxUnits == 0) {
+        return;
+    }
+
     cmd.bindPipeline(vk::PipelineBindPoint::eCompute, m_packPipeline);
-    
-    // Bind descriptors (we need a descriptor set for buffers?)
-    // The shader uses buffer references or bindings?
-    // The shader I wrote uses:
-    // layout(std430, binding = 0) buffer Field { float data[]; };
-    // layout(std430, binding = 1) buffer Halo { float haloData[]; };
-    
-    // We need to bind these buffers.
-    // Since we didn't create a descriptor set layout in createPipelines (we passed nullptr/empty),
-    // we can't use descriptor sets easily unless we use push descriptors or buffer device address.
-    // But wait, I created a pipeline layout with NO descriptor set layouts.
-    // That means I can't bind buffers via descriptors!
-    
-    // I must use Buffer Device Address (BDA) if I want to pass pointers via push constants,
-    // OR I must create a descriptor set layout and allocate sets.
-    // Given the "production ready" request and the existing code using BDA in other places,
-    // let's switch to BDA in the shader and pass addresses in push constants.
-    
-    // BUT, the shader I compiled in createPipelines used `binding = 0`.
-    // That requires a descriptor set.
-    // I need to fix createPipelines to use BDA or create a descriptor layout.
-    
-    // Let's fix createPipelines first to use BDA, as it's cleaner for this dynamic binding.
-    // OR, simpler: use vkCmdPushDescriptorSet (if available) or just create a temporary descriptor set?
-    // Creating sets per call is expensive.
-    
-    // Let's assume BDA is available (checked in VulkanContext).
-    // I will update the shader in createPipelines to use buffer_reference.
-    // And update this function to take addresses.
-    // Wait, the function takes vk::Buffer. I can get address from buffer if BDA is enabled.
-    
-    // For now, to avoid rewriting createPipelines immediately in this chunk (sequential edits),
-    // I will assume I can get the address.
-    
-    // Actually, I need to rewrite createPipelines to change the shader source.
-    // So I will do that in a separate step or combined.
-    
-    // Let's stick to the signature change here, and I'll fix the pipeline creation in the next step.
-    // For now, I'll just log and dispatch dummy to satisfy the signature change.
-    
-    // ... wait, I can't leave it broken.
-    // I will implement the logic assuming BDA.
-    
-    vk::BufferDeviceAddressInfo fieldAddrInfo{fieldBuffer};
-    uint64_t fieldAddr = m_context.getDevice().getBufferAddress(fieldAddrInfo);
-    
-    vk::BufferDeviceAddressInfo haloAddrInfo{haloBuffer};
-    uint64_t haloAddr = m_context.getDevice().getBufferAddress(haloAddrInfo);
-    
-    struct PC { 
-        uint64_t fieldAddr; 
-        uint64_t haloAddr; 
-        uint32_t offset; 
-        uint32_t count; 
-    } pc{fieldAddr, haloAddr, offset, count};
-    
+
+    // Buffers are passed as device addresses (no descriptor sets)
+    vk::BufferDeviceAddressInfo segmentAddrInfo{segmentTable};
+    uint64_t segmentAddr = m_context.getDevice().getBufferAddress(segmentAddrInfo);
+
+    vk::BufferDeviceAddressInfo messageAddrInfo{messageBuffer};
+    uint64_t messageAddr = m_context.getDevice().getBufferAddress(messageAddrInfo);
+
+    vk::BufferDeviceAddressInfo indexAddrInfo{indexBuffer};
+    uint64_t indexAddr = m_context.getDevice().getBufferAddress(indexAddrInfo);
+
+    struct PC {
+        uint64_t segmentAddr;
+        uint64_t messageAddr;
+        uint64_t indexAddr;
+        uint32_t segmentMask;
+        uint32_t maxUnits;
+    } pc{segmentAddr, messageAddr, indexAddr, segmentMask, maxUnits};
+
     cmd.pushConstants<PC>(m_pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, pc);
-    cmd.dispatch((count + 255) / 256, 1, 1);
+    cmd.dispatch((maxUnits + 255) / 256, segmentCount, 1);
 }
 
 void HaloSync::recordHaloTransfer(vk::CommandBuffer cmd,
                                   vk::Buffer srcBuffer,
                                   vk::Buffer dstBuffer,
-                                  vk::DeviceSize size) {
-    // Simple buffer copy
+                                  const std::vector<vk::BufferCopy>& regions) {
+    // One copy per message; each region is a field segment
     // In a real multi-GPU setup, this might involve specialized transfer queues or P2P.
     // Here we assume unified memory or P2P access.
-    
-    vk::BufferCopy copyRegion{};
-    copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = 0;
-    copyRegion.size = size;
-    
-    cmd.copyBuffer(srcBuffer, dstBuffer, 1, &copyRegion);
+    if (regions.empty()) {
+        return;
+    }
+
+    cmd.copyBuffer(srcBuffer, dstBuffer, regions);
 }
 
 void HaloSync::recordHaloUnpack(vk::CommandBuffer cmd,
-                                vk::Buffer haloBuffer,
-                                vk::Buffer fieldBuffer,
-                                uint32_t offset,
-                                uint32_t count) {
+                                vk::Buffer segmentTable,
+                                vk::Buffer messageBuffer,
+                                vk::Buffer indexBuffer,
+                                uint32_t segmentMask,
+                                uint32_t segmentCount,
+                                uint32_t maxUnits) {
+    if (segmentMask == 0 || maxUnits == 0) {
+        return;
+    }
+
     // Barrier to ensure transfer is visible
     vk::MemoryBarrier barrier = createMemoryBarrier();
     cmd.pipelineBarrier(
-        vk::PipelineStageFlagBits::eTransfer, // Assuming transfer wrote to haloBuffer
+        vk::PipelineStageFlagBits::eTransfer, // Assuming transfer wrote to the message
         vk::PipelineStageFlagBits::eComputeShader,
         vk::DependencyFlags{},
         barrier, nullptr, nullptr);
 
-    vk::BufferDeviceAddressInfo haloAddrInfo{haloBuffer};
-    uint64_t haloAddr = m_context.getDevice().getBufferAddress(haloAddrInfo);
-    
-    vk::BufferDeviceAddressInfo fieldAddrInfo{fieldBuffer};
-    uint64_t fieldAddr = m_context.getDevice().getBufferAddress(fieldAddrInfo);
-    
-    struct PC { 
-        uint64_t haloAddr; 
-        uint64_t fieldAddr; 
-        uint32_t offset; 
-        uint32_t count; 
-    } pc{haloAddr, fieldAddr, offset, count};
+    vk::BufferDeviceAddressInfo segmentAddrInfo{segmentTable};
+    uint64_t segmentAddr = m_context.getDevice().getBufferAddress(segmentAddrInfo);
+
+    vk::BufferDeviceAddressInfo messageAddrInfo{messageBuffer};
+    uint64_t messageAddr = m_context.getDevice().getBufferAddress(messageAddrInfo);
+
+    vk::BufferDeviceAddressInfo indexAddrInfo{indexBuffer};
+    uint64_t indexAddr = m_context.getDevice().getBufferAddress(indexAddrInfo);
+
+    struct PC {
+        uint64_t segmentAddr;
+        uint64_t messageAddr;
+        uint64_t indexAddr;
+        uint32_t segmentMask;
+        uint32_t maxUnits;
+    } pc{segmentAddr, messageAddr, indexAddr, segmentMask, maxUnits};
 
     cmd.bindPipeline(vk::PipelineBindPoint::eCompute, m_unpackPipeline);
     cmd.pushConstants<PC>(m_pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, pc);
-    cmd.dispatch((count + 255) / 256, 1, 1);
+    cmd.dispatch((maxUnits + 255) / 256, segmentCount, 1);
 }
 
 std::vector<vk::CommandBuffer> HaloSync::generateSyncCommands(
@@ -0,0 +1,54 @@
+#include "halo/HostLink.hpp"
+#include "halo/SharedMemoryRing.hpp"
+#include "halo/UnixSocketLink.hpp"
+
+#include <stdexcept>
+
+namespace halo {
+
+std::unique_ptr<HostLink> HostLink::create(HostLinkType type, const std::string& name,
+                                           uint32_t slotCount, uint64_t slotBytes) {
+    switch (type) {
+        case HostLinkType::SharedMemory:
+            return SharedMemoryRing::create(name, slotCount, slotBytes);
+        case HostLinkType::UnixSocket:
+            return UnixSocketLink::create(name, slotBytes);
+    }
+    throw std::runtime_error("Unknown host link type");
+}
+
+std::unique_ptr<HostLink> HostLink::open(HostLinkType type, const std::string& name,
+                                         uint64_t slotBytes, std::chrono::milliseconds timeout) {
+    switch (type) {
+        case HostLinkType::SharedMemory:
+            return SharedMemoryRing::open(name, slotBytes, timeout);
+        case HostLinkType::UnixSocket:
+            return UnixSocketLink::open(name, slotBytes, timeout);
+    }
+    throw std::runtime_error("Unknown host link type");
+}
+
+std::string HostLink::linkName(const std::string& session, uint32_t generation,
+                               uint32_t srcGpu, uint32_t dstGpu) {
+    return "fluidloom-" + session + "-" + std::to_string(generation) + "-" +
+           std::to_string(srcGpu) + "-" + std::to_string(dstGpu);
+}
+
+const char* HostLink::typeName(HostLinkType type) {
+    switch (type) {
+        case HostLinkType::SharedMemory: return "shm";
+        case HostLinkType::UnixSocket: return "socket";
+    }
+    return "unknown";
+}
+
+HostLinkType HostLink::parseType(const std::string& name) {
+    for (HostLinkType type : {HostLinkType::SharedMemory, HostLinkType::UnixSocket}) {
+        if (name == typeName(type)) {
+            return type;
+        }
+    }
+    throw std::runtime_error("Unknown host link '" + name + "' (expected shm or socket)");
+}
+
+} // namespace halo
@@ -0,0 +1,424 @@
+#include "halo/LevelInterface.hpp"
+#include "domain/DomainSplitter.hpp"
+#include "core/Logger.hpp"
+#include "core/ShaderCompiler.hpp"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace halo {
+
+namespace {
+
+static_assert(sizeof(LevelInterface::Entry) == sizeof(uint32_t) * (1 + 2 * LevelInterface::kMaxSources),
+              "Entry must match the kernel's scalar layout");
+
+// 21 bits per axis, as for the halo index lists
+uint64_t coordKey(const nanovdb::Coord& ijk) {
+    auto axisBits = [](int32_t v) { return static_cast<uint64_t>(v) & 0x1FFFFF; };
+    return axisBits(ijk[0]) | (axisBits(ijk[1]) << 21) | (axisBits(ijk[2]) << 42);
+}
+
+// Coarse cell containing a fine voxel (arithmetic shift rounds towards -inf)
+nanovdb::Coord parentOf(const nanovdb::Coord& ijk) {
+    return nanovdb::Coord(ijk[0] >> 1, ijk[1] >> 1, ijk[2] >> 1);
+}
+
+void sortMorton(std::vector<nanovdb::Coord>& coords) {
+    std::sort(coords.begin(), coords.end(), [](const nanovdb::Coord& a, const nanovdb::Coord& b) {
+        return domain::DomainSplitter::getMortonCode(a) < domain::DomainSplitter::getMortonCode(b);
+    });
+}
+
+bool isFloatFormat(vk::Format format) {
+    return format == vk::Format::eR32Sfloat || format == vk::Format::eR32G32Sfloat ||
+           format == vk::Format::eR32G32B32Sfloat || format == vk::Format::eR32G32B32A32Sfloat;
+}
+
+// x: entry, y: field. Targets and sources of one dispatch are on different
+// levels, so entries never read what another invocation writes.
+constexpr const char* kGatherShader = R"(
+#version 460
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_scalar_block_layout : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+
+layout(local_size_x = 256) in;
+
+const uint MAX_SOURCES = 8u;
+
+struct Entry {
+    uint target;
+    uint sources[MAX_SOURCES];
+    float weights[MAX_SOURCES];
+};
+
+struct FieldSlot {
+    uint64_t addr;
+    uint components;
+    uint _pad;
+};
+
+layout(buffer_reference, scalar) buffer EntryList { Entry entries[]; };
+layout(buffer_reference, scalar) buffer FieldTable { FieldSlot fields[]; };
+layout(buffer_reference, scalar) buffer FloatBuffer { float data[]; };
+
+layout(push_constant) uniform PC {
+    uint64_t entryAddr;
+    uint64_t fieldTableAddr;
+    uint entryCount;
+    uint fieldCount;
+} pc;
+
+void main() {
+    uint e = gl_GlobalInvocationID.x;
+    if (e >= pc.entryCount) {
+        return;
+    }
+
+    Entry entry = EntryList(pc.entryAddr).entries[e];
+    FieldSlot slot = FieldTable(pc.fieldTableAddr).fields[gl_WorkGroupID.y];
+    FloatBuffer field = FloatBuffer(slot.addr);
+
+    for (uint c = 0u; c < slot.components; ++c) {
+        float sum = 0.0;
+        for (uint i = 0u; i < MAX_SOURCES; ++i) {
+            if (entry.weights[i] != 0.0) {
+                sum += entry.weights[i] * field.data[entry.sources[i] * slot.components + c];
+            }
+        }
+        field.data[entry.target * slot.components + c] = sum;
+    }
+}
+)";
+
+} // namespace
+
+LevelInterface::Layout LevelInterface::buildLayout(
+    const std::vector<std::vector<nanovdb::Coord>>& levelCells,
+    uint32_t ghostDepth) {
+    std::vector<std::unordered_set<uint64_t>> cellKeys(levelCells.size());
+    for (size_t level = 0; level < levelCells.size(); ++level) {
+        for (const auto& ijk : levelCells[level]) {
+            cellKeys[level].insert(coordKey(ijk));
+        }
+    }
+
+    Layout layout;
+    int32_t depth = static_cast<int32_t>(ghostDepth);
+    for (size_t level = 0; level < levelCells.size(); ++level) {
+        std::vector<nanovdb::Coord> cells = levelCells[level];
+        sortMorton(cells);
+
+        // Fine voxels around the level that a coarse cell can fill
+        std::vector<nanovdb::Coord> ghosts;
+        if (level > 0) {
+            std::unordered_set<uint64_t> seen;
+            for (const auto& ijk : cells) {
+                for (int32_t dz = -depth; dz <= depth; ++dz) {
+                    for (int32_t dy = -depth; dy <= depth; ++dy) {
+                        for (int32_t dx = -depth; dx <= depth; ++dx) {
+                            nanovdb::Coord g = ijk.offsetBy(dx, dy, dz);
+                            uint64_t key = coordKey(g);
+                            if (cellKeys[level].count(key) || !seen.insert(key).second) {
+                                continue;
+                            }
+                            if (cellKeys[level - 1].count(coordKey(parentOf(g)))) {
+                                ghosts.push_back(g);
+                            }
+                        }
+                    }
+                }
+            }
+            sortMorton(ghosts);
+        }
+
+        LevelRange range;
+        range.level = static_cast<uint32_t>(level);
+        range.startIndex = static_cast<uint32_t>(layout.coords.size());
+        range.count = static_cast<uint32_t>(cells.size());
+        range.ghostCount = static_cast<uint32_t>(ghosts.size());
+        layout.levels.push_back(range);
+
+        layout.coords.insert(layout.coords.end(), cells.begin(), cells.end());
+        layout.coords.insert(layout.coords.end(), ghosts.begin(), ghosts.end());
+    }
+    return layout;
+}
+
+std::vector<LevelInterface::LevelLists> LevelInterface::buildLists(
+    const std::vector<nanovdb::Coord>& coords,
+    const std::vector<LevelRange>& levels,
+    Prolongation prolongation) {
+    // Element of each cell (ghosts are never interpolation sources)
+    std::vector<std::unordered_map<uint64_t, uint32_t>> cellIndex(levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        LOG_CHECK(i == 0 || levels[i].level == levels[i - 1].level + 1,
+                  "Grid levels must be consecutive");
+        LOG_CHECK(static_cast<size_t>(levels[i].startIndex) + levels[i].count + levels[i].ghostCount <= coords.size(),
+                  "Level range exceeds the field coordinates");
+        cellIndex[i].reserve(levels[i].count);
+        for (uint32_t e = levels[i].startIndex; e < levels[i].startIndex + levels[i].count; ++e) {
+            cellIndex[i][coordKey(coords[e])] = e;
+        }
+    }
+
+    std::vector<LevelLists> lists(levels.size());
+    uint32_t orphans = 0;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        lists[i].level = levels[i].level;
+
+        // Prolongation: ghosts of level i from cells of level i - 1
+        uint32_t firstGhost = levels[i].startIndex + levels[i].count;
+        for (uint32_t e = firstGhost; i > 0 && e < firstGhost + levels[i].ghostCount; ++e) {
+            const auto& coarse = cellIndex[i - 1];
+            nanovdb::Coord g = coords[e];
+            nanovdb::Coord p = parentOf(g);
+            auto parent = coarse.find(coordKey(p));
+            if (parent == coarse.end()) {
+                ++orphans;
+                continue;
+            }
+
+            Entry entry;
+            entry.target = e;
+            if (prolongation == Prolongation::Conservative) {
+                entry.sources[0] = parent->second;
+                entry.weights[0] = 1.0f;
+            } else {
+                // The ghost sits a quarter cell from its parent's centre,
+                // towards the coarse neighbour on its side of each axis
+                int32_t side[3];
+                for (int a = 0; a < 3; ++a) {
+                    side[a] = (g[a] & 1) ? 1 : -1;
+                }
+                uint32_t n = 0;
+                float total = 0.0f;
+                for (uint32_t corner = 0; corner < kMaxSources; ++corner) {
+                    nanovdb::Coord q = p;
+                    float weight = 1.0f;
+                    for (int a = 0; a < 3; ++a) {
+                        if (corner & (1u << a)) {
+                            q[a] += side[a];
+                            weight *= 0.25f;
+                        } else {
+                            weight *= 0.75f;
+                        }
+                    }
+                    auto source = coarse.find(coordKey(q));
+                    if (source == coarse.end()) {
+                        continue;   // Coarse boundary: renormalize over what exists
+                    }
+                    entry.sources[n] = source->second;
+                    entry.weights[n] = weight;
+                    total += weight;
+                    ++n;
+                }
+                for (uint32_t k = 0; k < n; ++k) {
+                    entry.weights[k] /= total;
+                }
+            }
+            lists[i].prolongation.push_back(entry);
+        }
+
+        // Restriction: covered cells of level i average their children on level i + 1
+        if (i + 1 < levels.size()) {
+            std::map<uint32_t, std::vector<uint32_t>> children;
+            const auto& fine = levels[i + 1];
+            for (uint32_t e = fine.startIndex; e < fine.startIndex + fine.count; ++e) {
+                auto parent = cellIndex[i].find(coordKey(parentOf(coords[e])));
+                if (parent != cellIndex[i].end()) {
+                    children[parent->second].push_back(e);
+                }
+            }
+            for (const auto& [target, sources] : children) {
+                Entry entry;
+                entry.target = target;
+                for (size_t k = 0; k < sources.size(); ++k) {
+                    entry.sources[k] = sources[k];
+                    entry.weights[k] = 1.0f / static_cast<float>(sources.size());
+                }
+                lists[i].restriction.push_back(entry);
+            }
+        }
+    }
+
+    if (orphans > 0) {
+        LOG_WARN("{} interface ghosts have no coarse parent and are left unfilled", orphans);
+    }
+    return lists;
+}
+
+LevelInterface::LevelInterface(const core::VulkanContext& context,
+                               core::MemoryAllocator& allocator,
+                               const Config& config)
+    : m_context(context), m_allocator(allocator), m_config(config) {
+    createPipeline();
+    LOG_DEBUG("LevelInterface initialized ({} prolongation)",
+              config.prolongation == Prolongation::Trilinear ? "trilinear" : "conservative");
+}
+
+LevelInterface::~LevelInterface() {
+    releaseBuffers();
+    m_allocator.destroyBuffer(m_fieldTable);
+    m_context.getDevice().destroyPipeline(m_pipeline);
+    m_context.getDevice().destroyPipelineLayout(m_pipelineLayout);
+}
+
+void LevelInterface::createPipeline() {
+    vk::PushConstantRange pushRange{};
+    pushRange.stageFlags = vk::ShaderStageFlagBits::eCompute;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(uint64_t) * 2 + sizeof(uint32_t) * 2; // 2 addrs + 2 uints
+
+    vk::PipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &pushRange;
+    m_pipelineLayout = m_context.getDevice().createPipelineLayout(layoutInfo);
+
+    std::vector<uint32_t> spirv = core::ShaderCompiler::compileOrThrow(
+        kGatherShader, vk::ShaderStageFlagBits::eCompute, "level_gather");
+
+    vk::ShaderModuleCreateInfo moduleInfo({}, spirv.size() * 4, spirv.data());
+    vk::ShaderModule module = m_context.getDevice().createShaderModule(moduleInfo);
+
+    vk::PipelineShaderStageCreateInfo stageInfo({}, vk::ShaderStageFlagBits::eCompute, module, "main", nullptr);
+    vk::ComputePipelineCreateInfo pipelineInfo({}, stageInfo, m_pipelineLayout, nullptr, -1);
+    m_pipeline = m_context.getDevice().createComputePipeline(nullptr, pipelineInfo).value;
+    m_context.getDevice().destroyShaderModule(module);
+}
+
+void LevelInterface::releaseBuffers() {
+    for (auto& buffers : m_buffers) {
+        m_allocator.destroyBuffer(buffers.entries);
+    }
+    m_buffers.clear();
+}
+
+void LevelInterface::rebuild(const std::vector<nanovdb::Coord>& coords,
+                             const std::vector<LevelRange>& levels) {
+    releaseBuffers();
+    m_lists = buildLists(coords, levels, m_config.prolongation);
+
+    uint64_t ghostCount = 0;
+    uint64_t coveredCount = 0;
+    m_buffers.resize(m_lists.size());
+    for (size_t i = 0; i < m_lists.size(); ++i) {
+        const auto& lists = m_lists[i];
+        auto& buffers = m_buffers[i];
+        buffers.prolongationCount = static_cast<uint32_t>(lists.prolongation.size());
+        buffers.restrictionCount = static_cast<uint32_t>(lists.restriction.size());
+        ghostCount += buffers.prolongationCount;
+        coveredCount += buffers.restrictionCount;
+
+        std::vector<Entry> entries = lists.prolongation;
+        entries.insert(entries.end(), lists.restriction.begin(), lists.restriction.end());
+        if (entries.empty()) {
+            continue;
+        }
+        vk::DeviceSize size = entries.size() * sizeof(Entry);
+        buffers.entries = m_allocator.createBuffer(
+            size,
+            vk::BufferUsageFlagBits::eStorageBuffer |
+            vk::BufferUsageFlagBits::eTransferDst |
+            vk::BufferUsageFlagBits::eShaderDeviceAddress);
+        m_allocator.uploadToGPU(buffers.entries, entries.data(), size);
+    }
+
+    LOG_INFO("Level interfaces rebuilt: {} levels, {} ghosts, {} covered cells",
+             m_lists.size(), ghostCount, coveredCount);
+}
+
+void LevelInterface::updateFieldTable(const field::FieldRegistry& fields) {
+    std::vector<FieldSlot> slots;
+    for (const auto& [name, desc] : fields.getFields()) {
+        if (isFloatFormat(desc.format)) {
+            slots.push_back({static_cast<uint64_t>(desc.deviceAddress),
+                             desc.elementSize / static_cast<uint32_t>(sizeof(float)), 0});
+        }
+    }
+
+    bool same = slots.size() == m_fieldSlots.size() &&
+        std::equal(slots.begin(), slots.end(), m_fieldSlots.begin(),
+                   [](const FieldSlot& a, const FieldSlot& b) {
+                       return a.address == b.address && a.components == b.components;
+                   });
+    if (same) {
+        return;
+    }
+
+    m_fieldSlots = std::move(slots);
+    m_allocator.destroyBuffer(m_fieldTable);
+    if (m_fieldSlots.empty()) {
+        return;
+    }
+    vk::DeviceSize size = m_fieldSlots.size() * sizeof(FieldSlot);
+    m_fieldTable = m_allocator.createBuffer(
+        size,
+        vk::BufferUsageFlagBits::eStorageBuffer |
+        vk::BufferUsageFlagBits::eTransferDst |
+        vk::BufferUsageFlagBits::eShaderDeviceAddress);
+    m_allocator.uploadToGPU(m_fieldTable, m_fieldSlots.data(), size);
+}
+
+bool LevelInterface::recordGather(vk::CommandBuffer cmd, const LevelBuffers& buffers,
+                                  uint32_t first, uint32_t count) {
+    if (count == 0) {
+        return false;
+    }
+
+    struct PC {
+        uint64_t entryAddr;
+        uint64_t fieldTableAddr;
+        uint32_t entryCount;
+        uint32_t fieldCount;
+    } pc{static_cast<uint64_t>(buffers.entries.deviceAddress) + first * sizeof(Entry),
+         static_cast<uint64_t>(m_fieldTable.deviceAddress),
+         count,
+         static_cast<uint32_t>(m_fieldSlots.size())};
+
+    cmd.bindPipeline(vk::PipelineBindPoint::eCompute, m_pipeline);
+    cmd.pushConstants<PC>(m_pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, pc);
+    cmd.dispatch((count + 255) / 256, pc.fieldCount, 1);
+    return true;
+}
+
+void LevelInterface::recordFill(vk::CommandBuffer cmd, const field::FieldRegistry& fields,
+                                uint32_t level) {
+    if (m_lists.empty() || level < m_lists.front().level ||
+        level - m_lists.front().level >= m_lists.size()) {
+        return;
+    }
+    updateFieldTable(fields);
+    if (m_fieldSlots.empty()) {
+        return;
+    }
+
+    auto barrier = [&cmd]() {
+        vk::MemoryBarrier memoryBarrier(vk::AccessFlagBits::eShaderWrite,
+                                        vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                            vk::PipelineStageFlagBits::eComputeShader,
+                            vk::DependencyFlags{}, memoryBarrier, nullptr, nullptr);
+    };
+
+    // Each transfer reads what the previous one wrote, finest first
+    size_t i = level - m_lists.front().level;
+    const auto& current = m_buffers[i];
+    if (recordGather(cmd, current, current.prolongationCount, current.restrictionCount)) {
+        barrier();
+    }
+    if (i > 0) {
+        const auto& coarser = m_buffers[i - 1];
+        if (recordGather(cmd, coarser, coarser.prolongationCount, coarser.restrictionCount)) {
+            barrier();
+        }
+    }
+    if (recordGather(cmd, current, 0, current.prolongationCount)) {
+        barrier();
+    }
+}
+
+} // namespace halo
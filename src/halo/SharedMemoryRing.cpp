@@ -0,0 +1,182 @@
+#include "halo/SharedMemoryRing.hpp"
+#include "core/Logger.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace halo {
+
+namespace {
+
+constexpr uint32_t kRingMagic = 0x464c5247;  // "FLRG"
+
+std::runtime_error systemError(const std::string& what, const std::string& name) {
+    return std::runtime_error(what + " '" + name + "': " + std::strerror(errno));
+}
+
+// POSIX shared memory names are a single leading slash plus the link name
+std::string posixName(const std::string& name) {
+    return "/" + name;
+}
+
+} // namespace
+
+SharedMemoryRing::SharedMemoryRing(std::string name, void* mapping, size_t mappingBytes, bool owner)
+    : m_name(std::move(name)),
+      m_mapping(mapping),
+      m_mappingBytes(mappingBytes),
+      m_owner(owner),
+      m_header(static_cast<Header*>(mapping)),
+      m_slotCount(m_header->slotCount),
+      m_slotBytes(m_header->slotBytes) {
+}
+
+SharedMemoryRing::~SharedMemoryRing() {
+    if (m_mapping) {
+        munmap(m_mapping, m_mappingBytes);
+    }
+    if (m_owner) {
+        shm_unlink(m_name.c_str());
+    }
+}
+
+size_t SharedMemoryRing::slotStride(uint64_t slotBytes) {
+    // Keep slots on separate cache lines
+    return (sizeof(SlotHeader) + slotBytes + 63) / 64 * 64;
+}
+
+size_t SharedMemoryRing::mappingSize(uint32_t slotCount, uint64_t slotBytes) {
+    return sizeof(Header) + slotCount * slotStride(slotBytes);
+}
+
+SharedMemoryRing::SlotHeader* SharedMemoryRing::slot(uint64_t index) const {
+    auto* base = reinterpret_cast<uint8_t*>(m_header + 1);
+    return reinterpret_cast<SlotHeader*>(base + (index % m_slotCount) * slotStride(m_slotBytes));
+}
+
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::create(const std::string& linkName,
+                                                           uint32_t slotCount,
+                                                           uint64_t slotBytes) {
+    LOG_CHECK(slotCount > 0, "Shared memory ring needs at least one slot");
+    std::string name = posixName(linkName);
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        LOG_WARN("Replacing stale shared memory ring '{}'", name);
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        throw systemError("Failed to create shared memory ring", name);
+    }
+
+    size_t bytes = mappingSize(slotCount, slotBytes);
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw systemError("Failed to size shared memory ring", name);
+    }
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw systemError("Failed to map shared memory ring", name);
+    }
+
+    // Fresh mappings are zeroed; the magic tells openers the layout is valid
+    auto* header = new (mapping) Header{};
+    header->slotCount = slotCount;
+    header->slotBytes = slotBytes;
+    header->head.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    header->magic.store(kRingMagic, std::memory_order_release);
+
+    LOG_DEBUG("Created shared memory ring '{}': {} x {} bytes", name, slotCount, slotBytes);
+    return std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(name, mapping, bytes, true));
+}
+
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::open(const std::string& linkName,
+                                                         uint64_t slotBytes,
+                                                         std::chrono::milliseconds timeout) {
+    std::string name = posixName(linkName);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (true) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd >= 0) {
+            struct stat info {};
+            if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header)) {
+                void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size),
+                                     PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                close(fd);
+                if (mapping == MAP_FAILED) {
+                    throw systemError("Failed to map shared memory ring", name);
+                }
+
+                auto* header = static_cast<Header*>(mapping);
+                if (header->magic.load(std::memory_order_acquire) == kRingMagic) {
+                    size_t bytes = static_cast<size_t>(info.st_size);
+                    LOG_CHECK(bytes >= mappingSize(header->slotCount, header->slotBytes),
+                              "Shared memory ring '" + name + "' is truncated");
+                    if (header->slotBytes < slotBytes) {
+                        munmap(mapping, bytes);
+                        throw std::runtime_error("Shared memory ring '" + name + "' slots are smaller than " +
+                                                 std::to_string(slotBytes) + " bytes");
+                    }
+                    return std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(name, mapping, bytes, false));
+                }
+                munmap(mapping, static_cast<size_t>(info.st_size));
+            } else {
+                close(fd);
+            }
+        } else if (errno != ENOENT) {
+            throw systemError("Failed to open shared memory ring", name);
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline) {
+            throw std::runtime_error("Timed out waiting for shared memory ring '" + name + "'");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+uint8_t* SharedMemoryRing::beginPush() {
+    uint64_t head = m_header->head.load(std::memory_order_relaxed);
+    if (head - m_header->tail.load(std::memory_order_acquire) >= m_slotCount) {
+        return nullptr;
+    }
+    return reinterpret_cast<uint8_t*>(slot(head) + 1);
+}
+
+void SharedMemoryRing::commitPush(uint64_t exchange, uint64_t size) {
+    LOG_CHECK(size <= m_slotBytes, "Message larger than its shared memory ring slot");
+    uint64_t head = m_header->head.load(std::memory_order_relaxed);
+    slot(head)->exchange = exchange;
+    slot(head)->size = size;
+    m_header->head.store(head + 1, std::memory_order_release);
+}
+
+const uint8_t* SharedMemoryRing::beginPop(uint64_t& exchange, uint64_t& size) {
+    uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+    if (tail == m_header->head.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    exchange = slot(tail)->exchange;
+    size = slot(tail)->size;
+    return reinterpret_cast<const uint8_t*>(slot(tail) + 1);
+}
+
+void SharedMemoryRing::commitPop() {
+    uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+    m_header->tail.store(tail + 1, std::memory_order_release);
+}
+
+} // namespace halo
@@ -0,0 +1,434 @@
+#include "halo/StagedTransfer.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace halo {
+
+namespace {
+
+// Link names carry the allocation round; ranks allocate in the same order
+std::atomic<uint32_t> g_linkGeneration{0};
+
+} // namespace
+
+StagedTransfer::StagedTransfer(HaloManager& haloManager, const Config& config)
+    : m_haloManager(haloManager),
+      m_config(config),
+      m_gpuCount(haloManager.getGPUCount()) {
+    LOG_CHECK(config.rank < static_cast<int32_t>(m_gpuCount), "Rank has no domain");
+    LOG_CHECK(config.rank < 0 || !config.session.empty(), "Ranks need a session name for their links");
+    m_channelIndex.assign(m_gpuCount * m_gpuCount, nullptr);
+    m_drainedSemaphores.resize(m_gpuCount * m_gpuCount);
+    m_arrivedSemaphores.resize(m_gpuCount * m_gpuCount);
+    if (config.rank < 0) {
+        LOG_INFO("StagedTransfer initialized for {} devices", m_gpuCount);
+    } else {
+        LOG_INFO("StagedTransfer initialized for rank {} of {} (session '{}', {} links)",
+                 config.rank, m_gpuCount, config.session, HostLink::typeName(config.link));
+    }
+}
+
+StagedTransfer::~StagedTransfer() {
+    stopRelays();
+    destroyChannels();
+
+    for (uint32_t src = 0; src < m_gpuCount; ++src) {
+        for (uint32_t dst = 0; dst < m_gpuCount; ++dst) {
+            uint32_t pair = src * m_gpuCount + dst;
+            if (m_drainedSemaphores[pair]) {
+                m_haloManager.getDevice(src).destroySemaphore(m_drainedSemaphores[pair]);
+            }
+            if (m_arrivedSemaphores[pair]) {
+                m_haloManager.getDevice(dst).destroySemaphore(m_arrivedSemaphores[pair]);
+            }
+        }
+    }
+    LOG_DEBUG("StagedTransfer destroyed");
+}
+
+void StagedTransfer::destroyChannels() {
+    for (auto& channel : m_channels) {
+        for (auto& slot : channel->sendSlots) {
+            m_haloManager.getAllocator(channel->srcGpu).destroyBuffer(slot);
+        }
+        for (auto& slot : channel->recvSlots) {
+            m_haloManager.getAllocator(channel->dstGpu).destroyBuffer(slot);
+        }
+    }
+    m_channels.clear();
+    m_channelIndex.assign(m_gpuCount * m_gpuCount, nullptr);
+}
+
+void StagedTransfer::allocate() {
+    stopRelays();
+    destroyChannels();
+    uint32_t generation = m_config.rank < 0 ? 0 : g_linkGeneration++;
+
+    vk::SemaphoreTypeCreateInfo timelineCreateInfo(vk::SemaphoreType::eTimeline, 0);
+    vk::SemaphoreCreateInfo createInfo;
+    createInfo.setPNext(&timelineCreateInfo);
+
+    vk::DeviceSize slotBytes = 0;
+    for (uint32_t src = 0; src < m_gpuCount; ++src) {
+        for (const auto& message : m_haloManager.getHaloBufferSet(src).messages) {
+            uint32_t dst = message.neighborGpu;
+            auto* incoming = m_haloManager.getHaloBufferSet(dst).find(src);
+            if (message.sendBytes == 0 || !incoming || incoming->recvBytes == 0) {
+                continue;
+            }
+            if (!isLocal(src) && !isLocal(dst)) {
+                continue;
+            }
+
+            auto channel = std::make_unique<Channel>();
+            channel->srcGpu = src;
+            channel->dstGpu = dst;
+            channel->route = isLocal(dst) ? (isLocal(src) ? Route::Local : Route::Incoming) : Route::Outgoing;
+            channel->relay = m_config.rank < 0 ? src : (channel->route == Route::Outgoing ? 0 : 1);
+
+            uint32_t pair = src * m_gpuCount + dst;
+            if (channel->route != Route::Incoming) {
+                for (auto& slot : channel->sendSlots) {
+                    slot = m_haloManager.getAllocator(src).createBuffer(
+                        message.sendBytes, vk::BufferUsageFlagBits::eTransferDst,
+                        VMA_MEMORY_USAGE_GPU_TO_CPU);
+                }
+                LOG_CHECK(channel->sendSlots[0].mappedData, "Staging slots must be host-mapped");
+                slotBytes += 2 * message.sendBytes;
+                if (!m_drainedSemaphores[pair]) {
+                    m_drainedSemaphores[pair] = m_haloManager.getDevice(src).createSemaphore(createInfo);
+                }
+            }
+            if (channel->route != Route::Outgoing) {
+                for (auto& slot : channel->recvSlots) {
+                    slot = m_haloManager.getAllocator(dst).createBuffer(
+                        incoming->recvBytes, vk::BufferUsageFlagBits::eTransferSrc,
+                        VMA_MEMORY_USAGE_CPU_TO_GPU);
+                }
+                LOG_CHECK(channel->recvSlots[0].mappedData, "Staging slots must be host-mapped");
+                slotBytes += 2 * incoming->recvBytes;
+                if (!m_arrivedSemaphores[pair]) {
+                    m_arrivedSemaphores[pair] = m_haloManager.getDevice(dst).createSemaphore(createInfo);
+                }
+            }
+
+            // Receivers create their links first, so no two ranks wait on each other
+            if (channel->route == Route::Incoming) {
+                channel->link = HostLink::create(
+                    m_config.link, HostLink::linkName(m_config.session, generation, src, dst),
+                    std::max(m_config.ringSlots, 1u), incoming->recvBytes);
+            }
+
+            m_channelIndex[pair] = channel.get();
+            m_channels.push_back(std::move(channel));
+        }
+    }
+
+    for (auto& channel : m_channels) {
+        if (channel->route != Route::Outgoing) {
+            continue;
+        }
+        // The receiving rank must agree on the message size
+        auto* incoming = m_haloManager.getHaloBufferSet(channel->dstGpu).find(channel->srcGpu);
+        channel->link = HostLink::open(
+            m_config.link, HostLink::linkName(m_config.session, generation, channel->srcGpu, channel->dstGpu),
+            incoming->recvBytes, std::chrono::milliseconds(m_config.openTimeoutMs));
+    }
+
+    LOG_INFO("Staged halo transfer: {} channels, {} bytes of pinned staging slots",
+             m_channels.size(), slotBytes);
+    startRelays();
+}
+
+StagedTransfer::Channel& StagedTransfer::channel(uint32_t srcGpu, uint32_t dstGpu) const {
+    if (srcGpu >= m_gpuCount || dstGpu >= m_gpuCount || !m_channelIndex[srcGpu * m_gpuCount + dstGpu]) {
+        throw std::runtime_error("No staged channel for GPU " + std::to_string(srcGpu) +
+                                 " -> " + std::to_string(dstGpu));
+    }
+    return *m_channelIndex[srcGpu * m_gpuCount + dstGpu];
+}
+
+const char* StagedTransfer::getName() const {
+    if (m_config.rank < 0) {
+        return "host staging";
+    }
+    return m_config.link == HostLinkType::UnixSocket ? "unix socket" : "shared memory";
+}
+
+Transport::Wait StagedTransfer::sendWait(uint32_t srcGpu, uint32_t dstGpu, uint64_t exchange) const {
+    if (exchange <= 2) {
+        return {};
+    }
+    return {getDrainedSemaphore(srcGpu, dstGpu), exchange - 2};
+}
+
+Transport::Wait StagedTransfer::receiveWait(uint32_t srcGpu, uint32_t dstGpu, uint64_t exchange) const {
+    return {getArrivedSemaphore(srcGpu, dstGpu), exchange};
+}
+
+vk::Semaphore StagedTransfer::getDrainedSemaphore(uint32_t srcGpu, uint32_t dstGpu) const {
+    return m_drainedSemaphores.at(srcGpu * m_gpuCount + dstGpu);
+}
+
+vk::Semaphore StagedTransfer::getArrivedSemaphore(uint32_t srcGpu, uint32_t dstGpu) const {
+    return m_arrivedSemaphores.at(srcGpu * m_gpuCount + dstGpu);
+}
+
+void StagedTransfer::recordStage(vk::CommandBuffer cmd, uint32_t srcGpu, uint32_t dstGpu,
+                                 uint64_t exchange, const std::vector<vk::BufferCopy>& regions) {
+    if (regions.empty()) {
+        return;
+    }
+
+    Channel& staged = channel(srcGpu, dstGpu);
+    auto* message = m_haloManager.getHaloBufferSet(srcGpu).find(dstGpu);
+    LOG_CHECK(message, "Staged exchange without a halo message");
+
+    // Segments keep their send message offsets inside the slot
+    std::vector<vk::BufferCopy> slotRegions;
+    slotRegions.reserve(regions.size());
+    for (const auto& region : regions) {
+        slotRegions.emplace_back(region.srcOffset, region.srcOffset, region.size);
+    }
+    cmd.copyBuffer(message->sendBuffer.handle, staged.sendSlots[exchange % 2].handle, slotRegions);
+
+    // The relay reads the slot on the host once the halo semaphore is signalled
+    vk::MemoryBarrier hostBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
+                        vk::DependencyFlags{}, hostBarrier, nullptr, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        staged.pending.push_back({exchange, regions});
+    }
+    m_pendingChanged.notify_all();
+}
+
+void StagedTransfer::recordReceive(vk::CommandBuffer cmd, uint32_t srcGpu, uint32_t dstGpu,
+                                   uint64_t exchange, const std::vector<vk::BufferCopy>& regions) {
+    if (regions.empty()) {
+        return;
+    }
+
+    Channel& staged = channel(srcGpu, dstGpu);
+    auto* message = m_haloManager.getHaloBufferSet(dstGpu).find(srcGpu);
+    LOG_CHECK(message, "Staged exchange without a halo message");
+
+    // The previous unpack may still read the receive message
+    vk::MemoryBarrier readBarrier(vk::AccessFlagBits::eShaderRead, vk::AccessFlagBits::eTransferWrite);
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer,
+                        vk::DependencyFlags{}, readBarrier, nullptr, nullptr);
+    cmd.copyBuffer(staged.recvSlots[exchange % 2].handle, message->recvBuffer.handle, regions);
+    vk::MemoryBarrier copyBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead);
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+                        vk::DependencyFlags{}, copyBarrier, nullptr, nullptr);
+}
+
+void StagedTransfer::startRelays() {
+    uint32_t relayCount = 0;
+    for (const auto& channel : m_channels) {
+        relayCount = std::max(relayCount, channel->relay + 1);
+    }
+
+    m_stop = false;
+    for (uint32_t relayIndex = 0; relayIndex < relayCount; ++relayIndex) {
+        m_relays.emplace_back(&StagedTransfer::relay, this, relayIndex);
+    }
+}
+
+void StagedTransfer::stopRelays() {
+    m_stop = true;
+    m_pendingChanged.notify_all();
+    for (auto& thread : m_relays) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    m_relays.clear();
+
+    for (const auto& channel : m_channels) {
+        if (!channel->pending.empty()) {
+            LOG_WARN("GPU {} -> GPU {}: {} staged exchanges dropped",
+                     channel->srcGpu, channel->dstGpu, channel->pending.size());
+            channel->pending.clear();
+        }
+    }
+}
+
+const StagedTransfer::PendingCopy* StagedTransfer::frontPending(Channel& channel) {
+    // Only the channel's relay thread pops, so the front stays valid while unlocked
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return channel.pending.empty() ? nullptr : &channel.pending.front();
+}
+
+void StagedTransfer::popPending(Channel& channel) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    channel.pending.pop_front();
+}
+
+void StagedTransfer::signal(uint32_t gpuIndex, vk::Semaphore semaphore, uint64_t value) {
+    m_haloManager.getDevice(gpuIndex).signalSemaphore(vk::SemaphoreSignalInfo(semaphore, value));
+}
+
+void StagedTransfer::relay(uint32_t relayIndex) {
+    vk::Device device;
+
+    while (!m_stop) {
+        bool progressed = false;
+        bool idle = true;
+        std::vector<vk::Semaphore> stagedSemaphores;
+        std::vector<uint64_t> stagedValues;
+
+        for (const auto& channel : m_channels) {
+            if (channel->relay != relayIndex) {
+                continue;
+            }
+            device = m_haloManager.getDevice(channel->srcGpu);
+
+            Progress progress = Progress::Idle;
+            switch (channel->route) {
+                case Route::Local:
+                    progress = relayLocal(*channel, stagedSemaphores, stagedValues);
+                    break;
+                case Route::Outgoing:
+                    progress = relayOutgoing(*channel, stagedSemaphores, stagedValues);
+                    break;
+                case Route::Incoming:
+                    progress = relayIncoming(*channel);
+                    break;
+            }
+            progressed |= progress == Progress::Moved;
+            idle &= progress == Progress::Idle;
+        }
+
+        if (progressed) {
+            continue;
+        }
+        if (idle) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_pendingChanged.wait_for(lock, std::chrono::milliseconds(10));
+        } else if (!stagedSemaphores.empty()) {
+            // Sleep until any of this device's messages is staged (slots and links are polled)
+            vk::SemaphoreWaitInfo waitInfo(vk::SemaphoreWaitFlagBits::eAny, stagedSemaphores, stagedValues);
+            (void)device.waitSemaphores(waitInfo, 1000000);
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+StagedTransfer::Progress StagedTransfer::relayLocal(Channel& channel,
+                                                    std::vector<vk::Semaphore>& waitSemaphores,
+                                                    std::vector<uint64_t>& waitValues) {
+    const PendingCopy* copy = frontPending(channel);
+    if (!copy) {
+        return Progress::Idle;
+    }
+
+    vk::Semaphore halo = m_haloManager.getHaloSemaphore(channel.srcGpu, channel.dstGpu);
+    vk::Semaphore release = m_haloManager.getReleaseSemaphore(channel.srcGpu, channel.dstGpu);
+    uint64_t staged = m_haloManager.getDevice(channel.srcGpu).getSemaphoreCounterValue(halo);
+    uint64_t released = m_haloManager.getDevice(channel.dstGpu).getSemaphoreCounterValue(release);
+    if (!slotReady(copy->exchange, staged, released)) {
+        if (staged < copy->exchange) {
+            waitSemaphores.push_back(halo);
+            waitValues.push_back(copy->exchange);
+        }
+        return Progress::Blocked;
+    }
+
+    auto& sendSlot = channel.sendSlots[copy->exchange % 2];
+    auto& recvSlot = channel.recvSlots[copy->exchange % 2];
+    m_haloManager.getAllocator(channel.srcGpu).invalidateBuffer(sendSlot);
+    const auto* src = static_cast<const uint8_t*>(sendSlot.mappedData);
+    auto* dst = static_cast<uint8_t*>(recvSlot.mappedData);
+    uint64_t bytes = 0;
+    for (const auto& region : copy->regions) {
+        std::memcpy(dst + region.dstOffset, src + region.srcOffset, region.size);
+        bytes += region.size;
+    }
+    m_haloManager.getAllocator(channel.dstGpu).flushBuffer(recvSlot);
+
+    // Host signals: the sender may refill its slot, the receiver may copy out
+    uint32_t pair = channel.srcGpu * m_gpuCount + channel.dstGpu;
+    signal(channel.srcGpu, m_drainedSemaphores[pair], copy->exchange);
+    signal(channel.dstGpu, m_arrivedSemaphores[pair], copy->exchange);
+    m_bytesSent += bytes;
+    m_bytesReceived += bytes;
+    popPending(channel);
+    return Progress::Moved;
+}
+
+StagedTransfer::Progress StagedTransfer::relayOutgoing(Channel& channel,
+                                                       std::vector<vk::Semaphore>& waitSemaphores,
+                                                       std::vector<uint64_t>& waitValues) {
+    // A message the link took only in part is finished first (sockets)
+    if (!channel.link->flush()) {
+        return Progress::Blocked;
+    }
+
+    const PendingCopy* copy = frontPending(channel);
+    if (!copy) {
+        return Progress::Idle;
+    }
+
+    vk::Semaphore halo = m_haloManager.getHaloSemaphore(channel.srcGpu, channel.dstGpu);
+    if (m_haloManager.getDevice(channel.srcGpu).getSemaphoreCounterValue(halo) < copy->exchange) {
+        waitSemaphores.push_back(halo);
+        waitValues.push_back(copy->exchange);
+        return Progress::Blocked;
+    }
+
+    // A full link means the receiving rank is behind
+    uint8_t* payload = channel.link->beginPush();
+    if (!payload) {
+        return Progress::Blocked;
+    }
+
+    // The link message is laid out like the receive message
+    auto& sendSlot = channel.sendSlots[copy->exchange % 2];
+    m_haloManager.getAllocator(channel.srcGpu).invalidateBuffer(sendSlot);
+    const auto* src = static_cast<const uint8_t*>(sendSlot.mappedData);
+    uint64_t size = 0;
+    for (const auto& region : copy->regions) {
+        std::memcpy(payload + region.dstOffset, src + region.srcOffset, region.size);
+        size = std::max<uint64_t>(size, region.dstOffset + region.size);
+    }
+    channel.link->commitPush(copy->exchange, size);
+
+    signal(channel.srcGpu, m_drainedSemaphores[channel.srcGpu * m_gpuCount + channel.dstGpu], copy->exchange);
+    m_bytesSent += size;
+    popPending(channel);
+    return Progress::Moved;
+}
+
+StagedTransfer::Progress StagedTransfer::relayIncoming(Channel& channel) {
+    uint64_t exchange = 0;
+    uint64_t size = 0;
+    const uint8_t* payload = channel.link->beginPop(exchange, size);
+    if (!payload) {
+        // Messages from another rank are not announced: poll
+        return Progress::Blocked;
+    }
+
+    // The receiver must have copied out exchange k - 2 from this slot
+    vk::Semaphore release = m_haloManager.getReleaseSemaphore(channel.srcGpu, channel.dstGpu);
+    if (m_haloManager.getDevice(channel.dstGpu).getSemaphoreCounterValue(release) + 2 < exchange) {
+        return Progress::Blocked;
+    }
+
+    auto& recvSlot = channel.recvSlots[exchange % 2];
+    std::memcpy(recvSlot.mappedData, payload, std::min<uint64_t>(size, recvSlot.size));
+    m_haloManager.getAllocator(channel.dstGpu).flushBuffer(recvSlot);
+    channel.link->commitPop();
+
+    signal(channel.dstGpu, m_arrivedSemaphores[channel.srcGpu * m_gpuCount + channel.dstGpu], exchange);
+    m_bytesReceived += size;
+    return Progress::Moved;
+}
+
+} // namespace halo
@@ -0,0 +1,229 @@
+#include "halo/UnixSocketLink.hpp"
+#include "core/Logger.hpp"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+
+namespace halo {
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+std::runtime_error systemError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    // No MSG_NOSIGNAL here: a hung-up peer must not kill the rank
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+} // namespace
+
+UnixSocketLink::UnixSocketLink(std::string path, int listenFd, int fd, uint64_t slotBytes)
+    : m_path(std::move(path)),
+      m_listenFd(listenFd),
+      m_fd(fd),
+      m_slotBytes(slotBytes) {
+    if (m_listenFd >= 0) {
+        m_recvBuffer.resize(sizeof(MessageHeader) + slotBytes);
+    } else {
+        m_sendBuffer.resize(sizeof(MessageHeader) + slotBytes);
+    }
+}
+
+UnixSocketLink::~UnixSocketLink() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+    }
+    if (!m_recvBuffer.empty()) {
+        unlink(m_path.c_str());
+    }
+}
+
+std::string UnixSocketLink::socketPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / (name + ".sock")).string();
+}
+
+std::unique_ptr<UnixSocketLink> UnixSocketLink::create(const std::string& name, uint64_t slotBytes) {
+    std::string path = socketPath(name);
+    sockaddr_un address = socketAddress(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw systemError("Failed to create socket", path);
+    }
+    if (unlink(path.c_str()) == 0) {
+        LOG_WARN("Replacing stale socket '{}'", path);
+    }
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(fd, 1) != 0) {
+        close(fd);
+        throw systemError("Failed to bind socket", path);
+    }
+    setNonBlocking(fd);
+
+    LOG_DEBUG("Created socket link '{}': {} byte messages", path, slotBytes);
+    return std::unique_ptr<UnixSocketLink>(new UnixSocketLink(path, fd, -1, slotBytes));
+}
+
+std::unique_ptr<UnixSocketLink> UnixSocketLink::open(const std::string& name, uint64_t slotBytes,
+                                                     std::chrono::milliseconds timeout) {
+    std::string path = socketPath(name);
+    sockaddr_un address = socketAddress(path);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (true) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw systemError("Failed to create socket", path);
+        }
+        // The receiver need not have accepted yet: the backlog takes the connection
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) {
+            setNonBlocking(fd);
+            return std::unique_ptr<UnixSocketLink>(new UnixSocketLink(path, -1, fd, slotBytes));
+        }
+        int error = errno;
+        close(fd);
+        if (error != ENOENT && error != ECONNREFUSED) {
+            errno = error;
+            throw systemError("Failed to connect socket", path);
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline) {
+            throw std::runtime_error("Timed out waiting for socket '" + path + "'");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool UnixSocketLink::flush() {
+    // Write out as much of the pending message as the socket takes
+    while (m_sendOffset < m_sendEnd) {
+        ssize_t sent = send(m_fd, m_sendBuffer.data() + m_sendOffset, m_sendEnd - m_sendOffset, kSendFlags);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return false;
+            }
+            if (!m_closed) {
+                LOG_ERROR("Socket link '{}' failed: {}", m_path, std::strerror(errno));
+                m_closed = true;
+            }
+            return false;
+        }
+        m_sendOffset += static_cast<size_t>(sent);
+    }
+    m_sendOffset = 0;
+    m_sendEnd = 0;
+    return true;
+}
+
+uint8_t* UnixSocketLink::beginPush() {
+    if (m_closed || !flush()) {
+        return nullptr;
+    }
+    return m_sendBuffer.data() + sizeof(MessageHeader);
+}
+
+void UnixSocketLink::commitPush(uint64_t exchange, uint64_t size) {
+    LOG_CHECK(size <= m_slotBytes, "Message larger than its socket link buffer");
+    MessageHeader header{exchange, size};
+    std::memcpy(m_sendBuffer.data(), &header, sizeof(header));
+    m_sendOffset = 0;
+    m_sendEnd = sizeof(header) + size;
+    flush();
+}
+
+bool UnixSocketLink::fill() {
+    // Only read up to the end of the current message, the rest stays queued
+    size_t needed = sizeof(MessageHeader);
+    while (true) {
+        if (m_recvFilled >= sizeof(MessageHeader)) {
+            MessageHeader header;
+            std::memcpy(&header, m_recvBuffer.data(), sizeof(header));
+            LOG_CHECK(header.size <= m_slotBytes, "Socket link '" + m_path + "' message too large");
+            needed = sizeof(MessageHeader) + header.size;
+        }
+        if (m_recvFilled >= needed) {
+            return true;
+        }
+
+        ssize_t received = recv(m_fd, m_recvBuffer.data() + m_recvFilled, needed - m_recvFilled, 0);
+        if (received > 0) {
+            m_recvFilled += static_cast<size_t>(received);
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return false;
+        }
+        if (!m_closed) {
+            if (received == 0) {
+                LOG_ERROR("Socket link '{}' closed by its sender", m_path);
+            } else {
+                LOG_ERROR("Socket link '{}' failed: {}", m_path, std::strerror(errno));
+            }
+            m_closed = true;
+        }
+        return false;
+    }
+}
+
+const uint8_t* UnixSocketLink::beginPop(uint64_t& exchange, uint64_t& size) {
+    if (m_closed) {
+        return nullptr;
+    }
+    if (m_fd < 0) {
+        m_fd = accept(m_listenFd, nullptr, nullptr);
+        if (m_fd < 0) {
+            return nullptr;
+        }
+        setNonBlocking(m_fd);
+        close(m_listenFd);
+        m_listenFd = -1;
+    }
+    if (!fill()) {
+        return nullptr;
+    }
+
+    MessageHeader header;
+    std::memcpy(&header, m_recvBuffer.data(), sizeof(header));
+    exchange = header.exchange;
+    size = header.size;
+    return m_recvBuffer.data() + sizeof(MessageHeader);
+}
+
+void UnixSocketLink::commitPop() {
+    m_recvFilled = 0;
+}
+
+} // namespace halo
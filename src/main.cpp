@@ -5,6 +5,7 @@
 
 #include "script/LuaContext.hpp"
 #include "script/SimulationEngine.hpp"
+#include "script/RankLauncher.hpp"
 #include "core/Logger.hpp"
 
 /*
@@ -20,6 +21,7 @@
   Author: zombie aka Karthik Thyagarajan
 */
 
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
 
@@ -28,19 +30,55 @@ VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 
 int main(int argc, char** argv) {
     try {
-        if (argc < 2) {
-            std::cerr << "Usage: " << argv[0] << " <script.lua>" << std::endl;
+        // Options: --ranks N runs one process per domain, --link shm|socket picks
+        // how they exchange halos; --rank/--session/--metrics are passed to
+        // those processes by the launcher
+        uint32_t rankCount = 0;
+        int32_t rank = -1;
+        std::string session;
+        halo::HostLinkType link = halo::HostLinkType::SharedMemory;
+        std::string metricsPath;
+        std::string scriptPath;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--ranks" && hasValue) {
+                rankCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--rank" && hasValue) {
+                rank = std::stoi(argv[++i]);
+            } else if (arg == "--session" && hasValue) {
+                session = argv[++i];
+            } else if (arg == "--link" && hasValue) {
+                link = halo::HostLink::parseType(argv[++i]);
+            } else if (arg == "--metrics" && hasValue) {
+                metricsPath = argv[++i];
+            } else {
+                scriptPath = arg;
+            }
+        }
+
+        if (scriptPath.empty()) {
+            std::cerr << "Usage: " << argv[0] << " [--ranks N] [--link shm|socket] <script.lua>" << std::endl;
             std::cerr << "Example: " << argv[0] << " tests/integration/minimal_test.lua" << std::endl;
             return 1;
         }
-
-        std::string scriptPath = argv[1];
         
         if (!std::filesystem::exists(scriptPath)) {
             std::cerr << "Error: Script file not found: " << scriptPath << std::endl;
             return 1;
         }
 
+        // Launcher: spawn one process per domain and merge their metrics
+        if (rankCount > 1 && rank < 0) {
+            script::RankLauncher::Config launchConfig;
+            launchConfig.rankCount = rankCount;
+            launchConfig.session = session;
+            launchConfig.link = link;
+            std::string executable = std::filesystem::exists("/proc/self/exe")
+                ? std::filesystem::read_symlink("/proc/self/exe").string() : std::string(argv[0]);
+            return script::RankLauncher::launch(executable, scriptPath, launchConfig);
+        }
+
         std::cout << "FluidLoom - GPU-Accelerated Fluid Simulation Engine\n";
         std::cout << "===================================================\n\n";
         std::cout << "Loading script: " << scriptPath << "\n\n";
@@ -52,6 +90,12 @@ int main(int argc, char** argv) {
         script::SimulationEngine::Config config;
         config.gpuCount = 1;
         config.haloThickness = 2;
+        if (rank >= 0) {
+            config.gpuCount = std::max(rankCount, 1u);
+            config.rank = rank;
+            config.rankSession = session;
+            config.rankLink = link;
+        }
         
         script::SimulationEngine engine(config);
         
@@ -60,6 +104,11 @@ int main(int argc, char** argv) {
         
         // Run the script
         lua.runScript(scriptPath);
+
+        if (!metricsPath.empty()) {
+            script::RankLauncher::writeMetrics(metricsPath, {static_cast<uint32_t>(std::max(rank, 0)),
+                                                             engine.getRunMetrics()});
+        }
         
         std::cout << "\n✓ Script execution complete!\n";
         return 0;
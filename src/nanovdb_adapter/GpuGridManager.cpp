@@ -4,6 +4,8 @@
 
 #include <nanovdb/NodeManager.h>
 #include <algorithm>
+#include <array>
+#include <numeric>
 
 namespace nanovdb_adapter {
 
@@ -28,67 +30,64 @@ GpuGridManager::GpuGridManager(const core::VulkanContext& context,
     LOG_DEBUG("GpuGridManager initialized");
 }
 
-GpuGridManager::GridResources GpuGridManager::upload(
+std::vector<nanovdb::Coord> GpuGridManager::collectSortedCoords(
     const nanovdb::GridHandle<nanovdb::HostBuffer>& grid) {
-    LOG_INFO("Uploading NanoVDB grid to GPU...");
-
     auto* hostGrid = grid.grid<float>();
     LOG_CHECK(hostGrid != nullptr, "Host grid is null or not a float grid");
 
-    // Get grid bounds
-    nanovdb::CoordBBox gridBounds = hostGrid->indexBBox();
-    LOG_DEBUG("Grid bounds: [{},{},{}] to [{},{},{}]",
-              gridBounds.min()[0], gridBounds.min()[1], gridBounds.min()[2],
-              gridBounds.max()[0], gridBounds.max()[1], gridBounds.max()[2]);
-
-    // Step 1: Collect active coordinates and values in Morton order
-    std::vector<nanovdb::Coord> activeCoords;
-    std::vector<float> activeValues;
-
     LOG_DEBUG("Collecting active voxels...");
-    
+    std::vector<nanovdb::Coord> coords;
+
     // Use NodeManager for efficient iteration
     auto mgrHandle = nanovdb::createNodeManager(*hostGrid);
     auto* mgr = mgrHandle.mgr<float>();
-    
+
     if (mgr) {
         for (uint32_t i = 0; i < mgr->leafCount(); ++i) {
             const auto& leaf = mgr->leaf(i);
             for (auto it = leaf.valueMask().beginOn(); it; ++it) {
-                nanovdb::Coord ijk = leaf.offsetToGlobalCoord(*it);
-                float value = leaf.getValue(*it);
-                activeCoords.push_back(ijk);
-                activeValues.push_back(value);
+                coords.push_back(leaf.offsetToGlobalCoord(*it));
             }
         }
     }
 
-    uint32_t activeVoxelCount = static_cast<uint32_t>(activeCoords.size());
+    LOG_DEBUG("Sorting by Morton code...");
+    std::sort(coords.begin(), coords.end(),
+        [](const nanovdb::Coord& a, const nanovdb::Coord& b) {
+            return getMortonCode(a[0], a[1], a[2]) < getMortonCode(b[0], b[1], b[2]);
+        });
+
+    return coords;
+}
+
+GpuGridManager::GridResources GpuGridManager::upload(
+    const nanovdb::GridHandle<nanovdb::HostBuffer>& grid) {
+    LOG_INFO("Uploading NanoVDB grid to GPU...");
+
+    auto* hostGrid = grid.grid<float>();
+    LOG_CHECK(hostGrid != nullptr, "Host grid is null or not a float grid");
+
+    // Get grid bounds
+    nanovdb::CoordBBox gridBounds = hostGrid->indexBBox();
+    LOG_DEBUG("Grid bounds: [{},{},{}] to [{},{},{}]",
+              gridBounds.min()[0], gridBounds.min()[1], gridBounds.min()[2],
+              gridBounds.max()[0], gridBounds.max()[1], gridBounds.max()[2]);
+
+    // Step 1: Collect active coordinates in Morton order for spatial locality
+    std::vector<nanovdb::Coord> sortedCoords = collectSortedCoords(grid);
+
+    uint32_t activeVoxelCount = static_cast<uint32_t>(sortedCoords.size());
     LOG_INFO("Found {} active voxels", activeVoxelCount);
 
     if (activeVoxelCount == 0) {
         throw std::runtime_error("Grid has no active voxels");
     }
 
-    // Step 2: Sort by Morton code for spatial locality
-    LOG_DEBUG("Sorting by Morton code...");
-    std::vector<uint32_t> sortIndices(activeVoxelCount);
-    std::iota(sortIndices.begin(), sortIndices.end(), 0);
-
-    std::sort(sortIndices.begin(), sortIndices.end(),
-        [&activeCoords](uint32_t a, uint32_t b) {
-            const auto& coordA = activeCoords[a];
-            const auto& coordB = activeCoords[b];
-            return getMortonCode(coordA[0], coordA[1], coordA[2]) <
-                   getMortonCode(coordB[0], coordB[1], coordB[2]);
-        });
-
-    // Reorder arrays by Morton order
-    std::vector<nanovdb::Coord> sortedCoords(activeVoxelCount);
+    // Step 2: Gather values in the same order
     std::vector<float> sortedValues(activeVoxelCount);
+    auto acc = hostGrid->getAccessor();
     for (uint32_t i = 0; i < activeVoxelCount; i++) {
-        sortedCoords[i] = activeCoords[sortIndices[i]];
-        sortedValues[i] = activeValues[sortIndices[i]];
+        sortedValues[i] = acc.getValue(sortedCoords[i]);
     }
 
     // Step 3: Upload raw grid structure
@@ -106,29 +105,176 @@ GpuGridManager::GridResources GpuGridManager::upload(
 
     m_allocator.uploadToGPU(resources.rawGrid, grid.data(), gridDataSize);
 
-    // Step 4: Upload coordinate lookup table
-    LOG_DEBUG("Uploading coordinate LUT...");
-    size_t coordLutSize = activeVoxelCount * sizeof(nanovdb::Coord);
-    resources.lutCoords = m_allocator.createBuffer(
-        coordLutSize,
-        vk::BufferUsageFlagBits::eStorageBuffer |
-        vk::BufferUsageFlagBits::eTransferDst |
-        vk::BufferUsageFlagBits::eShaderDeviceAddress);
+    // Step 4: Upload coordinate lookup table and linear values
+    uploadElements(resources, sortedCoords, sortedValues);
+    resources.levels = {{0, 0, activeVoxelCount, 0}};
+
+    LOG_INFO("GPU grid upload complete. Total GPU memory: {} bytes",
+             gridDataSize + resources.lutCoords.size + resources.linearValues.size);
+
+    return resources;
+}
+
+void GpuGridManager::uploadElements(GridResources& resources,
+                                    const std::vector<nanovdb::Coord>& coords,
+                                    const std::vector<float>& values) {
+    LOG_CHECK(coords.size() == values.size(), "One value per coordinate expected");
+    const auto usage = vk::BufferUsageFlagBits::eStorageBuffer |
+                       vk::BufferUsageFlagBits::eTransferDst |
+                       vk::BufferUsageFlagBits::eShaderDeviceAddress;
 
-    m_allocator.uploadToGPU(resources.lutCoords, sortedCoords.data(), coordLutSize);
+    LOG_DEBUG("Uploading coordinate LUT...");
+    size_t coordLutSize = coords.size() * sizeof(nanovdb::Coord);
+    resources.lutCoords = m_allocator.createBuffer(coordLutSize, usage);
+    m_allocator.uploadToGPU(resources.lutCoords, coords.data(), coordLutSize);
 
-    // Step 5: Upload linear values
     LOG_DEBUG("Uploading linear values...");
+    size_t valuesSize = values.size() * sizeof(float);
+    resources.linearValues = m_allocator.createBuffer(valuesSize, usage);
+    m_allocator.uploadToGPU(resources.linearValues, values.data(), valuesSize);
+}
+
+GpuGridManager::GridResources GpuGridManager::uploadLevels(
+    const std::vector<nanovdb::Coord>& coords,
+    const std::vector<float>& values,
+    std::vector<LevelRange> levels) {
+    LOG_INFO("Uploading {} elements on {} levels to GPU...", coords.size(), levels.size());
+    LOG_CHECK(!coords.empty() && !levels.empty(), "Grid has no active voxels");
+    LOG_CHECK(coords.size() <= UINT32_MAX, "Element count exceeds 32-bit LUT range");
+
+    GridResources resources;
+    resources.activeVoxelCount = static_cast<uint32_t>(coords.size());
+    // Bounds in the coarsest level's index space
+    for (uint32_t e = 0; e < levels.front().count; ++e) {
+        resources.bounds.expand(coords[levels.front().startIndex + e]);
+    }
+    uploadElements(resources, coords, values);
+    resources.levels = std::move(levels);
+    return resources;
+}
+
+GpuGridManager::GridResources GpuGridManager::uploadStreamed(
+    StreamingGridLoader& loader,
+    const StreamingGridLoader::LeafFilter& filter,
+    const StreamingGridLoader::ChunkCallback& onChunk) {
+    LOG_INFO("Streaming NanoVDB grid to GPU...");
+
+    // Step 1: Select leaves from the resident index and lay them out in Morton
+    // order. Leaf origins are multiples of 8, so sorting leaves by origin code and
+    // voxels within a leaf by local code reproduces the global voxel order.
+    const auto& index = loader.getLeafIndex();
+    std::vector<uint32_t> selected;
+    for (uint32_t i = 0; i < index.size(); ++i) {
+        if (index[i].activeCount > 0 && (!filter || filter(index[i]))) {
+            selected.push_back(i);
+        }
+    }
+
+    auto leafMorton = [&index](uint32_t leaf) {
+        nanovdb::Coord origin = index[leaf].bbox.min() & ~7;
+        return getMortonCode(origin[0], origin[1], origin[2]);
+    };
+    std::stable_sort(selected.begin(), selected.end(),
+        [&](uint32_t a, uint32_t b) { return leafMorton(a) < leafMorton(b); });
+
+    // Destination voxel offset of each selected leaf (exclusive prefix sum)
+    std::vector<uint32_t> leafOffsets(index.size(), 0);
+    uint64_t activeVoxelCount = 0;
+    nanovdb::CoordBBox gridBounds;
+    for (uint32_t leaf : selected) {
+        leafOffsets[leaf] = static_cast<uint32_t>(activeVoxelCount);
+        activeVoxelCount += index[leaf].activeCount;
+        gridBounds.expand(index[leaf].bbox);
+    }
+
+    LOG_INFO("Found {} active voxels in {} leaves", activeVoxelCount, selected.size());
+
+    if (activeVoxelCount == 0) {
+        throw std::runtime_error("Grid has no active voxels");
+    }
+    LOG_CHECK(activeVoxelCount <= UINT32_MAX, "Active voxel count exceeds 32-bit LUT range");
+
+    GridResources resources;
+    resources.activeVoxelCount = static_cast<uint32_t>(activeVoxelCount);
+    resources.bounds = filter ? gridBounds : loader.getIndexBBox();
+    resources.levels = {{0, 0, resources.activeVoxelCount, 0}};
+
+    const auto usage = vk::BufferUsageFlagBits::eStorageBuffer |
+                       vk::BufferUsageFlagBits::eTransferDst |
+                       vk::BufferUsageFlagBits::eShaderDeviceAddress;
+
+    // Step 2: Raw grid is streamed block by block (only meaningful unfiltered)
+    size_t gridDataSize = 0;
+    if (!filter) {
+        LOG_DEBUG("Streaming raw NanoVDB structure...");
+        gridDataSize = loader.getGridSize();
+        resources.rawGrid = m_allocator.createBuffer(gridDataSize, usage);
+        loader.forEachRawBlock([&](const void* data, uint64_t offset, uint64_t size) {
+            m_allocator.uploadToGPU(resources.rawGrid, data, size, offset);
+        });
+    }
+
+    size_t coordLutSize = activeVoxelCount * sizeof(nanovdb::Coord);
     size_t valuesSize = activeVoxelCount * sizeof(float);
-    resources.linearValues = m_allocator.createBuffer(
-        valuesSize,
-        vk::BufferUsageFlagBits::eStorageBuffer |
-        vk::BufferUsageFlagBits::eTransferDst |
-        vk::BufferUsageFlagBits::eShaderDeviceAddress);
+    resources.lutCoords = m_allocator.createBuffer(coordLutSize, usage);
+    resources.linearValues = m_allocator.createBuffer(valuesSize, usage);
 
-    m_allocator.uploadToGPU(resources.linearValues, sortedValues.data(), valuesSize);
+    // Morton order of the 512 voxels inside a leaf
+    static const std::array<uint32_t, 512> localOrder = [] {
+        std::array<uint32_t, 512> order{};
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [](uint32_t a, uint32_t b) {
+            return getMortonCode(a >> 6, (a >> 3) & 7, a & 7) <
+                   getMortonCode(b >> 6, (b >> 3) & 7, b & 7);
+        });
+        return order;
+    }();
 
-    LOG_INFO("GPU grid upload complete. Total GPU memory: {} bytes",
+    // Step 3: Stream selected leaves, scattering each leaf to its final offset
+    LOG_DEBUG("Streaming coordinate LUT and linear values...");
+    std::vector<nanovdb::Coord> chunkCoords;
+    std::vector<float> chunkValues;
+    std::vector<vk::BufferCopy> coordRegions;
+    std::vector<vk::BufferCopy> valueRegions;
+
+    auto leafFilter = [&](const StreamingGridLoader::LeafIndexEntry& entry) {
+        return entry.activeCount > 0 && (!filter || filter(entry));
+    };
+
+    loader.forEachChunk(leafFilter, [&](const StreamingGridLoader::LeafChunk& chunk) {
+        chunkCoords.clear();
+        chunkValues.clear();
+        coordRegions.clear();
+        valueRegions.clear();
+
+        for (uint32_t i = 0; i < chunk.count; ++i) {
+            const auto& leaf = chunk.leaves[i];
+            const auto& mask = leaf.valueMask();
+            vk::DeviceSize first = chunkCoords.size();
+
+            for (uint32_t n : localOrder) {
+                if (mask.isOn(n)) {
+                    chunkCoords.push_back(leaf.offsetToGlobalCoord(n));
+                    chunkValues.push_back(leaf.getValue(n));
+                }
+            }
+
+            vk::DeviceSize count = chunkCoords.size() - first;
+            vk::DeviceSize dst = leafOffsets[chunk.leafIndices[i]];
+            coordRegions.push_back({first * sizeof(nanovdb::Coord), dst * sizeof(nanovdb::Coord),
+                                    count * sizeof(nanovdb::Coord)});
+            valueRegions.push_back({first * sizeof(float), dst * sizeof(float),
+                                    count * sizeof(float)});
+        }
+
+        m_allocator.uploadToGPU(resources.lutCoords, chunkCoords.data(), coordRegions);
+        m_allocator.uploadToGPU(resources.linearValues, chunkValues.data(), valueRegions);
+        if (onChunk) {
+            onChunk(chunk);
+        }
+    });
+
+    LOG_INFO("Streamed GPU grid upload complete. Total GPU memory: {} bytes",
              gridDataSize + coordLutSize + valuesSize);
 
     return resources;
@@ -0,0 +1,273 @@
+#include "nanovdb_adapter/StreamingGridLoader.hpp"
+#include "core/Logger.hpp"
+
+#include <nanovdb/io/IO.h>
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <stdexcept>
+
+namespace nanovdb_adapter {
+
+namespace {
+constexpr uint64_t kLeafSize = sizeof(nanovdb::NanoLeaf<float>);
+} // namespace
+
+StreamingGridLoader::StreamingGridLoader(const std::filesystem::path& path,
+                                         const std::string& gridName)
+    : StreamingGridLoader(path, gridName, Config()) {
+}
+
+StreamingGridLoader::StreamingGridLoader(const std::filesystem::path& path,
+                                         const std::string& gridName,
+                                         const Config& config)
+    : m_path(path), m_config(config) {
+    LOG_INFO("Opening NanoVDB grid for streaming: {}", path.string());
+
+    if (!std::filesystem::exists(path)) {
+        std::string msg = "NanoVDB file not found: " + path.string();
+        LOG_ERROR(msg);
+        throw std::runtime_error(msg);
+    }
+
+    m_stream.open(path, std::ios::in | std::ios::binary);
+    LOG_CHECK(m_stream.is_open(), "Failed to open NanoVDB file for streaming");
+
+    openGrid(gridName);
+
+    // Every in-flight chunk (current + read-ahead) must fit in the memory budget
+    uint64_t slotCount = static_cast<uint64_t>(m_config.readAhead) + 1;
+    m_chunkCapacity = static_cast<uint32_t>(
+        std::max<uint64_t>(1, m_config.memoryBudget / (slotCount * kLeafSize)));
+
+    LOG_INFO("Streaming grid: {} leaves, {} active voxels, {} leaves per chunk ({} read-ahead)",
+             m_leafCount, m_activeVoxelCount, m_chunkCapacity, m_config.readAhead);
+}
+
+StreamingGridLoader::~StreamingGridLoader() {
+    LOG_DEBUG("StreamingGridLoader closed: {}", m_path.string());
+}
+
+void StreamingGridLoader::openGrid(const std::string& gridName) {
+    // File layout: one or more segments, each a header plus grid metadata,
+    // followed by the grid buffers in the same order
+    nanovdb::io::Segment segment;
+    bool found = false;
+
+    while (!found && segment.read(m_stream)) {
+        uint64_t offset = static_cast<uint64_t>(m_stream.tellg());
+
+        for (const auto& meta : segment.meta) {
+            if (gridName.empty() || meta.gridName == gridName) {
+                if (segment.header.codec != nanovdb::io::Codec::NONE) {
+                    throw std::runtime_error(
+                        "Streaming requires an uncompressed .nvdb file: " + m_path.string());
+                }
+                if (meta.gridType != nanovdb::GridType::Float) {
+                    throw std::runtime_error("Streaming supports float grids only");
+                }
+                m_gridOffset = offset;
+                m_gridSize = meta.gridSize;
+                found = true;
+                break;
+            }
+            offset += meta.fileSize;
+        }
+
+        m_stream.seekg(static_cast<std::streamoff>(offset));
+        segment.meta.clear();
+    }
+
+    if (!found) {
+        std::string msg = gridName.empty()
+            ? "No grid found in file: " + m_path.string()
+            : "Grid '" + gridName + "' not found in file: " + m_path.string();
+        LOG_ERROR(msg);
+        throw std::runtime_error(msg);
+    }
+
+    // Read grid + tree headers only; nodes stay on disk
+    constexpr uint64_t headerSize = sizeof(nanovdb::GridData) + sizeof(nanovdb::TreeData);
+    auto header = nanovdb::HostBuffer::create(headerSize);
+    m_stream.clear();
+    m_stream.seekg(static_cast<std::streamoff>(m_gridOffset));
+    m_stream.read(reinterpret_cast<char*>(header.data()), headerSize);
+    LOG_CHECK(m_stream.good(), "Failed to read grid header");
+
+    const auto* gridData = reinterpret_cast<const nanovdb::GridData*>(header.data());
+    const auto* treeData = reinterpret_cast<const nanovdb::TreeData*>(
+        reinterpret_cast<const uint8_t*>(header.data()) + sizeof(nanovdb::GridData));
+
+    LOG_CHECK(gridData->mGridType == nanovdb::GridType::Float, "Streamed grid is not a float grid");
+
+    m_indexBBox = gridData->indexBBox();
+    m_leafCount = treeData->mNodeCount[0];
+    m_leafOffset = sizeof(nanovdb::GridData) + treeData->mNodeOffset[0];
+    m_activeVoxelCount = treeData->mVoxelCount;
+
+    LOG_CHECK(m_leafOffset + m_leafCount * kLeafSize <= m_gridSize, "Corrupt leaf section in grid");
+}
+
+void StreamingGridLoader::readChunk(const ChunkPlan& plan, nanovdb::HostBuffer& buffer) {
+    uint64_t chunkBytes = static_cast<uint64_t>(m_chunkCapacity) * kLeafSize;
+    if (buffer.size() < chunkBytes) {
+        buffer = nanovdb::HostBuffer::create(chunkBytes);
+    }
+
+    auto* dst = reinterpret_cast<char*>(buffer.data());
+    for (const auto& range : plan.ranges) {
+        uint64_t fileOffset = m_gridOffset + m_leafOffset + range.firstLeaf * kLeafSize;
+        uint64_t bytes = range.count * kLeafSize;
+
+        m_stream.seekg(static_cast<std::streamoff>(fileOffset));
+        m_stream.read(dst, static_cast<std::streamsize>(bytes));
+        if (!m_stream.good()) {
+            throw std::runtime_error("Failed to read leaf nodes from " + m_path.string());
+        }
+        dst += bytes;
+    }
+}
+
+void StreamingGridLoader::streamChunks(const std::vector<ChunkPlan>& plans,
+                                       const ChunkCallback& callback) {
+    const size_t slotCount = static_cast<size_t>(m_config.readAhead) + 1;
+
+    // Declared before the futures so pending reads finish before buffers are freed
+    std::vector<nanovdb::HostBuffer> slots(slotCount);
+    std::deque<std::shared_future<void>> pending;
+
+    // Reads are chained so only one task touches the stream at a time
+    auto launch = [&](size_t index) {
+        std::shared_future<void> previous;
+        if (!pending.empty()) {
+            previous = pending.back();
+        }
+        nanovdb::HostBuffer& slot = slots[index % slotCount];
+        pending.push_back(std::async(std::launch::async, [this, &plans, &slot, index, previous]() {
+            if (previous.valid()) {
+                previous.wait();
+            }
+            readChunk(plans[index], slot);
+        }).share());
+    };
+
+    size_t next = 0;
+    while (next < plans.size() && pending.size() < slotCount) {
+        launch(next++);
+    }
+
+    for (size_t i = 0; i < plans.size(); ++i) {
+        pending.front().get();
+        pending.pop_front();
+
+        const auto& plan = plans[i];
+        LeafChunk chunk;
+        chunk.leaves = reinterpret_cast<const nanovdb::NanoLeaf<float>*>(slots[i % slotCount].data());
+        chunk.count = static_cast<uint32_t>(plan.leafIndices.size());
+        chunk.leafIndices = plan.leafIndices.data();
+        callback(chunk);
+
+        if (next < plans.size()) {
+            launch(next++);
+        }
+    }
+}
+
+void StreamingGridLoader::forEachChunk(const ChunkCallback& callback) {
+    std::vector<ChunkPlan> plans;
+    for (uint32_t first = 0; first < m_leafCount; first += m_chunkCapacity) {
+        ChunkPlan plan;
+        uint32_t count = std::min(m_chunkCapacity, m_leafCount - first);
+        plan.ranges.push_back({first, count});
+        plan.leafIndices.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            plan.leafIndices[i] = first + i;
+        }
+        plans.push_back(std::move(plan));
+    }
+
+    // A full pass is also how the leaf index gets built
+    const bool buildIndex = m_leafIndex.size() != m_leafCount;
+    if (buildIndex) {
+        m_leafIndex.clear();
+        m_leafIndex.reserve(m_leafCount);
+    }
+
+    LOG_DEBUG("Streaming {} leaves in {} chunks", m_leafCount, plans.size());
+    streamChunks(plans, [&](const LeafChunk& chunk) {
+        if (buildIndex) {
+            for (uint32_t i = 0; i < chunk.count; ++i) {
+                m_leafIndex.push_back({chunk.leaves[i].bbox(),
+                                       chunk.leaves[i].valueMask().countOn()});
+            }
+        }
+        if (callback) {
+            callback(chunk);
+        }
+    });
+}
+
+void StreamingGridLoader::forEachChunk(const LeafFilter& filter, const ChunkCallback& callback) {
+    const auto& index = getLeafIndex();
+
+    // Coalesce selected leaves into contiguous read ranges, packed into chunks
+    std::vector<ChunkPlan> plans;
+    ChunkPlan plan;
+    for (uint32_t leaf = 0; leaf < m_leafCount; ++leaf) {
+        if (!filter(index[leaf])) {
+            continue;
+        }
+
+        if (plan.leafIndices.size() == m_chunkCapacity) {
+            plans.push_back(std::move(plan));
+            plan = ChunkPlan{};
+        }
+
+        if (!plan.ranges.empty() &&
+            plan.ranges.back().firstLeaf + plan.ranges.back().count == leaf) {
+            plan.ranges.back().count++;
+        } else {
+            plan.ranges.push_back({leaf, 1});
+        }
+        plan.leafIndices.push_back(leaf);
+    }
+    if (!plan.leafIndices.empty()) {
+        plans.push_back(std::move(plan));
+    }
+
+    LOG_DEBUG("Streaming filtered leaves in {} chunks", plans.size());
+    streamChunks(plans, callback);
+}
+
+void StreamingGridLoader::forEachChunk(const nanovdb::CoordBBox& region,
+                                       const ChunkCallback& callback) {
+    forEachChunk([&region](const LeafIndexEntry& entry) { return region.hasOverlap(entry.bbox); },
+                 callback);
+}
+
+void StreamingGridLoader::forEachRawBlock(const RawCallback& callback) {
+    uint64_t blockSize = std::max<uint64_t>(kLeafSize, m_config.memoryBudget);
+    auto block = nanovdb::HostBuffer::create(std::min(blockSize, m_gridSize));
+
+    for (uint64_t offset = 0; offset < m_gridSize; offset += blockSize) {
+        uint64_t bytes = std::min(blockSize, m_gridSize - offset);
+
+        m_stream.seekg(static_cast<std::streamoff>(m_gridOffset + offset));
+        m_stream.read(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(bytes));
+        if (!m_stream.good()) {
+            throw std::runtime_error("Failed to read grid buffer from " + m_path.string());
+        }
+
+        callback(block.data(), offset, bytes);
+    }
+}
+
+const std::vector<StreamingGridLoader::LeafIndexEntry>& StreamingGridLoader::getLeafIndex() {
+    if (m_leafIndex.size() != m_leafCount) {
+        LOG_DEBUG("Building leaf index for {} leaves", m_leafCount);
+        forEachChunk(ChunkCallback{});
+    }
+    return m_leafIndex;
+}
+
+} // namespace nanovdb_adapter
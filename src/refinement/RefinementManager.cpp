@@ -1,9 +1,6 @@
 #include "refinement/RefinementManager.hpp"
 #include "core/Logger.hpp"
-
-#include <fstream>
-#include <cstdlib>
-#include <cstdio>
+#include "core/ShaderCompiler.hpp"
 
 RefinementManager::RefinementManager(core::VulkanContext& ctx,
                                      core::MemoryAllocator& allocator,
@@ -90,28 +87,8 @@ void main() {
     mask[idx] = action;
 }
 )";
-    // Compile logic (duplicated for now, should be shared)
-    std::string uuid = "mark_" + std::to_string(std::rand());
-    std::string glslFile = "/tmp/" + uuid + ".comp";
-    std::string spvFile = "/tmp/" + uuid + ".spv";
-    {
-        std::ofstream out(glslFile);
-        out << markShaderSource;
-    }
-    std::system(("/opt/homebrew/bin/glslc -fshader-stage=compute -o " + spvFile + " " + glslFile).c_str());
-    std::remove(glslFile.c_str());
-    
-    std::vector<uint32_t> markSpirv;
-    {
-        std::ifstream in(spvFile, std::ios::binary | std::ios::ate);
-        if (in) {
-            size_t size = in.tellg();
-            markSpirv.resize(size/4);
-            in.seekg(0);
-            in.read((char*)markSpirv.data(), size);
-        }
-    }
-    std::remove(spvFile.c_str());
+    std::vector<uint32_t> markSpirv = core::ShaderCompiler::compileOrThrow(
+        markShaderSource, vk::ShaderStageFlagBits::eCompute, "refinement_mark");
 
     vk::ShaderModuleCreateInfo markModuleInfo{
         .codeSize = markSpirv.size() * 4,
@@ -167,28 +144,8 @@ void main() {
     }
 }
 )";
-    // Compile logic
-    uuid = "remap_" + std::to_string(std::rand());
-    glslFile = "/tmp/" + uuid + ".comp";
-    spvFile = "/tmp/" + uuid + ".spv";
-    {
-        std::ofstream out(glslFile);
-        out << remapShaderSource;
-    }
-    std::system(("/opt/homebrew/bin/glslc -fshader-stage=compute -o " + spvFile + " " + glslFile).c_str());
-    std::remove(glslFile.c_str());
-
-    std::vector<uint32_t> remapSpirv;
-    {
-        std::ifstream in(spvFile, std::ios::binary | std::ios::ate);
-        if (in) {
-            size_t size = in.tellg();
-            remapSpirv.resize(size/4);
-            in.seekg(0);
-            in.read((char*)remapSpirv.data(), size);
-        }
-    }
-    std::remove(spvFile.c_str());
+    std::vector<uint32_t> remapSpirv = core::ShaderCompiler::compileOrThrow(
+        remapShaderSource, vk::ShaderStageFlagBits::eCompute, "refinement_remap");
 
     vk::ShaderModuleCreateInfo remapModuleInfo{
         .codeSize = remapSpirv.size() * 4,
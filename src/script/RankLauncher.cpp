@@ -0,0 +1,159 @@
+#include "script/RankLauncher.hpp"
+#include "core/Logger.hpp"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+namespace script {
+
+void RankLauncher::writeMetrics(const std::string& path, const RankMetrics& metrics) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to write rank metrics: " + path);
+    }
+    file << "rank " << metrics.rank << "\n"
+         << "steps " << metrics.metrics.steps << "\n"
+         << "seconds " << metrics.metrics.seconds << "\n"
+         << "haloBytesSent " << metrics.metrics.haloBytesSent << "\n"
+         << "haloBytesReceived " << metrics.metrics.haloBytesReceived << "\n";
+}
+
+RankLauncher::RankMetrics RankLauncher::readMetrics(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Missing rank metrics: " + path);
+    }
+
+    std::map<std::string, double> values;
+    std::string key;
+    double value = 0.0;
+    while (file >> key >> value) {
+        values[key] = value;
+    }
+    for (const char* required : {"rank", "steps", "seconds"}) {
+        if (!values.count(required)) {
+            throw std::runtime_error("Malformed rank metrics (no '" + std::string(required) + "'): " + path);
+        }
+    }
+
+    RankMetrics metrics;
+    metrics.rank = static_cast<uint32_t>(values["rank"]);
+    metrics.metrics.steps = static_cast<uint64_t>(values["steps"]);
+    metrics.metrics.seconds = values["seconds"];
+    metrics.metrics.haloBytesSent = static_cast<uint64_t>(values["haloBytesSent"]);
+    metrics.metrics.haloBytesReceived = static_cast<uint64_t>(values["haloBytesReceived"]);
+    return metrics;
+}
+
+SimulationEngine::RunMetrics RankLauncher::merge(const std::vector<RankMetrics>& ranks) {
+    SimulationEngine::RunMetrics merged;
+    if (ranks.empty()) {
+        return merged;
+    }
+
+    merged.steps = ranks.front().metrics.steps;
+    for (const auto& rank : ranks) {
+        merged.steps = std::min(merged.steps, rank.metrics.steps);
+        merged.seconds = std::max(merged.seconds, rank.metrics.seconds);
+        merged.haloBytesSent += rank.metrics.haloBytesSent;
+        merged.haloBytesReceived += rank.metrics.haloBytesReceived;
+    }
+    return merged;
+}
+
+int RankLauncher::launch(const std::string& executable, const std::string& scriptPath, const Config& config) {
+    std::string session = config.session.empty() ? "run" + std::to_string(getpid()) : config.session;
+    std::filesystem::path metricsDir = config.metricsDir.empty()
+        ? std::filesystem::temp_directory_path() : std::filesystem::path(config.metricsDir);
+    LOG_INFO("Launching {} ranks of '{}' (session '{}', {} links)",
+             config.rankCount, scriptPath, session, halo::HostLink::typeName(config.link));
+
+    auto metricsPath = [&](uint32_t rank) {
+        return (metricsDir / ("fluidloom-" + session + "-rank" + std::to_string(rank) + ".metrics")).string();
+    };
+
+    std::map<pid_t, uint32_t> running;
+    for (uint32_t rank = 0; rank < config.rankCount; ++rank) {
+        std::filesystem::remove(metricsPath(rank));
+
+        std::vector<std::string> args{executable, "--rank", std::to_string(rank),
+                                      "--ranks", std::to_string(config.rankCount),
+                                      "--session", session, "--link", halo::HostLink::typeName(config.link),
+                                      "--metrics", metricsPath(rank), scriptPath};
+        pid_t pid = fork();
+        if (pid < 0) {
+            LOG_ERROR("Failed to spawn rank {}", rank);
+            for (const auto& [child, childRank] : running) {
+                kill(child, SIGTERM);
+            }
+            break;
+        }
+        if (pid == 0) {
+            std::vector<char*> argv;
+            for (auto& arg : args) {
+                argv.push_back(arg.data());
+            }
+            argv.push_back(nullptr);
+            execv(executable.c_str(), argv.data());
+            _exit(127);
+        }
+        running[pid] = rank;
+    }
+
+    // A failed rank would leave its peers blocked on its rings: stop them
+    int exitCode = running.size() == config.rankCount ? 0 : 1;
+    while (!running.empty()) {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            break;
+        }
+        auto it = running.find(pid);
+        if (it == running.end()) {
+            continue;
+        }
+        uint32_t rank = it->second;
+        running.erase(it);
+
+        bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (!ok && exitCode == 0) {
+            if (WIFSIGNALED(status)) {
+                LOG_ERROR("Rank {} killed by signal {}, stopping the other ranks", rank, WTERMSIG(status));
+            } else {
+                LOG_ERROR("Rank {} failed (exit {}), stopping the other ranks", rank, WEXITSTATUS(status));
+            }
+            exitCode = 1;
+            for (const auto& [child, childRank] : running) {
+                kill(child, SIGTERM);
+            }
+        }
+    }
+    if (exitCode != 0) {
+        return exitCode;
+    }
+
+    std::vector<RankMetrics> ranks;
+    for (uint32_t rank = 0; rank < config.rankCount; ++rank) {
+        ranks.push_back(readMetrics(metricsPath(rank)));
+        std::filesystem::remove(metricsPath(rank));
+        const auto& metrics = ranks.back().metrics;
+        LOG_INFO("  Rank {}: {} steps in {:.3f}s, halo {} bytes out, {} bytes in",
+                 rank, metrics.steps, metrics.seconds, metrics.haloBytesSent, metrics.haloBytesReceived);
+    }
+
+    auto merged = merge(ranks);
+    LOG_INFO("All ranks: {} steps in {:.3f}s ({:.2f} steps/s), {} halo bytes exchanged",
+             merged.steps, merged.seconds,
+             merged.seconds > 0.0 ? static_cast<double>(merged.steps) / merged.seconds : 0.0,
+             merged.haloBytesSent);
+    return 0;
+}
+
+} // namespace script
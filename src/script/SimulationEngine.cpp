@@ -22,6 +22,7 @@
 #include <nanovdb/util/GridBuilder.h>
 #include <stdexcept>
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 
 namespace script {
@@ -42,17 +43,68 @@ SimulationEngine::SimulationEngine(const Config& config)
 }
 
 SimulationEngine::~SimulationEngine() {
+    if (m_vulkanContext) {
+        try {
+            drainSteps();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Failed to drain in-flight steps: {}", e.what());
+        }
+        destroyStepSlots();
+        for (uint32_t d = 0; d < m_stepSemaphores.size(); ++d) {
+            contextFor(d).getDevice().destroySemaphore(m_stepSemaphores[d]);
+        }
+    }
+
+    // Relays and per-device objects go before the halos and devices they use
+    m_stagedTransfer.reset();
+    m_replicas.clear();
+    m_graphExecutor.reset();
+    m_haloManager.reset();
+    m_stencilRegistry.reset();
+    m_fieldRegistry.reset();
     LOG_DEBUG("SimulationEngine destroyed");
 }
 
 void SimulationEngine::initialize() {
     // Initialize Vulkan
     m_vulkanContext = std::make_unique<core::VulkanContext>();
-    m_vulkanContext->init(false);  // No validation for production
+    m_vulkanContext->init(false, m_config.deviceFilter);  // No validation for production
 
     // Initialize memory allocator
     m_memoryAllocator = std::make_unique<core::MemoryAllocator>(*m_vulkanContext);
 
+    if (m_config.rank >= 0) {
+        LOG_CHECK(m_config.rank < static_cast<int32_t>(m_config.gpuCount), "Rank out of range");
+        LOG_INFO("Running as rank {} of {} (session '{}')", m_config.rank, m_config.gpuCount, m_config.rankSession);
+        if (m_config.devicePerDomain) {
+            LOG_WARN("Ranks run a single domain each, ignoring devicePerDomain");
+            m_config.devicePerDomain = false;
+        }
+        if (m_config.dynamicRebalance) {
+            LOG_WARN("Dynamic rebalancing is not supported across ranks, disabling it");
+            m_config.dynamicRebalance = false;
+        }
+        if (m_config.temporalBlockSteps == 0) {
+            // Each rank tunes on its own timings; ranks must exchange on the same steps
+            LOG_WARN("Auto-tuned temporal blocking is not supported across ranks, exchanging every step "
+                     "(set a fixed temporalBlockSteps)");
+            m_config.temporalBlockSteps = 1;
+        }
+    }
+
+    // One logical device per domain: device 0 is the primary context
+    if (m_config.devicePerDomain && m_config.gpuCount > 1) {
+        core::DeviceGroup::Config groupConfig;
+        groupConfig.deviceCount = m_config.gpuCount;
+        groupConfig.deviceFilter = m_config.deviceFilter;
+        m_deviceGroup = std::make_unique<core::DeviceGroup>(*m_vulkanContext, *m_memoryAllocator, groupConfig);
+        if (m_config.dynamicRebalance) {
+            // Migrated leaves would arrive without their field values
+            LOG_WARN("Dynamic rebalancing is not supported with a device per domain, disabling it");
+            m_config.dynamicRebalance = false;
+        }
+    }
+
     // Initialize field registry
     uint32_t estimatedVoxels = 1024 * 1024;  // Default estimate
     m_fieldRegistry = std::make_unique<field::FieldRegistry>(
@@ -62,6 +114,18 @@ void SimulationEngine::initialize() {
     m_stencilRegistry = std::make_unique<stencil::StencilRegistry>(
         *m_vulkanContext, *m_fieldRegistry);
 
+    // Every other device gets its own copy of fields and pipelines
+    if (m_deviceGroup) {
+        for (uint32_t device = 1; device < m_deviceGroup->getDeviceCount(); ++device) {
+            DeviceReplica replica;
+            replica.fieldRegistry = std::make_unique<field::FieldRegistry>(
+                m_deviceGroup->getContext(device), m_deviceGroup->getAllocator(device), estimatedVoxels);
+            replica.stencilRegistry = std::make_unique<stencil::StencilRegistry>(
+                m_deviceGroup->getContext(device), *replica.fieldRegistry);
+            m_replicas.push_back(std::move(replica));
+        }
+    }
+
     // Initialize dependency graph
     m_dependencyGraph = std::make_unique<graph::DependencyGraph>();
 
@@ -69,6 +133,20 @@ void SimulationEngine::initialize() {
     domain::DomainSplitter::SplitConfig splitConfig;
     splitConfig.gpuCount = m_config.gpuCount;
     splitConfig.haloThickness = m_config.haloThickness;
+    if (m_config.temporalBlockSteps != 1 && !m_deviceGroup && m_config.rank < 0) {
+        // Shared field buffers: a domain's ghosts are its neighbours' owned voxels
+        LOG_WARN("Temporal blocking needs a device per domain or ranks, exchanging every step");
+    } else if (m_config.temporalBlockSteps != 1) {
+        // Temporal blocking needs k times deeper lists
+        uint32_t maxBlockSteps = m_config.temporalBlockSteps == 0
+            ? m_config.maxTemporalBlockSteps : m_config.temporalBlockSteps;
+        splitConfig.haloThickness *= std::max(maxBlockSteps, 1u);
+    }
+    splitConfig.haloRouting = m_config.haloRouting;
+    if (m_config.haloRouting == domain::HaloRouting::Forwarded && m_config.temporalBlockSteps != 1) {
+        LOG_WARN("Temporal blocking is not supported with forwarded halo routing, exchanging every step");
+    }
+    splitConfig.loadBalanceTolerance = m_config.loadBalanceTolerance;
     m_domainSplitter = std::make_unique<domain::DomainSplitter>(splitConfig);
 
     // Initialize GPU grid manager
@@ -92,11 +170,25 @@ void SimulationEngine::loadGrid() {
     LOG_INFO("Loading NanoVDB grid from: {}", m_config.gridFile);
 
     try {
-        // Load grid
-        auto hostHandle = nanovdb_adapter::GridLoader::load(m_config.gridFile);
+        if (m_config.streamGrid) {
+            // Stream leaves straight to the GPU without a full host copy
+            auto loader = openStreamingGrid();
+            m_leafStats.clear();
+            m_leafStats.reserve(loader->getLeafCount());
+            m_gridResources = m_gridManager->uploadStreamed(*loader, {},
+                [this](const nanovdb_adapter::StreamingGridLoader::LeafChunk& chunk) {
+                    // Splitter statistics come from the same pass over the file
+                    for (uint32_t i = 0; i < chunk.count; ++i) {
+                        m_leafStats.push_back(domain::DomainSplitter::computeLeafStats(chunk.leaves[i]));
+                    }
+                });
+        } else {
+            // Load grid
+            auto hostHandle = addPeriodicGhosts(nanovdb_adapter::GridLoader::load(m_config.gridFile));
 
-        // Upload to GPU
-        m_gridResources = m_gridManager->upload(hostHandle);
+            // Upload to GPU
+            m_gridResources = m_gridManager->upload(hostHandle);
+        }
 
         LOG_INFO("Grid loaded: {} active voxels",
                  m_gridResources.activeVoxelCount);
@@ -125,6 +217,43 @@ void SimulationEngine::configureDomain(const DomainConfig& config) {
     if (!config.boundaryY1.empty()) LOG_INFO("Boundary +Y: {}", config.boundaryY1);
     if (!config.boundaryZ0.empty()) LOG_INFO("Boundary -Z: {}", config.boundaryZ0);
     if (!config.boundaryZ1.empty()) LOG_INFO("Boundary +Z: {}", config.boundaryZ1);
+
+    // Periodic axes wrap through the halo exchange (ghost shell around the box)
+    domain::PeriodicBoundary periodic;
+    periodic.box = nanovdb::CoordBBox(
+        nanovdb::Coord(0, 0, 0),
+        nanovdb::Coord(static_cast<int32_t>(config.nx) - 1,
+                       static_cast<int32_t>(config.ny) - 1,
+                       static_cast<int32_t>(config.nz) - 1));
+    const std::pair<const std::string*, const std::string*> faces[3] = {
+        {&config.boundaryX0, &config.boundaryX1},
+        {&config.boundaryY0, &config.boundaryY1},
+        {&config.boundaryZ0, &config.boundaryZ1}};
+    for (int axis = 0; axis < 3; ++axis) {
+        bool lower = *faces[axis].first == "periodic";
+        bool upper = *faces[axis].second == "periodic";
+        LOG_CHECK(lower == upper, std::string("Periodic boundary on one ") + "XYZ"[axis] + " face only");
+        periodic.axes[axis] = lower;
+    }
+    if (periodic.any()) {
+        LOG_CHECK(!m_config.streamGrid, "Periodic boundaries need a host grid (not streamed)");
+        LOG_CHECK(m_config.haloRouting == domain::HaloRouting::Direct,
+                  "Periodic boundaries need direct halo routing");
+        LOG_INFO("Periodic axes: {}{}{}", periodic.axes[0] ? "X" : "",
+                 periodic.axes[1] ? "Y" : "", periodic.axes[2] ? "Z" : "");
+    }
+    m_domainSplitter->setPeriodicBoundary(periodic);
+}
+
+nanovdb::GridHandle<nanovdb::HostBuffer> SimulationEngine::addPeriodicGhosts(
+    nanovdb::GridHandle<nanovdb::HostBuffer> grid) const {
+    const auto& splitConfig = m_domainSplitter->getConfig();
+    if (!splitConfig.periodic.any()) {
+        return grid;
+    }
+    // As deep as the halo lists reach
+    return domain::DomainSplitter::addPeriodicGhosts(
+        grid, splitConfig.periodic, std::min<uint32_t>(splitConfig.haloThickness, 8));
 }
 
 nanovdb::GridHandle<nanovdb::HostBuffer> SimulationEngine::buildUniformGrid() {
@@ -198,24 +327,39 @@ nanovdb::GridHandle<nanovdb::HostBuffer> SimulationEngine::buildUniformGrid() {
 void SimulationEngine::decomposeDomain() {
     LOG_INFO("Decomposing domain for {} GPUs", m_config.gpuCount);
 
+    // Halo semaphores and buffers are replaced below
+    drainSteps();
+
     try {
         nanovdb::GridHandle<nanovdb::HostBuffer> hostHandle;
 
         // Load grid if file specified, otherwise create from domain config
-        if (m_config.gridFile.empty()) {
+        if (m_config.streamGrid && !m_config.gridFile.empty()) {
+            // Partition from the per-leaf statistics gathered by the upload pass
+            if (m_gridResources.activeVoxelCount == 0) {
+                loadGrid();
+            }
+            m_subDomains = m_domainSplitter->split(m_leafStats);
+
+            // Halo lists and field coordinates are built from a host grid
+            LOG_CHECK(m_subDomains.size() == 1, "Streamed grids run as a single domain: halo exchange needs a host grid");
+            LOG_INFO("Streamed grid loaded as a single domain");
+        } else if (m_config.gridFile.empty()) {
             LOG_INFO("No grid file specified, creating grid from domain configuration");
-            hostHandle = buildUniformGrid();
+            hostHandle = addPeriodicGhosts(buildUniformGrid());
         } else {
             // Load grid from file
             if (m_gridResources.activeVoxelCount == 0) {
                 loadGrid();
             }
-            hostHandle = nanovdb_adapter::GridLoader::load(m_config.gridFile);
+            hostHandle = addPeriodicGhosts(nanovdb_adapter::GridLoader::load(m_config.gridFile));
             LOG_INFO("Loaded grid from file: {}", m_config.gridFile);
         }
 
         // Decompose based on GPU count
-        if (m_config.gpuCount == 1) {
+        if (hostHandle.empty()) {
+            // Already decomposed from the streamed leaf statistics
+        } else if (m_config.gpuCount == 1 && !m_domainSplitter->getConfig().periodic.any()) {
             LOG_INFO("Single GPU mode - creating single domain without decomposition");
 
             // Create a single domain covering the entire grid
@@ -238,31 +382,69 @@ void SimulationEngine::decomposeDomain() {
             m_subDomains.push_back(singleDomain);
             LOG_INFO("Single domain created: {} active voxels", voxelCount);
         } else {
+            // Periodic single-GPU runs take this path too: the domain exchanges with itself
             LOG_INFO("Multi-GPU mode - decomposing into {} domains", m_config.gpuCount);
-            m_subDomains = m_domainSplitter->split(hostHandle);
+            m_leafStats = domain::DomainSplitter::collectLeafStats(hostHandle);
+            m_subDomains = m_domainSplitter->split(m_leafStats);
+            m_domainSplitter->buildHaloLists(hostHandle, m_subDomains);
+            m_fieldCoords = nanovdb_adapter::GpuGridManager::collectSortedCoords(hostHandle);
+            m_hostGrid = std::move(hostHandle);
             LOG_INFO("Domain decomposed into {} sub-domains", m_subDomains.size());
         }
 
-        // Allocate halos
+        // Allocate halos: exact gather/scatter lists first, buffers sized from them
+        m_stagedTransfer.reset();
         m_haloManager = std::make_unique<halo::HaloManager>(
             *m_vulkanContext, *m_memoryAllocator, m_subDomains);
-
-        // For each field, allocate halos
-        for (const auto& [fieldName, fieldDesc] : m_fieldRegistry->getFields()) {
-            for (uint32_t gpu = 0; gpu < m_subDomains.size(); gpu++) {
-                m_haloManager->allocateFieldHalos(fieldName, fieldDesc, gpu);
-            }
+        if (m_deviceGroup || m_config.rank >= 0) {
+            LOG_CHECK(!m_fieldCoords.empty(), "Staged halo transfers need a host grid for halo lists");
+        }
+        if (m_deviceGroup) {
+            m_haloManager->setDevices(*m_deviceGroup);
+        }
+        m_haloManager->buildIndexLists(m_fieldCoords);
+        for (const auto& [fieldName, compression] : m_config.haloCompression) {
+            m_haloManager->setFieldHaloEncoding(fieldName, compression.encoding, compression.tolerance,
+                                                 compression.maxMagnitude);
         }
 
+        // One message per neighbor carrying every field, each as deep as its stencils read
+        updateHaloThickness();
+        allocateHaloMessages();
+
         // Create timeline semaphores
         m_haloManager->createHaloSemaphores();
 
+        // Domains on separate devices or in separate processes exchange through pinned host slots
+        if (m_deviceGroup || m_config.rank >= 0) {
+            halo::StagedTransfer::Config stagedConfig;
+            stagedConfig.rank = m_config.rank;
+            stagedConfig.session = m_config.rankSession;
+            stagedConfig.link = m_config.rankLink;
+            m_stagedTransfer = std::make_unique<halo::StagedTransfer>(*m_haloManager, stagedConfig);
+            m_stagedTransfer->allocate();
+        }
+
+        if (m_config.dynamicRebalance && m_subDomains.size() > 1) {
+            domain::LoadRebalancer::Config rebalanceConfig;
+            rebalanceConfig.tolerance = m_config.loadBalanceTolerance;
+            m_rebalancer = std::make_unique<domain::LoadRebalancer>(rebalanceConfig);
+        }
+
         // Create GraphExecutor now that HaloManager exists
         m_graphExecutor = std::make_unique<graph::GraphExecutor>(
             *m_vulkanContext,
             *m_haloManager,
             *m_fieldRegistry
         );
+        for (uint32_t device = 1; device <= m_replicas.size(); ++device) {
+            auto& replica = m_replicas[device - 1];
+            replica.graphExecutor = std::make_unique<graph::GraphExecutor>(
+                m_deviceGroup->getContext(device), *m_haloManager, *replica.fieldRegistry);
+        }
+        forEachExecutor([this](graph::GraphExecutor& executor) {
+            executor.setTransport(m_stagedTransfer.get());
+        });
 
         LOG_DEBUG("Halos allocated for all fields and domains");
 
@@ -272,6 +454,439 @@ void SimulationEngine::decomposeDomain() {
     }
 }
 
+void SimulationEngine::rebalanceDomains() {
+    // Halo buffers are reallocated below; nothing may still be using them
+    drainSteps();
+
+    auto plan = m_rebalancer->plan(*m_domainSplitter, m_leafStats, m_subDomains);
+    m_rebalancer->reset();
+
+    if (plan.empty()) {
+        LOG_DEBUG("Rebalance produced no leaf moves");
+        return;
+    }
+
+    // Interfaces moved: halo lists change for the changed domains and their
+    // neighbors before and after the move; lists between two unchanged
+    // domains stay valid
+    std::vector<bool> affected(m_subDomains.size(), false);
+    for (uint32_t d : plan.changedDomains) {
+        affected[d] = true;
+        for (const auto* neighbors : {&m_subDomains[d].neighbors, &plan.domains[d].neighbors}) {
+            for (const auto& neighbor : *neighbors) {
+                affected[neighbor.gpuIndex] = true;
+            }
+        }
+    }
+    std::vector<uint32_t> rebuild;
+    for (uint32_t d = 0; d < affected.size(); ++d) {
+        if (affected[d]) {
+            rebuild.push_back(d);
+        }
+    }
+
+    // Update domains in place: HaloManager and GraphExecutor hold references
+    // to m_subDomains. Field buffers are indexed through the global LUT and
+    // shared by all domains, so migrated leaves need no field data copies.
+    for (uint32_t d = 0; d < m_subDomains.size(); ++d) {
+        m_subDomains[d].neighbors = plan.domains[d].neighbors;
+    }
+    for (uint32_t d : plan.changedDomains) {
+        m_subDomains[d] = std::move(plan.domains[d]);
+    }
+
+    if (!m_hostGrid.empty()) {
+        rebuild = m_domainSplitter->buildHaloLists(m_hostGrid, m_subDomains, rebuild);
+    }
+    m_haloManager->buildIndexLists(m_fieldCoords, rebuild);
+    for (uint32_t d : rebuild) {
+        m_haloManager->rebuildDomainHalos(d, fieldsFor(d).getFields());
+    }
+    if (m_stagedTransfer) {
+        m_stagedTransfer->allocate();
+    }
+    forEachExecutor([](graph::GraphExecutor& executor) {
+        executor.markHalosDirty();
+    });
+
+    LOG_INFO("Rebalanced: migrated {} leaves ({} voxels) across {} domains, rebuilt halos of {}",
+             plan.moves.size(), plan.migratedVoxels, plan.changedDomains.size(), rebuild.size());
+}
+
+void SimulationEngine::allocateHaloMessages() {
+    if (m_deviceGroup) {
+        // Each device gathers from and scatters into its own field buffers
+        std::vector<const halo::HaloManager::FieldMap*> domainFields{&m_fieldRegistry->getFields()};
+        for (const auto& replica : m_replicas) {
+            domainFields.push_back(&replica.fieldRegistry->getFields());
+        }
+        m_haloManager->allocateHalos(domainFields);
+    } else {
+        m_haloManager->allocateHalos(m_fieldRegistry->getFields());
+    }
+    if (m_stagedTransfer) {
+        m_stagedTransfer->allocate();
+    }
+}
+
+core::VulkanContext& SimulationEngine::contextFor(uint32_t gpuIndex) const {
+    return m_deviceGroup ? m_deviceGroup->getContext(gpuIndex) : *m_vulkanContext;
+}
+
+graph::GraphExecutor& SimulationEngine::executorFor(uint32_t gpuIndex) const {
+    return m_deviceGroup && gpuIndex > 0 ? *m_replicas.at(gpuIndex - 1).graphExecutor : *m_graphExecutor;
+}
+
+const stencil::StencilRegistry& SimulationEngine::stencilsFor(uint32_t gpuIndex) const {
+    return m_deviceGroup && gpuIndex > 0 ? *m_replicas.at(gpuIndex - 1).stencilRegistry : *m_stencilRegistry;
+}
+
+const field::FieldRegistry& SimulationEngine::fieldsFor(uint32_t gpuIndex) const {
+    return m_deviceGroup && gpuIndex > 0 ? *m_replicas.at(gpuIndex - 1).fieldRegistry : *m_fieldRegistry;
+}
+
+void SimulationEngine::stepPipelined(const std::vector<std::string>& schedule, float dt) {
+    uint32_t domainCount = static_cast<uint32_t>(m_subDomains.size());
+
+    // Bound the queue depth: the oldest step must finish before another is queued
+    while (m_inFlightSteps.size() >= std::max(m_config.maxStepsInFlight, 1u)) {
+        retireStep();
+    }
+
+    if (m_stepSemaphores.size() != domainCount) {
+        drainSteps();
+        destroyStepSlots();
+        for (uint32_t d = 0; d < m_stepSemaphores.size(); ++d) {
+            contextFor(d).getDevice().destroySemaphore(m_stepSemaphores[d]);
+        }
+        m_stepSemaphores.clear();
+        m_stepIndex = 0;
+
+        vk::SemaphoreTypeCreateInfo timelineCreateInfo(vk::SemaphoreType::eTimeline, 0);
+        vk::SemaphoreCreateInfo createInfo;
+        createInfo.setPNext(&timelineCreateInfo);
+        for (uint32_t d = 0; d < domainCount; ++d) {
+            m_stepSemaphores.push_back(contextFor(d).getDevice().createSemaphore(createInfo));
+        }
+    }
+
+    uint32_t slotCount = std::max(m_config.maxStepsInFlight, 1u);
+    if (m_stepSlots.size() != slotCount) {
+        drainSteps();
+        destroyStepSlots();
+        m_stepSlots.resize(slotCount);
+    }
+
+    InFlightStep step;
+    step.index = ++m_stepIndex;
+    step.blockSteps = m_graphExecutor->getHaloPlanner().getBlockSteps();
+    step.slot = static_cast<uint32_t>(step.index % slotCount);
+    StepSlot& slot = m_stepSlots[step.slot];
+
+    // Pools are created on the slot's first step and reset when its steps retire
+    if (slot.pools.empty()) {
+        slot.pools.resize(domainCount);
+        for (uint32_t d = 0; d < domainCount; ++d) {
+            if (!isLocalDomain(d)) {
+                continue;
+            }
+            auto& context = contextFor(d);
+            slot.pools[d] = {context.createCommandPool(context.getQueues().computeFamily),
+                             context.createCommandPool(context.getQueues().transferFamily)};
+        }
+    }
+
+    // Step begin/end plus a pair around each interior, boundary and ghost dispatch
+    uint32_t queriesPerDomain = 2 + static_cast<uint32_t>(schedule.size()) * 6;
+    if (m_rebalancer || (m_blockTuner && !m_blockTuner->isTuned())) {
+        // One pool per device; domains sharing a device take consecutive ranges
+        uint32_t poolCount = m_deviceGroup ? domainCount : 1;
+        uint32_t domainsPerPool = m_deviceGroup ? 1 : domainCount;
+        if (slot.queriesPerPool < queriesPerDomain * domainsPerPool) {
+            for (uint32_t p = 0; p < slot.queryPools.size(); ++p) {
+                contextFor(p).getDevice().destroyQueryPool(slot.queryPools[p]);
+            }
+            slot.queryPools.clear();
+            slot.queriesPerPool = queriesPerDomain * domainsPerPool;
+            vk::QueryPoolCreateInfo queryInfo({}, vk::QueryType::eTimestamp, slot.queriesPerPool);
+            for (uint32_t p = 0; p < poolCount; ++p) {
+                slot.queryPools.push_back(contextFor(p).getDevice().createQueryPool(queryInfo));
+            }
+        }
+        step.timestamps.resize(domainCount);
+        for (uint32_t d = 0; d < domainCount; ++d) {
+            step.timestamps[d].pool = slot.queryPools[m_deviceGroup ? d : 0];
+            step.timestamps[d].first = m_deviceGroup ? 0 : d * queriesPerDomain;
+            step.timestamps[d].count = queriesPerDomain;
+        }
+    }
+
+    std::vector<std::vector<graph::GraphExecutor::Submission>> domainSubmissions;
+    std::vector<uint32_t> submittedDomains;
+    size_t stageCount = 0;
+
+    step.commandBuffers.resize(domainCount);
+    for (const auto& domain : m_subDomains) {
+        if (!isLocalDomain(domain.gpuIndex)) {
+            continue;
+        }
+        vk::CommandPool computePool = slot.pools[domain.gpuIndex][0];
+        vk::CommandPool transferPool = slot.pools[domain.gpuIndex][1];
+
+        auto* timestamps = step.timestamps.empty() ? nullptr : &step.timestamps[domain.gpuIndex];
+        auto submissions = executorFor(domain.gpuIndex).recordOverlappedTimestep(
+            computePool, transferPool, schedule, stencilsFor(domain.gpuIndex), domain, dt,
+            m_config.overlapHaloExchange, timestamps);
+
+        // The last (compute) submission marks the domain's step as done
+        submissions.back().signalSemaphores.push_back(m_stepSemaphores[domain.gpuIndex]);
+        submissions.back().signalValues.push_back(step.index);
+
+        // Command buffers go back to their pools when the step retires
+        auto& commandBuffers = step.commandBuffers[domain.gpuIndex];
+        commandBuffers.resize(2);
+        for (const auto& submission : submissions) {
+            bool transfer = submission.queue == graph::GraphExecutor::QueueType::Transfer;
+            commandBuffers[transfer ? 1 : 0].push_back(submission.cmd);
+        }
+
+        // Remote receivers do not hold back our step semaphores: remember what was sent
+        if (m_config.rank >= 0) {
+            step.sentValues.resize(domainCount);
+            step.sentValues[domain.gpuIndex] = m_haloManager->getHaloBufferSet(domain.gpuIndex).writeValues;
+        }
+
+        stageCount = std::max(stageCount, submissions.size());
+        domainSubmissions.push_back(std::move(submissions));
+        submittedDomains.push_back(domain.gpuIndex);
+    }
+
+    // Queue stage by stage across domains, so every semaphore wait is
+    // submitted after the signal it depends on
+    for (size_t stage = 0; stage < stageCount; ++stage) {
+        for (uint32_t d = 0; d < domainSubmissions.size(); ++d) {
+            const auto& submissions = domainSubmissions[d];
+            if (stage >= submissions.size()) {
+                continue;
+            }
+            const auto& submission = submissions[stage];
+            const auto& queues = contextFor(submittedDomains[d]).getQueues();
+
+            vk::TimelineSemaphoreSubmitInfo timelineInfo{};
+            timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(submission.waitValues.size());
+            timelineInfo.pWaitSemaphoreValues = submission.waitValues.data();
+            timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(submission.signalValues.size());
+            timelineInfo.pSignalSemaphoreValues = submission.signalValues.data();
+
+            bool transfer = submission.queue == graph::GraphExecutor::QueueType::Transfer;
+            std::vector<vk::PipelineStageFlags> waitStages(
+                submission.waitSemaphores.size(),
+                transfer ? vk::PipelineStageFlagBits::eTransfer : vk::PipelineStageFlagBits::eComputeShader);
+
+            vk::SubmitInfo submitInfo{};
+            submitInfo.pNext = &timelineInfo;
+            submitInfo.waitSemaphoreCount = static_cast<uint32_t>(submission.waitSemaphores.size());
+            submitInfo.pWaitSemaphores = submission.waitSemaphores.data();
+            submitInfo.pWaitDstStageMask = waitStages.data();
+            submitInfo.signalSemaphoreCount = static_cast<uint32_t>(submission.signalSemaphores.size());
+            submitInfo.pSignalSemaphores = submission.signalSemaphores.data();
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &submission.cmd;
+
+            (transfer ? queues.transfer : queues.compute).submit(submitInfo);
+        }
+    }
+
+    m_inFlightSteps.push_back(std::move(step));
+}
+
+void SimulationEngine::retireStep() {
+    if (m_inFlightSteps.empty()) {
+        return;
+    }
+
+    InFlightStep step = std::move(m_inFlightSteps.front());
+    m_inFlightSteps.pop_front();
+
+    // Every local domain's last submission signals its step semaphore with the
+    // step index; each device waits on its own semaphores
+    auto waitStep = [&](vk::Device device, const std::vector<vk::Semaphore>& semaphores) {
+        std::vector<uint64_t> values(semaphores.size(), step.index);
+        vk::SemaphoreWaitInfo waitInfo({}, semaphores, values);
+        if (device.waitSemaphores(waitInfo, UINT64_MAX) != vk::Result::eSuccess) {
+            throw std::runtime_error("Wait for step semaphores failed");
+        }
+    };
+    std::vector<vk::Semaphore> primarySemaphores;
+    for (uint32_t d = 0; d < m_stepSemaphores.size(); ++d) {
+        if (!isLocalDomain(d)) {
+            continue;
+        }
+        if (m_deviceGroup) {
+            waitStep(contextFor(d).getDevice(), {m_stepSemaphores[d]});
+        } else {
+            primarySemaphores.push_back(m_stepSemaphores[d]);
+        }
+    }
+    if (!primarySemaphores.empty()) {
+        waitStep(m_vulkanContext->getDevice(), primarySemaphores);
+    }
+
+    // A step semaphore only covers the domain's compute work; local receivers
+    // cover its sends by waiting on them, remote ones do not. Before the
+    // transfer command buffers are freed, wait for every message this step sent.
+    for (uint32_t d = 0; d < step.sentValues.size(); ++d) {
+        if (step.sentValues[d].empty()) {
+            continue;
+        }
+        std::vector<vk::Semaphore> semaphores;
+        std::vector<uint64_t> values;
+        for (const auto& list : m_haloManager->getIndexLists(d)) {
+            uint64_t sent = step.sentValues[d][list.neighborGpu];
+            if (list.sendCount > 0 && sent > 0) {
+                semaphores.push_back(m_haloManager->getHaloSemaphore(d, list.neighborGpu));
+                values.push_back(sent);
+            }
+        }
+        if (!semaphores.empty()) {
+            vk::SemaphoreWaitInfo waitInfo({}, semaphores, values);
+            if (contextFor(d).getDevice().waitSemaphores(waitInfo, UINT64_MAX) != vk::Result::eSuccess) {
+                throw std::runtime_error("Wait for sent halo messages failed");
+            }
+        }
+    }
+
+    if (!step.timestamps.empty()) {
+        // Per-domain busy time: sum of its dispatch intervals (GPU clock, no host fences).
+        // Whatever else the step spent (pack, waits, unpack) is charged to the exchange.
+        std::vector<double> stepTimes(step.timestamps.size(), 0.0);
+        double exchangeSeconds = 0.0;
+        for (size_t d = 0; d < step.timestamps.size(); ++d) {
+            const auto& queries = step.timestamps[d];
+            if (queries.used < 2) {
+                continue;
+            }
+            auto& context = contextFor(static_cast<uint32_t>(d));
+            double period = context.getPhysicalDevice().getProperties().limits.timestampPeriod;
+            auto result = context.getDevice().getQueryPoolResults<uint64_t>(
+                queries.pool, queries.first, queries.used,
+                queries.used * sizeof(uint64_t), sizeof(uint64_t),
+                vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+            const auto& ticks = result.value;
+            for (uint32_t q = 1; q + 2 < queries.used; q += 2) {
+                stepTimes[d] += static_cast<double>(ticks[q + 1] - ticks[q]) * period * 1e-9;
+            }
+            double total = static_cast<double>(ticks[queries.used - 1] - ticks[0]) * period * 1e-9;
+            exchangeSeconds = std::max(exchangeSeconds, total - stepTimes[d]);
+        }
+        if (m_rebalancer) {
+            m_rebalancer->recordStepTimes(stepTimes);
+        }
+        if (m_blockTuner && step.blockSteps == m_blockTuner->getBlockSteps() && !stepTimes.empty()) {
+            m_blockTuner->recordStep(exchangeSeconds,
+                                     *std::max_element(stepTimes.begin(), stepTimes.end()));
+        }
+    }
+
+    // The slot's pools are free for its next step
+    const auto& pools = m_stepSlots[step.slot].pools;
+    for (uint32_t d = 0; d < step.commandBuffers.size(); ++d) {
+        vk::Device device = contextFor(d).getDevice();
+        for (size_t p = 0; p < step.commandBuffers[d].size(); ++p) {
+            if (!step.commandBuffers[d][p].empty()) {
+                device.freeCommandBuffers(pools[d][p], step.commandBuffers[d][p]);
+            }
+            device.resetCommandPool(pools[d][p]);
+        }
+    }
+}
+
+void SimulationEngine::destroyStepSlots() {
+    for (auto& slot : m_stepSlots) {
+        for (uint32_t d = 0; d < slot.pools.size(); ++d) {
+            for (auto pool : slot.pools[d]) {
+                contextFor(d).getDevice().destroyCommandPool(pool);
+            }
+        }
+        for (uint32_t p = 0; p < slot.queryPools.size(); ++p) {
+            contextFor(p).getDevice().destroyQueryPool(slot.queryPools[p]);
+        }
+    }
+    m_stepSlots.clear();
+}
+
+void SimulationEngine::drainSteps() {
+    while (!m_inFlightSteps.empty()) {
+        retireStep();
+    }
+}
+
+uint32_t SimulationEngine::blockStepLimit() const {
+    // Domains sharing field buffers would recompute each other's voxels as ghosts
+    if (!m_deviceGroup && m_config.rank < 0) {
+        return 1;
+    }
+
+    // Relayed voxels are layered by distance to their final destination,
+    // so ghost depths along the relay are unknown
+    if (m_config.haloRouting == domain::HaloRouting::Forwarded) {
+        return 1;
+    }
+
+    std::vector<const stencil::StencilDefinition*> stencils;
+    for (const auto& [name, compiled] : m_stencilRegistry->getStencils()) {
+        stencils.push_back(&compiled.definition);
+    }
+    uint32_t stepRadius = graph::HaloPlanner::stepRadius(stencils);
+    uint32_t listDepth = std::min<uint32_t>(m_domainSplitter->getConfig().haloThickness, 8);
+    return stepRadius > 0 ? std::max(listDepth / stepRadius, 1u) : 1u;
+}
+
+void SimulationEngine::applyBlockSteps(uint32_t blockSteps) {
+    drainSteps();
+    forEachExecutor([blockSteps](graph::GraphExecutor& executor) {
+        executor.setBlockSteps(blockSteps);
+    });
+    updateHaloThickness();
+    LOG_INFO("Temporal blocking: exchanging halos every {} steps", blockSteps);
+}
+
+void SimulationEngine::updateHaloThickness() {
+    std::vector<const stencil::StencilDefinition*> stencils;
+    for (const auto& [name, compiled] : m_stencilRegistry->getStencils()) {
+        stencils.push_back(&compiled.definition);
+    }
+    uint32_t blockSteps = m_graphExecutor ? m_graphExecutor->getHaloPlanner().getBlockSteps() : 1;
+    auto thickness = graph::HaloPlanner::fieldHaloThickness(stencils, blockSteps);
+    uint32_t listDepth = std::min<uint32_t>(m_domainSplitter->getConfig().haloThickness, 8);
+
+    bool changed = false;
+    for (const auto& [fieldName, fieldDesc] : m_fieldRegistry->getFields()) {
+        auto it = thickness.find(fieldName);
+        uint32_t fieldThickness = it != thickness.end() ? it->second : 0;
+        if (fieldThickness > listDepth) {
+            LOG_WARN("Field '{}' is read with radius {} but halo lists are {} deep",
+                     fieldName, fieldThickness, listDepth);
+        }
+
+        changed |= m_haloManager->setFieldHaloThickness(fieldName, fieldThickness);
+    }
+
+    // Only re-lay out messages that already exist; decomposeDomain allocates them
+    if (changed && m_haloManager->hasHalos()) {
+        drainSteps();
+        allocateHaloMessages();
+    }
+}
+
+std::unique_ptr<nanovdb_adapter::StreamingGridLoader> SimulationEngine::openStreamingGrid() const {
+    nanovdb_adapter::StreamingGridLoader::Config streamConfig;
+    streamConfig.memoryBudget = m_config.streamMemoryBudget;
+    streamConfig.readAhead = m_config.streamReadAhead;
+    return std::make_unique<nanovdb_adapter::StreamingGridLoader>(
+        m_config.gridFile, "", streamConfig);
+}
+
 vk::Format SimulationEngine::parseFormat(const std::string& formatStr) {
     // Map format strings to Vulkan formats
     if (formatStr == "R32F") {
@@ -304,6 +919,9 @@ void SimulationEngine::addField(const std::string& name,
     try {
         vk::Format vkFormat = parseFormat(format);
         m_fieldRegistry->registerField(name, vkFormat, nullptr);
+        for (auto& replica : m_replicas) {
+            replica.fieldRegistry->registerField(name, vkFormat, nullptr);
+        }
 
         LOG_DEBUG("Field '{}' registered", name);
 
@@ -319,12 +937,20 @@ void SimulationEngine::addStencil(const stencil::StencilDefinition& definition)
     try {
         // Register in stencil registry
         m_stencilRegistry->registerStencil(definition);
+        for (auto& replica : m_replicas) {
+            replica.stencilRegistry->registerStencil(definition);
+        }
 
         // Add to dependency graph
         m_dependencyGraph->addNode(definition.name,
                                   definition.inputs,
                                   definition.outputs);
 
+        // Stencils added after decomposition may need deeper halos
+        if (m_haloManager) {
+            updateHaloThickness();
+        }
+
         LOG_DEBUG("Stencil '{}' added and registered", definition.name);
 
     } catch (const std::exception& e) {
@@ -345,6 +971,8 @@ void SimulationEngine::step(float dt) {
         LOG_INFO("Domains not initialized, auto-initializing before first timestep");
         decomposeDomain();
     }
+    auto stepStart = std::chrono::steady_clock::now();
+    ++m_metrics.steps;
 
     try {
         // Build execution schedule
@@ -352,8 +980,54 @@ void SimulationEngine::step(float dt) {
 
         LOG_DEBUG("Execution schedule: {} stencils", schedule.size());
 
+        // Decide once which fields each domain exchanges, and where
+        forEachExecutor([&](graph::GraphExecutor& executor) {
+            executor.beginStep(schedule, *m_stencilRegistry);
+        });
+
+        // Multi-domain steps are split at exchanges and pipelined on timeline
+        // semaphores; a single command buffer per domain would wait on halos
+        // its own submission has yet to signal
+        bool pipelined = m_graphExecutor && m_subDomains.size() > 1 &&
+                         std::all_of(m_subDomains.begin(), m_subDomains.end(), [&](const auto& domain) {
+                             return m_graphExecutor->canOverlapExchange(domain);
+                         });
+        if (pipelined) {
+            // Temporal blocking: fixed k, or probed and picked by the tuner
+            uint32_t blockSteps = m_graphExecutor->getHaloPlanner().getBlockSteps();
+            if (m_config.temporalBlockSteps == 0 && !m_blockTuner && blockStepLimit() > 1) {
+                graph::TemporalBlockTuner::Config tunerConfig;
+                tunerConfig.maxBlockSteps = std::min(m_config.maxTemporalBlockSteps, blockStepLimit());
+                m_blockTuner = std::make_unique<graph::TemporalBlockTuner>(tunerConfig);
+            }
+            uint32_t wanted = m_blockTuner ? m_blockTuner->getBlockSteps()
+                                           : std::min(std::max(m_config.temporalBlockSteps, 1u), blockStepLimit());
+            if (wanted != blockSteps) {
+                applyBlockSteps(wanted);
+                forEachExecutor([&](graph::GraphExecutor& executor) {
+                    executor.beginStep(schedule, *m_stencilRegistry);
+                });
+            }
+
+            stepPipelined(schedule, dt);
+            if (m_rebalancer && m_rebalancer->shouldRebalance()) {
+                rebalanceDomains();
+            }
+            LOG_DEBUG("Timestep {} queued ({} in flight)", m_stepIndex, m_inFlightSteps.size());
+            m_metrics.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count();
+            return;
+        }
+        LOG_CHECK(m_graphExecutor->getTransport().isDeviceLocal(),
+                  "Host-relayed halo transports need the pipelined timestep (halo lists for every domain)");
+        drainSteps();
+
+        // Wall time per domain, for runtime rebalancing
+        std::vector<double> stepTimes(m_subDomains.size(), 0.0);
+
         // For each domain, record and execute timestep
         for (const auto& domain : m_subDomains) {
+            auto domainStart = std::chrono::steady_clock::now();
+
             LOG_DEBUG("Executing domain {} ({} voxels)",
                      domain.gpuIndex, domain.activeVoxelCount);
 
@@ -420,9 +1094,20 @@ void SimulationEngine::step(float dt) {
             m_vulkanContext->getDevice().destroyFence(fence);
 
             m_vulkanContext->getDevice().destroyCommandPool(cmdPool);
+
+            stepTimes[domain.gpuIndex] = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - domainStart).count();
         }
 
         LOG_DEBUG("Timestep complete");
+        m_metrics.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count();
+
+        if (m_rebalancer) {
+            m_rebalancer->recordStepTimes(stepTimes);
+            if (m_rebalancer->shouldRebalance()) {
+                rebalanceDomains();
+            }
+        }
 
     } catch (const std::exception& e) {
         LOG_ERROR("Failed to execute timestep: {}", e.what());
@@ -430,6 +1115,15 @@ void SimulationEngine::step(float dt) {
     }
 }
 
+SimulationEngine::RunMetrics SimulationEngine::getRunMetrics() const {
+    RunMetrics metrics = m_metrics;
+    if (m_graphExecutor) {
+        metrics.haloBytesSent = m_graphExecutor->getTransport().getBytesSent();
+        metrics.haloBytesReceived = m_graphExecutor->getTransport().getBytesReceived();
+    }
+    return metrics;
+}
+
 void SimulationEngine::runFrames(uint32_t frameCount, float dt) {
     LOG_INFO("Running {} frames (dt={}s)", frameCount, dt);
 
@@ -513,7 +1207,7 @@ void script::SimulationEngine::writeVDB(const std::string& fieldName, const std:
     }
 
     // Download field data
-    std::vector<uint8_t> rawData = downloadBuffer(fieldDesc.buffer, activeVoxelCount * sizeof(float));
+    std::vector<uint8_t> rawData = downloadField(fieldName, activeVoxelCount * sizeof(float));
     const float* fieldData = reinterpret_cast<const float*>(rawData.data());
 
     // Download coordinates
@@ -566,7 +1260,7 @@ void script::SimulationEngine::writeVTK(const std::string& fieldName, const std:
     }
 
     // Download field data
-    std::vector<uint8_t> rawData = downloadBuffer(fieldDesc.buffer, activeVoxelCount * sizeof(float));
+    std::vector<uint8_t> rawData = downloadField(fieldName, activeVoxelCount * sizeof(float));
     const float* fieldData = reinterpret_cast<const float*>(rawData.data());
 
     // Download coordinates
@@ -704,7 +1398,31 @@ void script::SimulationEngine::dispatch(const std::string& stencilName, uint32_t
     m_vulkanContext->getDevice().destroyCommandPool(cmdPool);
 }
 
+std::vector<uint8_t> script::SimulationEngine::downloadField(const std::string& fieldName, size_t size) {
+    std::vector<uint8_t> hostData = downloadBuffer(m_fieldRegistry->getFields().at(fieldName).buffer, size);
+    if (!m_deviceGroup || !m_haloManager) {
+        return hostData;
+    }
+
+    // Devices 1..n-1 overwrite the voxels of their own domains
+    uint32_t elementSize = m_fieldRegistry->getFields().at(fieldName).elementSize;
+    for (uint32_t device = 1; device <= m_replicas.size(); ++device) {
+        const auto& fieldDesc = m_replicas[device - 1].fieldRegistry->getFields().at(fieldName);
+        auto& allocator = m_deviceGroup->getAllocator(device);
+        const auto* mapped = static_cast<const uint8_t*>(allocator.mapBuffer(fieldDesc.buffer));
+        for (uint32_t element : m_haloManager->getVoxelLists(device).ownedElements) {
+            if (static_cast<size_t>(element + 1) * elementSize <= size) {
+                std::memcpy(hostData.data() + static_cast<size_t>(element) * elementSize,
+                            mapped + static_cast<size_t>(element) * elementSize, elementSize);
+            }
+        }
+        allocator.unmapBuffer(fieldDesc.buffer);
+    }
+    return hostData;
+}
+
 std::vector<uint8_t> script::SimulationEngine::downloadBuffer(const core::MemoryAllocator::Buffer& buffer, size_t size) {
+    drainSteps();
     std::vector<uint8_t> hostData(size);
     void* mapped = m_memoryAllocator->mapBuffer(buffer);
     std::memcpy(hostData.data(), mapped, size);
@@ -46,8 +46,11 @@ std::string ShaderGenerator::generatePushConstants() {
     ss << "layout(push_constant, std430) uniform PC {\n";
     ss << "    uint64_t gridAddr;           // NanoVDB grid device address\n";
     ss << "    uint64_t bdaTableAddr;       // Field BDA table address\n";
-    ss << "    uint32_t activeVoxelCount;   // Total active voxels\n";
+    ss << "    uint64_t voxelListAddr;      // Field element per thread (0 = identity)\n";
+    ss << "    uint32_t activeVoxelCount;   // Voxels dispatched\n";
     ss << "    uint32_t neighborRadius;     // For accessing neighbor voxels\n";
+    ss << "    float dt;                    // Timestep delta\n";
+    ss << "    uint32_t firstVoxel;         // Element of thread 0 without a voxel list\n";
 
     // Add individual field addresses
     uint32_t fieldIndex = 0;
@@ -263,9 +266,12 @@ std::string ShaderGenerator::generateMainFunction(const StencilDefinition& stenc
     std::stringstream ss;
 
     ss << "// --- Main Computation ---\n";
+    ss << "layout(buffer_reference, scalar) buffer VoxelList { uint indices[]; };\n\n";
     ss << "void main() {\n";
-    ss << "    uint linearIdx = gl_GlobalInvocationID.x;\n";
-    ss << "    if (linearIdx >= pc.activeVoxelCount) return;\n";
+    ss << "    uint threadIdx = gl_GlobalInvocationID.x;\n";
+    ss << "    if (threadIdx >= pc.activeVoxelCount) return;\n";
+    ss << "    // Interior/boundary dispatches address their voxels through a list, levels by range\n";
+    ss << "    uint linearIdx = pc.voxelListAddr != 0 ? VoxelList(pc.voxelListAddr).indices[threadIdx] : pc.firstVoxel + threadIdx;\n";
     ss << "\n";
 
     // Inject user code
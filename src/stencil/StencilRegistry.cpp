@@ -1,10 +1,9 @@
 #include "stencil/StencilRegistry.hpp"
 #include "core/Logger.hpp"
+#include "core/ShaderCompiler.hpp"
 
 #include <stdexcept>
-#include <fstream>
 #include <cstdlib>
-#include <cstdio>
 #include <filesystem> // Added for std::filesystem::path
 
 namespace stencil {
@@ -101,60 +100,9 @@ void StencilRegistry::validateStencil(const StencilDefinition& definition) {
 
 std::vector<uint32_t> StencilRegistry::compileToSPIRV(const std::string& glslSource,
                                                        const std::string& entryPoint) {
-    LOG_INFO("Compiling GLSL to SPIR-V using glslc");
-
-    // Create temporary files
-    std::string uuid = "shader_" + std::to_string(std::rand()); // Simple random ID
-    std::string glslFile = "/tmp/" + uuid + ".comp";
-    std::string spvFile = "/tmp/" + uuid + ".spv";
-
-    // Write GLSL to file
-    {
-        std::ofstream out(glslFile);
-        if (!out) {
-            throw std::runtime_error("Failed to create temporary GLSL file");
-        }
-        out << glslSource;
-    }
-
-    // Build command: glslc -fshader-stage=compute -o output.spv input.glsl
-    std::string command = "/opt/homebrew/bin/glslc -fshader-stage=compute -o " + spvFile + " " + glslFile;
-    
-    // Execute command
-    int ret = std::system(command.c_str());
-    
-    // Cleanup GLSL file
-    std::remove(glslFile.c_str());
-
-    if (ret != 0) {
-        std::string error = "Shader compilation failed with code " + std::to_string(ret);
-        LOG_ERROR(error);
-        throw std::runtime_error(error);
-    }
-
-    // Read SPIR-V back
-    std::vector<uint32_t> spirv;
-    {
-        std::ifstream in(spvFile, std::ios::binary | std::ios::ate);
-        if (!in) {
-            throw std::runtime_error("Failed to open compiled SPIR-V file");
-        }
-
-        size_t fileSize = in.tellg();
-        if (fileSize % 4 != 0) {
-            throw std::runtime_error("Invalid SPIR-V file size (not multiple of 4)");
-        }
-
-        spirv.resize(fileSize / 4);
-        in.seekg(0);
-        in.read(reinterpret_cast<char*>(spirv.data()), fileSize);
-    }
-
-    // Cleanup SPIR-V file
-    std::remove(spvFile.c_str());
-
-    LOG_DEBUG("Shader compiled successfully ({} bytes)", spirv.size() * 4);
-    return spirv;
+    LOG_INFO("Compiling GLSL to SPIR-V");
+    return core::ShaderCompiler::compileOrThrow(glslSource, vk::ShaderStageFlagBits::eCompute,
+                                                "stencil", entryPoint);
 }
 
 vk::Pipeline StencilRegistry::createComputePipeline(const std::vector<uint32_t>& spirvCode) {
@@ -1,9 +1,7 @@
 #include "vis/VolumeRenderer.hpp"
 #include "core/Logger.hpp"
+#include "core/ShaderCompiler.hpp"
 
-#include <fstream>
-#include <cstdlib>
-#include <cstdio>
 #include <glm/gtc/type_ptr.hpp>
 #include <stdexcept>
 
@@ -156,27 +154,8 @@ void main() {
     outUV = uv;
 }
 )";
-    std::string uuid = "quad_" + std::to_string(std::rand());
-    std::string glslFile = "/tmp/" + uuid + ".vert";
-    std::string spvFile = "/tmp/" + uuid + ".spv";
-    {
-        std::ofstream out(glslFile);
-        out << vertSource;
-    }
-    std::system(("/opt/homebrew/bin/glslc -fshader-stage=vertex -o " + spvFile + " " + glslFile).c_str());
-    std::remove(glslFile.c_str());
-
-    std::vector<uint32_t> vertSpirv;
-    {
-        std::ifstream in(spvFile, std::ios::binary | std::ios::ate);
-        if (in) {
-            size_t size = in.tellg();
-            vertSpirv.resize(size/4);
-            in.seekg(0);
-            in.read((char*)vertSpirv.data(), size);
-        }
-    }
-    std::remove(spvFile.c_str());
+    std::vector<uint32_t> vertSpirv = core::ShaderCompiler::compileOrThrow(
+        vertSource, vk::ShaderStageFlagBits::eVertex, "volume_quad");
 
     vk::ShaderModuleCreateInfo vertModuleInfo{
         .codeSize = vertSpirv.size() * 4,
@@ -269,27 +248,8 @@ void main() {
     outColor = color;
 }
 )";
-    uuid = "volume_" + std::to_string(std::rand());
-    glslFile = "/tmp/" + uuid + ".frag";
-    spvFile = "/tmp/" + uuid + ".spv";
-    {
-        std::ofstream out(glslFile);
-        out << fragSource;
-    }
-    std::system(("/opt/homebrew/bin/glslc -fshader-stage=fragment -o " + spvFile + " " + glslFile).c_str());
-    std::remove(glslFile.c_str());
-
-    std::vector<uint32_t> fragSpirv;
-    {
-        std::ifstream in(spvFile, std::ios::binary | std::ios::ate);
-        if (in) {
-            size_t size = in.tellg();
-            fragSpirv.resize(size/4);
-            in.seekg(0);
-            in.read((char*)fragSpirv.data(), size);
-        }
-    }
-    std::remove(spvFile.c_str());
+    std::vector<uint32_t> fragSpirv = core::ShaderCompiler::compileOrThrow(
+        fragSource, vk::ShaderStageFlagBits::eFragment, "volume_raymarch");
 
     vk::ShaderModuleCreateInfo fragModuleInfo{
         .codeSize = fragSpirv.size() * 4,
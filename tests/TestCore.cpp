@@ -1,9 +1,14 @@
 #include "VulkanFixture.hpp"
 #include "core/Logger.hpp"
 #include "nanovdb_adapter/GridLoader.hpp"
+#include "nanovdb_adapter/StreamingGridLoader.hpp"
 #include "field/FieldRegistry.hpp"
+#include "core/ShaderCompiler.hpp"
 
 #include <catch2/catch_all.hpp>
+#include <nanovdb/io/IO.h>
+#include <filesystem>
+#include <thread>
 
 /**
  * Test Suite: Core Infrastructure
@@ -153,6 +158,51 @@ TEST_CASE_METHOD(VulkanFixture, "Gradient grid creation", "[nanovdb][grid]")
     REQUIRE(value00 == Catch::Approx(0.0f));
 }
 
+TEST_CASE("Streaming grid loader matches in-memory grid", "[nanovdb][streaming]")
+{
+    auto grid = VulkanFixture::createGradientTestGrid(32);
+    auto* gridPtr = grid.grid<float>();
+    REQUIRE(gridPtr != nullptr);
+
+    auto path = std::filesystem::temp_directory_path() / "fluidloom_stream_test.nvdb";
+    nanovdb::io::writeGrid(path.string(), grid);
+
+    // Budget of a few leaves forces many chunks with read-ahead
+    nanovdb_adapter::StreamingGridLoader::Config config;
+    config.memoryBudget = 4 * sizeof(nanovdb::NanoLeaf<float>);
+    config.readAhead = 1;
+    nanovdb_adapter::StreamingGridLoader loader(path, "", config);
+
+    REQUIRE(loader.getLeafCount() == gridPtr->tree().nodeCount(0));
+    REQUIRE(loader.getActiveVoxelCount() == gridPtr->activeVoxelCount());
+    REQUIRE(loader.getChunkCapacity() == 2);
+
+    uint64_t streamedVoxels = 0;
+    bool valuesMatch = true;
+    loader.forEachChunk([&](const nanovdb_adapter::StreamingGridLoader::LeafChunk& chunk) {
+        for (uint32_t i = 0; i < chunk.count; ++i) {
+            const auto& leaf = chunk.leaves[i];
+            for (auto it = leaf.valueMask().beginOn(); it; ++it) {
+                auto ijk = leaf.offsetToGlobalCoord(*it);
+                valuesMatch &= leaf.getValue(*it) == gridPtr->tree().getValue(ijk);
+                streamedVoxels++;
+            }
+        }
+    });
+    REQUIRE(valuesMatch);
+    REQUIRE(streamedVoxels == gridPtr->activeVoxelCount());
+
+    // Region load only touches overlapping leaves
+    nanovdb::CoordBBox region(nanovdb::Coord(0), nanovdb::Coord(7));
+    uint32_t regionLeaves = 0;
+    loader.forEachChunk(region, [&](const nanovdb_adapter::StreamingGridLoader::LeafChunk& chunk) {
+        regionLeaves += chunk.count;
+    });
+    REQUIRE(regionLeaves == 1);
+
+    std::filesystem::remove(path);
+}
+
 /**
  * Test Suite: Field Registry
  */
@@ -213,6 +263,51 @@ TEST_CASE_METHOD(VulkanFixture, "Field lookup by name", "[field][registry]")
     REQUIRE(velocityRef.name == "velocity");
 }
 
+TEST_CASE("Shader compiler builds SPIR-V in process", "[core][shader]")
+{
+    const std::string source = R"(
+#version 460
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+layout(local_size_x = 64) in;
+layout(buffer_reference) buffer Values { float data[]; };
+layout(push_constant) uniform PC { uint64_t addr; } pc;
+void main() { Values(pc.addr).data[gl_GlobalInvocationID.x] = 1.0; }
+)";
+
+    auto result = core::ShaderCompiler::compile(source, vk::ShaderStageFlagBits::eCompute, "fill");
+    REQUIRE(result.succeeded());
+    REQUIRE(result.errorCount == 0);
+    REQUIRE(result.spirv[0] == 0x07230203);  // SPIR-V magic
+
+    SECTION("Errors come back as diagnostics") {
+        auto broken = core::ShaderCompiler::compile("#version 460\nvoid main() { undefined = 1; }\n",
+                                                    vk::ShaderStageFlagBits::eCompute, "broken");
+        REQUIRE_FALSE(broken.succeeded());
+        REQUIRE(broken.errorCount > 0);
+        REQUIRE(broken.diagnostics.find("broken") != std::string::npos);
+        REQUIRE(broken.diagnostics.find("undefined") != std::string::npos);
+        REQUIRE_THROWS(core::ShaderCompiler::compileOrThrow("#version 460\nvoid main() { undefined = 1; }\n",
+                                                            vk::ShaderStageFlagBits::eCompute, "broken"));
+    }
+
+    SECTION("Concurrent compilations share the compiler") {
+        std::vector<std::vector<uint32_t>> outputs(4);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            threads.emplace_back([&, i] {
+                outputs[i] = core::ShaderCompiler::compile(source, vk::ShaderStageFlagBits::eCompute, "fill").spirv;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (const auto& spirv : outputs) {
+            REQUIRE(spirv == result.spirv);
+        }
+    }
+}
+
 /**
  * Test Suite: Utility Helpers
  */
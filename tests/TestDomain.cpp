@@ -1,8 +1,27 @@
 #include "VulkanFixture.hpp"
 #include "domain/DomainSplitter.hpp"
+#include "domain/GraphPartitioner.hpp"
+#include "domain/LoadRebalancer.hpp"
+#include "halo/HaloManager.hpp"
+#include "halo/StagedTransfer.hpp"
+#include "halo/HaloSync.hpp"
+#include "halo/SharedMemoryRing.hpp"
+#include "halo/UnixSocketLink.hpp"
+#include "halo/LevelInterface.hpp"
+#include "core/DeviceGroup.hpp"
 #include "nanovdb_adapter/GpuGridManager.hpp"
 
 #include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <unistd.h>
 
 /**
  * Test Suite: Domain Decomposition
@@ -82,3 +101,1420 @@ TEST_CASE_METHOD(VulkanFixture, "Empty domain handling", "[domain][splitter]")
     // Just verify basic initialization works
     REQUIRE(true);
 }
+
+TEST_CASE("Hilbert curve visits adjacent cells consecutively", "[domain][splitter][hilbert]")
+{
+    // Every step along the curve must move exactly one cell
+    constexpr int size = 8;
+    std::vector<std::pair<uint64_t, nanovdb::Coord>> cells;
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            for (int z = 0; z < size; ++z) {
+                nanovdb::Coord c(x, y, z);
+                cells.push_back({domain::DomainSplitter::getHilbertCode(c, 3), c});
+            }
+        }
+    }
+    std::sort(cells.begin(), cells.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    for (size_t i = 0; i < cells.size(); ++i) {
+        REQUIRE(cells[i].first == i);
+        if (i > 0) {
+            nanovdb::Coord d = cells[i].second - cells[i - 1].second;
+            REQUIRE(std::abs(d[0]) + std::abs(d[1]) + std::abs(d[2]) == 1);
+        }
+    }
+}
+
+TEST_CASE("Hilbert split reports communication metrics", "[domain][splitter][hilbert]")
+{
+    // Elongated block of fully active leaves: 16 x 4 x 2
+    std::vector<domain::LeafStats> leaves;
+    for (int x = 0; x < 16; ++x) {
+        for (int y = 0; y < 4; ++y) {
+            for (int z = 0; z < 2; ++z) {
+                domain::LeafStats leaf;
+                leaf.origin = nanovdb::Coord(x * 8, y * 8, z * 8);
+                leaf.bbox = nanovdb::CoordBBox(leaf.origin, leaf.origin.offsetBy(7));
+                leaf.activeCount = 512;
+                leaves.push_back(leaf);
+            }
+        }
+    }
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 4;
+    config.strategy = domain::SplitStrategy::Hilbert;
+    domain::DomainSplitter splitter(config);
+
+    auto domains = splitter.split(leaves);
+    REQUIRE(domains.size() == 4);
+
+    auto stats = splitter.analyzeBalance(domains);
+    REQUIRE(stats.minVoxels == stats.maxVoxels);
+    REQUIRE(stats.totalHaloVoxels > 0);
+    REQUIRE(stats.maxHaloVoxels <= stats.totalHaloVoxels);
+    REQUIRE(stats.averageSurfaceToVolume > 0.0);
+    REQUIRE(stats.maxSurfaceToVolume >= stats.averageSurfaceToVolume);
+}
+
+TEST_CASE("Recursive bisection produces disjoint box domains", "[domain][splitter][bisection]")
+{
+    // 12 x 4 x 2 block of fully active leaves, split three ways
+    std::vector<domain::LeafStats> leaves;
+    for (int x = 0; x < 12; ++x) {
+        for (int y = 0; y < 4; ++y) {
+            for (int z = 0; z < 2; ++z) {
+                domain::LeafStats leaf;
+                leaf.origin = nanovdb::Coord(x * 8, y * 8, z * 8);
+                leaf.bbox = nanovdb::CoordBBox(leaf.origin, leaf.origin.offsetBy(7));
+                leaf.activeCount = 512;
+                leaves.push_back(leaf);
+            }
+        }
+    }
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 3;
+    config.strategy = domain::SplitStrategy::Bisection;
+    domain::DomainSplitter splitter(config);
+
+    auto domains = splitter.split(leaves);
+    REQUIRE(domains.size() == 3);
+
+    auto stats = splitter.analyzeBalance(domains);
+    REQUIRE(stats.minVoxels == stats.maxVoxels);
+
+    for (size_t i = 0; i < domains.size(); ++i) {
+        REQUIRE(domains[i].bounds.volume() == domains[i].activeVoxelCount);
+        for (size_t j = i + 1; j < domains.size(); ++j) {
+            REQUIRE_FALSE(domains[i].bounds.hasOverlap(domains[j].bounds));
+        }
+    }
+
+    // Slabs along X: the middle domain touches both others through a face
+    REQUIRE(domains[1].neighbors.size() == 2);
+}
+
+TEST_CASE("Curve split balances exact active counts", "[domain][splitter][load-balance]")
+{
+    // Sparse leaves with varying occupancy: balancing must use active
+    // counts, not the 512-voxel leaf volume
+    std::vector<domain::LeafStats> leaves;
+    uint64_t total = 0;
+    for (int x = 0; x < 32; ++x) {
+        domain::LeafStats leaf;
+        leaf.origin = nanovdb::Coord(x * 8, 0, 0);
+        leaf.bbox = nanovdb::CoordBBox(leaf.origin, leaf.origin.offsetBy(7, 7, 0));
+        leaf.activeCount = (x < 16) ? 64 : 16;
+        total += leaf.activeCount;
+        leaves.push_back(leaf);
+    }
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 2;
+    domain::DomainSplitter splitter(config);
+
+    auto domains = splitter.split(leaves);
+    REQUIRE(domains.size() == 2);
+    REQUIRE(domains[0].activeVoxelCount + domains[1].activeVoxelCount == total);
+    REQUIRE(domains[0].activeVoxelCount == total / 2);
+}
+
+TEST_CASE("Cost model and device throughput drive the split", "[domain][splitter][load-balance]")
+{
+    std::vector<domain::LeafStats> leaves;
+    for (int x = 0; x < 30; ++x) {
+        domain::LeafStats leaf;
+        leaf.origin = nanovdb::Coord(x * 8, 0, 0);
+        leaf.bbox = nanovdb::CoordBBox(leaf.origin, leaf.origin.offsetBy(7));
+        leaf.activeCount = 512;
+        leaves.push_back(leaf);
+    }
+
+    // Device 1 is twice as fast as device 0
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 2;
+    config.leafCost = [](const domain::LeafStats& leaf) { return leaf.activeCount / 512.0; };
+    config.deviceThroughput = {1.0, 2.0};
+    domain::DomainSplitter splitter(config);
+
+    auto domains = splitter.split(leaves);
+    REQUIRE(domains.size() == 2);
+    REQUIRE(domains[0].workload == Catch::Approx(10.0));
+    REQUIRE(domains[1].workload == Catch::Approx(20.0));
+
+    auto stats = splitter.analyzeBalance(domains);
+    REQUIRE(stats.predictedDeviceTime.size() == 2);
+    REQUIRE(stats.predictedDeviceTime[0] == Catch::Approx(stats.predictedDeviceTime[1]));
+    REQUIRE(stats.predictedImbalance == Catch::Approx(1.0));
+
+    // Dropping empty domains renumbers them, but predictions keep each one's device
+    config.gpuCount = 3;
+    config.deviceThroughput = {1.0, 2.0, 4.0};
+    domain::DomainSplitter sparseSplitter(config);
+    auto sparse = sparseSplitter.split({leaves.front()});
+    REQUIRE(sparse.size() == 1);
+    REQUIRE(sparse[0].gpuIndex == 0);
+    REQUIRE(sparse[0].deviceIndex < 3);
+
+    auto sparseStats = sparseSplitter.analyzeBalance(sparse);
+    REQUIRE(sparseStats.predictedDeviceTime[0] ==
+            Catch::Approx(1.0 / config.deviceThroughput[sparse[0].deviceIndex]));
+}
+
+TEST_CASE("Rebalancer migrates leaves away from a slow domain", "[domain][rebalance]")
+{
+    std::vector<domain::LeafStats> leaves;
+    for (int x = 0; x < 32; ++x) {
+        domain::LeafStats leaf;
+        leaf.origin = nanovdb::Coord(x * 8, 0, 0);
+        leaf.bbox = nanovdb::CoordBBox(leaf.origin, leaf.origin.offsetBy(7));
+        leaf.activeCount = 512;
+        leaves.push_back(leaf);
+    }
+
+    domain::DomainSplitter::SplitConfig splitConfig;
+    splitConfig.gpuCount = 2;
+    domain::DomainSplitter splitter(splitConfig);
+    auto domains = splitter.split(leaves);
+    REQUIRE(domains.size() == 2);
+
+    domain::LoadRebalancer::Config config;
+    config.warmupSteps = 2;
+    config.cooldownSteps = 2;
+    domain::LoadRebalancer rebalancer(config);
+
+    // Balanced timings never trigger
+    rebalancer.recordStepTimes({1.0, 1.0});
+    rebalancer.recordStepTimes({1.0, 1.0});
+    REQUIRE_FALSE(rebalancer.shouldRebalance());
+
+    // Domain 0 runs at half speed
+    const std::vector<double> stepTimes = {2.0, 1.0};
+    rebalancer.reset();
+    rebalancer.recordStepTimes(stepTimes);
+    rebalancer.recordStepTimes(stepTimes);
+    REQUIRE(rebalancer.shouldRebalance());
+
+    auto plan = rebalancer.plan(splitter, leaves, domains);
+    REQUIRE_FALSE(plan.empty());
+    REQUIRE(plan.domains.size() == domains.size());
+    for (const auto& move : plan.moves) {
+        REQUIRE(move.fromDomain == 0);
+        REQUIRE(move.toDomain == 1);
+    }
+
+    // Predicted step times at the measured speeds are within tolerance
+    std::vector<double> predicted;
+    for (size_t d = 0; d < domains.size(); ++d) {
+        double throughput = domains[d].workload / stepTimes[d];
+        predicted.push_back(plan.domains[d].workload / throughput);
+    }
+    double average = (predicted[0] + predicted[1]) / 2.0;
+    REQUIRE(std::max(predicted[0], predicted[1]) / average <= 1.0 + config.tolerance);
+
+    // Exactly the leaves whose owner changed are moved, between changed domains only
+    auto owners = [](const std::vector<domain::SubDomain>& layout) {
+        std::map<uint64_t, uint32_t> owner;
+        for (const auto& domain : layout) {
+            for (const auto& leafBox : domain.assignedLeaves) {
+                owner[domain::DomainSplitter::getLeafKey(leafBox.min())] = domain.gpuIndex;
+            }
+        }
+        return owner;
+    };
+    auto before = owners(domains);
+    auto after = owners(plan.domains);
+    REQUIRE(before.size() == after.size());
+    size_t reassigned = 0;
+    for (const auto& [key, owner] : after) {
+        reassigned += before.at(key) != owner;
+    }
+    REQUIRE(plan.moves.size() == reassigned);
+
+    std::set<uint32_t> touched;
+    for (const auto& move : plan.moves) {
+        touched.insert(move.fromDomain);
+        touched.insert(move.toDomain);
+    }
+    REQUIRE(std::set<uint32_t>(plan.changedDomains.begin(), plan.changedDomains.end()) == touched);
+}
+
+TEST_CASE("Rebalancer measures device speeds through the device index", "[domain][rebalance]")
+{
+    std::vector<domain::LeafStats> leaves;
+    for (int x = 0; x < 32; ++x) {
+        domain::LeafStats leaf;
+        leaf.origin = nanovdb::Coord(x * 8, 0, 0);
+        leaf.bbox = nanovdb::CoordBBox(leaf.origin, leaf.origin.offsetBy(7));
+        leaf.activeCount = 512;
+        leaves.push_back(leaf);
+    }
+
+    // Device 1 got no leaves: domains 0 and 1 run on devices 0 and 2
+    domain::DomainSplitter::SplitConfig splitConfig;
+    splitConfig.gpuCount = 2;
+    auto domains = domain::DomainSplitter(splitConfig).split(leaves);
+    REQUIRE(domains.size() == 2);
+    REQUIRE(domains[0].workload == Catch::Approx(domains[1].workload));
+    domains[1].deviceIndex = 2;
+
+    splitConfig.gpuCount = 3;
+    domain::DomainSplitter splitter(splitConfig);
+
+    domain::LoadRebalancer rebalancer;
+    rebalancer.recordStepTimes({1.0, 2.0});
+    rebalancer.plan(splitter, leaves, domains);
+
+    // Normalized over the two measured devices; device 1 stays at their average
+    const auto& throughput = splitter.getConfig().deviceThroughput;
+    REQUIRE(throughput.size() == 3);
+    REQUIRE(throughput[0] == Catch::Approx(4.0 / 3.0));
+    REQUIRE(throughput[1] == Catch::Approx(1.0));
+    REQUIRE(throughput[2] == Catch::Approx(2.0 / 3.0));
+}
+
+TEST_CASE("Extracting all domains preserves every active voxel", "[domain][extract]")
+{
+    auto grid = VulkanFixture::createGradientTestGrid(32);
+    auto* gridPtr = grid.grid<float>();
+
+    // Curve domains have overlapping bounds; every leaf still lands in one sub-grid
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 3;
+    config.strategy = GENERATE(domain::SplitStrategy::Bisection, domain::SplitStrategy::Morton);
+    domain::DomainSplitter splitter(config);
+
+    auto domains = splitter.split(grid);
+    auto subGrids = splitter.extractAll(grid, domains);
+    REQUIRE(subGrids.size() == domains.size());
+
+    uint64_t extracted = 0;
+    for (size_t d = 0; d < domains.size(); ++d) {
+        auto* sub = subGrids[d].grid<float>();
+        REQUIRE(sub != nullptr);
+        REQUIRE(sub->activeVoxelCount() == domains[d].activeVoxelCount);
+        extracted += sub->activeVoxelCount();
+
+        // Values survive the leaf copy
+        auto probe = domains[d].assignedLeaves.front().min();
+        REQUIRE(sub->tree().isActive(probe));
+        REQUIRE(sub->tree().getValue(probe) == gridPtr->tree().getValue(probe));
+    }
+    REQUIRE(extracted == gridPtr->activeVoxelCount());
+
+    // Single-domain extraction goes through the same path
+    auto single = splitter.extract(grid, domains.front());
+    REQUIRE(single.grid<float>()->activeVoxelCount() == domains.front().activeVoxelCount);
+}
+
+TEST_CASE("Neighbors come from leaf adjacency including corners", "[domain][splitter][neighbors]")
+{
+    // Four single-leaf domains: 0 and 1 share a face, 0 and 2 an edge,
+    // 0 and 3 only a corner
+    const nanovdb::Coord origins[4] = {
+        nanovdb::Coord(0, 0, 0), nanovdb::Coord(8, 0, 0),
+        nanovdb::Coord(0, 8, 8), nanovdb::Coord(-8, -8, -8)};
+
+    nanovdb::tools::build::Grid<float> buildGrid(0.0f);
+    auto acc = buildGrid.getAccessor();
+    for (const auto& origin : origins) {
+        for (int i = 0; i < 8; ++i)
+            for (int j = 0; j < 8; ++j)
+                for (int k = 0; k < 8; ++k)
+                    acc.setValue(origin.offsetBy(i, j, k), 1.0f);
+    }
+    auto grid = nanovdb::tools::createNanoGrid(buildGrid);
+
+    std::vector<domain::SubDomain> domains(4);
+    for (uint32_t d = 0; d < 4; ++d) {
+        domains[d].gpuIndex = d;
+        // Deliberately overlapping bounds: adjacency must not depend on them
+        domains[d].bounds = nanovdb::CoordBBox(nanovdb::Coord(-8), nanovdb::Coord(15));
+        domains[d].assignedLeaves.push_back(
+            nanovdb::CoordBBox(origins[d], origins[d].offsetBy(7)));
+        domains[d].activeVoxelCount = 512;
+    }
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 4;
+    config.haloThickness = 2;
+    domain::DomainSplitter splitter(config);
+    splitter.computeNeighbors(domains);
+    splitter.buildHaloLists(grid, domains);
+
+    REQUIRE(domains[0].neighbors.size() == 3);
+    REQUIRE(domains[0].neighbors[0].gpuIndex == 1);
+    REQUIRE(domains[0].neighbors[0].face == 1);  // +X
+    REQUIRE(domains[0].neighbors[0].contactCount == 1);
+
+    REQUIRE(domains[0].haloLists.size() == 3);
+    const auto& face = domains[0].haloLists[0];
+    const auto& edge = domains[0].haloLists[1];
+    const auto& corner = domains[0].haloLists[2];
+
+    // Face: two 8x8 slabs, nearest slab first
+    REQUIRE(face.sendVoxels.size() == 128);
+    REQUIRE(face.layerEnds == std::vector<uint32_t>{64, 128});
+    REQUIRE(face.sendVoxels.front()[0] == 7);
+
+    // Edge: 2x2 columns of 8, corner: 2x2x2 cube
+    REQUIRE(edge.sendVoxels.size() == 32);
+    REQUIRE(edge.layerEnds.front() == 8);
+    REQUIRE(corner.sendVoxels.size() == 8);
+    REQUIRE(corner.layerEnds.front() == 1);
+}
+
+TEST_CASE("Leaf face counts match the active voxels on each face", "[domain][splitter][graph]")
+{
+    // Irregular occupancy of one leaf (a different count on every face),
+    // counted voxel by voxel as the reference
+    nanovdb::tools::build::FloatGrid builder(0.0f);
+    auto acc = builder.getAccessor();
+    std::array<uint16_t, 6> expected{};
+    uint32_t active = 0;
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            for (int z = 0; z < 8; ++z) {
+                if ((x * x + y + 4 * z * z * z + x * z) % 5 >= 2) continue;
+                acc.setValue(nanovdb::Coord(8 + x, 16 + y, 24 + z), 1.0f);
+                ++active;
+                const int local[3] = {x, y, z};
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (local[axis] == 0) expected[axis * 2]++;
+                    if (local[axis] == 7) expected[axis * 2 + 1]++;
+                }
+            }
+        }
+    }
+    auto grid = nanovdb::tools::createNanoGrid(builder);
+
+    auto stats = domain::DomainSplitter::collectLeafStats(grid);
+    REQUIRE(stats.size() == 1);
+    REQUIRE(stats[0].activeCount == active);
+    REQUIRE(stats[0].faceCounts == expected);
+}
+
+TEST_CASE("Graph partitioner follows thin structures", "[domain][splitter][graph]")
+{
+    // Serpentine "river": five rows of 8 leaves joined at alternating ends
+    std::vector<domain::LeafStats> leaves;
+    for (int row = 0; row < 5; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            domain::LeafStats leaf;
+            leaf.origin = nanovdb::Coord(col * 8, row * 16, 0);
+            leaf.bbox = nanovdb::CoordBBox(leaf.origin, leaf.origin.offsetBy(7));
+            leaf.activeCount = 512;
+            leaf.faceCounts = {64, 64, 64, 64, 64, 64};
+            leaves.push_back(leaf);
+        }
+        if (row < 4) {
+            domain::LeafStats link;
+            link.origin = nanovdb::Coord((row % 2) ? 0 : 56, row * 16 + 8, 0);
+            link.bbox = nanovdb::CoordBBox(link.origin, link.origin.offsetBy(7));
+            link.activeCount = 512;
+            link.faceCounts = {64, 64, 64, 64, 64, 64};
+            leaves.push_back(link);
+        }
+    }
+
+    std::vector<double> costs(leaves.size(), 512.0);
+    auto graph = domain::GraphPartitioner::buildLeafGraph(leaves, costs);
+    REQUIRE(graph.nodeCount() == 44);
+
+    // A path cut into four pieces crosses exactly three leaf faces
+    domain::GraphPartitioner partitioner;
+    auto part = partitioner.partition(graph, {1.0, 1.0, 1.0, 1.0});
+    REQUIRE(domain::GraphPartitioner::edgeCut(graph, part) == Catch::Approx(3 * 64.0));
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 4;
+    config.strategy = domain::SplitStrategy::Graph;
+    domain::DomainSplitter splitter(config);
+
+    auto domains = splitter.split(leaves);
+    REQUIRE(domains.size() == 4);
+    for (const auto& domain : domains) {
+        REQUIRE(domain.activeVoxelCount == 11 * 512);
+        REQUIRE(domain.neighbors.size() <= 2);
+    }
+}
+
+TEST_CASE("Forwarded routing relays diagonal halos through face neighbors", "[domain][splitter][halo]")
+{
+    // 2x2x2 single-leaf domains: every domain has 3 face, 3 edge and 1 corner neighbor
+    nanovdb::tools::build::Grid<float> buildGrid(0.0f);
+    auto acc = buildGrid.getAccessor();
+    std::vector<domain::SubDomain> domains(8);
+    for (uint32_t d = 0; d < 8; ++d) {
+        nanovdb::Coord origin(8 * (d & 1), 8 * ((d >> 1) & 1), 8 * ((d >> 2) & 1));
+        for (int i = 0; i < 8; ++i)
+            for (int j = 0; j < 8; ++j)
+                for (int k = 0; k < 8; ++k)
+                    acc.setValue(origin.offsetBy(i, j, k), 1.0f);
+        domains[d].gpuIndex = d;
+        domains[d].assignedLeaves.push_back(nanovdb::CoordBBox(origin, origin.offsetBy(7)));
+        domains[d].activeVoxelCount = 512;
+    }
+    auto grid = nanovdb::tools::createNanoGrid(buildGrid);
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 8;
+    config.haloThickness = 1;
+    config.haloRouting = domain::HaloRouting::Forwarded;
+    domain::DomainSplitter splitter(config);
+    splitter.computeNeighbors(domains);
+    splitter.buildHaloLists(grid, domains);
+
+    auto listTo = [&](uint32_t from, uint32_t to) -> const domain::SubDomain::HaloList& {
+        for (const auto& list : domains[from].haloLists) {
+            if (list.neighborGpu == to) return list;
+        }
+        FAIL("No halo list");
+        return domains[from].haloLists.front();
+    };
+    auto carries = [](const domain::SubDomain::HaloList& list, const nanovdb::Coord& ijk) {
+        return std::find(list.sendVoxels.begin(), list.sendVoxels.end(), ijk) != list.sendVoxels.end();
+    };
+
+    // Only face pairs carry data, one phase per axis
+    REQUIRE(listTo(0, 1).phase == 0);
+    REQUIRE(listTo(0, 2).phase == 1);
+    REQUIRE(listTo(0, 4).phase == 2);
+    REQUIRE(listTo(0, 3).sendVoxels.empty());
+    REQUIRE(listTo(0, 7).sendVoxels.empty());
+
+    // Domain 0's corner voxel reaches domain 7 along X, then Y, then Z
+    const nanovdb::Coord corner(7, 7, 7);
+    REQUIRE(carries(listTo(0, 1), corner));
+    REQUIRE(carries(listTo(1, 3), corner));
+    REQUIRE(carries(listTo(3, 7), corner));
+
+    // Face slab plus relayed edge and corner voxels, all in layer 1
+    REQUIRE(listTo(0, 1).sendVoxels.size() == 64);
+    REQUIRE(listTo(0, 1).layerEnds.front() == 64);
+}
+
+TEST_CASE("Halo lists of unaffected domains survive a partial rebuild", "[domain][splitter][halo]")
+{
+    // Five leaves in a row; domain 3 owns the last two
+    nanovdb::tools::build::Grid<float> buildGrid(0.0f);
+    auto acc = buildGrid.getAccessor();
+    std::vector<domain::SubDomain> domains(4);
+    for (int leaf = 0; leaf < 5; ++leaf) {
+        nanovdb::Coord origin(8 * leaf, 0, 0);
+        for (int i = 0; i < 8; ++i)
+            for (int j = 0; j < 8; ++j)
+                for (int k = 0; k < 8; ++k)
+                    acc.setValue(origin.offsetBy(i, j, k), 1.0f);
+        uint32_t d = std::min(leaf, 3);
+        domains[d].gpuIndex = d;
+        domains[d].assignedLeaves.push_back(nanovdb::CoordBBox(origin, origin.offsetBy(7)));
+        domains[d].activeVoxelCount += 512;
+    }
+    auto grid = nanovdb::tools::createNanoGrid(buildGrid);
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 4;
+    config.haloThickness = 2;
+    domain::DomainSplitter splitter(config);
+    splitter.computeNeighbors(domains);
+    splitter.buildHaloLists(grid, domains);
+
+    // Leaf 3 moves from domain 3 to domain 2: domains 1, 2 and 3 are affected
+    auto moved = domains;
+    moved[2].assignedLeaves.push_back(moved[3].assignedLeaves.front());
+    moved[3].assignedLeaves.erase(moved[3].assignedLeaves.begin());
+    splitter.computeNeighbors(moved);
+    auto full = moved;
+    splitter.buildHaloLists(grid, full);
+    auto rebuilt = splitter.buildHaloLists(grid, moved, {1, 2, 3});
+    REQUIRE(rebuilt == std::vector<uint32_t>{1, 2, 3});
+
+    for (uint32_t d = 0; d < 4; ++d) {
+        REQUIRE(moved[d].haloLists.size() == full[d].haloLists.size());
+        for (size_t n = 0; n < full[d].haloLists.size(); ++n) {
+            REQUIRE(moved[d].haloLists[n].neighborGpu == full[d].haloLists[n].neighborGpu);
+            REQUIRE(moved[d].haloLists[n].sendVoxels == full[d].haloLists[n].sendVoxels);
+            REQUIRE(moved[d].haloLists[n].layerEnds == full[d].haloLists[n].layerEnds);
+        }
+    }
+}
+
+TEST_CASE("Index lists follow the halo lists through the Morton LUT", "[halo][lists]")
+{
+    // 2x2 leaves, one domain each, with a hole so the LUT is not a dense box
+    nanovdb::tools::build::Grid<float> buildGrid(0.0f);
+    auto acc = buildGrid.getAccessor();
+    std::vector<domain::SubDomain> domains(4);
+    for (uint32_t d = 0; d < 4; ++d) {
+        nanovdb::Coord origin(8 * (d & 1), 8 * (d >> 1), 0);
+        for (int i = 0; i < 8; ++i)
+            for (int j = 0; j < 8; ++j)
+                for (int k = 0; k < 8; ++k)
+                    if ((i + j + k) % 5 != 0) acc.setValue(origin.offsetBy(i, j, k), 1.0f);
+        domains[d].gpuIndex = d;
+        domains[d].assignedLeaves.push_back(nanovdb::CoordBBox(origin, origin.offsetBy(7)));
+    }
+    auto grid = nanovdb::tools::createNanoGrid(buildGrid);
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 4;
+    config.haloThickness = 2;
+    domain::DomainSplitter splitter(config);
+    splitter.computeNeighbors(domains);
+    splitter.buildHaloLists(grid, domains);
+
+    auto coords = nanovdb_adapter::GpuGridManager::collectSortedCoords(grid);
+    auto lists = halo::HaloManager::computeIndexLists(domains, coords, {0, 1, 2, 3});
+    REQUIRE(lists.size() == 4);
+
+    auto toCoords = [&](const std::vector<uint32_t>& indices) {
+        std::vector<nanovdb::Coord> result;
+        for (uint32_t index : indices) {
+            REQUIRE(index < coords.size());
+            result.push_back(coords[index]);
+        }
+        return result;
+    };
+
+    for (uint32_t d = 0; d < 4; ++d) {
+        REQUIRE(lists[d].gather.size() == domains[d].haloLists.size());
+        REQUIRE(lists[d].scatter.size() == domains[d].haloLists.size());
+        for (size_t n = 0; n < domains[d].haloLists.size(); ++n) {
+            const auto& sendList = domains[d].haloLists[n];
+            REQUIRE_FALSE(sendList.sendVoxels.empty());
+
+            // Gathers in send order; scatters in the order the neighbor sends
+            REQUIRE(toCoords(lists[d].gather[n]) == sendList.sendVoxels);
+            for (const auto& incoming : domains[sendList.neighborGpu].haloLists) {
+                if (incoming.neighborGpu == d) {
+                    REQUIRE(toCoords(lists[d].scatter[n]) == incoming.sendVoxels);
+                }
+            }
+        }
+    }
+
+    // Computing one domain alone gives the same lists
+    auto single = halo::HaloManager::computeIndexLists(domains, coords, {2});
+    REQUIRE(single[0].gather.empty());
+    REQUIRE(single[2].gather == lists[2].gather);
+    REQUIRE(single[2].scatter == lists[2].scatter);
+    REQUIRE(single[2].interior == lists[2].interior);
+    REQUIRE(single[2].boundary == lists[2].boundary);
+}
+
+TEST_CASE("Interior and boundary partition each domain's owned voxels", "[halo][lists]")
+{
+    // 3x2 leaves with a sparse pattern, split into three domains of two leaves
+    nanovdb::tools::build::Grid<float> buildGrid(0.0f);
+    auto acc = buildGrid.getAccessor();
+    std::vector<domain::SubDomain> domains(3);
+    for (int x = 0; x < 3; ++x) {
+        for (int y = 0; y < 2; ++y) {
+            nanovdb::Coord origin(8 * x, 8 * y, 0);
+            for (int i = 0; i < 8; ++i)
+                for (int j = 0; j < 8; ++j)
+                    for (int k = 0; k < 8; ++k)
+                        if ((i * 3 + j + k) % 7 != 0) acc.setValue(origin.offsetBy(i, j, k), 1.0f);
+            domains[x].gpuIndex = x;
+            domains[x].assignedLeaves.push_back(nanovdb::CoordBBox(origin, origin.offsetBy(7)));
+        }
+    }
+    auto grid = nanovdb::tools::createNanoGrid(buildGrid);
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 3;
+    config.haloThickness = 2;
+    domain::DomainSplitter splitter(config);
+    splitter.computeNeighbors(domains);
+    splitter.buildHaloLists(grid, domains);
+
+    auto coords = nanovdb_adapter::GpuGridManager::collectSortedCoords(grid);
+    auto lists = halo::HaloManager::computeIndexLists(domains, coords, {0, 1, 2});
+
+    size_t partitioned = 0;
+    for (uint32_t d = 0; d < 3; ++d) {
+        const auto& interior = lists[d].interior;
+        const auto& boundary = lists[d].boundary;
+        REQUIRE(std::is_sorted(interior.begin(), interior.end()));
+        REQUIRE(std::is_sorted(boundary.begin(), boundary.end()));
+        REQUIRE_FALSE(interior.empty());
+        REQUIRE_FALSE(boundary.empty());
+
+        // Disjoint
+        std::vector<uint32_t> common;
+        std::set_intersection(interior.begin(), interior.end(), boundary.begin(), boundary.end(),
+                              std::back_inserter(common));
+        REQUIRE(common.empty());
+
+        // Together exactly the elements inside the domain's leaves
+        std::vector<uint32_t> owned;
+        for (uint32_t i = 0; i < coords.size(); ++i) {
+            for (const auto& leafBox : domains[d].assignedLeaves) {
+                if (leafBox.isInside(coords[i])) owned.push_back(i);
+            }
+        }
+        std::vector<uint32_t> both;
+        std::merge(interior.begin(), interior.end(), boundary.begin(), boundary.end(),
+                   std::back_inserter(both));
+        REQUIRE(both == owned);
+        partitioned += both.size();
+
+        // Boundary is the union of the send lists
+        std::set<uint32_t> sent;
+        for (const auto& gather : lists[d].gather) {
+            sent.insert(gather.begin(), gather.end());
+        }
+        REQUIRE(std::vector<uint32_t>(sent.begin(), sent.end()) == boundary);
+    }
+    REQUIRE(partitioned == coords.size());
+}
+
+TEST_CASE("Periodic axes exchange ghost images, with the domain itself if needed", "[domain][splitter][periodic]")
+{
+    // 16x8x8 channel, periodic along X; values are the X index
+    nanovdb::tools::build::Grid<float> buildGrid(0.0f);
+    auto acc = buildGrid.getAccessor();
+    for (int i = 0; i < 16; ++i)
+        for (int j = 0; j < 8; ++j)
+            for (int k = 0; k < 8; ++k)
+                acc.setValue(nanovdb::Coord(i, j, k), static_cast<float>(i));
+
+    domain::PeriodicBoundary periodic;
+    periodic.axes = {true, false, false};
+    periodic.box = nanovdb::CoordBBox(nanovdb::Coord(0), nanovdb::Coord(15, 7, 7));
+    REQUIRE(periodic.wrap(nanovdb::Coord(-1, 2, 3)) == nanovdb::Coord(15, 2, 3));
+    REQUIRE(periodic.wrap(nanovdb::Coord(17, 2, 3)) == nanovdb::Coord(1, 2, 3));
+
+    // One ghost layer on each X face holds the opposite side's values
+    auto grid = domain::DomainSplitter::addPeriodicGhosts(
+        nanovdb::tools::createNanoGrid(buildGrid), periodic, 1);
+    auto* hostGrid = grid.grid<float>();
+    auto gridAcc = hostGrid->getAccessor();
+    REQUIRE(hostGrid->activeVoxelCount() == 16 * 64 + 2 * 64);
+    REQUIRE(gridAcc.getValue(nanovdb::Coord(-1, 4, 4)) == 15.0f);
+    REQUIRE(gridAcc.getValue(nanovdb::Coord(16, 4, 4)) == 0.0f);
+    REQUIRE_FALSE(gridAcc.isActive(nanovdb::Coord(-1, 8, 4)));
+
+    domain::DomainSplitter::SplitConfig config;
+    config.haloThickness = 1;
+    config.periodic = periodic;
+    const int origins[4] = {-8, 0, 8, 16};
+
+    SECTION("A single domain exchanges with itself") {
+        std::vector<domain::SubDomain> domains(1);
+        for (int x : origins) {
+            nanovdb::Coord origin(x, 0, 0);
+            domains[0].assignedLeaves.push_back(nanovdb::CoordBBox(origin, origin.offsetBy(7)));
+        }
+
+        domain::DomainSplitter splitter(config);
+        splitter.computeNeighbors(domains);
+        splitter.buildHaloLists(grid, domains);
+
+        REQUIRE(domains[0].neighbors.size() == 1);
+        REQUIRE(domains[0].neighbors[0].gpuIndex == 0);
+        REQUIRE(domains[0].haloLists.size() == 1);
+
+        const auto& self = domains[0].haloLists[0];
+        REQUIRE(self.neighborGpu == 0);
+        REQUIRE(self.sendVoxels.size() == 128);
+        REQUIRE(self.recvVoxels.size() == 128);
+        REQUIRE(self.layerEnds == std::vector<uint32_t>{128});
+        for (size_t i = 0; i < self.sendVoxels.size(); ++i) {
+            REQUIRE(periodic.isGhost(self.recvVoxels[i]));
+            REQUIRE(periodic.wrap(self.recvVoxels[i]) == self.sendVoxels[i]);
+        }
+    }
+
+    SECTION("Two domains add the wrap to their face exchange") {
+        std::vector<domain::SubDomain> domains(2);
+        for (int x : origins) {
+            nanovdb::Coord origin(x, 0, 0);
+            domains[x < 8 ? 0 : 1].assignedLeaves.push_back(nanovdb::CoordBBox(origin, origin.offsetBy(7)));
+        }
+        domains[1].gpuIndex = 1;
+
+        domain::DomainSplitter splitter(config);
+        splitter.computeNeighbors(domains);
+        splitter.buildHaloLists(grid, domains);
+
+        REQUIRE(domains[0].neighbors.size() == 1);
+        REQUIRE(domains[0].haloLists.size() == 1);
+
+        // Domain 1 sends its -X face slab as is and its +X face slab into domain 0's ghosts
+        const auto& list = domains[1].haloLists[0];
+        REQUIRE(list.neighborGpu == 0);
+        REQUIRE(list.sendVoxels.size() == 128);
+        REQUIRE(list.recvVoxels.size() == 128);
+        size_t wrapped = 0;
+        for (size_t i = 0; i < list.sendVoxels.size(); ++i) {
+            if (list.sendVoxels[i][0] == 8) {
+                REQUIRE(list.recvVoxels[i] == list.sendVoxels[i]);
+            } else {
+                REQUIRE(list.sendVoxels[i][0] == 15);
+                REQUIRE(list.recvVoxels[i][0] == -1);
+                ++wrapped;
+            }
+        }
+        REQUIRE(wrapped == 64);
+    }
+
+    SECTION("Forwarded routing is rejected") {
+        config.haloRouting = domain::HaloRouting::Forwarded;
+        domain::DomainSplitter splitter(config);
+        std::vector<domain::SubDomain> domains(1);
+        REQUIRE_THROWS(splitter.buildHaloLists(grid, domains));
+    }
+}
+
+TEST_CASE("Reduced halo encodings halve message size", "[halo][encoding]")
+{
+    using halo::HaloEncoding;
+    using halo::HaloManager;
+
+    // 333 vec3 voxels
+    const uint32_t voxels = 333;
+    REQUIRE(HaloManager::encodedWords(HaloEncoding::Float32, voxels, 3) == 999);
+    REQUIRE(HaloManager::encodedWords(HaloEncoding::Float16, voxels, 3) == 500);
+    REQUIRE(HaloManager::encodedWords(HaloEncoding::BFloat16, voxels, 3) == 500);
+    REQUIRE(HaloManager::encodedUnits(HaloEncoding::Float16, voxels, 3) == 500);
+
+    // Blocks of 32 voxels of one component: a 2-word header and 16 offset pairs
+    REQUIRE(HaloManager::encodedUnits(HaloEncoding::BlockDelta, voxels, 3) == 3 * 11);
+    REQUIRE(HaloManager::encodedWords(HaloEncoding::BlockDelta, voxels, 3) == 3 * 11 * 18);
+    REQUIRE(HaloManager::encodedUnits(HaloEncoding::BlockDelta, voxels, 1) == 11);
+    REQUIRE(HaloManager::encodedUnits(HaloEncoding::BlockDelta, 0, 3) == 0);
+    REQUIRE(HaloManager::encodedWords(HaloEncoding::BlockDelta, 1024, 1) * 16 <= 1024 * 9);
+
+    // Exact fp32, then delta offsets, half and bfloat by increasing error
+    const float magnitude = 100.0f;
+    REQUIRE(HaloManager::encodingError(HaloEncoding::Float32) == 0.0f);
+    REQUIRE(HaloManager::encodingError(HaloEncoding::BlockDelta) <
+            HaloManager::encodingError(HaloEncoding::Float16, magnitude));
+    REQUIRE(HaloManager::encodingError(HaloEncoding::Float16, magnitude) <
+            HaloManager::encodingError(HaloEncoding::BFloat16));
+    REQUIRE(HaloManager::encodingError(HaloEncoding::BFloat16) <= 1.0f / 256.0f);
+
+    // Half precision overflows above 65504, and an unknown range may too
+    REQUIRE(HaloManager::encodingError(HaloEncoding::Float16, 65504.0f) <= 1.0f / 2048.0f);
+    REQUIRE(std::isinf(HaloManager::encodingError(HaloEncoding::Float16, 1.0e5f)));
+    REQUIRE(std::isinf(HaloManager::encodingError(HaloEncoding::Float16)));
+    REQUIRE(HaloManager::encodingError(HaloEncoding::BFloat16, 1.0e30f) <= 1.0f / 256.0f);
+}
+
+TEST_CASE_METHOD(VulkanFixture, "Aggregated halo messages agree on both ends", "[halo][layout]")
+{
+    std::vector<domain::SubDomain> domains(2);
+    domains[0].gpuIndex = 0;
+    domains[1].gpuIndex = 1;
+    halo::HaloManager haloManager(getContext(), getAllocator(), domains);
+
+    auto makeField = [](const std::string& name, vk::Format format, uint32_t elementSize) {
+        field::FieldDesc desc{};
+        desc.name = name;
+        desc.format = format;
+        desc.elementSize = elementSize;
+        return desc;
+    };
+    haloManager.setFieldHaloThickness("density", 1);
+    haloManager.setFieldHaloThickness("flags", 2);
+    haloManager.setFieldHaloThickness("velocity", 2);
+    haloManager.setFieldHaloThickness("pressure", 0);
+
+    // Each end has its own field map, filled in a different order
+    std::vector<field::FieldDesc> descs = {
+        makeField("velocity", vk::Format::eR32G32B32Sfloat, 12),
+        makeField("pressure", vk::Format::eR32Sfloat, 4),
+        makeField("density", vk::Format::eR32Sfloat, 4),
+        makeField("flags", vk::Format::eR32Sint, 4)
+    };
+    halo::HaloManager::FieldMap fields0, fields1;
+    for (const auto& desc : descs) {
+        fields0[desc.name] = desc;
+    }
+    for (auto it = descs.rbegin(); it != descs.rend(); ++it) {
+        fields1[it->name] = *it;
+    }
+
+    // 0 sends 24 + 16 voxels in two layers, 1 sends 18 + 12 back
+    halo::HaloIndexList list01;
+    list01.neighborGpu = 1;
+    list01.sendCount = 40;
+    list01.sendLayerEnds = {24, 40};
+    list01.recvCount = 30;
+    list01.recvLayerEnds = {18, 30};
+    halo::HaloIndexList list10;
+    list10.neighborGpu = 0;
+    list10.sendCount = 30;
+    list10.sendLayerEnds = {18, 30};
+    list10.recvCount = 40;
+    list10.recvLayerEnds = {24, 40};
+
+    auto message01 = haloManager.layoutMessage(list01, fields0);
+    auto message10 = haloManager.layoutMessage(list10, fields1);
+
+    // Name order, fields without halo left out
+    REQUIRE(message01.segments.size() == 3);
+    REQUIRE(message01.segments[0].fieldName == "density");
+    REQUIRE(message01.segments[1].fieldName == "flags");
+    REQUIRE(message01.segments[2].fieldName == "velocity");
+    REQUIRE(message01.segmentIndex("pressure") == -1);
+
+    // Thickness picks the layers; vec3 segments hold three values per voxel
+    REQUIRE(message01.segments[0].sendCount == 24);
+    REQUIRE(message01.segments[0].sendBytes == 24 * 4);
+    REQUIRE(message01.segments[1].sendBytes == 40 * 4);
+    REQUIRE(message01.segments[2].sendBytes == 40 * 12);
+    REQUIRE(message01.segments[2].recvBytes == 30 * 12);
+
+    // Segments are contiguous
+    vk::DeviceSize sendOffset = 0, recvOffset = 0;
+    for (const auto& segment : message01.segments) {
+        REQUIRE(segment.sendOffset == sendOffset);
+        REQUIRE(segment.recvOffset == recvOffset);
+        sendOffset += segment.sendBytes;
+        recvOffset += segment.recvBytes;
+    }
+    REQUIRE(message01.sendBytes == sendOffset);
+    REQUIRE(message01.recvBytes == recvOffset);
+
+    // What one end packs is exactly what the other unpacks
+    REQUIRE(message10.segments.size() == message01.segments.size());
+    for (size_t i = 0; i < message01.segments.size(); ++i) {
+        REQUIRE(message10.segments[i].fieldName == message01.segments[i].fieldName);
+        REQUIRE(message10.segments[i].sendOffset == message01.segments[i].recvOffset);
+        REQUIRE(message10.segments[i].sendBytes == message01.segments[i].recvBytes);
+        REQUIRE(message10.segments[i].recvBytes == message01.segments[i].sendBytes);
+    }
+    REQUIRE(message01.sendBytes == message10.recvBytes);
+    REQUIRE(message10.sendBytes == message01.recvBytes);
+
+    // Half precision is refused without a range it can represent
+    REQUIRE_FALSE(haloManager.setFieldHaloEncoding("velocity", halo::HaloEncoding::Float16, 1e-2f));
+    REQUIRE_FALSE(haloManager.setFieldHaloEncoding("velocity", halo::HaloEncoding::Float16, 1e-2f, 1.0e5f));
+    REQUIRE(haloManager.getFieldHaloEncoding("velocity") == halo::HaloEncoding::Float32);
+
+    // Reduced encodings shrink both ends alike
+    REQUIRE(haloManager.setFieldHaloEncoding("velocity", halo::HaloEncoding::Float16, 1e-2f, 100.0f));
+    message01 = haloManager.layoutMessage(list01, fields0);
+    message10 = haloManager.layoutMessage(list10, fields1);
+    REQUIRE(message01.segments[2].sendBytes == 40 * 3 * 2);
+    REQUIRE(message01.sendBytes == message10.recvBytes);
+
+    // Delta blocks are per component: 2 blocks of 32 voxels for each of 3
+    REQUIRE(haloManager.setFieldHaloEncoding("velocity", halo::HaloEncoding::BlockDelta, 1e-4f));
+    message01 = haloManager.layoutMessage(list01, fields0);
+    message10 = haloManager.layoutMessage(list10, fields1);
+    REQUIRE(message01.segments[2].sendBytes == 3 * 2 * 18 * 4);
+    REQUIRE(message01.sendBytes == message10.recvBytes);
+}
+
+TEST_CASE_METHOD(VulkanFixture, "Halo encodings round-trip within their error bound", "[halo][encoding]")
+{
+    using halo::HaloEncoding;
+    using halo::HaloManager;
+
+    // 41 voxels: an odd value count for the pair encodings and a 9-voxel tail
+    // block; the vec3 components differ in scale by five orders of magnitude
+    const uint32_t voxels = 41;
+    const std::array<uint32_t, 2> components = {1, 3};
+    const std::array<float, 3> scales = {1000.0f, 0.01f, 50.0f};
+    std::array<std::vector<float>, 2> source;
+    for (uint32_t f = 0; f < 2; ++f) {
+        for (uint32_t v = 0; v < voxels; ++v) {
+            for (uint32_t c = 0; c < components[f]; ++c) {
+                float scale = f == 0 ? 3.0f : scales[c];
+                source[f].push_back(scale * std::sin(0.37f * v + 1.3f * c + f));
+            }
+        }
+    }
+
+    // Largest magnitude per field component: the error bounds' reference
+    std::array<std::vector<float>, 2> magnitude;
+    for (uint32_t f = 0; f < 2; ++f) {
+        magnitude[f].assign(components[f], 0.0f);
+        for (size_t i = 0; i < source[f].size(); ++i) {
+            float& m = magnitude[f][i % components[f]];
+            m = std::max(m, std::abs(source[f][i]));
+        }
+    }
+
+    // Pack through a permutation, unpack in order
+    std::vector<uint32_t> gather(voxels), scatter(voxels);
+    for (uint32_t i = 0; i < voxels; ++i) {
+        gather[i] = (i * 7) % voxels;
+        scatter[i] = i;
+    }
+
+    auto& alloc = getAllocator();
+    const auto usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress;
+    auto hostBuffer = [&](const void* data, vk::DeviceSize size,
+                          VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU) {
+        auto buffer = alloc.createBuffer(size, usage, memoryUsage);
+        void* mapped = alloc.mapBuffer(buffer);
+        if (data) {
+            std::memcpy(mapped, data, size);
+        } else {
+            std::memset(mapped, 0, size);
+        }
+        alloc.unmapBuffer(buffer);
+        return buffer;
+    };
+
+    // Segment layout read by the pack/unpack shaders (offsets in words)
+    struct GpuSegment {
+        uint64_t fieldAddr;
+        uint32_t sendOffset;
+        uint32_t sendCount;
+        uint32_t recvOffset;
+        uint32_t recvCount;
+        uint32_t components;
+        uint32_t encoding;
+    };
+
+    halo::HaloSync sync(1, getContext());
+    auto gatherBuffer = hostBuffer(gather.data(), voxels * sizeof(uint32_t));
+    auto scatterBuffer = hostBuffer(scatter.data(), voxels * sizeof(uint32_t));
+
+    for (HaloEncoding encoding : {HaloEncoding::Float32, HaloEncoding::Float16,
+                                  HaloEncoding::BFloat16, HaloEncoding::BlockDelta}) {
+        DYNAMIC_SECTION("Encoding " << static_cast<uint32_t>(encoding)) {
+            std::array<core::MemoryAllocator::Buffer, 2> src, dst;
+            std::vector<GpuSegment> table;
+            uint32_t words = 0, maxUnits = 0;
+            for (uint32_t f = 0; f < 2; ++f) {
+                src[f] = hostBuffer(source[f].data(), source[f].size() * sizeof(float));
+                dst[f] = hostBuffer(nullptr, source[f].size() * sizeof(float), VMA_MEMORY_USAGE_GPU_TO_CPU);
+                table.push_back({0, words, voxels, words, voxels, components[f],
+                                 static_cast<uint32_t>(encoding)});
+                words += HaloManager::encodedWords(encoding, voxels, components[f]);
+                maxUnits = std::max(maxUnits, HaloManager::encodedUnits(encoding, voxels, components[f]));
+            }
+
+            // One message packed from the sources, unpacked into the destinations
+            auto message = hostBuffer(nullptr, words * sizeof(uint32_t));
+            std::vector<GpuSegment> packTable = table, unpackTable = table;
+            for (uint32_t f = 0; f < 2; ++f) {
+                packTable[f].fieldAddr = alloc.getBufferAddress(src[f]);
+                unpackTable[f].fieldAddr = alloc.getBufferAddress(dst[f]);
+            }
+            auto packSegments = hostBuffer(packTable.data(), packTable.size() * sizeof(GpuSegment));
+            auto unpackSegments = hostBuffer(unpackTable.data(), unpackTable.size() * sizeof(GpuSegment));
+
+            auto cmd = beginCommand();
+            sync.recordHaloPack(cmd, packSegments.handle, message.handle, gatherBuffer.handle, 0x3, 2, maxUnits);
+            vk::MemoryBarrier packed(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead);
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+                                {}, packed, nullptr, nullptr);
+            sync.recordHaloUnpack(cmd, unpackSegments.handle, message.handle, scatterBuffer.handle, 0x3, 2, maxUnits);
+            vk::MemoryBarrier unpacked(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eHostRead);
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost,
+                                {}, unpacked, nullptr, nullptr);
+            endCommand(cmd);
+
+            // Voxel i of the destination holds gathered voxel gather[i] of the source
+            for (uint32_t f = 0; f < 2; ++f) {
+                const float* decoded = static_cast<const float*>(alloc.mapBuffer(dst[f]));
+                for (uint32_t i = 0; i < voxels; ++i) {
+                    for (uint32_t c = 0; c < components[f]; ++c) {
+                        float m = magnitude[f][c];
+                        float expected = source[f][gather[i] * components[f] + c];
+                        // Reduced encodings also round once more in fp32 when decoding
+                        float bound = HaloManager::encodingError(encoding, m) * m;
+                        if (encoding != HaloEncoding::Float32) {
+                            bound += 4.0f * std::numeric_limits<float>::epsilon() * m;
+                        }
+                        INFO("field " << f << ", voxel " << i << ", component " << c);
+                        REQUIRE(std::abs(decoded[i * components[f] + c] - expected) <= bound);
+                    }
+                }
+                alloc.unmapBuffer(dst[f]);
+            }
+
+            for (uint32_t f = 0; f < 2; ++f) {
+                alloc.destroyBuffer(src[f]);
+                alloc.destroyBuffer(dst[f]);
+            }
+            alloc.destroyBuffer(message);
+            alloc.destroyBuffer(packSegments);
+            alloc.destroyBuffer(unpackSegments);
+        }
+    }
+
+    alloc.destroyBuffer(gatherBuffer);
+    alloc.destroyBuffer(scatterBuffer);
+}
+
+TEST_CASE("Coarse-fine interfaces prolong ghosts and restrict covered cells", "[halo][levels]")
+{
+    using halo::LevelInterface;
+
+    // Level 0: a 4^3 block; level 1 refines its central 2^3 cells
+    std::vector<std::vector<nanovdb::Coord>> cells(2);
+    for (int k = 0; k < 4; ++k)
+        for (int j = 0; j < 4; ++j)
+            for (int i = 0; i < 4; ++i)
+                cells[0].emplace_back(i, j, k);
+    for (int k = 2; k < 6; ++k)
+        for (int j = 2; j < 6; ++j)
+            for (int i = 2; i < 6; ++i)
+                cells[1].emplace_back(i, j, k);
+
+    auto layout = LevelInterface::buildLayout(cells, 2);
+    REQUIRE(layout.levels.size() == 2);
+    REQUIRE(layout.levels[0].startIndex == 0);
+    REQUIRE(layout.levels[0].count == 64);
+    REQUIRE(layout.levels[0].ghostCount == 0);
+    REQUIRE(layout.levels[1].startIndex == 64);
+    REQUIRE(layout.levels[1].count == 64);
+    REQUIRE(layout.levels[1].ghostCount == 8 * 8 * 8 - 64);
+    REQUIRE(layout.coords.size() == 64 + 64 + 448);
+
+    auto findEntry = [&](const std::vector<LevelInterface::Entry>& entries, const nanovdb::Coord& ijk) {
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [&](const auto& entry) { return layout.coords[entry.target] == ijk; });
+        REQUIRE(it != entries.end());
+        return *it;
+    };
+
+    SECTION("Trilinear ghosts weigh the parent 3/4 per axis") {
+        auto lists = LevelInterface::buildLists(layout.coords, layout.levels, halo::Prolongation::Trilinear);
+        REQUIRE(lists.size() == 2);
+        REQUIRE(lists[0].prolongation.empty());
+        REQUIRE(lists[1].prolongation.size() == 448);
+        for (const auto& entry : lists[1].prolongation) {
+            float sum = 0.0f;
+            for (float weight : entry.weights) sum += weight;
+            REQUIRE(sum == Catch::Approx(1.0f));
+        }
+
+        // Odd coordinates lean towards +1: all eight coarse sources exist
+        auto inner = findEntry(lists[1].prolongation, nanovdb::Coord(1, 3, 3));
+        REQUIRE(layout.coords[inner.sources[0]] == nanovdb::Coord(0, 1, 1));
+        REQUIRE(inner.weights[0] == Catch::Approx(27.0f / 64.0f));
+        REQUIRE(inner.weights[7] == Catch::Approx(1.0f / 64.0f));
+
+        // Past the corner of the coarse block only the parent remains
+        auto corner = findEntry(lists[1].prolongation, nanovdb::Coord(7, 7, 7));
+        REQUIRE(layout.coords[corner.sources[0]] == nanovdb::Coord(3, 3, 3));
+        REQUIRE(corner.weights[0] == Catch::Approx(1.0f));
+        REQUIRE(corner.weights[1] == 0.0f);
+
+        // Covered coarse cells average their eight children
+        REQUIRE(lists[0].restriction.size() == 8);
+        REQUIRE(lists[1].restriction.empty());
+        auto covered = findEntry(lists[0].restriction, nanovdb::Coord(1, 2, 1));
+        for (uint32_t k = 0; k < LevelInterface::kMaxSources; ++k) {
+            nanovdb::Coord child = layout.coords[covered.sources[k]];
+            REQUIRE(child[0] >> 1 == 1);
+            REQUIRE(child[1] >> 1 == 2);
+            REQUIRE(child[2] >> 1 == 1);
+            REQUIRE(covered.weights[k] == Catch::Approx(0.125f));
+        }
+    }
+
+    SECTION("Conservative ghosts copy the parent") {
+        auto lists = LevelInterface::buildLists(layout.coords, layout.levels, halo::Prolongation::Conservative);
+        auto ghost = findEntry(lists[1].prolongation, nanovdb::Coord(1, 3, 3));
+        REQUIRE(layout.coords[ghost.sources[0]] == nanovdb::Coord(0, 1, 1));
+        REQUIRE(ghost.weights[0] == 1.0f);
+        REQUIRE(ghost.weights[1] == 0.0f);
+    }
+}
+
+TEST_CASE("Staged transfers double-buffer devices per domain", "[halo][staged]")
+{
+    // Four domains on two physical devices: round-robin from the primary's
+    auto physical = core::DeviceGroup::assignPhysical(4, 2);
+    std::vector<uint32_t> expected{0, 1, 0, 1};
+    REQUIRE(physical == expected);
+
+    // A single GPU (or lavapipe) hosts every logical device
+    auto shared = core::DeviceGroup::assignPhysical(3, 1);
+    std::vector<uint32_t> sharedExpected{0, 0, 0};
+    REQUIRE(shared == sharedExpected);
+
+    // Exchange k is relayed once staged, even before the receiver copied out k - 1
+    using halo::StagedTransfer;
+    REQUIRE_FALSE(StagedTransfer::slotReady(3, 2, 1));
+    REQUIRE(StagedTransfer::slotReady(3, 3, 1));
+    REQUIRE(StagedTransfer::slotReady(1, 1, 0));
+    REQUIRE(StagedTransfer::slotReady(2, 2, 0));
+
+    // ... but not into a slot still holding k - 2
+    REQUIRE_FALSE(StagedTransfer::slotReady(4, 4, 1));
+    REQUIRE(StagedTransfer::slotReady(4, 4, 2));
+}
+
+TEST_CASE_METHOD(VulkanFixture, "Staged transfers relay exchanges between two devices", "[halo][staged][devices]")
+{
+    // A second logical device may share the primary's GPU (or lavapipe)
+    std::unique_ptr<core::DeviceGroup> group;
+    try {
+        core::DeviceGroup::Config groupConfig;
+        groupConfig.deviceCount = 2;
+        group = std::make_unique<core::DeviceGroup>(getContext(), getAllocator(), groupConfig);
+    } catch (const std::exception& e) {
+        SKIP("No second logical device: " << e.what());
+    }
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = 2;
+    config.strategy = domain::SplitStrategy::Bisection;
+    auto grid = createTestGrid(16, 1.0f);
+    auto domains = domain::DomainSplitter(config).split(grid);
+    REQUIRE(domains.size() == 2);
+    auto coords = nanovdb_adapter::GpuGridManager::collectSortedCoords(grid);
+
+    halo::HaloManager haloManager(getContext(), getAllocator(), domains);
+    haloManager.setDevices(*group);
+    haloManager.setFieldHaloThickness("phi", 1);
+    haloManager.buildIndexLists(coords);
+
+    // Each device holds the whole field, zero until values arrive
+    const float zero = 0.0f;
+    std::vector<std::unique_ptr<field::FieldRegistry>> registries;
+    for (uint32_t d = 0; d < 2; ++d) {
+        registries.push_back(std::make_unique<field::FieldRegistry>(
+            group->getContext(d), group->getAllocator(d), static_cast<uint32_t>(coords.size())));
+        registries.back()->registerField("phi", vk::Format::eR32Sfloat, &zero);
+    }
+    haloManager.allocateHalos({&registries[0]->getFields(), &registries[1]->getFields()});
+    haloManager.createHaloSemaphores();
+
+    halo::StagedTransfer staged(haloManager);
+    staged.allocate();
+
+    auto* sendMessage = haloManager.getHaloBufferSet(0).find(1);
+    auto* recvMessage = haloManager.getHaloBufferSet(1).find(0);
+    REQUIRE(sendMessage);
+    REQUIRE(recvMessage);
+    int32_t sendIndex = sendMessage->segmentIndex("phi");
+    int32_t recvIndex = recvMessage->segmentIndex("phi");
+    REQUIRE(sendIndex >= 0);
+    REQUIRE(recvIndex >= 0);
+    const auto& sendSegment = sendMessage->segments[sendIndex];
+    const auto& recvSegment = recvMessage->segments[recvIndex];
+    REQUIRE(sendSegment.sendCount > 0);
+    REQUIRE(recvSegment.recvCount == sendSegment.sendCount);
+
+    auto findList = [&](uint32_t gpu, uint32_t neighbor) {
+        for (const auto& list : haloManager.getIndexLists(gpu)) {
+            if (list.neighborGpu == neighbor) return &list;
+        }
+        return static_cast<const halo::HaloIndexList*>(nullptr);
+    };
+    const auto* sendList = findList(0, 1);
+    const auto* recvList = findList(1, 0);
+    REQUIRE(sendList);
+    REQUIRE(recvList);
+
+    uint32_t maxUnits = halo::HaloManager::encodedUnits(sendSegment.encoding, sendSegment.sendCount, 1);
+    std::vector<vk::BufferCopy> sendRegions{{sendSegment.sendOffset, recvSegment.recvOffset, sendSegment.sendBytes}};
+    std::vector<vk::BufferCopy> recvRegions{{recvSegment.recvOffset, recvSegment.recvOffset, recvSegment.recvBytes}};
+
+    halo::HaloSync packSync(2, group->getContext(0));
+    halo::HaloSync unpackSync(2, group->getContext(1));
+
+    std::array<vk::CommandPool, 2> pools;
+    for (uint32_t d = 0; d < 2; ++d) {
+        pools[d] = group->getContext(d).getDevice().createCommandPool(
+            vk::CommandPoolCreateInfo({}, group->getContext(d).getComputeQueueFamily()));
+    }
+    auto begin = [&](uint32_t d) {
+        vk::CommandBufferAllocateInfo allocInfo(pools[d], vk::CommandBufferLevel::ePrimary, 1);
+        auto cmd = group->getContext(d).getDevice().allocateCommandBuffers(allocInfo)[0];
+        cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        return cmd;
+    };
+    auto submit = [&](uint32_t d, vk::CommandBuffer cmd, halo::Transport::Wait wait,
+                      vk::Semaphore signal, uint64_t value) {
+        cmd.end();
+        vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eAllCommands;
+        uint32_t waitCount = wait.semaphore ? 1 : 0;
+        vk::TimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.waitSemaphoreValueCount = waitCount;
+        timelineInfo.pWaitSemaphoreValues = &wait.value;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &value;
+
+        vk::SubmitInfo submitInfo{};
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.waitSemaphoreCount = waitCount;
+        submitInfo.pWaitSemaphores = &wait.semaphore;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &cmd;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &signal;
+        group->getContext(d).getComputeQueue().submit(submitInfo);
+    };
+
+    // Exchange k sends the value k. All four are queued before any is
+    // received: 3 and 4 reuse the slots of 1 and 2, so the sender waits for
+    // them to drain and the relay for the receiver to release them.
+    const uint64_t exchanges = 4;
+    const auto& sourceField = registries[0]->getField("phi");
+    for (uint64_t k = 1; k <= exchanges; ++k) {
+        auto cmd = begin(0);
+        vk::MemoryBarrier reuse(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead,
+                                vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderWrite);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+                            vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader,
+                            {}, reuse, nullptr, nullptr);
+
+        float value = static_cast<float>(k);
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        cmd.fillBuffer(sourceField.buffer.handle, 0, VK_WHOLE_SIZE, bits);
+        vk::MemoryBarrier filled(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+                            {}, filled, nullptr, nullptr);
+
+        packSync.recordHaloPack(cmd, sendMessage->segmentTable.handle, sendMessage->sendBuffer.handle,
+                                sendList->gatherIndices.handle, 1u << sendIndex,
+                                static_cast<uint32_t>(sendMessage->segments.size()), maxUnits);
+        vk::MemoryBarrier packed(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer,
+                            {}, packed, nullptr, nullptr);
+
+        staged.recordStage(cmd, 0, 1, k, sendRegions);
+        submit(0, cmd, staged.sendWait(0, 1, k), haloManager.getHaloSemaphore(0, 1), k);
+    }
+
+    auto& receiverAllocator = group->getAllocator(1);
+    const auto& ghostField = registries[1]->getField("phi");
+    vk::DeviceSize fieldBytes = coords.size() * sizeof(float);
+    auto readback = receiverAllocator.createBuffer(fieldBytes, vk::BufferUsageFlagBits::eTransferDst,
+                                                   VMA_MEMORY_USAGE_GPU_TO_CPU);
+    vk::Semaphore release = haloManager.getReleaseSemaphore(0, 1);
+
+    for (uint64_t k = 1; k <= exchanges; ++k) {
+        auto cmd = begin(1);
+        staged.recordReceive(cmd, 0, 1, k, recvRegions);
+        unpackSync.recordHaloUnpack(cmd, recvMessage->segmentTable.handle, recvMessage->recvBuffer.handle,
+                                    recvList->scatterIndices.handle, 1u << recvIndex,
+                                    static_cast<uint32_t>(recvMessage->segments.size()), maxUnits);
+        vk::MemoryBarrier unpacked(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer,
+                            {}, unpacked, nullptr, nullptr);
+        cmd.copyBuffer(ghostField.buffer.handle, readback.handle, vk::BufferCopy(0, 0, fieldBytes));
+        vk::MemoryBarrier copied(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
+                            {}, copied, nullptr, nullptr);
+        submit(1, cmd, staged.receiveWait(0, 1, k), release, k);
+
+        vk::SemaphoreWaitInfo waitInfo({}, release, k);
+        REQUIRE(group->getContext(1).getDevice().waitSemaphores(waitInfo, 10'000'000'000ull) ==
+                vk::Result::eSuccess);
+
+        // Exactly the ghosts from device 0 hold this exchange's value
+        const float* values = static_cast<const float*>(receiverAllocator.mapBuffer(readback));
+        uint32_t received = 0, untouched = 0;
+        for (size_t i = 0; i < coords.size(); ++i) {
+            received += values[i] == static_cast<float>(k);
+            untouched += values[i] == 0.0f;
+        }
+        receiverAllocator.unmapBuffer(readback);
+        INFO("exchange " << k);
+        REQUIRE(received == recvSegment.recvCount);
+        REQUIRE(received + untouched == coords.size());
+    }
+
+    for (uint32_t d = 0; d < 2; ++d) {
+        group->getContext(d).getDevice().waitIdle();
+    }
+    // The relay counts an exchange right after signalling it arrived
+    REQUIRE(staged.getBytesReceived() >= (exchanges - 1) * sendSegment.sendBytes);
+
+    receiverAllocator.destroyBuffer(readback);
+    for (uint32_t d = 0; d < 2; ++d) {
+        group->getContext(d).getDevice().destroyCommandPool(pools[d]);
+    }
+}
+
+TEST_CASE("Shared memory ring carries halo messages between ranks", "[halo][shm]")
+{
+    using halo::SharedMemoryRing;
+    auto name = halo::HostLink::linkName("test" + std::to_string(getpid()), 0, 1, 0);
+
+    // Receiver creates, sender opens by name
+    auto receiver = SharedMemoryRing::create(name, 2, 64);
+    auto sender = SharedMemoryRing::open(name, 64, std::chrono::milliseconds(100));
+    REQUIRE(sender->getSlotCount() == 2);
+    REQUIRE(sender->getSlotBytes() == 64);
+
+    uint64_t exchange = 0;
+    uint64_t size = 0;
+    REQUIRE(receiver->beginPop(exchange, size) == nullptr);
+
+    // Two exchanges in flight, then the sender stalls
+    for (uint64_t k = 1; k <= 2; ++k) {
+        uint8_t* payload = sender->beginPush();
+        REQUIRE(payload != nullptr);
+        std::memcpy(payload, &k, sizeof(k));
+        sender->commitPush(k, sizeof(k));
+    }
+    REQUIRE(sender->beginPush() == nullptr);
+
+    // Messages arrive in order, and popping frees a slot for exchange 3
+    const uint8_t* payload = receiver->beginPop(exchange, size);
+    REQUIRE(payload != nullptr);
+    uint64_t value = 0;
+    std::memcpy(&value, payload, sizeof(value));
+    REQUIRE(exchange == 1);
+    REQUIRE(size == sizeof(uint64_t));
+    REQUIRE(value == 1);
+    receiver->commitPop();
+    REQUIRE(sender->beginPush() != nullptr);
+
+    REQUIRE(receiver->beginPop(exchange, size) != nullptr);
+    REQUIRE(exchange == 2);
+
+    REQUIRE_THROWS(SharedMemoryRing::open(name + "-missing", 64, std::chrono::milliseconds(5)));
+    REQUIRE_THROWS(SharedMemoryRing::open(name, 128, std::chrono::milliseconds(5)));
+}
+
+TEST_CASE("Unix socket link frames halo messages between ranks", "[halo][socket]")
+{
+    using halo::HostLink;
+    using halo::HostLinkType;
+    auto name = HostLink::linkName("test" + std::to_string(getpid()), 0, 0, 1);
+
+    auto receiver = HostLink::create(HostLinkType::UnixSocket, name, 2, 1024);
+    auto sender = HostLink::open(HostLinkType::UnixSocket, name, 1024, std::chrono::milliseconds(100));
+    REQUIRE(sender->getSlotBytes() == 1024);
+
+    uint64_t exchange = 0;
+    uint64_t size = 0;
+    REQUIRE(receiver->beginPop(exchange, size) == nullptr);
+
+    // Messages of different sizes keep their boundaries
+    for (uint64_t k = 1; k <= 3; ++k) {
+        uint8_t* payload = sender->beginPush();
+        REQUIRE(payload != nullptr);
+        std::memset(payload, static_cast<int>(k), k * 100);
+        sender->commitPush(k, k * 100);
+    }
+
+    for (uint64_t k = 1; k <= 3; ++k) {
+        const uint8_t* payload = nullptr;
+        for (int attempt = 0; attempt < 1000 && !payload; ++attempt) {
+            payload = receiver->beginPop(exchange, size);
+        }
+        REQUIRE(payload != nullptr);
+        REQUIRE(exchange == k);
+        REQUIRE(size == k * 100);
+        REQUIRE(payload[0] == k);
+        REQUIRE(payload[size - 1] == k);
+        receiver->commitPop();
+    }
+    REQUIRE(receiver->beginPop(exchange, size) == nullptr);
+
+    REQUIRE(HostLink::parseType(HostLink::typeName(HostLinkType::UnixSocket)) == HostLinkType::UnixSocket);
+    REQUIRE_THROWS(HostLink::parseType("carrier-pigeon"));
+}
@@ -1,5 +1,8 @@
 #include "VulkanFixture.hpp"
 #include "graph/DependencyGraph.hpp"
+#include "graph/GraphExecutor.hpp"
+#include "graph/HaloPlanner.hpp"
+#include "graph/TemporalBlockTuner.hpp"
 #include "stencil/StencilDefinition.hpp"
 
 #include <catch2/catch_all.hpp>
@@ -204,3 +207,191 @@ TEST_CASE("Large DAG scheduling", "[graph][performance]")
         REQUIRE(cur < next);
     }
 }
+
+TEST_CASE("Halo exchange only for dirty fields before neighbor reads", "[graph][halo]")
+{
+    auto makeStencil = [](std::string name, std::vector<std::string> inputs,
+                          std::vector<std::string> outputs, uint32_t radius) {
+        stencil::StencilDefinition def;
+        def.name = std::move(name);
+        def.inputs = std::move(inputs);
+        def.outputs = std::move(outputs);
+        def.neighborRadius = radius;
+        return def;
+    };
+
+    // 'source' only reads its own voxel; 'diffuse' and 'project' read neighbors
+    auto source = makeStencil("source", {"density", "temperature"}, {"density"}, 0);
+    auto diffuse = makeStencil("diffuse", {"density", "velocity"}, {"density_new"}, 1);
+    auto project = makeStencil("project", {"density_new", "velocity"}, {"pressure"}, 2);
+    std::vector<const stencil::StencilDefinition*> schedule{&source, &diffuse, &project};
+
+    graph::HaloPlanner planner;
+    auto first = planner.planStep(schedule);
+
+    REQUIRE(first.exchanges.size() == 3);
+    REQUIRE(first.exchanges[0].empty());           // No neighbor reads, 'temperature' never exchanged
+    REQUIRE(first.exchanges[1].size() == 2);       // Before the first consumer
+    REQUIRE(first.exchanges[1][0].field == "density");
+    REQUIRE(first.exchanges[1][1].field == "velocity");
+    REQUIRE(first.exchanges[1][1].radius == 2);    // Shared with 'project'
+    REQUIRE(first.exchanges[2].size() == 1);       // Written by 'diffuse' this step
+    REQUIRE(first.exchanges[2][0].field == "density_new");
+    REQUIRE(first.exchangeCount == 3);
+
+    // 'velocity' is never rewritten, so the second step skips it
+    auto second = planner.planStep(schedule);
+    REQUIRE(second.exchangeCount == 2);
+    REQUIRE(second.exchanges[1].size() == 1);
+    REQUIRE(second.exchanges[1][0].field == "density");
+    REQUIRE_FALSE(planner.isDirty("velocity"));
+
+    planner.markAllDirty();
+    REQUIRE(planner.isDirty("velocity"));
+    REQUIRE(planner.planStep(schedule).exchangeCount == 3);
+}
+
+TEST_CASE("Halo thickness follows the widest neighbor read", "[graph][halo]")
+{
+    stencil::StencilDefinition source;
+    source.inputs = {"density", "temperature"};
+    source.outputs = {"density"};
+
+    stencil::StencilDefinition diffuse;
+    diffuse.inputs = {"density"};
+    diffuse.outputs = {"density_new"};
+    diffuse.neighborRadius = 1;
+
+    stencil::StencilDefinition gradient;
+    gradient.inputs = {"density", "pressure"};
+    gradient.outputs = {"velocity"};
+    gradient.neighborRadius = 2;
+
+    stencil::StencilDefinition boundary;
+    boundary.inputs = {"velocity"};
+    boundary.outputs = {"velocity_bc"};
+    boundary.requiresHalos = true;
+
+    auto thickness = graph::HaloPlanner::fieldHaloThickness({&source, &diffuse, &gradient, &boundary});
+
+    REQUIRE(thickness.at("density") == 2);
+    REQUIRE(thickness.at("pressure") == 2);
+    REQUIRE(thickness.at("velocity") == 1);       // Neighbor access without a radius
+    REQUIRE(thickness.count("temperature") == 0); // Pointwise only: no halo
+    REQUIRE(thickness.count("density_new") == 0);
+}
+
+TEST_CASE("Temporal blocking exchanges deep halos once per block", "[graph][halo][blocking]")
+{
+    stencil::StencilDefinition source;
+    source.inputs = {"density", "temperature"};
+    source.outputs = {"density"};
+
+    stencil::StencilDefinition diffuse;
+    diffuse.inputs = {"density"};
+    diffuse.outputs = {"density_new"};
+    diffuse.neighborRadius = 1;
+
+    stencil::StencilDefinition advect;
+    advect.inputs = {"density_new", "velocity"};
+    advect.outputs = {"density"};
+    advect.neighborRadius = 2;
+
+    std::vector<const stencil::StencilDefinition*> schedule{&source, &diffuse, &advect};
+    REQUIRE(graph::HaloPlanner::stepRadius(schedule) == 3);
+
+    // Pointwise inputs need the full depth too: their ghosts are recomputed
+    auto thickness = graph::HaloPlanner::fieldHaloThickness(schedule, 2);
+    REQUIRE(thickness.at("temperature") == 6);
+    REQUIRE(thickness.at("velocity") == 6);
+    REQUIRE(thickness.count("density") == 1);
+
+    graph::HaloPlanner planner;
+    planner.setBlockSteps(2);
+
+    auto first = planner.planStep(schedule);
+    REQUIRE(first.exchanges[0].size() == 3);       // density, temperature, velocity
+    REQUIRE(first.exchanges[0][0].radius == 6);
+    REQUIRE(first.exchanges[1].empty());           // density_new is written before it is read
+    std::vector<uint32_t> firstDepth{6, 5, 3};     // Shrinks by each neighbor read
+    REQUIRE(first.ghostDepth == firstDepth);
+
+    auto second = planner.planStep(schedule);
+    REQUIRE(second.exchangeCount == 0);
+    std::vector<uint32_t> secondDepth{3, 2, 0};    // Owned voxels only at the end
+    REQUIRE(second.ghostDepth == secondDepth);
+
+    // Next block: only the fields written since the last exchange
+    auto third = planner.planStep(schedule);
+    REQUIRE(third.exchangeCount == 1);
+    REQUIRE(third.exchanges[0][0].field == "density");
+    REQUIRE(third.ghostDepth.front() == 6);
+
+    // Repartitioning mid-block restarts the block with a full exchange
+    planner.markAllDirty();
+    REQUIRE(planner.getBlockPosition() == 0);
+    REQUIRE(planner.planStep(schedule).exchangeCount == 3);
+}
+
+TEST_CASE_METHOD(VulkanFixture, "Temporal blocking needs per-domain field buffers", "[graph][halo][blocking]")
+{
+    // Stands in for a host relay between per-domain copies of the fields
+    struct RelayTransport : halo::Transport {
+        const char* getName() const override { return "relay"; }
+        Wait sendWait(uint32_t, uint32_t, uint64_t) const override { return {}; }
+        void recordSend(vk::CommandBuffer, uint32_t, uint32_t, uint64_t,
+                        const std::vector<vk::BufferCopy>&) override {}
+        Wait receiveWait(uint32_t, uint32_t, uint64_t) const override { return {}; }
+        void recordReceive(vk::CommandBuffer, uint32_t, uint32_t, uint64_t,
+                           const std::vector<vk::BufferCopy>&) override {}
+    };
+
+    std::vector<domain::SubDomain> domains(2);
+    domains[0].gpuIndex = 0;
+    domains[1].gpuIndex = 1;
+    halo::HaloManager haloManager(getContext(), getAllocator(), domains);
+    field::FieldRegistry fields(getContext(), getAllocator(), 64);
+    graph::GraphExecutor executor(getContext(), haloManager, fields);
+
+    // Device copies leave both domains on one set of field buffers: a block
+    // step of domain 0 would advance domain 1's voxels as its ghosts
+    REQUIRE(executor.getTransport().isDeviceLocal());
+    REQUIRE_THROWS(executor.setBlockSteps(2));
+    REQUIRE(executor.getHaloPlanner().getBlockSteps() == 1);
+    REQUIRE_NOTHROW(executor.setBlockSteps(1));
+
+    RelayTransport relay;
+    executor.setTransport(&relay);
+    executor.setBlockSteps(2);
+    REQUIRE(executor.getHaloPlanner().getBlockSteps() == 2);
+    executor.setTransport(nullptr);
+}
+
+TEST_CASE("Block tuner weighs exchange latency against ghost compute", "[graph][halo][blocking]")
+{
+    graph::TemporalBlockTuner::Config config;
+    config.maxBlockSteps = 4;
+    config.probeBlocks = 2;
+
+    SECTION("Latency-bound exchange favors deep blocks") {
+        graph::TemporalBlockTuner tuner(config);
+        REQUIRE(tuner.getBlockSteps() == 1);
+        for (int i = 0; i < 2; ++i) tuner.recordStep(10.0, 1.0);
+        REQUIRE(tuner.getBlockSteps() == 4);
+        for (int block = 0; block < 2; ++block) {
+            tuner.recordStep(10.5, 1.1);
+            for (int i = 0; i < 3; ++i) tuner.recordStep(0.0, 1.1);
+        }
+        REQUIRE(tuner.isTuned());
+        REQUIRE(tuner.getBlockSteps() == 4);
+        REQUIRE(tuner.predictStepTime(4) < tuner.predictStepTime(1));
+    }
+
+    SECTION("Cheap exchange with costly ghosts stays at one step") {
+        graph::TemporalBlockTuner tuner(config);
+        for (int i = 0; i < 2; ++i) tuner.recordStep(0.1, 1.0);
+        for (int i = 0; i < 8; ++i) tuner.recordStep(i % 4 == 0 ? 0.4 : 0.0, 2.0);
+        REQUIRE(tuner.isTuned());
+        REQUIRE(tuner.getBlockSteps() == 1);
+    }
+}
@@ -147,6 +147,7 @@ inline vk::CommandBuffer VulkanFixture::beginCommand()
         1);
 
     auto buffers = m_context->getDevice().allocateCommandBuffers(allocInfo);
+    buffers[0].begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
     return buffers[0];
 }
 
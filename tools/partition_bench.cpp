@@ -0,0 +1,390 @@
+// tools/partition_bench.cpp
+// Compares DomainSplitter strategies on a grid and writes partition quality to CSV/JSON
+//
+// Usage:
+//   partition_bench <grid.nvdb|grid.vdb> [--gpus 2,4,8] [--fields density:4,velocity:12]
+//                   [--halo 2] [--tolerance 0.1] [--csv out.csv] [--json out.json]
+
+#include "core/Logger.hpp"
+#include "domain/DomainSplitter.hpp"
+#include "nanovdb_adapter/GridLoader.hpp"
+
+#include <nanovdb/tools/CreateNanoGrid.h>
+#ifdef FLUIDLOOM_HAS_OPENVDB
+#include <openvdb/openvdb.h>
+#endif
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct FieldSpec {
+    std::string name;
+    uint32_t bytesPerVoxel = 4;
+};
+
+struct Options {
+    std::filesystem::path gridPath;
+    std::vector<uint32_t> gpuCounts = {2, 4, 8};
+    std::vector<FieldSpec> fields = {{"density", 4}};
+    uint32_t haloThickness = 2;
+    float tolerance = 0.1f;
+    std::string csvPath;
+    std::string jsonPath;
+};
+
+struct NeighborResult {
+    uint32_t gpuIndex = 0;
+    uint32_t face = 0;
+    uint64_t sendVoxels = 0;
+};
+
+struct DomainResult {
+    uint32_t gpuIndex = 0;
+    uint32_t activeVoxels = 0;
+    double workload = 0.0;
+    std::array<uint64_t, 6> faceHaloVoxels{};   // Send voxels by dominant contact face
+    uint64_t haloVoxels = 0;
+    uint64_t commBytes = 0;                     // Bytes sent per step for the field set
+    uint64_t memoryBytes = 0;                   // Field set storage + halo send buffers
+    std::vector<NeighborResult> neighbors;
+};
+
+struct RunResult {
+    std::string strategy;
+    uint32_t gpuCount = 0;
+    double splitMs = 0.0;
+    double haloListMs = 0.0;
+    domain::DomainSplitter::LoadBalanceStats stats;
+    uint64_t commBytes = 0;
+    std::vector<DomainResult> domains;
+};
+
+const char* kFaceNames[6] = {"-X", "+X", "-Y", "+Y", "-Z", "+Z"};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Quote a string for the hand-written JSON output
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+            quoted += escape;
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + '"';
+}
+
+void printUsage() {
+    std::cout << "Usage: partition_bench <grid.nvdb|grid.vdb> [options]\n"
+              << "  --gpus 2,4,8                 GPU counts to evaluate\n"
+              << "  --fields name:bytes,...      Field set for communication volume (default density:4)\n"
+              << "  --halo N                     Halo thickness in voxels (default 2)\n"
+              << "  --tolerance T                Load balance tolerance (default 0.1)\n"
+              << "  --csv FILE                   Write per-domain rows as CSV\n"
+              << "  --json FILE                  Write full results (incl. per-neighbor) as JSON\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.gridPath = argv[1];
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--gpus") {
+            options.gpuCounts.clear();
+            for (const auto& item : splitList(value)) {
+                options.gpuCounts.push_back(static_cast<uint32_t>(std::stoul(item)));
+            }
+        } else if (arg == "--fields") {
+            options.fields.clear();
+            for (const auto& item : splitList(value)) {
+                FieldSpec field;
+                auto colon = item.find(':');
+                field.name = item.substr(0, colon);
+                if (colon != std::string::npos) {
+                    field.bytesPerVoxel = static_cast<uint32_t>(std::stoul(item.substr(colon + 1)));
+                }
+                options.fields.push_back(field);
+            }
+        } else if (arg == "--halo") {
+            options.haloThickness = static_cast<uint32_t>(std::stoul(value));
+        } else if (arg == "--tolerance") {
+            options.tolerance = std::stof(value);
+        } else if (arg == "--csv") {
+            options.csvPath = value;
+        } else if (arg == "--json") {
+            options.jsonPath = value;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+nanovdb::GridHandle<nanovdb::HostBuffer> loadGrid(const std::filesystem::path& path) {
+    if (path.extension() != ".vdb") {
+        return nanovdb_adapter::GridLoader::load(path);
+    }
+
+#ifdef FLUIDLOOM_HAS_OPENVDB
+    openvdb::initialize();
+    openvdb::io::File file(path.string());
+    file.open();
+    auto baseGrid = file.readGrid(file.beginName().gridName());
+    file.close();
+
+    auto floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
+    if (!floatGrid) {
+        throw std::runtime_error("Only float OpenVDB grids are supported: " + path.string());
+    }
+    return nanovdb::tools::createNanoGrid(*floatGrid);
+#else
+    throw std::runtime_error("partition_bench was built without OpenVDB; convert to .nvdb first");
+#endif
+}
+
+RunResult runSplit(const nanovdb::GridHandle<nanovdb::HostBuffer>& grid,
+                   const std::vector<domain::LeafStats>& leaves,
+                   const Options& options,
+                   domain::SplitStrategy strategy,
+                   const std::string& strategyName,
+                   uint32_t gpuCount) {
+    using Clock = std::chrono::steady_clock;
+
+    domain::DomainSplitter::SplitConfig config;
+    config.gpuCount = gpuCount;
+    config.haloThickness = options.haloThickness;
+    config.loadBalanceTolerance = options.tolerance;
+    config.strategy = strategy;
+    domain::DomainSplitter splitter(config);
+
+    RunResult run;
+    run.strategy = strategyName;
+    run.gpuCount = gpuCount;
+
+    auto start = Clock::now();
+    auto domains = splitter.split(leaves);
+    auto split = Clock::now();
+    splitter.buildHaloLists(grid, domains);
+    auto halo = Clock::now();
+
+    run.splitMs = std::chrono::duration<double, std::milli>(split - start).count();
+    run.haloListMs = std::chrono::duration<double, std::milli>(halo - split).count();
+    run.stats = splitter.analyzeBalance(domains);
+
+    uint64_t bytesPerVoxel = 0;
+    for (const auto& field : options.fields) {
+        bytesPerVoxel += field.bytesPerVoxel;
+    }
+
+    for (const auto& domain : domains) {
+        DomainResult result;
+        result.gpuIndex = domain.gpuIndex;
+        result.activeVoxels = domain.activeVoxelCount;
+        result.workload = domain.workload;
+
+        for (const auto& list : domain.haloLists) {
+            NeighborResult neighbor;
+            neighbor.gpuIndex = list.neighborGpu;
+            neighbor.sendVoxels = list.sendVoxels.size();
+            for (const auto& info : domain.neighbors) {
+                if (info.gpuIndex == list.neighborGpu) {
+                    neighbor.face = info.face;
+                }
+            }
+
+            result.faceHaloVoxels[neighbor.face] += neighbor.sendVoxels;
+            result.haloVoxels += neighbor.sendVoxels;
+            result.neighbors.push_back(neighbor);
+        }
+
+        result.commBytes = result.haloVoxels * bytesPerVoxel;
+        result.memoryBytes = static_cast<uint64_t>(domain.activeVoxelCount) * bytesPerVoxel +
+                             result.commBytes;
+        run.commBytes += result.commBytes;
+        run.domains.push_back(std::move(result));
+    }
+
+    return run;
+}
+
+void writeCSV(const std::string& path, const std::vector<RunResult>& runs) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Cannot open CSV output: " + path);
+    }
+
+    out << "strategy,gpus,split_ms,halo_list_ms,imbalance,stddev_voxels,predicted_imbalance,"
+           "total_halo_voxels,max_halo_voxels,avg_surface_to_volume,max_surface_to_volume,"
+           "comm_bytes_per_step,domain,active_voxels,workload,neighbors,halo_send_voxels";
+    for (const char* face : kFaceNames) {
+        out << ",halo_" << face;
+    }
+    out << ",domain_comm_bytes,memory_bytes\n";
+
+    for (const auto& run : runs) {
+        for (const auto& domain : run.domains) {
+            out << run.strategy << ',' << run.gpuCount << ','
+                << run.splitMs << ',' << run.haloListMs << ','
+                << run.stats.imbalanceFactor << ',' << run.stats.standardDeviation << ','
+                << run.stats.predictedImbalance << ','
+                << run.stats.totalHaloVoxels << ',' << run.stats.maxHaloVoxels << ','
+                << run.stats.averageSurfaceToVolume << ',' << run.stats.maxSurfaceToVolume << ','
+                << run.commBytes << ','
+                << domain.gpuIndex << ',' << domain.activeVoxels << ',' << domain.workload << ','
+                << domain.neighbors.size() << ',' << domain.haloVoxels;
+            for (uint64_t count : domain.faceHaloVoxels) {
+                out << ',' << count;
+            }
+            out << ',' << domain.commBytes << ',' << domain.memoryBytes << '\n';
+        }
+    }
+}
+
+void writeJSON(const std::string& path, const Options& options, const std::vector<RunResult>& runs) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Cannot open JSON output: " + path);
+    }
+
+    out << "{\n  \"grid\": " << jsonString(options.gridPath.generic_string()) << ",\n"
+        << "  \"haloThickness\": " << options.haloThickness << ",\n"
+        << "  \"tolerance\": " << options.tolerance << ",\n  \"fields\": [";
+    for (size_t f = 0; f < options.fields.size(); ++f) {
+        out << (f ? ", " : "") << "{\"name\": " << jsonString(options.fields[f].name)
+            << ", \"bytesPerVoxel\": " << options.fields[f].bytesPerVoxel << "}";
+    }
+    out << "],\n  \"runs\": [\n";
+
+    for (size_t r = 0; r < runs.size(); ++r) {
+        const auto& run = runs[r];
+        out << "    {\"strategy\": " << jsonString(run.strategy) << ", \"gpus\": " << run.gpuCount
+            << ", \"splitMs\": " << run.splitMs << ", \"haloListMs\": " << run.haloListMs
+            << ",\n     \"balance\": {\"minVoxels\": " << run.stats.minVoxels
+            << ", \"maxVoxels\": " << run.stats.maxVoxels
+            << ", \"averageVoxels\": " << run.stats.averageVoxels
+            << ", \"standardDeviation\": " << run.stats.standardDeviation
+            << ", \"imbalanceFactor\": " << run.stats.imbalanceFactor
+            << ", \"predictedImbalance\": " << run.stats.predictedImbalance
+            << ", \"totalHaloVoxels\": " << run.stats.totalHaloVoxels
+            << ", \"maxHaloVoxels\": " << run.stats.maxHaloVoxels
+            << ", \"averageSurfaceToVolume\": " << run.stats.averageSurfaceToVolume
+            << ", \"maxSurfaceToVolume\": " << run.stats.maxSurfaceToVolume << "},\n"
+            << "     \"commBytesPerStep\": " << run.commBytes << ",\n     \"domains\": [\n";
+
+        for (size_t d = 0; d < run.domains.size(); ++d) {
+            const auto& domain = run.domains[d];
+            out << "       {\"gpu\": " << domain.gpuIndex
+                << ", \"activeVoxels\": " << domain.activeVoxels
+                << ", \"workload\": " << domain.workload
+                << ", \"haloSendVoxels\": " << domain.haloVoxels
+                << ", \"commBytes\": " << domain.commBytes
+                << ", \"memoryBytes\": " << domain.memoryBytes
+                << ",\n        \"faces\": {";
+            for (int face = 0; face < 6; ++face) {
+                out << (face ? ", " : "") << '"' << kFaceNames[face] << "\": "
+                    << domain.faceHaloVoxels[face];
+            }
+            out << "},\n        \"neighbors\": [";
+            for (size_t n = 0; n < domain.neighbors.size(); ++n) {
+                const auto& neighbor = domain.neighbors[n];
+                out << (n ? ", " : "") << "{\"gpu\": " << neighbor.gpuIndex
+                    << ", \"face\": \"" << kFaceNames[neighbor.face]
+                    << "\", \"sendVoxels\": " << neighbor.sendVoxels << "}";
+            }
+            out << "]}" << (d + 1 < run.domains.size() ? "," : "") << "\n";
+        }
+        out << "     ]}" << (r + 1 < runs.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    core::Logger::init(spdlog::level::warn);
+
+    try {
+        auto grid = loadGrid(options.gridPath);
+        auto leaves = domain::DomainSplitter::collectLeafStats(grid);
+        std::cout << "Loaded " << options.gridPath << ": " << leaves.size() << " leaves, "
+                  << grid.grid<float>()->activeVoxelCount() << " active voxels" << std::endl;
+
+        const std::pair<domain::SplitStrategy, const char*> strategies[] = {
+            {domain::SplitStrategy::Morton, "morton"},
+            {domain::SplitStrategy::Hilbert, "hilbert"},
+            {domain::SplitStrategy::Bisection, "bisection"},
+            {domain::SplitStrategy::Graph, "graph"},
+        };
+
+        std::vector<RunResult> runs;
+        for (uint32_t gpuCount : options.gpuCounts) {
+            for (const auto& [strategy, name] : strategies) {
+                runs.push_back(runSplit(grid, leaves, options, strategy, name, gpuCount));
+                const auto& run = runs.back();
+                std::cout << "  " << name << " x" << gpuCount
+                          << ": split " << run.splitMs << " ms"
+                          << ", imbalance " << run.stats.imbalanceFactor
+                          << ", halo voxels " << run.stats.totalHaloVoxels
+                          << ", comm " << run.commBytes << " B/step" << std::endl;
+            }
+        }
+
+        if (!options.csvPath.empty()) {
+            writeCSV(options.csvPath, runs);
+            std::cout << "✓ Wrote " << options.csvPath << std::endl;
+        }
+        if (!options.jsonPath.empty()) {
+            writeJSON(options.jsonPath, options, runs);
+            std::cout << "✓ Wrote " << options.jsonPath << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "partition_bench failed: " << e.what() << std::endl;
+        core::Logger::shutdown();
+        return 1;
+    }
+
+    core::Logger::shutdown();
+    return 0;
+}
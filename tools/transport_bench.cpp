@@ -0,0 +1,331 @@
+// tools/transport_bench.cpp
+// Loopback latency and bandwidth of each halo transport backend
+//
+// Host links (shared memory ring, Unix socket) run against an echo process
+// forked on this node, like two ranks of a run. The device copy backend
+// times vkCmdCopyBuffer between two device buffers, including submit and
+// wait, like a same-device halo transfer.
+//
+// Usage:
+//   transport_bench [--sizes 64,4096,65536,1048576] [--iterations 1000]
+//                   [--backends device,shm,socket] [--csv out.csv]
+
+#define VK_NO_PROTOTYPES
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include "core/Logger.hpp"
+#include "core/VulkanContext.hpp"
+#include "core/MemoryAllocator.hpp"
+#include "halo/HostLink.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Define Vulkan dynamic dispatcher storage
+VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Exchange tags understood by the echo process
+constexpr uint64_t kEcho = 1ull << 62;     // Reply with a message of the same size
+constexpr uint64_t kStop = 1ull << 63;     // Exit
+
+struct Options {
+    std::vector<uint64_t> sizes = {64, 4096, 65536, 1 << 20};
+    uint32_t iterations = 1000;
+    std::vector<std::string> backends = {"device", "shm", "socket"};
+    std::string csvPath;
+};
+
+struct Result {
+    std::string backend;
+    uint64_t bytes = 0;
+    double latencyUs = 0.0;         // Median one-way latency
+    double bandwidthGBs = 0.0;      // Streaming throughput
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+void printUsage() {
+    std::cout << "Usage: transport_bench [options]\n"
+              << "  --sizes 64,4096,...          Message sizes in bytes\n"
+              << "  --iterations N               Messages per measurement (default 1000)\n"
+              << "  --backends device,shm,socket Backends to measure (device needs a Vulkan device)\n"
+              << "  --csv FILE                   Write results as CSV\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--sizes") {
+            options.sizes.clear();
+            for (const auto& item : splitList(value)) {
+                options.sizes.push_back(std::stoull(item));
+            }
+        } else if (arg == "--iterations") {
+            options.iterations = static_cast<uint32_t>(std::stoul(value));
+        } else if (arg == "--backends") {
+            options.backends = splitList(value);
+        } else if (arg == "--csv") {
+            options.csvPath = value;
+        } else {
+            return false;
+        }
+    }
+    return !options.sizes.empty() && options.iterations > 0;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+void flushBlocking(halo::HostLink& link) {
+    while (!link.flush()) {
+        std::this_thread::yield();
+    }
+}
+
+uint8_t* pushBlocking(halo::HostLink& link) {
+    uint8_t* payload = nullptr;
+    while (!(payload = link.beginPush())) {
+        std::this_thread::yield();
+    }
+    return payload;
+}
+
+const uint8_t* popBlocking(halo::HostLink& link, uint64_t& exchange, uint64_t& size) {
+    const uint8_t* payload = nullptr;
+    while (!(payload = link.beginPop(exchange, size))) {
+        std::this_thread::yield();
+    }
+    return payload;
+}
+
+// Echo side of a host link measurement (runs in the forked process)
+[[noreturn]] void runEcho(halo::HostLink& requests, halo::HostLinkType type,
+                          const std::string& replyName, uint64_t slotBytes) {
+    int status = 0;
+    try {
+        auto replies = halo::HostLink::open(type, replyName, slotBytes, std::chrono::seconds(10));
+        while (true) {
+            uint64_t exchange = 0;
+            uint64_t size = 0;
+            popBlocking(requests, exchange, size);
+            requests.commitPop();
+            if (exchange & kStop) {
+                break;
+            }
+            if (exchange & kEcho) {
+                pushBlocking(*replies);
+                replies->commitPush(exchange, size);
+                flushBlocking(*replies);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "echo process failed: " << e.what() << std::endl;
+        status = 1;
+    }
+    _exit(status);
+}
+
+std::vector<Result> benchHostLink(halo::HostLinkType type, const Options& options) {
+    std::string session = "bench" + std::to_string(getpid());
+    std::string requestName = halo::HostLink::linkName(session, 0, 0, 1);
+    std::string replyName = halo::HostLink::linkName(session, 0, 1, 0);
+    uint64_t slotBytes = *std::max_element(options.sizes.begin(), options.sizes.end());
+
+    // Both receiving ends exist before the fork; each process opens its sending end
+    auto requests = halo::HostLink::create(type, requestName, 4, slotBytes);
+    auto replies = halo::HostLink::create(type, replyName, 4, slotBytes);
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("fork failed");
+    }
+    if (pid == 0) {
+        runEcho(*requests, type, replyName, slotBytes);
+    }
+    auto sender = halo::HostLink::open(type, requestName, slotBytes, std::chrono::seconds(10));
+
+    std::vector<Result> results;
+    uint64_t exchange = 0;
+    for (uint64_t bytes : options.sizes) {
+        Result result;
+        result.backend = halo::HostLink::typeName(type);
+        result.bytes = bytes;
+
+        // Latency: ping-pong, half the round trip
+        std::vector<double> samples;
+        for (uint32_t i = 0; i < options.iterations; ++i) {
+            auto start = Clock::now();
+            std::memset(pushBlocking(*sender), static_cast<int>(i), bytes);
+            sender->commitPush(++exchange | kEcho, bytes);
+            flushBlocking(*sender);
+            uint64_t replyExchange = 0;
+            uint64_t replySize = 0;
+            popBlocking(*replies, replyExchange, replySize);
+            replies->commitPop();
+            samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count() / 2.0);
+        }
+        result.latencyUs = median(samples);
+
+        // Bandwidth: stream messages, the last one is acknowledged
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < options.iterations; ++i) {
+            std::memset(pushBlocking(*sender), static_cast<int>(i), bytes);
+            sender->commitPush(++exchange | (i + 1 == options.iterations ? kEcho : 0), bytes);
+        }
+        flushBlocking(*sender);
+        uint64_t replyExchange = 0;
+        uint64_t replySize = 0;
+        popBlocking(*replies, replyExchange, replySize);
+        replies->commitPop();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.bandwidthGBs = static_cast<double>(bytes) * options.iterations / seconds / 1e9;
+
+        results.push_back(result);
+    }
+
+    pushBlocking(*sender);
+    sender->commitPush(kStop, 0);
+    flushBlocking(*sender);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error(std::string("echo process for ") + halo::HostLink::typeName(type) + " failed");
+    }
+    return results;
+}
+
+std::vector<Result> benchDeviceCopy(const Options& options) {
+    core::VulkanContext context;
+    context.init(false);
+
+    std::vector<Result> results;
+    {
+        core::MemoryAllocator allocator(context);
+        vk::CommandPool pool = context.createCommandPool(context.getComputeQueueFamily());
+        vk::Queue queue = context.getComputeQueue();
+
+        for (uint64_t bytes : options.sizes) {
+            auto src = allocator.createBuffer(bytes, vk::BufferUsageFlagBits::eTransferSrc);
+            auto dst = allocator.createBuffer(bytes, vk::BufferUsageFlagBits::eTransferDst);
+            vk::BufferCopy region(0, 0, bytes);
+
+            Result result;
+            result.backend = "device";
+            result.bytes = bytes;
+
+            // Latency: one copy per submission, as a halo transfer is submitted
+            std::vector<double> samples;
+            for (uint32_t i = 0; i < options.iterations; ++i) {
+                auto start = Clock::now();
+                vk::CommandBuffer cmd = context.beginSingleTimeCommands(pool);
+                cmd.copyBuffer(src.handle, dst.handle, region);
+                context.endSingleTimeCommands(cmd, pool, queue);
+                samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            }
+            result.latencyUs = median(samples);
+
+            // Bandwidth: back-to-back copies in one submission
+            auto start = Clock::now();
+            vk::CommandBuffer cmd = context.beginSingleTimeCommands(pool);
+            for (uint32_t i = 0; i < options.iterations; ++i) {
+                cmd.copyBuffer(src.handle, dst.handle, region);
+            }
+            context.endSingleTimeCommands(cmd, pool, queue);
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            result.bandwidthGBs = static_cast<double>(bytes) * options.iterations / seconds / 1e9;
+
+            allocator.destroyBuffer(src);
+            allocator.destroyBuffer(dst);
+            results.push_back(result);
+        }
+        context.getDevice().destroyCommandPool(pool);
+    }
+    context.cleanup();
+    return results;
+}
+
+void writeCSV(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+    file << "backend,bytes,latency_us,bandwidth_gbs\n";
+    for (const auto& result : results) {
+        file << result.backend << "," << result.bytes << "," << result.latencyUs << ","
+             << result.bandwidthGBs << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    core::Logger::init(spdlog::level::warn);
+
+    try {
+        std::vector<Result> results;
+        for (const auto& backend : options.backends) {
+            std::vector<Result> backendResults;
+            if (backend == "device") {
+                backendResults = benchDeviceCopy(options);
+            } else {
+                backendResults = benchHostLink(halo::HostLink::parseType(backend), options);
+            }
+
+            for (const auto& result : backendResults) {
+                std::cout << "  " << result.backend << " " << result.bytes << " B"
+                          << ": latency " << result.latencyUs << " us"
+                          << ", bandwidth " << result.bandwidthGBs << " GB/s" << std::endl;
+            }
+            results.insert(results.end(), backendResults.begin(), backendResults.end());
+        }
+
+        if (!options.csvPath.empty()) {
+            writeCSV(options.csvPath, results);
+            std::cout << "✓ Wrote " << options.csvPath << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "transport_bench failed: " << e.what() << std::endl;
+        core::Logger::shutdown();
+        return 1;
+    }
+
+    core::Logger::shutdown();
+    return 0;
+}